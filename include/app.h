@@ -3,6 +3,11 @@
 #include <wx/wx.h>
 #include "mainframe.h"
 #include "config/configmanager.h"
+#include "lua/luascript.h"
+#include "ui/notificationcenter.h"
+#include "util/systemsampler.h"
+#include "util/timeseries.h"
+#include "widgets/tickscheduler.h"
 
 namespace ITD {
 
@@ -25,15 +30,69 @@ public:
      */
     virtual int OnExit() override;
 
+    /**
+     * @brief Called when an event loop starts running
+     * @param loop The event loop being entered
+     */
+    virtual void OnEventLoopEnter(wxEventLoopBase* loop) override;
+
     /**
      * @brief Get the configuration manager instance
      * @return Reference to the configuration manager
      */
     ConfigManager& GetConfigManager() { return m_configManager; }
 
+    /**
+     * @brief Get the main application window
+     * @return Main window, or nullptr before it is created
+     */
+    MainFrame* GetMainFrame() const { return m_mainFrame; }
+
+    /**
+     * @brief Get the Lua scripting engine
+     * @return Reference to the Lua script instance
+     */
+    LuaScript& GetLuaScript() { return m_luaScript; }
+
+    /**
+     * @brief Get the shared scheduler for periodic UI updates
+     * @return Reference to the tick scheduler
+     */
+    TickScheduler& GetTickScheduler() { return m_tickScheduler; }
+
+    /**
+     * @brief Get the shared system resource sampler
+     * @return Reference to the sampler; it runs while widgets are subscribed
+     */
+    SystemSampler& GetSystemSampler() { return m_systemSampler; }
+
+    /**
+     * @brief Get the metric history shared by widgets
+     * @return Reference to the time series store
+     */
+    TimeSeriesStore& GetTimeSeries() { return m_timeSeries; }
+
+    /**
+     * @brief Get the notification center
+     * @return Reference to the notification center; Post() is safe from any thread
+     */
+    NotificationCenter& GetNotificationCenter() { return m_notificationCenter; }
+
 private:
     MainFrame* m_mainFrame = nullptr;  ///< Main application window
     ConfigManager m_configManager;     ///< Configuration manager
+    // Declared before the script so that it outlives its worker threads
+    NotificationCenter m_notificationCenter;  ///< Notifications from any thread
+    LuaScript m_luaScript;             ///< User scripting
+    TickScheduler m_tickScheduler;     ///< Periodic widget and taskbar updates
+    SystemSampler m_systemSampler;     ///< CPU, memory, disk and network usage
+    TimeSeriesStore m_timeSeries;      ///< Metric history for graphs
+
+    // Run the user's init.lua from the configuration directory
+    void LoadUserScripts();
+
+    // First idle after the main window is shown: the prompt is interactive
+    void OnStartupIdle(wxIdleEvent& event);
 };
 
 } // namespace ITD
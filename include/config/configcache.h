@@ -0,0 +1,132 @@
+#pragma once
+
+#include <wx/wx.h>
+#include <cstdint>
+#include <vector>
+#include "config/configwatcher.h"
+#include "util/mappedfile.h"
+
+namespace ITD {
+
+/**
+ * @brief Binary cache of the parsed configuration file
+ *
+ * The cache holds every entry of the configuration file as sorted, fixed-size
+ * records plus a UTF-8 string table. It is memory-mapped and queried in
+ * place, so startup does not parse INI text and does not grow with the size
+ * of the configuration.
+ *
+ * A cache is only used if it matches its source file: same size and
+ * modification time, or, if only the time differs, the same content hash.
+ */
+class ConfigCache {
+public:
+    /**
+     * @brief Constructor
+     */
+    ConfigCache() = default;
+
+    /**
+     * @brief Map the cache for a configuration file
+     * @param configPath Configuration (source) file path
+     * @return True if a valid, up-to-date cache was mapped
+     */
+    bool Open(const wxString& configPath);
+
+    /**
+     * @brief Unmap the cache
+     */
+    void Close();
+
+    /**
+     * @brief Check if a cache is mapped
+     * @return True if mapped
+     */
+    bool IsOpen() const { return m_header != nullptr; }
+
+    /**
+     * @brief Look up a value
+     * @param section Configuration section
+     * @param key Configuration key
+     * @param value Receives the raw value
+     * @return True if the entry exists
+     */
+    bool Find(const wxString& section, const wxString& key, wxString& value) const;
+
+    /**
+     * @brief Get all sections, in cache order
+     * @return Vector of section names
+     */
+    std::vector<wxString> GetSections() const;
+
+    /**
+     * @brief Get all keys in a section
+     * @param section Configuration section
+     * @return Vector of key names
+     */
+    std::vector<wxString> GetKeys(const wxString& section) const;
+
+    /**
+     * @brief Materialize every entry
+     * @return Flattened configuration content
+     */
+    ConfigEntries ReadEntries() const;
+
+    /**
+     * @brief Rebuild the cache from the current content of a configuration file
+     *
+     * Does not touch any instance state and may be called from any thread.
+     *
+     * @param configPath Configuration (source) file path
+     * @return True if successful
+     */
+    static bool Update(const wxString& configPath);
+
+    /**
+     * @brief Get the cache file path for a configuration file
+     * @param configPath Configuration (source) file path
+     * @return Cache file path
+     */
+    static wxString GetCachePath(const wxString& configPath);
+
+private:
+    // On-disk layout: Header, Entry[entryCount], string table
+    struct StringRef {
+        uint32_t offset;   ///< Offset into the string table
+        uint32_t length;   ///< Length in bytes
+    };
+
+    struct Entry {
+        StringRef section; ///< Section name
+        StringRef key;     ///< Key name
+        StringRef value;   ///< Raw value
+    };
+
+    struct Header {
+        char magic[8];            ///< File identification
+        uint32_t version;         ///< Format version
+        uint32_t byteOrder;       ///< Written as 0x01020304
+        uint64_t entryCount;      ///< Number of entries
+        uint64_t stringsSize;     ///< String table size in bytes
+        int64_t sourceModified;   ///< Source modification time (ms since epoch)
+        uint64_t sourceSize;      ///< Source size in bytes
+        uint64_t sourceHash;      ///< Source content hash
+    };
+
+    MappedFile m_file;                    ///< Mapped cache file
+    const Header* m_header = nullptr;     ///< Header inside the mapping
+    const Entry* m_entries = nullptr;     ///< Sorted entries inside the mapping
+    const char* m_strings = nullptr;      ///< String table inside the mapping
+
+    // Resolve a string reference
+    wxString GetString(const StringRef& ref) const;
+
+    // Find the first entry not ordered before (section, key)
+    const Entry* LowerBound(const char* section, size_t sectionLength,
+                            const char* key, size_t keyLength) const;
+
+    // Check a mapped cache against its source file
+    bool IsValid(const wxString& configPath) const;
+};
+
+} // namespace ITD
\ No newline at end of file
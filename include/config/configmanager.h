@@ -4,12 +4,29 @@
 #include <wx/fileconf.h>
 #include <wx/filename.h>
 #include <unordered_map>
+#include <map>
+#include <set>
 #include <string>
 #include <vector>
 #include <memory>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include "config/configsnapshot.h"
+#include "config/configcache.h"
+#include "config/configwatcher.h"
+#include "config/configsaver.h"
 
 namespace ITD {
 
+/**
+ * @brief Listener for configuration changes
+ *
+ * Called on the UI thread with the newly published snapshot and the mask of
+ * ConfigChange flags describing what changed.
+ */
+using ConfigChangeListener = std::function<void(const ConfigSnapshot& snapshot, uint32_t changes)>;
+
 /**
  * @brief Configuration manager for ITD
  * 
@@ -30,6 +47,10 @@ public:
 
     /**
      * @brief Load configuration from disk
+     *
+     * If an up-to-date binary cache of the file exists it is mapped and read
+     * in place; the INI text is only parsed once something is modified.
+     *
      * @param filename Configuration file path (optional)
      * @return True if successful
      */
@@ -37,11 +58,27 @@ public:
 
     /**
      * @brief Save configuration to disk
+     *
+     * The file is replaced atomically; only sections changed since the last
+     * save are re-serialized.
+     *
      * @param filename Configuration file path (optional)
      * @return True if successful
      */
     bool Save(const wxString& filename = wxEmptyString);
 
+    /**
+     * @brief Enable or disable automatic saving
+     *
+     * When enabled, changes schedule a debounced save that is written in the
+     * background once changes stop arriving, so bursts of updates (such as
+     * dragging widgets around) result in a single write. Disabling flushes a
+     * pending save.
+     *
+     * @param enable True to enable
+     */
+    void EnableAutoSave(bool enable);
+
     /**
      * @brief Get string value
      * @param section Configuration section
@@ -168,10 +205,130 @@ public:
      */
     wxString GetConfigFilePath() const { return m_configFilePath; }
 
+    /**
+     * @brief Get the current typed configuration snapshot
+     *
+     * This is a single atomic load and is cheap enough to call on every
+     * paint or tick. The snapshot is replaced whenever a section it covers
+     * changes; the returned one stays valid for as long as it is held.
+     *
+     * @return Current snapshot, never null
+     */
+    std::shared_ptr<const ConfigSnapshot> GetSnapshot() const { return std::atomic_load(&m_snapshot); }
+
+    /**
+     * @brief Register a change listener
+     * @param mask ConfigChange flags the listener is interested in
+     * @param listener Callback invoked when any of those areas change
+     * @return Listener ID for RemoveChangeListener()
+     */
+    int AddChangeListener(uint32_t mask, ConfigChangeListener listener);
+
+    /**
+     * @brief Unregister a change listener
+     * @param id Listener ID returned by AddChangeListener()
+     */
+    void RemoveChangeListener(int id);
+
+    /**
+     * @brief Start a batch of changes
+     *
+     * Until the matching EndBatch(), changes are applied and saved as usual
+     * but the snapshot is not republished, so listeners are notified once
+     * for the whole batch instead of once per value. Batches nest.
+     */
+    void BeginBatch() { ++m_batchDepth; }
+
+    /**
+     * @brief End a batch of changes
+     *
+     * The outermost call publishes the snapshot and notifies the listeners
+     * if a covered section changed during the batch.
+     */
+    void EndBatch();
+
+    /**
+     * @brief Start watching the configuration file for external edits
+     *
+     * Edits are parsed in the background, merged into the current
+     * configuration and reported to the listeners of the affected areas.
+     * Requires a running event loop.
+     *
+     * @return True if the watch was installed
+     */
+    bool StartWatching();
+
+    /**
+     * @brief Stop watching the configuration file
+     */
+    void StopWatching();
+
+    /**
+     * @brief Parse a configuration file into flattened entries
+     *
+     * Does not touch any ConfigManager state and may be called from any thread.
+     *
+     * @param filename Configuration file path
+     * @param entries Receives the parsed content
+     * @return True if successful
+     */
+    static bool ReadEntries(const wxString& filename, ConfigEntries& entries);
+
+    /**
+     * @brief Parse configuration file content into flattened entries
+     *
+     * Does not touch any ConfigManager state and may be called from any thread.
+     *
+     * @param data File content
+     * @param size Content size in bytes
+     * @param entries Receives the parsed content
+     * @return True if successful
+     */
+    static bool ParseEntries(const char* data, size_t size, ConfigEntries& entries);
+
+    /**
+     * @brief Serialize flattened entries in the configuration file format
+     *
+     * The inverse of ParseEntries(); may be called from any thread.
+     *
+     * @param entries Sections and their values
+     * @return File content
+     */
+    static std::string SerializeEntries(const ConfigEntries& entries);
+
 private:
-    std::unique_ptr<wxFileConfig> m_config;  ///< Configuration object
+    std::unique_ptr<wxFileConfig> m_config;  ///< Configuration object (null while served from m_binaryCache)
     wxString m_configFilePath;               ///< Configuration file path
 
+    // Typed snapshot published to readers (std::atomic_load/atomic_store only)
+    std::shared_ptr<const ConfigSnapshot> m_snapshot;
+    uint64_t m_snapshotGeneration = 0;
+
+    // Change notification
+    struct ListenerEntry {
+        int id;
+        uint32_t mask;
+        ConfigChangeListener callback;
+    };
+    std::vector<ListenerEntry> m_listeners;
+    int m_nextListenerId = 1;
+    int m_batchDepth = 0;                 ///< Nesting level of BeginBatch()
+    bool m_batchSnapshotStale = false;    ///< A covered section changed during the batch
+
+    // Incremental saving
+    std::set<wxString> m_dirtySections;              ///< Sections changed since the last save
+    std::map<wxString, uint64_t> m_unsavedSections;  ///< Serialized sections by save sequence, not yet known written
+    std::map<wxString, std::string> m_sectionText;   ///< Serialized text per section
+    std::unique_ptr<ConfigSaver> m_saver;            ///< Background saver (auto-save only)
+
+    // External edit tracking
+    std::unique_ptr<ConfigWatcher> m_watcher;
+    ConfigEntries m_fileEntries;  ///< File content as last loaded or saved
+
+    // Binary cache of the file for fast startup
+    ConfigCache m_binaryCache;    ///< Mapped cache, open until the config is materialized
+    std::thread m_cacheThread;    ///< Rebuilds the cache after a synchronous save
+
     // Cache for faster access
     mutable std::unordered_map<wxString, std::unordered_map<wxString, wxString>> m_cache;
 
@@ -183,6 +340,43 @@ private:
 
     // Create default configuration
     void CreateDefaultConfig();
+
+    // Read m_configFilePath (or its binary cache), or create it on first run
+    bool ReadConfigFile();
+
+    // Parse the configuration from the mapped binary cache before modifying it
+    void EnsureConfig();
+
+    // Rebuild the binary cache in the background
+    void RefreshBinaryCache();
+
+    // Build a typed snapshot from the current configuration
+    std::unique_ptr<ConfigSnapshot> CompileSnapshot() const;
+
+    // Atomically replace the published snapshot, returning what changed
+    uint32_t PublishSnapshot(std::unique_ptr<ConfigSnapshot> snapshot);
+
+    // Notify the listeners interested in the changes
+    void NotifyListeners(uint32_t changes);
+
+    // Flatten a configuration object into entries
+    static ConfigEntries CollectEntries(wxConfigBase& config);
+
+    // Merge edits made to the file since it was last loaded or saved
+    void ApplyExternalChanges(const ConfigEntries& entries);
+
+    // Mark a section dirty, republish the snapshot if it covers it, and schedule a save
+    void OnSectionChanged(const wxString& section);
+
+    // Serialize the configuration, reusing the text of clean sections; a
+    // commit moves the dirty sections to m_unsavedSections under sequence
+    std::string Serialize(bool commit, uint64_t sequence = 0);
+
+    // A background write finished: forget or re-dirty the sections it covered
+    void OnWritten(uint64_t sequence, bool success);
+
+    // Serialize a single section and collect its values
+    std::string SerializeSection(const wxString& section, std::map<wxString, wxString>& values) const;
 };
 
 } // namespace ITD 
\ No newline at end of file
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <wx/wx.h>
+#include <wx/timer.h>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+namespace ITD {
+
+/**
+ * @brief Debounced, crash-safe background writer for the configuration file
+ *
+ * Save requests are coalesced: each request restarts a short quiet period on
+ * the UI thread, and only when it expires is the configuration serialized
+ * (on the UI thread, which owns it) and handed to a writer thread. The
+ * writer replaces the file atomically. If new data arrives while a write is
+ * in flight, only the latest data is written next.
+ *
+ * Each serialization gets a sequence number, and the outcome of every write
+ * is reported back on the UI thread with the number of the data it wrote,
+ * so the owner can tell which changes reached the file. Data superseded
+ * before it was written is not reported.
+ */
+class ConfigSaver : public wxEvtHandler {
+public:
+    /**
+     * @brief Callback producing the file content; runs on the UI thread
+     *
+     * Receives the sequence number the data will be reported with.
+     */
+    using SerializeCallback = std::function<std::string(uint64_t sequence)>;
+
+    /**
+     * @brief Callback run on the UI thread after each write
+     *
+     * Receives the sequence number of the written data and whether the
+     * file was replaced.
+     */
+    using WrittenCallback = std::function<void(uint64_t sequence, bool success)>;
+
+    /**
+     * @brief Constructor
+     * @param serialize Callback producing the data to write
+     * @param written Optional callback told about each write
+     */
+    explicit ConfigSaver(SerializeCallback serialize, WrittenCallback written = WrittenCallback());
+
+    /**
+     * @brief Destructor
+     *
+     * Writes any pending data before returning.
+     */
+    virtual ~ConfigSaver();
+
+    /**
+     * @brief Request a save
+     *
+     * The save happens once no further request has arrived for the debounce
+     * period.
+     *
+     * @param filename File to write
+     */
+    void Schedule(const wxString& filename);
+
+    /**
+     * @brief Drop a scheduled save and wait for an in-flight write to finish
+     *
+     * Call before writing the file synchronously so that an older background
+     * write cannot land after it.
+     */
+    void Cancel();
+
+    /**
+     * @brief Check if a save is scheduled or being written
+     * @return True if there is unwritten data
+     */
+    bool IsPending() const;
+
+private:
+    SerializeCallback m_serialize;     ///< Produces the file content
+    WrittenCallback m_written;         ///< Post-write hook (UI thread)
+    wxTimer m_debounceTimer;           ///< Coalesces save requests
+    wxString m_filename;               ///< File for the scheduled save
+    uint64_t m_sequence = 0;           ///< Sequence number of the last serialization
+
+    // Writer thread state
+    std::thread m_writerThread;                 ///< Writer thread
+    mutable std::mutex m_mutex;                 ///< Guards the fields below
+    std::condition_variable m_condition;        ///< Signals work and completion
+    wxString m_pendingFilename;                 ///< File for the pending write
+    std::string m_pendingData;                  ///< Data for the pending write
+    uint64_t m_pendingSequence = 0;             ///< Sequence number of the pending write
+    bool m_hasPending = false;                  ///< Pending write available
+    bool m_writing = false;                     ///< Write in flight
+    bool m_stopping = false;                    ///< Writer should exit
+
+    // Event handlers
+    void OnDebounceTimer(wxTimerEvent& event);
+
+    // Serialize and hand the data to the writer thread
+    void Enqueue(const wxString& filename);
+
+    // Writer thread function
+    void WriterLoop();
+};
+
+} // namespace ITD
\ No newline at end of file
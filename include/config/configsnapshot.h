@@ -0,0 +1,127 @@
+#pragma once
+
+#include <wx/wx.h>
+#include <cstdint>
+
+namespace ITD {
+
+/**
+ * @brief Areas of the configuration reported by change notifications
+ *
+ * Listeners subscribe with a mask of these flags so that, for example,
+ * editing a terminal color only re-applies the terminal color scheme.
+ */
+enum ConfigChange : uint32_t {
+    ConfigChangeNone            = 0,
+    ConfigChangeTerminalFont    = 1 << 0,  ///< Terminal font name or size
+    ConfigChangeTerminalColors  = 1 << 1,  ///< Terminal color scheme
+    ConfigChangeTerminalMode    = 1 << 2,  ///< Terminal behavior (Vim mode)
+    ConfigChangeTransparency    = 1 << 3,  ///< Window transparency
+    ConfigChangeTheme           = 1 << 4,  ///< Theme name
+    ConfigChangeTaskbarPosition = 1 << 5,  ///< Taskbar docking edge
+    ConfigChangeTaskbar         = 1 << 6,  ///< Other taskbar settings
+    ConfigChangeWidgets         = 1 << 7,  ///< Widget settings
+    ConfigChangeWidgetLayout    = 1 << 8,  ///< Per-widget layout sections
+    ConfigChangeExplorer        = 1 << 9,  ///< Explorer pane settings
+    ConfigChangeOther           = 1 << 10, ///< Any section not covered above
+    ConfigChangeAll             = 0xFFFFFFFF
+};
+
+/**
+ * @brief Typed, immutable view of the configuration
+ *
+ * A snapshot is compiled by ConfigManager whenever the configuration is
+ * loaded or one of its sections changes, and is then published atomically.
+ * Hot paths (painting, per-frame updates) read plain fields from here
+ * instead of going through the string-keyed ConfigManager getters, so no
+ * hashing, locking or parsing happens on read.
+ *
+ * ConfigManager::GetSnapshot() returns a shared pointer; a snapshot stays
+ * valid for as long as someone holds it, however often newer ones are
+ * published. Listeners get a reference that is valid during the call.
+ */
+struct ConfigSnapshot {
+    /**
+     * @brief Screen edge used for docked components
+     */
+    enum class Edge {
+        Top,      ///< Docked at the top
+        Bottom,   ///< Docked at the bottom
+        Left,     ///< Docked at the left
+        Right     ///< Docked at the right
+    };
+
+    /**
+     * @brief Terminal settings, compiled from the [terminal] section
+     */
+    struct Terminal {
+        wxString fontName = "Cascadia Code";               ///< Font face name
+        int fontSize = 12;                                 ///< Font size in points
+        wxColour foreground = wxColour(0xF2, 0xF2, 0xF2);  ///< Text color
+        wxColour background = wxColour(0x0C, 0x0C, 0x0C); ///< Background color
+        wxColour selection = wxColour(0x26, 0x4F, 0x78);   ///< Selection color
+        bool vimMode = false;                              ///< Vim mode enabled at startup
+    } terminal;
+
+    /**
+     * @brief General appearance settings, compiled from the [ui] section
+     */
+    struct Appearance {
+        bool transparencyEnabled = true;   ///< Whether transparency is applied at all
+        unsigned char transparency = 230;  ///< Window alpha (0-255)
+        wxString theme = "default";        ///< Theme name
+    } ui;
+
+    /**
+     * @brief Taskbar settings, compiled from the [taskbar] section
+     */
+    struct TaskbarSettings {
+        Edge position = Edge::Bottom;      ///< Docking edge
+        bool visible = true;               ///< Taskbar shown at startup
+        bool showClock = true;             ///< Show the clock area
+        wxString clockFormat = "%H:%M";    ///< strftime-style clock format
+    } taskbar;
+
+    /**
+     * @brief Widget settings, compiled from the [widgets] section
+     */
+    struct Widgets {
+        bool visible = true;               ///< Widgets shown at startup
+        unsigned char transparency = 255;  ///< Widget alpha (0-255)
+    } widgets;
+
+    /**
+     * @brief Explorer settings, compiled from the [explorer] section
+     */
+    struct Explorer {
+        bool visible = false;              ///< Explorer pane shown at startup
+        int width = 300;                   ///< Preferred pane width in pixels
+    } explorer;
+
+    uint64_t generation = 0;  ///< Incremented for every published snapshot
+
+    /**
+     * @brief Parse an edge name ("top", "bottom", "left", "right")
+     * @param name Edge name, case-insensitive
+     * @param defaultVal Value returned for unknown names
+     * @return Parsed edge
+     */
+    static Edge ParseEdge(const wxString& name, Edge defaultVal = Edge::Bottom);
+
+    /**
+     * @brief Get the configuration name of an edge
+     * @param edge Edge value
+     * @return Lower-case edge name
+     */
+    static wxString EdgeName(Edge edge);
+
+    /**
+     * @brief Compare two snapshots
+     * @param before Previous snapshot
+     * @param after New snapshot
+     * @return Mask of ConfigChange flags for the areas that differ
+     */
+    static uint32_t Diff(const ConfigSnapshot& before, const ConfigSnapshot& after);
+};
+
+} // namespace ITD
\ No newline at end of file
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <wx/wx.h>
+#include <wx/fswatcher.h>
+#include <wx/timer.h>
+#include <map>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <functional>
+
+namespace ITD {
+
+/**
+ * @brief Flattened configuration content: section -> key -> raw value
+ */
+using ConfigEntries = std::map<wxString, std::map<wxString, wxString>>;
+
+/**
+ * @brief Watches the configuration file and re-parses it in the background
+ *
+ * The watcher monitors the directory containing the configuration file
+ * (editors often save by writing a new file and renaming it), debounces
+ * bursts of file system events, parses the file on a worker thread and hands
+ * the parsed entries back to the UI thread through a callback.
+ */
+class ConfigWatcher : public wxEvtHandler {
+public:
+    /**
+     * @brief Callback invoked on the UI thread with freshly parsed entries
+     */
+    using ReloadCallback = std::function<void(const ConfigEntries& entries)>;
+
+    /**
+     * @brief Constructor
+     * @param filename Configuration file to watch
+     * @param callback Callback receiving the parsed file content
+     */
+    ConfigWatcher(const wxString& filename, ReloadCallback callback);
+
+    /**
+     * @brief Destructor
+     */
+    virtual ~ConfigWatcher();
+
+    /**
+     * @brief Start watching
+     *
+     * Requires a running event loop.
+     *
+     * @return True if the watch was installed
+     */
+    bool Start();
+
+    /**
+     * @brief Stop watching and wait for a running parse to finish
+     */
+    void Stop();
+
+    /**
+     * @brief Check if the watcher is active
+     * @return True if watching
+     */
+    bool IsWatching() const { return m_watcher != nullptr; }
+
+private:
+    wxString m_filename;                              ///< Watched configuration file
+    ReloadCallback m_callback;                        ///< Reload callback
+    std::unique_ptr<wxFileSystemWatcher> m_watcher;   ///< File system watcher
+    wxTimer m_debounceTimer;                          ///< Coalesces bursts of events
+    std::thread m_parseThread;                        ///< Background parse thread
+    std::atomic<bool> m_parsing{false};               ///< Parse in progress
+    bool m_reloadPending = false;                     ///< File changed again while parsing
+
+    // Event handlers
+    void OnFileSystemEvent(wxFileSystemWatcherEvent& event);
+    void OnDebounceTimer(wxTimerEvent& event);
+
+    // Parse the file on the worker thread
+    void StartParse();
+    void OnParseFinished(const ConfigEntries& entries, bool success);
+};
+
+} // namespace ITD
\ No newline at end of file
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct lua_State;
+
+namespace ITD {
+
+/**
+ * @brief Memory allocator for a Lua state
+ *
+ * Small blocks (up to kMaxPooledSize bytes) come from per-size-class free
+ * lists carved out of large arena chunks, so the short-lived tables and
+ * strings created per event are recycled without going through the system
+ * heap. Larger blocks use malloc/realloc.
+ *
+ * An optional memory limit caps the bytes a state may hold. A refused
+ * allocation makes Lua run an emergency full collection and retry, and if
+ * that does not help the script fails with a memory error; the heap of a
+ * state therefore never grows past the limit.
+ *
+ * An allocator serves one state and is not thread-safe; like the state it
+ * must only be used from one thread at a time. It must outlive the state.
+ */
+class LuaAllocator {
+public:
+    static constexpr size_t kSizeClassGranularity = 16;  ///< Size class step (and block alignment)
+    static constexpr size_t kMaxPooledSize = 256;        ///< Largest pooled block
+    static constexpr size_t kArenaChunkSize = 64 * 1024; ///< Bytes reserved per arena chunk
+
+    /**
+     * @brief Allocation statistics
+     */
+    struct Stats {
+        size_t bytesInUse = 0;          ///< Bytes currently allocated by Lua
+        size_t peakBytesInUse = 0;      ///< Highest bytesInUse so far
+        size_t arenaBytes = 0;          ///< Bytes reserved by arena chunks
+        size_t largeBytes = 0;          ///< Bytes in blocks from the system heap
+        uint64_t allocations = 0;       ///< Blocks allocated
+        uint64_t frees = 0;             ///< Blocks freed
+        uint64_t pooledAllocations = 0; ///< Blocks served by a size class
+        uint64_t refusedAllocations = 0;///< Allocations refused by the limit
+    };
+
+    /**
+     * @brief Constructor
+     * @param limit Maximum bytes in use (0 = unlimited)
+     */
+    explicit LuaAllocator(size_t limit = 0);
+
+    /**
+     * @brief Destructor
+     *
+     * Releases all arena chunks; the state must already be closed.
+     */
+    ~LuaAllocator();
+
+    /**
+     * @brief Create a Lua state using this allocator
+     * @return New state, or nullptr on failure
+     */
+    lua_State* NewState();
+
+    /**
+     * @brief Set the memory limit
+     *
+     * Lowering the limit below the current usage only affects future growth.
+     *
+     * @param limit Maximum bytes in use (0 = unlimited)
+     */
+    void SetLimit(size_t limit) { m_limit = limit; }
+
+    /**
+     * @brief Get the memory limit
+     * @return Maximum bytes in use (0 = unlimited)
+     */
+    size_t GetLimit() const { return m_limit; }
+
+    /**
+     * @brief Get the allocation statistics
+     * @return Statistics
+     */
+    const Stats& GetStats() const { return m_stats; }
+
+    /**
+     * @brief Allocation function with the lua_Alloc signature
+     * @param userData LuaAllocator instance
+     * @param block Block to resize, or nullptr
+     * @param oldSize Current block size (an object type if block is nullptr)
+     * @param newSize Requested size (0 frees the block)
+     * @return Resized block, or nullptr on failure or when freeing
+     */
+    static void* Allocate(void* userData, void* block, size_t oldSize, size_t newSize);
+
+private:
+    static constexpr size_t kSizeClassCount = kMaxPooledSize / kSizeClassGranularity;
+
+    // Heap blocks have room for a link past the largest pooled size, so that
+    // a shrink into the pool can keep them (see KeepBlock())
+    static constexpr size_t kMinHeapBlockSize = kMaxPooledSize + sizeof(void*);
+
+    // Free block header; free blocks are linked through their first bytes
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    size_t m_limit;                                        ///< Maximum bytes in use (0 = unlimited)
+    Stats m_stats;                                         ///< Allocation statistics
+    std::array<FreeBlock*, kSizeClassCount> m_freeLists{}; ///< Free blocks per size class
+    std::vector<void*> m_chunks;                           ///< Arena chunks
+    char* m_chunkCursor = nullptr;                         ///< Next unused byte in the current chunk
+    char* m_chunkEnd = nullptr;                            ///< End of the current chunk
+    void* m_keptHeapBlocks = nullptr;                      ///< Heap blocks moved into the pool by KeepBlock()
+
+    // Resize a block; see Allocate()
+    void* Reallocate(void* block, size_t oldSize, size_t newSize);
+
+    // Get a block of the given size, or release one
+    void* AllocateBlock(size_t size);
+    void ReleaseBlock(void* block, size_t size);
+
+    // Finish a shrink that could not move the block, keeping it in place
+    void* KeepBlock(void* block, size_t oldSize, size_t newSize);
+
+    // Carve a block from the arena
+    void* AllocateFromArena(size_t blockSize);
+
+    // Size class of a pooled size (1..kMaxPooledSize)
+    static size_t GetSizeClass(size_t size) { return (size - 1) / kSizeClassGranularity; }
+
+    LuaAllocator(const LuaAllocator&) = delete;
+    LuaAllocator& operator=(const LuaAllocator&) = delete;
+};
+
+} // namespace ITD
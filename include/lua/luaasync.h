@@ -0,0 +1,145 @@
+#pragma once
+
+#include <wx/wx.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "util/threadpool.h"
+
+struct lua_State;
+
+namespace ITD {
+
+/**
+ * @brief Coroutine-based asynchronous file I/O for Lua
+ *
+ * Scripts start a task with itd.Async(fn, ...), which runs fn as a
+ * coroutine on the UI thread. Inside a task, the asynchronous functions
+ * queue their work on a thread pool and yield the coroutine; it is resumed
+ * on the UI thread when the result is ready, so the UI never blocks:
+ *
+ *  - itd.ReadFileAsync(path) returns the content, or nil and an error
+ *  - itd.ListDirectoryAsync(path) returns a table of names, or nil and an error
+ *  - itd.ReadChunks(path, [size]) iterates over chunks of a file
+ *  - itd.ListDirectoryChunks(path, [count]) iterates over batches of names
+ *
+ * The iterators keep one read ahead of the script and raise an error if a
+ * read fails, so memory stays flat however large the file or directory is.
+ * A plain coroutine.yield() in a task gives the UI a turn and continues on
+ * the next event loop iteration.
+ */
+class LuaAsync : public wxEvtHandler {
+public:
+    /**
+     * @brief Called with the message and traceback of a failed task
+     */
+    using ErrorHandler = std::function<void(const wxString& message)>;
+
+    /**
+     * @brief Constructor
+     * @param L Main Lua state; must outlive this object
+     * @param onError Error handler
+     */
+    LuaAsync(lua_State* L, ErrorHandler onError);
+
+    /**
+     * @brief Destructor
+     *
+     * Waits for running reads; pending tasks are never resumed.
+     */
+    virtual ~LuaAsync();
+
+    /**
+     * @brief Add the asynchronous functions to a table
+     *
+     * The table must be on the top of the stack of the main state.
+     */
+    void RegisterFunctions();
+
+    /**
+     * @brief Get the number of unfinished tasks
+     * @return Task count
+     */
+    size_t GetTaskCount() const { return m_tasks.size(); }
+
+    static constexpr size_t kDefaultChunkSize = 64 * 1024;  ///< ReadChunks() default
+    static constexpr size_t kDefaultBatchSize = 256;        ///< ListDirectoryChunks() default
+
+private:
+    /**
+     * @brief Outcome of a background read
+     */
+    struct Result {
+        enum class Kind { Data, Names, End, Error };
+        Kind kind = Kind::End;
+        std::string data;             ///< File content (Data)
+        std::vector<wxString> names;  ///< Directory entries (Names)
+        wxString error;               ///< Error message (Error)
+    };
+
+    using Producer = std::function<Result()>;
+
+    /**
+     * @brief Read-ahead state of a chunk iterator (UI thread only)
+     */
+    struct Stream {
+        Producer next;                ///< Reads the next chunk (one call at a time)
+        std::optional<Result> ready;  ///< Chunk read ahead
+        bool pending = false;         ///< A read is running
+        bool finished = false;        ///< End or error was read
+        lua_State* waiter = nullptr;  ///< Task waiting for the pending read
+    };
+
+    /**
+     * @brief Running task
+     */
+    struct Task {
+        int ref;               ///< Registry reference keeping the coroutine alive
+        bool waiting = false;  ///< Suspended until a read completes
+    };
+
+    lua_State* m_state;                             ///< Main Lua state
+    ErrorHandler m_onError;                         ///< Error handler
+    std::unordered_map<lua_State*, Task> m_tasks;   ///< Tasks by coroutine
+    std::atomic<bool> m_stopping{false};            ///< Abort long reads
+    ThreadPool m_pool;                              ///< I/O threads (destroyed first)
+
+    // Resume a task with arguments on its stack
+    void Resume(lua_State* co, lua_State* from, int argCount);
+
+    // Resume a waiting task with a result, from the event loop
+    void ResumeWithResult(lua_State* co, const Result& result);
+
+    // Run work in the background and resume the task with its result; the
+    // caller then yields
+    void Await(lua_State* co, Producer work);
+
+    // Push a chunk iterator and start reading
+    void PushStream(lua_State* L, Producer next);
+    void ReadAhead(const std::shared_ptr<Stream>& stream);
+    void OnStreamRead(const std::shared_ptr<Stream>& stream, Result result);
+
+    // Push a result as Lua values; returns the count. Raises on errors, so
+    // no C++ object of the caller may be alive
+    static int PushResult(lua_State* L, const Result& result);
+    static int PushResultThunk(lua_State* L);
+
+    // Raise an error unless L is a task; returns the task
+    Task& CheckTask(lua_State* L, const char* function);
+
+    // Lua functions (the LuaAsync is their first upvalue)
+    static LuaAsync& FromUpvalue(lua_State* L);
+    static int Async(lua_State* L);
+    static int ReadFileAsync(lua_State* L);
+    static int ListDirectoryAsync(lua_State* L);
+    static int ReadChunks(lua_State* L);
+    static int ListDirectoryChunks(lua_State* L);
+    static int StreamNext(lua_State* L);
+    static int StreamGc(lua_State* L);
+};
+
+} // namespace ITD
@@ -0,0 +1,436 @@
+#pragma once
+
+#include <wx/wx.h>
+#include <lua.hpp>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ITD {
+
+/**
+ * @brief Compile-time bindings between C++ functions and Lua
+ *
+ * Every bound function gets its own thunk, instantiated from its signature:
+ * the argument checks and conversions are unrolled at compile time, there is
+ * no std::function and no per-call heap allocation. A bound call costs the
+ * Lua C call itself plus one type check and one conversion per argument.
+ *
+ * Marshaling is defined by Stack<T> specializations. Supported types are
+ * bool, integers, floating point, const char*, std::string_view,
+ * std::string, wxString, std::optional<T> (nil when absent) and
+ * std::vector<T> (sequence tables). Functions that need the Lua state
+ * directly can still be bound as plain lua_CFunction.
+ *
+ * Lua raises errors with longjmp, which skips C++ destructors. Every call
+ * that can raise therefore happens while no C++ object of the call is
+ * alive: arguments are checked and prepared before any of them is
+ * converted, conversion itself never calls into Lua in a way that can fail,
+ * and a result with a destructor is pushed under lua_pcall. Exceptions
+ * thrown by bound functions are turned into Lua errors once the handler has
+ * exited.
+ */
+namespace LuaBinding {
+
+/**
+ * @brief Marshaling of a C++ type to and from the Lua stack
+ *
+ * Specializations provide:
+ * - Name(): type name used in error messages
+ * - Is(L, index): check the value without side effects
+ * - Prepare(L, index): do whatever conversion in place may raise a Lua
+ *   error, after Is(); returns whether the value was replaced
+ * - Get(L, index): convert the value without raising; only called after
+ *   Prepare()
+ * - Push(L, value): push a value; may raise, so must not hold C++ objects
+ *   with destructors while calling into Lua
+ */
+template<typename T, typename Enable = void>
+struct Stack;
+
+template<>
+struct Stack<bool> {
+    static const char* Name() { return "boolean"; }
+    static bool Is(lua_State* L, int index) { return lua_isboolean(L, index) || lua_isnoneornil(L, index); }
+    static bool Prepare(lua_State*, int) { return false; }
+    static bool Get(lua_State* L, int index) { return lua_toboolean(L, index) != 0; }
+    static void Push(lua_State* L, bool value) { lua_pushboolean(L, value); }
+};
+
+template<typename T>
+struct Stack<T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>>> {
+    static const char* Name() { return "integer"; }
+    static bool Is(lua_State* L, int index) {
+        int isInteger = 0;
+        lua_tointegerx(L, index, &isInteger);
+        return isInteger != 0;
+    }
+    static bool Prepare(lua_State*, int) { return false; }
+    static T Get(lua_State* L, int index) { return static_cast<T>(lua_tointeger(L, index)); }
+    static void Push(lua_State* L, T value) { lua_pushinteger(L, static_cast<lua_Integer>(value)); }
+};
+
+template<typename T>
+struct Stack<T, std::enable_if_t<std::is_floating_point_v<T>>> {
+    static const char* Name() { return "number"; }
+    static bool Is(lua_State* L, int index) { return lua_isnumber(L, index) != 0; }
+    static bool Prepare(lua_State*, int) { return false; }
+    static T Get(lua_State* L, int index) { return static_cast<T>(lua_tonumber(L, index)); }
+    static void Push(lua_State* L, T value) { lua_pushnumber(L, static_cast<lua_Number>(value)); }
+};
+
+template<>
+struct Stack<const char*> {
+    static const char* Name() { return "string"; }
+    static bool Is(lua_State* L, int index) { return lua_isstring(L, index) != 0; }
+    // Numbers are converted in place, which allocates a Lua string
+    static bool Prepare(lua_State* L, int index) {
+        if (lua_type(L, index) != LUA_TNUMBER)
+            return false;
+        lua_tolstring(L, index, nullptr);
+        return true;
+    }
+    static const char* Get(lua_State* L, int index) { return lua_tostring(L, index); }
+    static void Push(lua_State* L, const char* value) { lua_pushstring(L, value); }
+};
+
+// Views straight into the Lua string; valid while the argument is on the stack
+template<>
+struct Stack<std::string_view> {
+    static const char* Name() { return "string"; }
+    static bool Is(lua_State* L, int index) { return lua_isstring(L, index) != 0; }
+    static bool Prepare(lua_State* L, int index) { return Stack<const char*>::Prepare(L, index); }
+    static std::string_view Get(lua_State* L, int index) {
+        size_t length = 0;
+        const char* data = lua_tolstring(L, index, &length);
+        return std::string_view(data, length);
+    }
+    static void Push(lua_State* L, std::string_view value) { lua_pushlstring(L, value.data(), value.size()); }
+};
+
+template<>
+struct Stack<std::string> {
+    static const char* Name() { return "string"; }
+    static bool Is(lua_State* L, int index) { return lua_isstring(L, index) != 0; }
+    static bool Prepare(lua_State* L, int index) { return Stack<const char*>::Prepare(L, index); }
+    static std::string Get(lua_State* L, int index) { return std::string(Stack<std::string_view>::Get(L, index)); }
+    static void Push(lua_State* L, const std::string& value) { lua_pushlstring(L, value.data(), value.size()); }
+};
+
+// Lua strings are UTF-8. Reading converts once, directly from the Lua buffer;
+// pushing converts straight into a Lua buffer, so no C++ buffer is alive
+// while Lua allocates
+template<>
+struct Stack<wxString> {
+    static const char* Name() { return "string"; }
+    static bool Is(lua_State* L, int index) { return lua_isstring(L, index) != 0; }
+    static bool Prepare(lua_State* L, int index) { return Stack<const char*>::Prepare(L, index); }
+    static wxString Get(lua_State* L, int index) {
+        size_t length = 0;
+        const char* data = lua_tolstring(L, index, &length);
+        return wxString::FromUTF8(data, length);
+    }
+    static void Push(lua_State* L, const wxString& value) {
+        size_t length = wxConvUTF8.FromWChar(nullptr, 0, value.wc_str(), value.length());
+        if (length == wxCONV_FAILED)
+            length = 0;
+        luaL_Buffer buffer;
+        char* data = luaL_buffinitsize(L, &buffer, length);
+        if (length != 0)
+            wxConvUTF8.FromWChar(data, length, value.wc_str(), value.length());
+        luaL_pushresultsize(&buffer, length);
+    }
+};
+
+template<typename T>
+struct Stack<std::optional<T>> {
+    static const char* Name() { return Stack<T>::Name(); }
+    static bool Is(lua_State* L, int index) { return lua_isnoneornil(L, index) || Stack<T>::Is(L, index); }
+    static bool Prepare(lua_State* L, int index) { return !lua_isnoneornil(L, index) && Stack<T>::Prepare(L, index); }
+    static std::optional<T> Get(lua_State* L, int index) {
+        if (lua_isnoneornil(L, index))
+            return std::nullopt;
+        return Stack<T>::Get(L, index);
+    }
+    static void Push(lua_State* L, const std::optional<T>& value) {
+        if (value)
+            Stack<T>::Push(L, *value);
+        else
+            lua_pushnil(L);
+    }
+};
+
+template<typename T>
+struct Stack<std::vector<T>> {
+    static const char* Name() { return "table"; }
+    static bool Is(lua_State* L, int index) {
+        if (!lua_istable(L, index))
+            return false;
+
+        // Check every element up front so that Get() cannot fail
+        const int table = lua_absindex(L, index);
+        const lua_Integer count = static_cast<lua_Integer>(lua_rawlen(L, table));
+        for (lua_Integer i = 1; i <= count; ++i) {
+            lua_rawgeti(L, table, i);
+            const bool valid = Stack<T>::Is(L, -1);
+            lua_pop(L, 1);
+            if (!valid)
+                return false;
+        }
+        return true;
+    }
+    // Elements converted in place go into a copy; the caller's table is left alone
+    static bool Prepare(lua_State* L, int index) {
+        const int table = lua_absindex(L, index);
+        const lua_Integer count = static_cast<lua_Integer>(lua_rawlen(L, table));
+        int copy = 0;
+        for (lua_Integer i = 1; i <= count; ++i) {
+            lua_rawgeti(L, table, i);
+            if (Stack<T>::Prepare(L, -1) && copy == 0) {
+                lua_createtable(L, static_cast<int>(count), 0);
+                lua_insert(L, -2);
+                copy = lua_gettop(L) - 1;
+                for (lua_Integer j = 1; j < i; ++j) {
+                    lua_rawgeti(L, table, j);
+                    lua_rawseti(L, copy, j);
+                }
+            }
+            if (copy != 0)
+                lua_rawseti(L, copy, i);
+            else
+                lua_pop(L, 1);
+        }
+        if (copy == 0)
+            return false;
+        lua_replace(L, table);
+        return true;
+    }
+    static std::vector<T> Get(lua_State* L, int index) {
+        const int table = lua_absindex(L, index);
+        const lua_Integer count = static_cast<lua_Integer>(lua_rawlen(L, table));
+        std::vector<T> values;
+        values.reserve(static_cast<size_t>(count));
+        for (lua_Integer i = 1; i <= count; ++i) {
+            lua_rawgeti(L, table, i);
+            values.push_back(Stack<T>::Get(L, -1));
+            lua_pop(L, 1);
+        }
+        return values;
+    }
+    static void Push(lua_State* L, const std::vector<T>& values) {
+        lua_createtable(L, static_cast<int>(values.size()), 0);
+        for (size_t i = 0; i < values.size(); ++i) {
+            Stack<T>::Push(L, values[i]);
+            lua_rawseti(L, -2, static_cast<lua_Integer>(i + 1));
+        }
+    }
+};
+
+/**
+ * @brief Push a value using its Stack<T> specialization
+ * @param L Lua state
+ * @param value Value to push
+ */
+template<typename T>
+void Push(lua_State* L, const T& value) {
+    // String literals are pushed as const char*
+    using Type = std::conditional_t<std::is_array_v<T>, const std::remove_extent_t<T>*, std::decay_t<T>>;
+    Stack<Type>::Push(L, value);
+}
+
+/**
+ * @brief Signature information for free and member function pointers
+ */
+template<typename Function>
+struct FunctionTraits;
+
+template<typename Ret, typename... Args>
+struct FunctionTraits<Ret(*)(Args...)> {
+    using Return = Ret;
+    using Class = void;
+    using Arguments = std::tuple<std::decay_t<Args>...>;
+};
+
+template<typename Ret, typename... Args>
+struct FunctionTraits<Ret(*)(Args...) noexcept> : FunctionTraits<Ret(*)(Args...)> {};
+
+template<typename Ret, typename Object, typename... Args>
+struct FunctionTraits<Ret(Object::*)(Args...)> : FunctionTraits<Ret(*)(Args...)> {
+    using Class = Object;
+};
+
+template<typename Ret, typename Object, typename... Args>
+struct FunctionTraits<Ret(Object::*)(Args...) const> : FunctionTraits<Ret(*)(Args...)> {
+    using Class = const Object;
+};
+
+template<typename Ret, typename Object, typename... Args>
+struct FunctionTraits<Ret(Object::*)(Args...) noexcept> : FunctionTraits<Ret(Object::*)(Args...)> {};
+
+template<typename Ret, typename Object, typename... Args>
+struct FunctionTraits<Ret(Object::*)(Args...) const noexcept> : FunctionTraits<Ret(Object::*)(Args...) const> {};
+
+namespace Detail {
+
+inline int ArgError(lua_State* L, int index, const char* expected) {
+    return luaL_argerror(L, index, lua_pushfstring(L, "%s expected, got %s", expected, luaL_typename(L, index)));
+}
+
+template<typename T>
+int PushThunk(lua_State* L) {
+    Stack<T>::Push(L, *static_cast<const T*>(lua_touserdata(L, 1)));
+    return 1;
+}
+
+// An error raised while pushing stops at the lua_pcall instead of skipping
+// the destructor of the value; it is left on the stack on failure
+template<typename T>
+bool PushProtected(lua_State* L, const T& value) {
+    lua_pushcfunction(L, &PushThunk<T>);
+    lua_pushlightuserdata(L, const_cast<T*>(&value));
+    return lua_pcall(L, 1, 1, 0) == LUA_OK;
+}
+
+template<typename Arguments>
+struct Invoker;
+
+template<typename... Args>
+struct Invoker<std::tuple<Args...>> {
+    using Indices = std::index_sequence_for<Args...>;
+
+    // Everything that can raise a Lua error happens here, before any
+    // argument exists in C++
+    template<size_t... I>
+    static void Check(lua_State* L, std::index_sequence<I...>) {
+        (void)((Stack<Args>::Is(L, static_cast<int>(I) + 1) ||
+                ArgError(L, static_cast<int>(I) + 1, Stack<Args>::Name())), ...);
+        (void)(Stack<Args>::Prepare(L, static_cast<int>(I) + 1), ...);
+    }
+
+    // Returns the number of results, or -1 with the Lua error on the stack
+    template<typename Ret, typename Callable, size_t... I>
+    static int Call(lua_State* L, Callable& callable, std::index_sequence<I...>) {
+        if constexpr (std::is_void_v<Ret>) {
+            callable(Stack<Args>::Get(L, static_cast<int>(I) + 1)...);
+            return 0;
+        } else {
+            // The arguments are destroyed with this statement
+            using Value = std::decay_t<Ret>;
+            const Value& result = callable(Stack<Args>::Get(L, static_cast<int>(I) + 1)...);
+            if constexpr (std::is_trivially_destructible_v<Value>) {
+                Stack<Value>::Push(L, result);
+                return 1;
+            } else {
+                return PushProtected(L, result) ? 1 : -1;
+            }
+        }
+    }
+};
+
+constexpr size_t kMaxErrorMessage = 512;
+
+template<typename Traits, typename Callable>
+int Dispatch(lua_State* L, Callable callable) {
+    using Invoke = Invoker<typename Traits::Arguments>;
+
+    Invoke::Check(L, typename Invoke::Indices());
+
+    // The message is copied out so that the exception is gone before Lua
+    // allocates the error string
+    char message[kMaxErrorMessage];
+    bool thrown = false;
+    try {
+        const int results = Invoke::template Call<typename Traits::Return>(L, callable, typename Invoke::Indices());
+        if (results >= 0)
+            return results;
+    } catch (const std::exception& e) {
+        std::snprintf(message, sizeof(message), "%s", e.what());
+        thrown = true;
+    }
+
+    // Raised outside the handler so that no C++ frame is skipped
+    if (thrown)
+        lua_pushstring(L, message);
+    return lua_error(L);
+}
+
+template<auto Function>
+int FunctionThunk(lua_State* L) {
+    return Dispatch<FunctionTraits<decltype(Function)>>(L, Function);
+}
+
+template<auto Method>
+int MethodThunk(lua_State* L) {
+    using Traits = FunctionTraits<decltype(Method)>;
+    auto* object = static_cast<typename Traits::Class*>(lua_touserdata(L, lua_upvalueindex(1)));
+    return Dispatch<Traits>(L, [object](auto&&... args) -> decltype(auto) {
+        return (object->*Method)(std::forward<decltype(args)>(args)...);
+    });
+}
+
+template<typename Ret, typename... Args>
+int PointerThunk(lua_State* L) {
+    using Function = Ret(*)(Args...);
+    Function function;
+    std::memcpy(&function, lua_touserdata(L, lua_upvalueindex(1)), sizeof(function));
+    return Dispatch<FunctionTraits<Function>>(L, function);
+}
+
+} // namespace Detail
+
+/**
+ * @brief Push a function known at compile time
+ *
+ * Plain lua_CFunction pointers are pushed as they are.
+ *
+ * @param L Lua state
+ */
+template<auto Function>
+void PushFunction(lua_State* L) {
+    if constexpr (std::is_convertible_v<decltype(Function), lua_CFunction>)
+        lua_pushcfunction(L, Function);
+    else
+        lua_pushcfunction(L, &Detail::FunctionThunk<Function>);
+}
+
+/**
+ * @brief Push a member function bound to an object
+ *
+ * The object must outlive the Lua state or the function.
+ *
+ * @param L Lua state
+ * @param object Object to call the method on
+ */
+template<auto Method, typename Class>
+void PushMethod(lua_State* L, Class* object) {
+    // Convert before erasing the type so that base class offsets are applied
+    typename FunctionTraits<decltype(Method)>::Class* target = object;
+    lua_pushlightuserdata(L, const_cast<void*>(static_cast<const void*>(target)));
+    lua_pushcclosure(L, &Detail::MethodThunk<Method>, 1);
+}
+
+/**
+ * @brief Push a function pointer only known at run time
+ *
+ * The pointer is stored in the closure once; calls do not allocate.
+ *
+ * @param L Lua state
+ * @param function Function to push
+ */
+template<typename Ret, typename... Args>
+void PushFunction(lua_State* L, Ret(*function)(Args...)) {
+    void* storage = lua_newuserdata(L, sizeof(function));
+    std::memcpy(storage, &function, sizeof(function));
+    lua_pushcclosure(L, &Detail::PointerThunk<Ret, Args...>, 1);
+}
+
+} // namespace LuaBinding
+
+} // namespace ITD
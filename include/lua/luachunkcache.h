@@ -0,0 +1,78 @@
+#pragma once
+
+#include <wx/wx.h>
+#include "util/threadpool.h"
+#include <string>
+
+struct lua_State;
+
+namespace ITD {
+
+/**
+ * @brief On-disk cache of compiled Lua chunks
+ *
+ * Scripts are compiled once and their bytecode (lua_dump) is stored in the
+ * cache directory, keyed by script path. A cached chunk is used only if the
+ * script still has the same size and modification time, or, if only the
+ * time differs, the same content hash. Cached chunks are loaded with
+ * lua_load straight from a memory-mapped file.
+ *
+ * Bytecode is trusted as-is, so the cache directory must only be writable by
+ * the user; the default directory is inside the user configuration
+ * directory.
+ */
+class LuaChunkCache {
+public:
+    /**
+     * @brief Constructor
+     * @param directory Cache directory (created on first write)
+     */
+    explicit LuaChunkCache(const wxString& directory = GetDefaultDirectory());
+
+    /**
+     * @brief Destructor
+     *
+     * Waits for the cache file being written; queued writes are dropped and
+     * their scripts compiled again next time.
+     */
+    ~LuaChunkCache();
+
+    /**
+     * @brief Load a script as a chunk, using the cache when possible
+     *
+     * Behaves like luaL_loadfile: on success the chunk is pushed as a
+     * function, on failure an error message is pushed.
+     *
+     * @param L Lua state
+     * @param filename Script file path
+     * @return Lua status code (LUA_OK on success)
+     */
+    int Load(lua_State* L, const wxString& filename);
+
+    /**
+     * @brief Get the default cache directory
+     * @return Directory path
+     */
+    static wxString GetDefaultDirectory();
+
+private:
+    wxString m_directory;  ///< Cache directory
+    ThreadPool m_writer;   ///< Writes cache files off the startup path (destroyed first)
+
+    // Get the cache file for a script
+    wxString GetCachePath(const wxString& filename) const;
+
+    // Load from the cache file; false if it is missing or stale
+    bool LoadCached(lua_State* L, const wxString& filename, const wxString& chunkName);
+
+    // Compile from source and write the cache in the background
+    int LoadSource(lua_State* L, const wxString& filename, const wxString& chunkName);
+
+    // Write a cache file in the background
+    void WriteCache(const wxString& filename, std::string data);
+
+    LuaChunkCache(const LuaChunkCache&) = delete;
+    LuaChunkCache& operator=(const LuaChunkCache&) = delete;
+};
+
+} // namespace ITD
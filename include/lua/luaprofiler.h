@@ -0,0 +1,149 @@
+#pragma once
+
+#include <wx/wx.h>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct lua_State;
+struct lua_Debug;
+
+namespace ITD {
+
+class LuaAllocator;
+
+/**
+ * @brief Sampling profiler for the scripts of a Lua state
+ *
+ * While running, a count hook takes a sample every few thousand VM
+ * instructions. Each sample walks the Lua stack and charges the wall time and
+ * the allocations since the previous sample to the current stack, function
+ * and line. Time between two calls into Lua is not charged; the host marks
+ * every entry into the VM with MarkEntry().
+ *
+ * Results are available as folded stacks ("a;b;c weight" lines, the input
+ * format of flamegraph.pl, inferno and speedscope) and as a text report of
+ * the hottest functions and lines.
+ *
+ * Only one profiler can run at a time. Coroutines created while it runs
+ * inherit the hook; coroutines that already exist are not sampled.
+ */
+class LuaProfiler {
+public:
+    /**
+     * @brief Accumulated cost
+     */
+    struct Cost {
+        uint64_t timeNs = 0;       ///< Wall time
+        uint64_t samples = 0;      ///< Number of samples
+        uint64_t allocations = 0;  ///< Lua allocations
+    };
+
+    /**
+     * @brief Constructor
+     * @param L Lua state to profile
+     * @param allocator Allocator of the state, for allocation counts (optional)
+     */
+    LuaProfiler(lua_State* L, const LuaAllocator* allocator);
+
+    /**
+     * @brief Destructor
+     */
+    ~LuaProfiler();
+
+    /**
+     * @brief Start sampling
+     *
+     * Previous results are discarded.
+     *
+     * @param instructionInterval VM instructions between samples
+     * @return False if another profiler is running
+     */
+    bool Start(int instructionInterval = kDefaultInterval);
+
+    /**
+     * @brief Stop sampling; results are kept
+     */
+    void Stop();
+
+    /**
+     * @brief Check if sampling
+     * @return True while started
+     */
+    bool IsRunning() const { return s_active == this; }
+
+    /**
+     * @brief Write the samples as folded stacks
+     *
+     * Weights are in microseconds; frames are "function (source:line)".
+     *
+     * @param filename Output file
+     * @return True if successful
+     */
+    bool WriteFoldedStacks(const wxString& filename) const;
+
+    /**
+     * @brief Format the hottest functions and lines
+     * @param limit Number of entries per table
+     * @return Report text
+     */
+    wxString GetReport(size_t limit = 20) const;
+
+    /**
+     * @brief Get the total sampled cost
+     * @return Cost of all samples
+     */
+    const Cost& GetTotal() const { return m_total; }
+
+    /**
+     * @brief Note that the host is about to call into Lua
+     *
+     * Restarts the sample clock so that time spent outside Lua is not charged
+     * to the next sample. Costs one branch when no profiler runs.
+     */
+    static void MarkEntry() {
+        if (s_active)
+            s_active->m_lastSample = std::chrono::steady_clock::now();
+    }
+
+    static constexpr int kDefaultInterval = 1000;  ///< Default instructions per sample
+
+private:
+    /**
+     * @brief Cost of a function, split into its own and its callees' share
+     */
+    struct FunctionCost {
+        Cost self;   ///< Samples in the function itself
+        Cost total;  ///< Samples with the function anywhere on the stack
+    };
+
+    lua_State* m_state;                 ///< Profiled state
+    const LuaAllocator* m_allocator;    ///< Allocation counter (optional)
+    std::chrono::steady_clock::time_point m_lastSample;  ///< End of the previous sample
+    uint64_t m_lastAllocations = 0;     ///< Allocation count at the previous sample
+
+    Cost m_total;                                            ///< All samples
+    std::unordered_map<std::string, Cost> m_stacks;          ///< Folded stack costs
+    std::unordered_map<std::string, FunctionCost> m_functions;  ///< Per-function costs
+    std::unordered_map<std::string, Cost> m_lines;           ///< Per-line costs
+
+    // Scratch buffers reused by every sample
+    std::vector<std::string> m_frames;
+    std::string m_stack;
+    std::string m_line;
+
+    static LuaProfiler* s_active;  ///< Running profiler
+
+    // Take one sample
+    void Sample(lua_State* L);
+
+    // Count hook
+    static void Hook(lua_State* L, lua_Debug* debug);
+
+    LuaProfiler(const LuaProfiler&) = delete;
+    LuaProfiler& operator=(const LuaProfiler&) = delete;
+};
+
+} // namespace ITD
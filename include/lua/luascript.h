@@ -1,17 +1,42 @@
 #pragma once
 
 #include <wx/wx.h>
+#include <array>
+#include <chrono>
 #include <string>
 #include <functional>
 #include <unordered_map>
 #include <vector>
 #include <memory>
-
-// Forward declaration for Lua state
-struct lua_State;
+#include <optional>
+#include <string_view>
+#include "lua/luaallocator.h"
+#include "lua/luaasync.h"
+#include "lua/luabinding.h"
+#include "lua/luachunkcache.h"
+#include "lua/luaprofiler.h"
+#include "lua/luaworkerpool.h"
+#include "util/latencyhistogram.h"
 
 namespace ITD {
 
+namespace LuaAPI {
+    int RunInBackground(lua_State* L);
+}
+
+/**
+ * @brief Application events that scripts can handle with itd.On()
+ *
+ * Handler arguments are listed per event.
+ */
+enum class LuaEvent : uint8_t {
+    KeyPress,            ///< (key, keyCode); a handler returning true consumes the key
+    WindowFocus,         ///< (name) of the window that received the focus
+    CommandExecuted,     ///< (command, success) after a terminal command was started
+    SearchResultOpened,  ///< (path) of the opened search result
+    Count                ///< Number of events
+};
+
 /**
  * @brief Lua scripting engine for ITD
  * 
@@ -32,6 +57,10 @@ public:
 
     /**
      * @brief Load and execute a Lua script file
+     *
+     * The compiled chunk is cached on disk, so unchanged scripts are not
+     * parsed again on the next start.
+     *
      * @param filename Path to the script file
      * @return True if successful, false otherwise
      */
@@ -46,21 +75,48 @@ public:
 
     /**
      * @brief Call a Lua function
+     *
+     * Arguments are pushed through LuaBinding::Stack without intermediate
+     * copies.
+     *
      * @param functionName Name of the function to call
      * @param args Arguments to pass to the function
      * @return True if successful, false otherwise
      */
     template<typename... Args>
-    bool CallFunction(const std::string& functionName, Args... args);
+    bool CallFunction(const std::string& functionName, const Args&... args);
 
     /**
      * @brief Register a C++ function to be callable from Lua
+     *
+     * The function pointer is only known at run time and is stored with the
+     * Lua function; prefer Register<&Function>() when it is known at compile
+     * time.
+     *
      * @param name Function name in Lua
      * @param function C++ function to register
      */
     template<typename Ret, typename... Args>
     void RegisterFunction(const std::string& name, Ret(*function)(Args...));
 
+    /**
+     * @brief Register a C++ function known at compile time
+     *
+     * Lua calls the function through a thunk specialized for its signature.
+     *
+     * @param name Function name in Lua
+     */
+    template<auto Function>
+    void Register(const char* name);
+
+    /**
+     * @brief Register a member function bound to an object
+     * @param name Function name in Lua
+     * @param object Object to call the method on; must outlive this script
+     */
+    template<auto Method, typename Class>
+    void Register(const char* name, Class* object);
+
     /**
      * @brief Check if a Lua function exists
      * @param functionName Name of the function to check
@@ -86,47 +142,331 @@ public:
      */
     const std::vector<wxString>& GetLoadedScripts() const { return m_loadedScripts; }
 
+    /**
+     * @brief Run a script on a worker thread
+     *
+     * The script runs in its own Lua state and cannot call UI functions; it
+     * reports back with itd.Post(). Handlers are called on the UI thread.
+     *
+     * @param source Lua code, or a script path if options.isFile is set
+     * @param options Instruction budget and source kind
+     * @param onComplete Completion handler (optional)
+     * @param onMessage Message handler (optional)
+     * @return Job ID for CancelBackground()
+     */
+    LuaWorkerPool::JobId RunInBackground(const wxString& source, const LuaWorkerPool::JobOptions& options,
+                                         LuaWorkerPool::CompletionHandler onComplete = LuaWorkerPool::CompletionHandler(),
+                                         LuaWorkerPool::MessageHandler onMessage = LuaWorkerPool::MessageHandler());
+
+    /**
+     * @brief Cancel a background script
+     * @param id Job ID returned by RunInBackground()
+     * @return True if the job was still queued or running
+     */
+    bool CancelBackground(LuaWorkerPool::JobId id);
+
+    /**
+     * @brief Check if an event has handlers
+     *
+     * Lets callers skip building expensive handler arguments.
+     *
+     * @param event Event
+     * @return True if at least one handler is registered
+     */
+    bool HasHandlers(LuaEvent event) const { return !m_eventHandlers[static_cast<size_t>(event)].empty(); }
+
+    /**
+     * @brief Call the handlers of an event
+     *
+     * Handlers are kept as registry references in a per-event vector, so
+     * firing an event does not look anything up by name; an event without
+     * handlers returns immediately. Handler errors are reported and do not
+     * stop the remaining handlers.
+     *
+     * @param event Event
+     * @param args Handler arguments
+     * @return True if a handler returned true
+     */
+    template<typename... Args>
+    bool FireEvent(LuaEvent event, const Args&... args);
+
+    /**
+     * @brief Add an event handler
+     * IDs are never reused, so removing a handler twice cannot remove
+     * another one that was added in between.
+     *
+     * @param event Event
+     * @param index Stack index of the handler function
+     * @return Handler ID for RemoveEventHandler()
+     */
+    int AddEventHandler(LuaEvent event, int index);
+
+    /**
+     * @brief Remove an event handler
+     *
+     * Safe to call from a handler of the same event.
+     *
+     * @param event Event
+     * @param handlerId ID returned by AddEventHandler()
+     * @return True if the handler was registered
+     */
+    bool RemoveEventHandler(LuaEvent event, int handlerId);
+
+    /**
+     * @brief Push the function of an event handler
+     * @param L State of this script, or one of its threads
+     * @param event Event
+     * @param handlerId ID returned by AddEventHandler()
+     * @return False, with nothing pushed, if the handler is not registered
+     */
+    bool PushEventHandler(lua_State* L, LuaEvent event, int handlerId) const;
+
+    /**
+     * @brief Call a function with the latency of each event handler
+     *
+     * Every handler call is timed, whether or not the profiler runs.
+     *
+     * @param visit Called with the event, handler ID and histogram
+     */
+    void ForEachHandlerLatency(const std::function<void(LuaEvent event, int handlerId,
+                                                        const LatencyHistogram& latency)>& visit) const;
+
+    /**
+     * @brief Start the sampling profiler
+     * @param instructionInterval VM instructions between samples
+     * @return False if a profiler is already running elsewhere
+     */
+    bool StartProfiler(int instructionInterval = LuaProfiler::kDefaultInterval);
+
+    /**
+     * @brief Stop the sampling profiler, keeping its results
+     */
+    void StopProfiler();
+
+    /**
+     * @brief Get the profiler
+     * @return Profiler, or nullptr if it was never started
+     */
+    const LuaProfiler* GetProfiler() const { return m_profiler.get(); }
+
+    /**
+     * @brief Get the name of an event as used by itd.On()
+     * @param event Event
+     * @return Event name
+     */
+    static const char* GetEventName(LuaEvent event);
+
+    /**
+     * @brief Limit the memory used by the Lua state
+     *
+     * Allocations beyond the limit fail with a Lua memory error after an
+     * emergency garbage collection.
+     *
+     * @param bytes Maximum bytes in use (0 = unlimited)
+     */
+    void SetMemoryLimit(size_t bytes) { m_allocator.SetLimit(bytes); }
+
+    /**
+     * @brief Get the allocation statistics of the Lua state
+     * @return Statistics
+     */
+    const LuaAllocator::Stats& GetMemoryStats() const { return m_allocator.GetStats(); }
+
+    /**
+     * @brief Get the script instance owning a Lua state
+     * @param L Lua state created by a LuaScript
+     * @return Owning script
+     */
+    static LuaScript* FromState(lua_State* L);
+
 private:
+    LuaAllocator m_allocator;         ///< Memory of the Lua state (outlives it)
     lua_State* m_luaState = nullptr;  ///< Lua state
     wxString m_lastError;             ///< Last error message
     std::vector<wxString> m_loadedScripts;  ///< List of loaded script files
+    LuaChunkCache m_chunkCache;       ///< Compiled chunk cache
+    std::unique_ptr<LuaWorkerPool> m_workerPool;  ///< Background scripts (created on first use)
+    std::unique_ptr<LuaAsync> m_async;  ///< Asynchronous file I/O for coroutines
+
+    std::unique_ptr<LuaProfiler> m_profiler;  ///< Sampling profiler (created on first use)
+
+    /**
+     * @brief Registered event handler
+     */
+    struct EventHandler {
+        int id;                    ///< ID returned to the script
+        int ref;                   ///< Registry reference of the function (LUA_NOREF once removed)
+        LatencyHistogram latency;  ///< Duration of the calls
+    };
+
+    // Event handlers, indexed by LuaEvent
+    std::array<std::vector<EventHandler>, static_cast<size_t>(LuaEvent::Count)> m_eventHandlers;
+    int m_nextHandlerId = 0;           ///< Last handler ID given out
+    int m_eventDepth = 0;              ///< Nesting level of FireEvent()
+    bool m_eventHandlersRemoved = false;  ///< Removed handlers wait for compaction
 
     // Register standard library functions
     void RegisterStandardFunctions();
 
     // Error handling
     void HandleLuaError();
+
+    // Run a loaded chunk
+    bool RunChunk();
+
+    // Drop handlers removed while events were being fired
+    void CompactEventHandlers();
+
+    // Call a function stored in the registry, reporting errors
+    template<typename... Args>
+    void CallRef(int ref, const Args&... args);
+
+    friend int LuaAPI::RunInBackground(lua_State* L);
 };
 
-// Application-specific API functions exposed to Lua
+template<typename... Args>
+bool LuaScript::CallFunction(const std::string& functionName, const Args&... args) {
+    if (lua_getglobal(m_luaState, functionName.c_str()) != LUA_TFUNCTION) {
+        lua_pop(m_luaState, 1);
+        m_lastError = "Function not found: " + wxString::FromUTF8(functionName.c_str());
+        return false;
+    }
+
+    (LuaBinding::Push(m_luaState, args), ...);
+    LuaProfiler::MarkEntry();
+    if (lua_pcall(m_luaState, static_cast<int>(sizeof...(Args)), 0, 0) != LUA_OK) {
+        HandleLuaError();
+        return false;
+    }
+
+    return true;
+}
+
+template<typename... Args>
+bool LuaScript::FireEvent(LuaEvent event, const Args&... args) {
+    std::vector<EventHandler>& handlers = m_eventHandlers[static_cast<size_t>(event)];
+    if (handlers.empty())
+        return false;
+
+    // Handlers added meanwhile run from the next event on; removed ones are
+    // set to LUA_NOREF until the outermost call compacts the vector
+    bool consumed = false;
+    ++m_eventDepth;
+    const size_t count = handlers.size();
+    for (size_t i = 0; i < count; ++i) {
+        if (handlers[i].ref == LUA_NOREF)
+            continue;
+
+        lua_rawgeti(m_luaState, LUA_REGISTRYINDEX, handlers[i].ref);
+        (LuaBinding::Push(m_luaState, args), ...);
+        LuaProfiler::MarkEntry();
+        const auto start = std::chrono::steady_clock::now();
+        const int status = lua_pcall(m_luaState, static_cast<int>(sizeof...(Args)), 1, 0);
+        handlers[i].latency.Record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()));
+
+        if (status != LUA_OK) {
+            HandleLuaError();
+            continue;
+        }
+        consumed = lua_toboolean(m_luaState, -1) || consumed;
+        lua_pop(m_luaState, 1);
+    }
+    if (--m_eventDepth == 0 && m_eventHandlersRemoved)
+        CompactEventHandlers();
+
+    return consumed;
+}
+
+template<typename... Args>
+void LuaScript::CallRef(int ref, const Args&... args) {
+    lua_rawgeti(m_luaState, LUA_REGISTRYINDEX, ref);
+    (LuaBinding::Push(m_luaState, args), ...);
+    LuaProfiler::MarkEntry();
+    if (lua_pcall(m_luaState, static_cast<int>(sizeof...(Args)), 0, 0) != LUA_OK)
+        HandleLuaError();
+}
+
+template<typename Ret, typename... Args>
+void LuaScript::RegisterFunction(const std::string& name, Ret(*function)(Args...)) {
+    LuaBinding::PushFunction(m_luaState, function);
+    lua_setglobal(m_luaState, name.c_str());
+}
+
+template<auto Function>
+void LuaScript::Register(const char* name) {
+    LuaBinding::PushFunction<Function>(m_luaState);
+    lua_setglobal(m_luaState, name);
+}
+
+template<auto Method, typename Class>
+void LuaScript::Register(const char* name, Class* object) {
+    LuaBinding::PushMethod<Method>(m_luaState, object);
+    lua_setglobal(m_luaState, name);
+}
+
+// Application-specific API functions exposed to Lua through the "itd" table.
+// They are bound with LuaBinding, so they are written as ordinary functions.
 namespace LuaAPI {
     // Terminal functions
-    int ExecuteCommand(lua_State* L);
-    int GetCurrentDirectory(lua_State* L);
+    bool ExecuteCommand(const wxString& command);
+    wxString GetCurrentDirectory();
     
     // Widget functions
-    int CreateWidget(lua_State* L);
-    int RemoveWidget(lua_State* L);
+    bool CreateWidget(const wxString& type, const std::optional<wxString>& title);
+    bool RemoveWidget(const wxString& title);
     
     // Window management functions
-    int SetLayoutType(lua_State* L);
-    int FocusWindow(lua_State* L);
-    int SplitWindow(lua_State* L);
+    bool SetLayoutType(const wxString& layout);
+    bool FocusWindow(const wxString& name);
+    void SplitWindow(const std::optional<wxString>& direction);
+    bool SaveWorkspace(const wxString& name);
+    bool LoadWorkspace(const wxString& name);
+    std::vector<wxString> ListWorkspaces();
+    bool SwitchDesktop(int desktop);
+    int GetDesktop();
+    bool MoveWindowToDesktop(const wxString& name, int desktop);
+    
+    // Batch functions: UI changes between BeginBatch() and CommitBatch() are
+    // laid out and repainted once; a batch left open is committed when
+    // control returns to the event loop
+    void BeginBatch();
+    bool CommitBatch();
+    int Batch(lua_State* L);
     
     // UI functions
-    int SetTransparency(lua_State* L);
-    int ShowMessage(lua_State* L);
-    int PromptInput(lua_State* L);
+    void SetTransparency(int alpha);
+    void ShowMessage(const wxString& message, const std::optional<wxString>& title);
+    wxString PromptInput(const wxString& message, const std::optional<wxString>& defaultValue);
+    bool Notify(const wxString& title, const std::optional<wxString>& message, const std::optional<wxString>& level);
     
-    // File system functions
-    int ListDirectory(lua_State* L);
-    int FileExists(lua_State* L);
-    int ReadFile(lua_State* L);
-    int WriteFile(lua_State* L);
+    // File system functions (blocking; LuaAsync has streaming versions)
+    std::optional<std::vector<wxString>> ListDirectory(const wxString& path);
+    bool FileExists(const wxString& path);
+    std::optional<std::string> ReadFile(const wxString& path);
+    bool WriteFile(const wxString& path, std::string_view content);
     
-    // Key binding functions
+    // Key binding functions (these keep Lua functions, so they take the state)
     int RegisterKeyBinding(lua_State* L);
     int UnregisterKeyBinding(lua_State* L);
+
+    // Background script functions (these take Lua callbacks)
+    int RunInBackground(lua_State* L);
+    int CancelBackground(lua_State* L);
+
+    // Event functions (these take Lua callbacks)
+    int On(lua_State* L);
+    int Off(lua_State* L);
+
+    // Diagnostics (these return tables)
+    int GetMemoryStats(lua_State* L);
+    int GetHandlerLatency(lua_State* L);
+    int GetTickStats(lua_State* L);
+
+    // Profiler functions
+    bool StartProfiler(const std::optional<int>& instructionInterval);
+    bool StopProfiler(const std::optional<wxString>& foldedStacksFile);
+    wxString GetProfileReport(const std::optional<int>& limit);
 }
 
 } // namespace ITD 
\ No newline at end of file
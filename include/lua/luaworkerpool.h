@@ -0,0 +1,138 @@
+#pragma once
+
+#include <wx/wx.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+struct lua_State;
+struct lua_Debug;
+
+namespace ITD {
+
+/**
+ * @brief Runs Lua scripts on worker threads
+ *
+ * Each worker owns an isolated Lua state; jobs never touch the UI thread's
+ * state. Scripts run in a fresh global environment per job and only see the
+ * thread-safe part of the API (file system functions, itd.Notify()) plus
+ * itd.Post(), which sends a message back to the UI thread. Message and
+ * completion handlers are always invoked on the UI thread.
+ *
+ * Jobs on the same worker share its library tables (string, table, math,
+ * ...). Changes a job makes to them, to the globals or to the string
+ * metatable are undone when it finishes, so later jobs start from the same
+ * libraries. The debug library can still reach past this; jobs on
+ * different workers never share a state.
+ *
+ * Jobs can be given an instruction budget and can be cancelled; both are
+ * enforced by a count hook, so a runaway script is stopped within a few
+ * thousand instructions (but not while it is inside a single C call).
+ */
+class LuaWorkerPool : public wxEvtHandler {
+public:
+    using JobId = uint64_t;
+
+    /**
+     * @brief Called on the UI thread for each itd.Post(name, value)
+     */
+    using MessageHandler = std::function<void(JobId id, const wxString& name, const wxString& value)>;
+
+    /**
+     * @brief Called on the UI thread when a job ends
+     */
+    using CompletionHandler = std::function<void(JobId id, bool success, const wxString& error)>;
+
+    /**
+     * @brief Job settings
+     */
+    struct JobOptions {
+        uint64_t instructionBudget = 0;  ///< Maximum VM instructions (0 = unlimited)
+        bool isFile = false;             ///< Source is a script path rather than code
+    };
+
+    /**
+     * @brief Constructor
+     *
+     * Worker threads are started on the first submitted job.
+     *
+     * @param workerCount Number of workers (0 = based on the hardware)
+     */
+    explicit LuaWorkerPool(size_t workerCount = 0);
+
+    /**
+     * @brief Destructor
+     *
+     * Cancels all jobs and waits for the workers; no handler is called
+     * afterwards.
+     */
+    virtual ~LuaWorkerPool();
+
+    /**
+     * @brief Submit a job
+     * @param source Lua code, or a script path if options.isFile is set
+     * @param options Job settings
+     * @param onComplete Completion handler (optional)
+     * @param onMessage Message handler (optional)
+     * @return Job ID
+     */
+    JobId Submit(const wxString& source, const JobOptions& options,
+                 CompletionHandler onComplete = CompletionHandler(),
+                 MessageHandler onMessage = MessageHandler());
+
+    /**
+     * @brief Cancel a queued or running job
+     *
+     * The job completes with an error shortly afterwards.
+     *
+     * @param id Job ID
+     * @return True if the job was still queued or running
+     */
+    bool Cancel(JobId id);
+
+    /**
+     * @brief Get the number of queued and running jobs
+     * @return Job count
+     */
+    size_t GetActiveJobCount() const;
+
+private:
+    struct Job;
+    struct Worker;
+
+    size_t m_workerCount;                              ///< Number of workers to start
+    std::vector<std::unique_ptr<Worker>> m_workers;    ///< Worker threads and states
+
+    mutable std::mutex m_mutex;                        ///< Guards the fields below
+    std::condition_variable m_condition;               ///< Signals queued jobs
+    std::deque<std::shared_ptr<Job>> m_queue;          ///< Jobs waiting for a worker
+    std::unordered_map<JobId, std::shared_ptr<Job>> m_jobs;  ///< Queued and running jobs
+    JobId m_nextJobId = 1;                             ///< Next job ID
+    bool m_stopping = false;                           ///< Workers should exit
+
+    // Worker thread function
+    void WorkerLoop(Worker& worker);
+
+    // Run one job on a worker's state
+    void RunJob(Worker& worker, Job& job);
+
+    // Job running on the current worker thread
+    static thread_local std::shared_ptr<Job>* s_currentJob;
+
+    // Deliver results to the UI thread
+    void DeliverMessage(const std::shared_ptr<Job>& job, const wxString& name, const wxString& value);
+    void Complete(const std::shared_ptr<Job>& job, bool success, const wxString& error);
+
+    // Lua callbacks
+    static void InstructionHook(lua_State* L, lua_Debug* debug);
+    static int Post(lua_State* L);
+};
+
+} // namespace ITD
@@ -7,7 +7,9 @@
 #include "explorer/yaziexplorer.h"
 #include "ui/taskbar.h"
 #include "ui/tilingmanager.h"
+#include "ui/workspacemanager.h"
 #include "search/searchbar.h"
+#include "config/configsnapshot.h"
 
 namespace ITD {
 
@@ -32,6 +34,55 @@ public:
      */
     virtual ~MainFrame();
 
+    /**
+     * @brief Create the components deferred past the first frame
+     *
+     * Called once the window is shown and the terminal is interactive. Only
+     * components visible according to the configuration are created here;
+     * the rest are created when first shown.
+     */
+    void CompleteStartup();
+
+    /**
+     * @brief Get the terminal
+     * @return Terminal widget
+     */
+    TerminalWx* GetTerminal() const { return m_terminal; }
+
+    /**
+     * @brief Get the tiling manager
+     * @return Tiling manager
+     */
+    TilingManager* GetTilingManager() const { return m_tilingManager; }
+
+    /**
+     * @brief Get the widget manager, creating it if needed
+     * @return Widget manager
+     */
+    WidgetManager* GetWidgetManager();
+
+    /**
+     * @brief Get the workspace manager, creating it if needed
+     * @return Workspace manager
+     */
+    WorkspaceManager* GetWorkspaceManager();
+
+    /**
+     * @brief Start a batch of UI changes
+     *
+     * Until the matching EndUpdateBatch(), the frame is frozen, configuration
+     * changes are not broadcast and the tiling manager does not lay out. The
+     * outermost EndUpdateBatch() then applies the configuration once, runs a
+     * single layout pass and repaints once. Calls must be balanced; batches
+     * nest.
+     */
+    void BeginUpdateBatch();
+
+    /**
+     * @brief End a batch of UI changes
+     */
+    void EndUpdateBatch();
+
 private:
     // UI Components
     wxAuiManager m_auiManager;         ///< AUI manager for dockable panels
@@ -40,7 +91,11 @@ private:
     YaziExplorer* m_explorer = nullptr;  ///< File explorer
     Taskbar* m_taskbar = nullptr;      ///< Custom taskbar
     TilingManager* m_tilingManager = nullptr;  ///< Window tiling manager
+    WorkspaceManager* m_workspaceManager = nullptr;  ///< Saved workspaces
     SearchBar* m_searchBar = nullptr;  ///< Search bar
+    int m_configListener = 0;          ///< Configuration change listener ID
+    bool m_startupComplete = false;    ///< Deferred components may be created
+    wxWindow* m_focusedChild = nullptr;  ///< Child that last received the focus (compared only)
 
     // Event handlers
     void OnExit(wxCommandEvent& event);
@@ -51,15 +106,32 @@ private:
     void OnToggleWidgets(wxCommandEvent& event);
     void OnPreferences(wxCommandEvent& event);
 
+    // Forward application events to Lua handlers
+    void OnCharHook(wxKeyEvent& event);
+    void OnChildFocus(wxChildFocusEvent& event);
+    void OnTerminalCommand(wxCommandEvent& event);
+    void OnSearchResultOpened(wxCommandEvent& event);
+
     // Initialize methods
     void InitMenuBar();
     void InitStatusBar();
     void InitComponents();
     void InitLayout();
     void InitKeyBindings();
+    void InitScriptEvents();
+
+    // Create components on first use
+    void EnsureExplorer();
+    void EnsureWidgetManager();
+    void EnsureWorkspaceManager();
+    void EnsureSearchBar();
+
+    // Re-apply the parts of the configuration that changed
+    void ApplyConfig(const ConfigSnapshot& config, uint32_t changes);
 
     // Window event handlers
     void OnSize(wxSizeEvent& event);
+    void OnIconize(wxIconizeEvent& event);
     void OnClose(wxCloseEvent& event);
 
     wxDECLARE_EVENT_TABLE();
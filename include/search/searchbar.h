@@ -7,6 +7,13 @@
 
 namespace ITD {
 
+/**
+ * @brief Sent (and propagated to the parents) when a search result is opened
+ *
+ * The event string is the path of the result.
+ */
+wxDECLARE_EVENT(EVT_SEARCH_RESULT_OPENED, wxCommandEvent);
+
 /**
  * @brief Search bar component
  * 
@@ -2,16 +2,29 @@
 
 #include <wx/wx.h>
 #include <wx/stc/stc.h>
+#include "ui/resizedebouncer.h"
 #include <vector>
 #include <string>
 
 namespace ITD {
 
+/**
+ * @brief Sent (and propagated to the parents) after a command was started
+ *
+ * The event string is the command and the event int is 1 if it was started
+ * successfully.
+ */
+wxDECLARE_EVENT(EVT_TERMINAL_COMMAND, wxCommandEvent);
+
 /**
  * @brief Terminal emulation widget for ITD
  * 
  * This class provides terminal emulation functionality using the wxStyledTextCtrl
  * component, with custom enhancements for the Integrated Terminal Desktop.
+ *
+ * While the terminal is hidden (on an inactive desktop, or behind another
+ * pane), process output is kept in a buffer instead of the text control and
+ * is appended in one piece when the terminal is shown again.
  */
 class TerminalWx : public wxPanel {
 public:
@@ -35,6 +48,9 @@ public:
 
     /**
      * @brief Execute a command in the terminal
+     *
+     * Sends EVT_TERMINAL_COMMAND unless the terminal is busy.
+     *
      * @param command Command to execute
      * @return True if successful, false otherwise
      */
@@ -73,6 +89,40 @@ public:
      */
     wxString GetCurrentDirectory() const { return m_currentDirectory; }
 
+    /**
+     * @brief Change the current directory, rewriting the prompt
+     *
+     * Input typed after the prompt is discarded.
+     *
+     * @param directory Directory; ignored while the terminal is busy
+     */
+    void SetCurrentDirectory(const wxString& directory);
+
+    /**
+     * @brief Get the output shown before the current prompt
+     * @param maxLength Longest text returned; older output is dropped first
+     * @return Scrollback text
+     */
+    wxString GetScrollback(size_t maxLength) const;
+
+    /**
+     * @brief Insert saved output before the current prompt
+     * @param text Scrollback text, as returned by GetScrollback()
+     */
+    void RestoreScrollback(const wxString& text);
+
+    /**
+     * @brief Get the first line scrolled into view
+     * @return Line number in the text, not counting wrapping
+     */
+    int GetScrollAnchor() const;
+
+    /**
+     * @brief Scroll a line to the top of the view
+     * @param line Line number, as returned by GetScrollAnchor()
+     */
+    void SetScrollAnchor(int line);
+
     /**
      * @brief Enable/disable Vim mode
      * @param enable True to enable Vim mode, false to disable
@@ -88,6 +138,8 @@ private:
     bool m_vimModeEnabled = false;           ///< Vim mode status
     int m_inputStart = 0;                    ///< Start position of user input
     unsigned char m_transparency = 255;      ///< Transparency level
+    ResizeDebouncer m_resizeDebouncer;       ///< Defers reflowing the text while dragging
+    wxString m_pendingOutput;                ///< Output received while hidden
 
     // Command history
     std::vector<wxString> m_commandHistory;
@@ -99,11 +151,22 @@ private:
     void OnProcessTerminate(wxProcessEvent& event);
     void OnSize(wxSizeEvent& event);
     void OnChar(wxKeyEvent& event);
+    void OnShow(wxShowEvent& event);
+
+    // Run a command; see ExecuteCommand()
+    bool RunCommand(const wxString& command);
 
     // Terminal I/O
     void ReadProcessOutput();
     void WriteProcessInput(const wxString& input);
 
+    // Show process output, or keep it while hidden
+    void AppendOutput(const wxString& text);
+    void FlushOutput();
+
+    // Show a line of process output; a bell in it becomes a notification
+    void AppendProcessLine(wxString line);
+
     // Vim mode related
     void HandleVimModeInput(wxKeyEvent& event);
     enum class VimMode { Normal, Insert, Visual, Command };
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <wx/wx.h>
+#include <wx/timer.h>
+#include "util/mpscqueue.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace ITD {
+
+/**
+ * @brief Notification posted by a producer
+ */
+struct Notification {
+    /**
+     * @brief Importance
+     */
+    enum class Level {
+        Info,
+        Warning,
+        Error
+    };
+
+    wxString source;          ///< Producer ("terminal", "lua", ...)
+    wxString title;           ///< Short summary
+    wxString message;         ///< Details; may be empty
+    Level level = Level::Info;
+    wxString key;             ///< Coalescing key; source and title if empty
+};
+
+/**
+ * @brief Notification as kept in the history
+ */
+struct NotificationRecord {
+    uint64_t id = 0;                 ///< Sequence number
+    wxString key;                    ///< Coalescing key
+    Notification notification;       ///< Latest occurrence
+    unsigned count = 1;              ///< Occurrences coalesced into this record
+    wxDateTime time;                 ///< Time of the latest occurrence
+    std::chrono::steady_clock::time_point lastSeen;  ///< For the coalescing window
+};
+
+/**
+ * @brief Collects notifications from any thread and presents them on the UI thread
+ *
+ * Producers (terminal sessions, worker threads, scripts) call Post(), which
+ * moves the notification into a lock-free queue and never waits; when the
+ * queue is full the notification is dropped and counted. However many
+ * notifications are posted, the UI thread is woken once per drain, and a
+ * drain takes at most kMaxDrainBatch of them before yielding to other
+ * events.
+ *
+ * On the UI thread, a notification with the same key as a recent one
+ * (within kCoalesceWindowMs) is merged into it and counted. Listeners are
+ * told about at most kBurst notifications at once and then kRatePerSecond;
+ * what arrives faster is summarized as the latest record plus the number
+ * of others not presented. The history keeps the last kMaxHistory records.
+ */
+class NotificationCenter : public wxEvtHandler {
+public:
+    /**
+     * @brief Called on the UI thread to present a notification
+     * @param record Latest notification
+     * @param suppressed Other records that arrived since the last
+     *        presentation and are not presented on their own
+     */
+    using Listener = std::function<void(const NotificationRecord& record, size_t suppressed)>;
+
+    /**
+     * @brief Constructor
+     */
+    NotificationCenter();
+
+    /**
+     * @brief Destructor
+     */
+    virtual ~NotificationCenter();
+
+    /**
+     * @brief Post a notification; safe from any thread, never blocks
+     * @param notification Notification to move into the queue
+     * @return False if the queue was full and the notification was dropped
+     */
+    bool Post(Notification notification);
+
+    /**
+     * @brief Add a presentation listener; UI thread only
+     * @param listener Called for each presentation
+     * @return Listener ID for RemoveListener()
+     */
+    int AddListener(Listener listener);
+
+    /**
+     * @brief Remove a presentation listener
+     * @param id Listener ID returned by AddListener()
+     */
+    void RemoveListener(int id);
+
+    /**
+     * @brief Get the recent notifications, oldest first
+     * @return History; UI thread only
+     */
+    const std::deque<NotificationRecord>& GetHistory() const { return m_history; }
+
+    /**
+     * @brief Forget the recent notifications
+     */
+    void ClearHistory();
+
+    /**
+     * @brief Get the number of notifications dropped because the queue was full
+     * @return Dropped count since construction
+     */
+    uint64_t GetDroppedCount() const { return m_queue.GetDropped(); }
+
+    static constexpr size_t kQueueCapacity = 4096;     ///< Notifications waiting for the UI thread
+    static constexpr size_t kMaxDrainBatch = 256;      ///< Notifications taken per drain
+    static constexpr size_t kMaxHistory = 200;         ///< Records kept
+    static constexpr int kCoalesceWindowMs = 5000;     ///< Repeats merged within this time
+    static constexpr double kBurst = 3;                ///< Presentations allowed at once
+    static constexpr double kRatePerSecond = 1;        ///< Presentations allowed after a burst
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct ListenerEntry {
+        int id;
+        Listener callback;
+    };
+
+    MpscQueue<Notification> m_queue;               ///< Posted, not yet drained
+    std::atomic<bool> m_wakePending{false};        ///< A drain is queued on the UI thread
+    std::deque<NotificationRecord> m_history;      ///< Records by consecutive id
+    std::unordered_map<wxString, uint64_t> m_keys; ///< Latest record of each key
+    uint64_t m_nextId = 1;                         ///< Next record id
+    uint64_t m_pendingId = 0;                      ///< Record waiting to be presented, 0 if none
+    size_t m_suppressed = 0;                       ///< Records superseded while waiting
+    double m_tokens = kBurst;                      ///< Presentations currently allowed
+    Clock::time_point m_lastRefill;                ///< Time m_tokens was computed
+    std::vector<ListenerEntry> m_listeners;
+    int m_nextListenerId = 1;
+    wxTimer m_timer;                               ///< Presents when the rate allows again
+
+    // Queue a drain on the UI thread unless one is queued
+    void Wake();
+
+    // Take posted notifications into the history
+    void Drain();
+    void Record(Notification&& notification, Clock::time_point now);
+
+    // Find a record by id
+    NotificationRecord* Find(uint64_t id);
+
+    // Present the pending record if the rate allows, or schedule it
+    void Present();
+
+    // Event handlers
+    void OnTimer(wxTimerEvent& event);
+};
+
+} // namespace ITD
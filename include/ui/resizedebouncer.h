@@ -0,0 +1,61 @@
+#pragma once
+
+#include <wx/wx.h>
+#include <wx/timer.h>
+#include <functional>
+
+namespace ITD {
+
+/**
+ * @brief Tells a lone resize from a drag and defers the work of a drag
+ *
+ * A size event after a quiet period is applied at once, so maximizing or a
+ * programmatic resize does not lag. Further size events within the quiet
+ * period belong to a drag: Defer() returns true for them, and the settle
+ * callback runs once, when no size event has arrived for the quiet period.
+ */
+class ResizeDebouncer : public wxEvtHandler {
+public:
+    /**
+     * @brief Callback run once a deferred resize has settled
+     */
+    using SettleCallback = std::function<void()>;
+
+    /**
+     * @brief Constructor
+     * @param settled Callback run when a drag ends
+     * @param quietMs Time without size events that ends a drag
+     */
+    explicit ResizeDebouncer(SettleCallback settled, int quietMs = kDefaultQuietMs);
+
+    /**
+     * @brief Note a size event
+     * @return True if the event is part of a drag and its work should be
+     *         deferred to the settle callback
+     */
+    bool Defer();
+
+    /**
+     * @brief Check if a drag is in progress
+     * @return True between the first deferred event and the settle callback
+     */
+    bool IsDeferring() const { return m_deferring; }
+
+    /**
+     * @brief End a drag now, running the settle callback if work was deferred
+     */
+    void Settle();
+
+    static constexpr int kDefaultQuietMs = 150;  ///< Default quiet period
+
+private:
+    SettleCallback m_settled;  ///< Runs the deferred work
+    wxTimer m_timer;           ///< Measures the quiet period
+    int m_quietMs;             ///< Quiet period
+    bool m_deferring = false;  ///< Work was deferred since the last settle
+
+    // Event handlers
+    void OnTimer(wxTimerEvent& event);
+};
+
+} // namespace ITD
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <wx/wx.h>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ITD {
+
+/**
+ * @brief Binary space partition of an area between windows
+ *
+ * Every inner node splits its rectangle in two, side by side or one above
+ * the other, at a ratio; every leaf holds a window. Nodes keep the rectangle
+ * computed for them, and a change (a ratio, an insertion, a removal, the
+ * area) marks only the node it touches and the path to the root. Layout()
+ * then descends only into marked paths and into children whose rectangle
+ * actually changed, and reports only the windows that must move.
+ */
+class SplitTree {
+public:
+    /**
+     * @brief New rectangle of a window
+     */
+    struct Change {
+        wxWindow* window;  ///< Window to move
+        wxRect rect;       ///< Its rectangle in the area's coordinates
+    };
+
+    /**
+     * @brief Remove all windows
+     */
+    void Clear();
+
+    /**
+     * @brief Rebuild the tree as a balanced row or column of windows
+     * @param windows Windows in order
+     * @param horizontal True to place the windows side by side
+     */
+    void BuildRow(const std::vector<wxWindow*>& windows, bool horizontal);
+
+    /**
+     * @brief Rebuild the tree as a balanced grid of windows
+     *
+     * The last row may be short; its windows share the full width.
+     *
+     * @param windows Windows in row order
+     * @param columns Windows per row
+     */
+    void BuildGrid(const std::vector<wxWindow*>& windows, size_t columns);
+
+    /**
+     * @brief Describe the arrangement as text
+     *
+     * A window is written as its index in windows, and a split as 'h' (side
+     * by side) or 'v' followed by the first child's share in ten-thousandths
+     * and both children in parentheses: "h5000(0,v3333(1,2))". Windows that
+     * are not listed are left out.
+     *
+     * @param windows Windows that may appear, by index
+     * @return The description, empty if no listed window is in the tree
+     */
+    std::string Save(const std::vector<wxWindow*>& windows) const;
+
+    /**
+     * @brief Rebuild the tree from a Save() description
+     *
+     * Indices of null windows are left out, and their splits collapse.
+     *
+     * @param shape Description
+     * @param windows Windows by index
+     * @return False if the description is malformed or names an index twice
+     *         or out of range; the tree is then empty
+     */
+    bool Load(const std::string& shape, const std::vector<wxWindow*>& windows);
+
+    /**
+     * @brief Split a window's space with a new window
+     * @param window Window to insert
+     * @param target Window to split; the whole area if nullptr or unknown
+     * @param horizontal True to place the new window right of the target,
+     *        false to place it below
+     * @return False if the window is already in the tree
+     */
+    bool Insert(wxWindow* window, wxWindow* target, bool horizontal);
+
+    /**
+     * @brief Remove a window, giving its space to its sibling
+     * @param window Window to remove
+     * @return False if the window is not in the tree
+     */
+    bool Remove(wxWindow* window);
+
+    /**
+     * @brief Set the share of a window's split that the window gets
+     * @param window Window in the tree
+     * @param ratio Share between kMinRatio and 1 - kMinRatio
+     * @return False if the window is not in the tree or fills the area alone
+     */
+    bool SetRatio(wxWindow* window, double ratio);
+
+    /**
+     * @brief Set the area to divide
+     * @param area Area, usually the parent's client rectangle
+     */
+    void SetArea(const wxRect& area);
+
+    /**
+     * @brief Report every window in the next Layout(), moved or not
+     */
+    void Invalidate();
+
+    /**
+     * @brief Recompute the rectangles of the changed parts of the tree
+     * @param changes Receives the windows whose rectangle changed; cleared
+     *        first and reused without reallocating
+     * @return Number of nodes visited
+     */
+    size_t Layout(std::vector<Change>& changes);
+
+    /**
+     * @brief Check if a window is in the tree
+     * @param window Window
+     * @return True if it was inserted and not removed
+     */
+    bool Contains(wxWindow* window) const { return m_leaves.count(window) != 0; }
+
+    /**
+     * @brief Get the number of windows
+     * @return Window count
+     */
+    size_t GetWindowCount() const { return m_leaves.size(); }
+
+    /**
+     * @brief Get the rectangle computed by the last Layout()
+     * @param window Window in the tree
+     * @return The rectangle, or an empty one if the window is not in the tree
+     */
+    wxRect GetRect(wxWindow* window) const;
+
+    static constexpr double kMinRatio = 0.05;  ///< Smallest share of a split
+
+private:
+    /**
+     * @brief Split or window
+     */
+    struct Node {
+        int parent = -1;
+        int first = -1;           ///< Left or top child, -1 for a leaf
+        int second = -1;          ///< Right or bottom child
+        wxWindow* window = nullptr;
+        float ratio = 0.5f;       ///< Share of the first child
+        bool horizontal = true;   ///< Children side by side
+        bool dirty = true;        ///< Children must be recomputed; for a leaf, reported
+        bool childDirty = false;  ///< A descendant is dirty
+        wxRect rect{0, 0, -1, -1};
+    };
+
+    std::vector<Node> m_nodes;                   ///< Nodes, including free ones
+    std::vector<int> m_free;                     ///< Indices of free nodes
+    std::unordered_map<wxWindow*, int> m_leaves; ///< Leaf of each window
+    int m_root = -1;                             ///< Root node, -1 if empty
+    wxRect m_area;                               ///< Area of the root
+
+    int NewNode();
+    void FreeNode(int index);
+    void MarkDirty(int index);
+    void ReplaceChild(int parent, int child, int replacement);
+    int Build(size_t begin, size_t end, bool horizontal, const std::function<int(size_t)>& item);
+    void Visit(int index, std::vector<Change>& changes, size_t& visited);
+    bool SaveNode(int index, const std::unordered_map<wxWindow*, size_t>& indices, std::string& shape) const;
+    int LoadNode(const char*& p, const char* end, const std::vector<wxWindow*>& windows, int depth, bool& ok);
+};
+
+} // namespace ITD
@@ -2,32 +2,23 @@
 
 #include <wx/wx.h>
 #include <wx/timer.h>
-#include <vector>
-#include <unordered_map>
+#include "ui/notificationcenter.h"
+#include "ui/tasklistmodel.h"
+#include "ui/taskstrip.h"
 
 namespace ITD {
 
-/**
- * @brief Task information structure
- */
-struct TaskInfo {
-    wxString name;           ///< Task name
-    wxIcon icon;             ///< Task icon
-    wxWindow* window;        ///< Associated window
-    bool isActive;           ///< True if task is active
-    
-    /**
-     * @brief Constructor
-     */
-    TaskInfo() : window(nullptr), isActive(false) {}
-};
-
 /**
  * @brief Custom taskbar component for ITD
  * 
  * This class provides a taskbar for managing running applications
  * and system status, similar to the Windows taskbar but customized
  * for the Integrated Terminal Desktop.
+ *
+ * The tasks are kept in a TaskListModel and shown by a TaskStrip that
+ * repaints only what a change affects; nothing is rebuilt when a task is
+ * added, removed or activated. Notifications presented by the
+ * NotificationCenter are shown beside the clock for a few seconds.
  */
 class Taskbar : public wxPanel {
 public:
@@ -93,6 +84,12 @@ public:
      */
     void SetActiveTask(wxWindow* window);
 
+    /**
+     * @brief Get the tasks
+     * @return Task list, for reading and for change notifications
+     */
+    const TaskListModel& GetTasks() const { return m_tasks; }
+
     /**
      * @brief Set transparency level
      * @param alpha Alpha value (0-255, where 0 is fully transparent and 255 is opaque)
@@ -102,8 +99,9 @@ public:
     /**
      * @brief Show/hide the taskbar
      * @param show True to show, false to hide
+     * @return True if the visibility changed
      */
-    void Show(bool show = true) override;
+    bool Show(bool show = true) override;
 
     /**
      * @brief Check if the taskbar is visible
@@ -112,33 +110,37 @@ public:
     bool IsShown() const override { return m_isVisible; }
 
 private:
-    std::vector<TaskInfo> m_tasks;    ///< List of tasks
+    TaskListModel m_tasks;           ///< List of tasks
     Position m_position = Position::Bottom;  ///< Taskbar position
     unsigned char m_transparency = 255;  ///< Transparency level
     bool m_isVisible = true;         ///< Visibility state
-    wxSize m_itemSize;               ///< Size of each task item
-    wxTimer m_clockTimer;            ///< Timer for clock updates
+    int m_clockTask = 0;             ///< Clock update task in the TickScheduler
     wxString m_clockText;            ///< Current clock text
+    int m_notificationListener = 0;  ///< NotificationCenter listener ID
+    wxTimer m_notificationTimer;     ///< Hides the shown notification
 
     // UI components
     wxBoxSizer* m_mainSizer = nullptr;  ///< Main sizer
-    wxBoxSizer* m_tasksSizer = nullptr;  ///< Sizer for tasks
+    TaskStrip* m_taskStrip = nullptr;  ///< Task items
     wxStaticText* m_clockLabel = nullptr;  ///< Clock label
+    wxStaticText* m_notificationLabel = nullptr;  ///< Latest notification
 
     // Event handlers
     void OnPaint(wxPaintEvent& event);
     void OnSize(wxSizeEvent& event);
-    void OnTaskSelected(wxCommandEvent& event);
-    void OnClockTimer(wxTimerEvent& event);
     void OnRightClick(wxContextMenuEvent& event);
+    void OnNotificationTimer(wxTimerEvent& event);
 
     // UI update methods
     void UpdateLayout();
-    void UpdateTaskList();
     void UpdateClock();
+    void UpdateBackground();
+
+    // Bring a task's window forward
+    void ActivateTask(wxWindow* window);
 
-    // Helper methods
-    wxRect GetTaskRect(size_t index) const;
+    // Show a notification presented by the NotificationCenter
+    void ShowNotification(const NotificationRecord& record, size_t suppressed);
 
     wxDECLARE_EVENT_TABLE();
 };
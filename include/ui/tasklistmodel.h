@@ -0,0 +1,136 @@
+#pragma once
+
+#include <wx/wx.h>
+#include <cstddef>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace ITD {
+
+/**
+ * @brief Task information structure
+ */
+struct TaskInfo {
+    wxString name;           ///< Task name
+    wxIcon icon;             ///< Task icon
+    wxWindow* window;        ///< Associated window
+    bool isActive;           ///< True if task is active
+
+    /**
+     * @brief Constructor
+     */
+    TaskInfo() : window(nullptr), isActive(false) {}
+};
+
+/**
+ * @brief Tasks shown by the taskbar, with change notifications
+ *
+ * Every change is reported to the listeners with the index of the task it
+ * concerns, so a view updates only the items affected instead of rebuilding
+ * itself. Tasks are found by window with a hash lookup. UI thread only.
+ */
+class TaskListModel {
+public:
+    /**
+     * @brief Kind of change
+     */
+    enum class ChangeKind {
+        Inserted,   ///< Task added at the index
+        Removed,    ///< Task removed from the index; later tasks moved up
+        Changed,    ///< Name or icon changed
+        Activated   ///< Task became active or inactive
+    };
+
+    /**
+     * @brief Change reported to listeners
+     */
+    struct Change {
+        ChangeKind kind;    ///< What changed
+        size_t index;       ///< Index of the task
+        wxWindow* window;   ///< Window of the task
+    };
+
+    using Listener = std::function<void(const Change& change)>;
+
+    /**
+     * @brief Add a task at the end
+     * @param name Task name
+     * @param icon Task icon
+     * @param window Associated window
+     * @return False if the window is null or already has a task
+     */
+    bool Add(const wxString& name, const wxIcon& icon, wxWindow* window);
+
+    /**
+     * @brief Remove a task
+     * @param window Associated window
+     * @return False if the window has no task
+     */
+    bool Remove(wxWindow* window);
+
+    /**
+     * @brief Change the name and icon of a task
+     * @param window Associated window
+     * @param name New name
+     * @param icon New icon
+     * @return False if the window has no task
+     */
+    bool Update(wxWindow* window, const wxString& name, const wxIcon& icon);
+
+    /**
+     * @brief Make a task the active one
+     * @param window Associated window; nullptr or a window without a task
+     *        leaves no task active
+     */
+    void SetActive(wxWindow* window);
+
+    /**
+     * @brief Get the number of tasks
+     * @return Task count
+     */
+    size_t GetCount() const { return m_tasks.size(); }
+
+    /**
+     * @brief Get a task
+     * @param index Index below GetCount()
+     * @return The task
+     */
+    const TaskInfo& GetTask(size_t index) const { return m_tasks[index]; }
+
+    /**
+     * @brief Find the task of a window
+     * @param window Associated window
+     * @return Index of the task, -1 if none
+     */
+    int Find(wxWindow* window) const;
+
+    /**
+     * @brief Add a change listener
+     * @param listener Called after each change
+     * @return Listener ID for RemoveListener()
+     */
+    int AddListener(Listener listener);
+
+    /**
+     * @brief Remove a change listener
+     * @param id Listener ID returned by AddListener()
+     */
+    void RemoveListener(int id);
+
+private:
+    struct ListenerEntry {
+        int id;
+        Listener callback;
+    };
+
+    std::vector<TaskInfo> m_tasks;                   ///< Tasks in display order
+    std::unordered_map<wxWindow*, size_t> m_indices; ///< Index of each window's task
+    wxWindow* m_active = nullptr;                    ///< Window of the active task
+    std::vector<ListenerEntry> m_listeners;
+    int m_nextListenerId = 1;
+
+    void Notify(ChangeKind kind, size_t index, wxWindow* window);
+};
+
+} // namespace ITD
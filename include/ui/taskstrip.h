@@ -0,0 +1,98 @@
+#pragma once
+
+#include <wx/wx.h>
+#include "ui/tasklistmodel.h"
+#include <functional>
+#include <unordered_map>
+
+namespace ITD {
+
+/**
+ * @brief Virtualized strip of taskbar items
+ *
+ * Items are drawn rather than made of child controls, and a repaint draws
+ * only the items inside the updated area, so the cost of painting and of
+ * hovering does not grow with the number of tasks. Hit testing is arithmetic
+ * on the item size. A model change repaints only the items it affects: one
+ * item for a rename or activation, the items from the change onwards for an
+ * insertion or removal. Icons are scaled to the item once per DPI and cached
+ * by window. Items that do not fit are reached with the mouse wheel.
+ */
+class TaskStrip : public wxWindow {
+public:
+    using SelectCallback = std::function<void(wxWindow* window)>;
+
+    /**
+     * @brief Constructor
+     * @param parent Parent window
+     * @param model Tasks to show; must outlive the strip
+     * @param onSelect Called with the task's window when an item is clicked
+     */
+    TaskStrip(wxWindow* parent, TaskListModel& model, SelectCallback onSelect);
+
+    /**
+     * @brief Destructor
+     */
+    virtual ~TaskStrip();
+
+    /**
+     * @brief Set the orientation
+     * @param vertical True to stack the items, false to place them in a row
+     */
+    void SetVertical(bool vertical);
+
+    /**
+     * @brief Find the item at a point
+     * @param point Point in client coordinates
+     * @return Task index, -1 if there is no item there
+     */
+    int HitTest(const wxPoint& point) const;
+
+    /**
+     * @brief Get the rectangle of an item
+     * @param index Task index
+     * @return Rectangle in client coordinates, possibly outside the strip
+     */
+    wxRect GetItemRect(size_t index) const;
+
+private:
+    TaskListModel& m_model;            ///< Tasks shown
+    int m_listener = 0;                ///< Model listener ID
+    SelectCallback m_onSelect;         ///< Click handler
+    bool m_vertical = false;           ///< Items stacked
+    wxSize m_itemSize;                 ///< Item size in pixels
+    int m_scrollOffset = 0;            ///< Pixels scrolled along the strip
+    int m_hover = -1;                  ///< Item under the mouse, -1 if none
+    std::unordered_map<wxWindow*, wxBitmap> m_icons;  ///< Scaled icons by task window
+
+    // Get the scaled icon of a task, scaling it on first use
+    const wxBitmap& GetIcon(const TaskInfo& task);
+
+    // Length of the strip and of all items along the strip
+    int GetLength() const;
+    int GetExtent() const;
+
+    // Keep the scroll offset within the items
+    void ClampScroll();
+
+    // Repaint an item, or the items from one to the end of the strip
+    void RefreshItem(int index);
+    void RefreshFrom(size_t index);
+
+    // Hover tracking
+    void SetHover(int index);
+
+    // Model listener
+    void OnModelChange(const TaskListModel::Change& change);
+
+    // Event handlers
+    void OnPaint(wxPaintEvent& event);
+    void OnSize(wxSizeEvent& event);
+    void OnMotion(wxMouseEvent& event);
+    void OnLeave(wxMouseEvent& event);
+    void OnLeftUp(wxMouseEvent& event);
+    void OnMouseWheel(wxMouseEvent& event);
+    void OnDPIChanged(wxDPIChangedEvent& event);
+};
+
+} // namespace ITD
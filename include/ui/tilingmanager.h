@@ -1,6 +1,9 @@
 #pragma once
 
 #include <wx/wx.h>
+#include "ui/resizedebouncer.h"
+#include "ui/splittree.h"
+#include <cstdint>
 #include <vector>
 #include <memory>
 #include <unordered_map>
@@ -12,6 +15,21 @@ namespace ITD {
  * 
  * This class manages the layout of windows in a tiled arrangement,
  * similar to tiling window managers in Linux.
+ *
+ * The horizontal, vertical, grid and tiled layouts are kept in a SplitTree
+ * that persists between layout passes, so a pass recomputes only the parts
+ * of the tree that changed and moves only the windows whose rectangle
+ * changed, all in one batch.
+ *
+ * While the parent is being resized by dragging, the windows are hidden
+ * behind a preview of placeholder panes that follows the new geometry; they
+ * are placed, and reflow their content, once the size settles.
+ *
+ * Windows belong to one of several virtual desktops, each with its own
+ * layout, arrangement and focus. Only the active desktop is laid out; the
+ * windows of the others stay hidden, so they are neither laid out nor
+ * painted, and tasks gated on their visibility stop ticking. Switching
+ * back shows them with a single layout pass.
  */
 class TilingManager : public wxEvtHandler {
 public:
@@ -34,7 +52,8 @@ public:
         Vertical,      ///< Windows arranged vertically
         Grid,          ///< Windows arranged in a grid
         Stacked,       ///< Windows stacked (only one visible at a time)
-        Tabbed         ///< Windows arranged as tabs
+        Tabbed,        ///< Windows arranged as tabs
+        Tiled          ///< Windows arranged by successive splits
     };
 
     /**
@@ -50,7 +69,7 @@ public:
     LayoutType GetLayoutType() const { return m_currentLayout; }
 
     /**
-     * @brief Add a window to be managed
+     * @brief Add a window to be managed on the active desktop
      * @param window Window to add
      * @param name Window name
      */
@@ -58,7 +77,7 @@ public:
 
     /**
      * @brief Remove a window from management
-     * @param window Window to remove
+     * @param window Window to remove, on any desktop
      * @return True if successful, false otherwise
      */
     bool RemoveWindow(wxWindow* window);
@@ -70,7 +89,13 @@ public:
     void FocusWindow(wxWindow* window);
 
     /**
-     * @brief Get all managed windows
+     * @brief Get the focused window
+     * @return Window last passed to FocusWindow(), nullptr if none
+     */
+    wxWindow* GetFocusedWindow() const { return m_focusedWindow; }
+
+    /**
+     * @brief Get the managed windows of the active desktop
      * @return Vector of window pointers
      */
     const std::vector<wxWindow*>& GetWindows() const { return m_windows; }
@@ -90,6 +115,68 @@ public:
      */
     void UpdateLayout();
 
+    /**
+     * @brief Describe the arrangement of the split layouts
+     * @param windows Windows to describe, by index; others are left out
+     * @return SplitTree::Save() description, empty for the stacked and tabbed
+     *         layouts or before the first layout pass
+     */
+    std::string SaveLayout(const std::vector<wxWindow*>& windows) const;
+
+    /**
+     * @brief Set the layout type and arrangement in one layout pass
+     *
+     * Managed windows missing from the description are added beside the
+     * others; without a valid description, the layout is rebuilt as usual.
+     *
+     * @param type Layout type
+     * @param shape SaveLayout() description
+     * @param windows Windows by index in the description; null for missing ones
+     * @return False if the description could not be used
+     */
+    bool RestoreLayout(LayoutType type, const std::string& shape, const std::vector<wxWindow*>& windows);
+
+    /**
+     * @brief Get the name of a layout type
+     * @param type Layout type
+     * @return Lowercase name ("grid", "tiled", ...)
+     */
+    static wxString GetLayoutName(LayoutType type);
+
+    /**
+     * @brief Parse a layout type name, ignoring case
+     * @param name Name returned by GetLayoutName()
+     * @param type Receives the layout type
+     * @return False if the name is unknown; type is then unchanged
+     */
+    static bool ParseLayoutName(const wxString& name, LayoutType& type);
+
+    /**
+     * @brief Start a batch of changes
+     *
+     * Until the matching EndUpdate(), adding, removing, splitting and
+     * changing the layout type only mark the layout as stale; the outermost
+     * EndUpdate() lays the windows out once. Batches nest.
+     */
+    void BeginUpdate() { ++m_updateDepth; }
+
+    /**
+     * @brief End a batch of changes, laying out the windows if needed
+     */
+    void EndUpdate();
+
+    /**
+     * @brief Check if a batch is open
+     * @return True between BeginUpdate() and the matching EndUpdate()
+     */
+    bool IsUpdating() const { return m_updateDepth > 0; }
+
+    /**
+     * @brief Get the number of layout passes run so far
+     * @return Layout pass count
+     */
+    uint64_t GetLayoutCount() const { return m_layoutCount; }
+
     /**
      * @brief Set transparency level for all managed windows
      * @param alpha Alpha value (0-255, where 0 is fully transparent and 255 is opaque)
@@ -103,28 +190,118 @@ public:
 
     /**
      * @brief Split the current window
-     * @param direction Split direction (true for horizontal, false for vertical)
+     *
+     * Switches to the tiled layout, keeping the current arrangement; the next
+     * window added shares the focused window's space.
+     *
+     * @param horizontal Split direction (true to place the next window to the
+     *        right, false to place it below)
      */
     void SplitWindow(bool horizontal);
 
+    /**
+     * @brief Set the share of its split that a window gets
+     *
+     * Only the windows in that split are laid out again.
+     *
+     * @param window Managed window
+     * @param ratio Share of the split, from 0 to 1
+     * @return False if the window is not managed or the layout has no splits
+     */
+    bool SetSplitRatio(wxWindow* window, double ratio);
+
+    /**
+     * @brief Make a virtual desktop the active one
+     *
+     * The windows of the previous desktop are hidden as they are, and those
+     * of the new one are shown where they were left.
+     *
+     * @param index Desktop index, from 0 to kMaxDesktops - 1
+     * @return False if the index is out of range
+     */
+    bool SwitchDesktop(size_t index);
+
+    /**
+     * @brief Get the active virtual desktop
+     * @return Desktop index
+     */
+    size_t GetActiveDesktop() const { return m_activeDesktop; }
+
+    /**
+     * @brief Get the number of virtual desktops used so far
+     * @return One more than the highest desktop index switched or moved to
+     */
+    size_t GetDesktopCount() const { return m_desktops.size(); }
+
+    /**
+     * @brief Move a managed window to another virtual desktop
+     * @param window Window on any desktop
+     * @param index Desktop index, from 0 to kMaxDesktops - 1
+     * @return False if the window is not managed or the index is out of range
+     */
+    bool MoveWindowToDesktop(wxWindow* window, size_t index);
+
+    static constexpr size_t kMaxDesktops = 16;  ///< Number of virtual desktops
+
 private:
+    /**
+     * @brief Windows and arrangement of an inactive virtual desktop
+     *
+     * The active desktop lives in the members below; its slot holds an
+     * empty desktop until it is switched away from.
+     */
+    struct Desktop {
+        std::vector<wxWindow*> windows;
+        std::unordered_map<wxWindow*, wxString> windowNames;
+        LayoutType layout = LayoutType::Grid;
+        wxWindow* focusedWindow = nullptr;
+        SplitTree tree;
+        bool treeValid = false;
+        bool splitHorizontal = true;
+    };
+
     wxWindow* m_parent;                    ///< Parent window
     std::vector<wxWindow*> m_windows;      ///< Managed windows
     std::unordered_map<wxWindow*, wxString> m_windowNames; ///< Window names
     LayoutType m_currentLayout = LayoutType::Grid; ///< Current layout type
     wxWindow* m_focusedWindow = nullptr;   ///< Currently focused window
     unsigned char m_transparency = 255;    ///< Transparency level
+    int m_updateDepth = 0;                 ///< Nesting level of BeginUpdate()
+    bool m_layoutPending = false;          ///< UpdateLayout() was deferred by a batch
+    uint64_t m_layoutCount = 0;            ///< Layout passes run
+    SplitTree m_tree;                      ///< Geometry of the split layouts
+    bool m_treeValid = false;              ///< m_tree matches m_windows and the layout type
+    bool m_splitHorizontal = true;         ///< Direction of the next split in the tiled layout
+    std::vector<SplitTree::Change> m_changes; ///< Moves of the current pass
+    ResizeDebouncer m_resizeDebouncer;     ///< Tells resize drags from lone resizes
+    wxWindow* m_preview = nullptr;         ///< Placeholder panes shown during a drag
+    std::vector<Desktop> m_desktops{1};    ///< Virtual desktops by index
+    size_t m_activeDesktop = 0;            ///< Desktop held in the members above
+
+    // Exchange the active desktop's state with a parked one
+    void SwapDesktop(Desktop& desktop);
+
+    // Find the inactive desktop holding a window
+    Desktop* FindParkedDesktop(wxWindow* window);
+
+    // Move and resize a window, showing it
+    void Place(wxWindow* window, const wxRect& rect);
 
     // Layout methods
-    void LayoutHorizontal();
-    void LayoutVertical();
-    void LayoutGrid();
+    void RebuildTree();
+    void LayoutTree();
     void LayoutStacked();
     void LayoutTabbed();
 
+    // Resize preview
+    bool IsPreviewing() const { return m_preview && m_preview->IsShown(); }
+    void ShowResizePreview();
+    void EndResizePreview();
+
     // Event handlers
     void OnParentSize(wxSizeEvent& event);
     void OnWindowClose(wxCloseEvent& event);
+    void OnPreviewPaint(wxPaintEvent& event);
 };
 
 } // namespace ITD 
\ No newline at end of file
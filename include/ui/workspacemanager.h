@@ -0,0 +1,168 @@
+#pragma once
+
+#include <wx/wx.h>
+#include "config/configwatcher.h"
+#include "ui/tilingmanager.h"
+#include "util/threadpool.h"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace ITD {
+
+/**
+ * @brief Saved state of one pane
+ */
+struct WorkspacePane {
+    wxString type;       ///< Pane type ("terminal", "explorer")
+    wxString name;       ///< Name given to the tiling manager
+    wxString directory;  ///< Working directory
+    int anchor = 0;      ///< First line scrolled into view
+    wxString history;    ///< Scrollback file name, relative to the workspace file; empty if none
+};
+
+/**
+ * @brief Saved arrangement of the tiled panes
+ *
+ * Stored in the configuration file format:
+ *
+ * @code
+ * [workspace]
+ * layout=tiled
+ * tree=h5000(0,v5000(1,2))
+ * focus=0
+ *
+ * [pane0]
+ * type=terminal
+ * name=Build
+ * directory=/home/me/src
+ * anchor=120
+ * history=dev.0.history
+ * @endcode
+ *
+ * The tree refers to panes by index (see SplitTree::Save()).
+ */
+struct Workspace {
+    TilingManager::LayoutType layout = TilingManager::LayoutType::Grid; ///< Layout type
+    std::string tree;                 ///< TilingManager::SaveLayout() description
+    int focus = -1;                   ///< Index of the focused pane, -1 if none
+    std::vector<WorkspacePane> panes; ///< Panes by index
+
+    /**
+     * @brief Convert to configuration entries
+     * @return Sections and values
+     */
+    ConfigEntries ToEntries() const;
+
+    /**
+     * @brief Read configuration entries
+     * @param entries Sections and values
+     * @return False if there is no [workspace] section
+     */
+    bool FromEntries(const ConfigEntries& entries);
+};
+
+/**
+ * @brief Saves the tiled panes as named workspaces and restores them
+ *
+ * Workspaces are kept in the "workspaces" directory beside the configuration
+ * file, with each terminal's scrollback in a file of its own. Restoring is
+ * one layout pass: panes whose type and name match a current pane are kept
+ * as they are, the others are created empty and hidden, and the expensive
+ * part of their content (scrollback, explorer listing) is loaded when they
+ * are first shown. Scrollback files are read on a thread pool, so panes
+ * shown together load in parallel. Parsed workspaces are cached, so
+ * switching back to one does not read its file again.
+ *
+ * Current panes the workspace does not keep are destroyed if they were
+ * created here. Others, such as the initial terminal, are moved to a
+ * virtual desktop after the existing ones (the last desktop when all are
+ * in use), where they keep running and can be switched to.
+ */
+class WorkspaceManager : public wxEvtHandler {
+public:
+    /**
+     * @brief Constructor
+     * @param parent Parent of the created panes
+     * @param tilingManager Tiling manager arranging the panes
+     */
+    WorkspaceManager(wxWindow* parent, TilingManager* tilingManager);
+
+    /**
+     * @brief Destructor
+     */
+    virtual ~WorkspaceManager();
+
+    /**
+     * @brief Save the current panes as a workspace
+     * @param name Workspace name
+     * @return True if successful
+     */
+    bool Save(const wxString& name);
+
+    /**
+     * @brief Replace the current panes with a saved workspace
+     * @param name Workspace name
+     * @return False if the workspace does not exist or cannot be read
+     */
+    bool Restore(const wxString& name);
+
+    /**
+     * @brief Get the names of the saved workspaces
+     * @return Names, sorted
+     */
+    std::vector<wxString> GetWorkspaceNames() const;
+
+    /**
+     * @brief Get the directory holding the workspaces
+     * @return Directory path
+     */
+    static wxString GetDirectory();
+
+    static constexpr size_t kMaxHistoryLength = 1024 * 1024;  ///< Scrollback saved per terminal
+
+private:
+    /**
+     * @brief Parsed workspace file
+     */
+    struct CacheEntry {
+        Workspace workspace;   ///< Parsed content
+        wxDateTime modified;   ///< File time when parsed
+    };
+
+    /**
+     * @brief Content of a pane waiting for it to be shown
+     */
+    struct PendingContent {
+        uint64_t id;           ///< Tells a reused window address apart
+        WorkspacePane pane;    ///< Saved state
+        wxString historyPath;  ///< Absolute scrollback file path
+    };
+
+    wxWindow* m_parent;                       ///< Parent of created panes
+    TilingManager* m_tilingManager;           ///< Arranges the panes
+    std::map<wxString, CacheEntry> m_cache;   ///< Parsed workspaces by name
+    std::unordered_set<wxWindow*> m_ownedPanes; ///< Panes created here
+    std::unordered_map<wxWindow*, PendingContent> m_pending; ///< Content not loaded yet
+    uint64_t m_nextContentId = 1;             ///< Next PendingContent id
+    ThreadPool m_pool;                        ///< Scrollback readers (destroyed first)
+
+    // Get a workspace from the cache or its file
+    const Workspace* Load(const wxString& name);
+
+    // Create an empty, hidden pane
+    wxWindow* CreatePane(const WorkspacePane& pane, const wxString& directory);
+
+    // Load deferred content
+    void LoadContent(wxWindow* window);
+    void ApplyContent(wxWindow* window, uint64_t id, const wxString& history);
+
+    // Event handlers
+    void OnPaneShow(wxShowEvent& event);
+    void OnPaneDestroy(wxWindowDestroyEvent& event);
+};
+
+} // namespace ITD
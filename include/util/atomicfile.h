@@ -0,0 +1,32 @@
+#pragma once
+
+#include <wx/wx.h>
+#include <string>
+
+namespace ITD {
+
+/**
+ * @brief Replace a file's contents atomically and durably
+ *
+ * The data is written to a temporary file next to the target, flushed to
+ * disk, and renamed over the target. A crash at any point leaves either the
+ * old or the new file in place, never a torn one.
+ *
+ * @param filename Target file path
+ * @param data Bytes to write
+ * @param size Number of bytes to write
+ * @return True if successful
+ */
+bool WriteFileAtomic(const wxString& filename, const void* data, size_t size);
+
+/**
+ * @brief Replace a file's contents atomically and durably
+ * @param filename Target file path
+ * @param data Bytes to write
+ * @return True if successful
+ */
+inline bool WriteFileAtomic(const wxString& filename, const std::string& data) {
+    return WriteFileAtomic(filename, data.data(), data.size());
+}
+
+} // namespace ITD
\ No newline at end of file
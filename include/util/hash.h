@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace ITD {
+
+/**
+ * @brief 64-bit FNV-1a hash
+ *
+ * Used to validate on-disk caches against their source files; not suitable
+ * for anything security related.
+ *
+ * @param data Bytes to hash
+ * @param size Number of bytes
+ * @param seed Starting value, for hashing data in several pieces
+ * @return Hash value
+ */
+inline uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 0xcbf29ce484222325ULL) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+} // namespace ITD
\ No newline at end of file
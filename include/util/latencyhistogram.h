@@ -0,0 +1,73 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+namespace ITD {
+
+/**
+ * @brief Fixed-size latency histogram with power-of-two buckets
+ *
+ * Bucket i counts durations below 2^i microseconds (bucket 0: below 1 µs);
+ * the last bucket also takes everything longer. Recording is a handful of
+ * instructions and never allocates, so it can stay enabled on hot paths.
+ */
+struct LatencyHistogram {
+    static constexpr size_t kBucketCount = 24;  ///< Up to ~8 s, then overflow
+
+    std::array<uint32_t, kBucketCount> buckets{};  ///< Sample counts per bucket
+    uint64_t count = 0;                            ///< Number of samples
+    uint64_t totalNs = 0;                          ///< Sum of all samples
+    uint64_t maxNs = 0;                            ///< Longest sample
+
+    /**
+     * @brief Add a sample
+     * @param ns Duration in nanoseconds
+     */
+    void Record(uint64_t ns) {
+        uint64_t us = ns / 1000;
+        size_t bucket = 0;
+        while (us != 0 && bucket + 1 < kBucketCount) {
+            us >>= 1;
+            ++bucket;
+        }
+        ++buckets[bucket];
+        ++count;
+        totalNs += ns;
+        maxNs = std::max(maxNs, ns);
+    }
+
+    /**
+     * @brief Get the upper bound of a bucket
+     * @param bucket Bucket index
+     * @return Upper bound in microseconds
+     */
+    static uint64_t GetBucketLimitUs(size_t bucket) { return uint64_t(1) << bucket; }
+
+    /**
+     * @brief Estimate a percentile
+     * @param fraction Percentile as a fraction (0.5 = median)
+     * @return Upper bound of the bucket holding the percentile, in microseconds
+     */
+    uint64_t GetPercentileUs(double fraction) const {
+        if (count == 0)
+            return 0;
+        const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(fraction * static_cast<double>(count) + 0.5));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            seen += buckets[i];
+            if (seen >= rank)
+                return GetBucketLimitUs(i);
+        }
+        return GetBucketLimitUs(kBucketCount - 1);
+    }
+
+    /**
+     * @brief Get the mean duration
+     * @return Mean in microseconds
+     */
+    double GetMeanUs() const { return count ? static_cast<double>(totalNs) / static_cast<double>(count) / 1000.0 : 0.0; }
+};
+
+} // namespace ITD
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <wx/wx.h>
+#include <cstddef>
+
+namespace ITD {
+
+/**
+ * @brief Read-only memory mapping of a file
+ *
+ * Used for on-disk caches that are consumed in place instead of being read
+ * and parsed at startup.
+ */
+class MappedFile {
+public:
+    /**
+     * @brief Constructor
+     */
+    MappedFile() = default;
+
+    /**
+     * @brief Destructor
+     */
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Map a file
+     * @param filename File to map
+     * @return True if successful
+     */
+    bool Open(const wxString& filename);
+
+    /**
+     * @brief Unmap the file
+     */
+    void Close();
+
+    /**
+     * @brief Check if a file is mapped
+     * @return True if mapped
+     */
+    bool IsOpen() const { return m_data != nullptr; }
+
+    /**
+     * @brief Get the mapped bytes
+     * @return Pointer to the start of the mapping
+     */
+    const char* GetData() const { return m_data; }
+
+    /**
+     * @brief Get the mapped size
+     * @return Size in bytes
+     */
+    size_t GetSize() const { return m_size; }
+
+private:
+    const char* m_data = nullptr;  ///< Mapped bytes
+    size_t m_size = 0;             ///< Mapping size
+#ifdef _WIN32
+    void* m_mapping = nullptr;     ///< File mapping handle
+#endif
+};
+
+} // namespace ITD
\ No newline at end of file
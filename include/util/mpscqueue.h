@@ -0,0 +1,115 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace ITD {
+
+/**
+ * @brief Lock-free multi-producer single-consumer queue
+ *
+ * Producers on any thread link a node with one atomic exchange and never
+ * wait for each other or for the consumer; when the queue already holds
+ * its capacity, Push() drops the value and counts it instead of blocking or
+ * growing without bound. A single consumer thread pops in FIFO order (per
+ * producer; producers racing each other are ordered by their exchange).
+ *
+ * A producer between its exchange and its link makes the values behind it
+ * invisible for a moment; Pop() then reports the queue as empty, and the
+ * values appear on a later Pop(). Whoever wakes the consumer must do so
+ * after Push() returns.
+ *
+ * Values must be default constructible and movable.
+ */
+template<typename T>
+class MpscQueue {
+public:
+    /**
+     * @brief Constructor
+     * @param capacity Values the queue may hold before Push() drops
+     */
+    explicit MpscQueue(size_t capacity)
+        : m_capacity(capacity),
+          m_head(new Node()),
+          m_tail(m_head.load(std::memory_order_relaxed)) {
+    }
+
+    /**
+     * @brief Destructor; no producer may be pushing
+     */
+    ~MpscQueue() {
+        T value;
+        while (Pop(value)) {
+        }
+        delete m_tail;
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    /**
+     * @brief Add a value; safe from any thread, never blocks on other threads
+     * @param value Value to move into the queue
+     * @return False if the queue was full and the value was dropped
+     */
+    bool Push(T value) {
+        if (m_size.fetch_add(1, std::memory_order_relaxed) >= m_capacity) {
+            m_size.fetch_sub(1, std::memory_order_relaxed);
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        Node* node = new Node();
+        node->value = std::move(value);
+        Node* previous = m_head.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Take the oldest value; consumer thread only
+     * @param value Receives the value
+     * @return False if no value is available
+     */
+    bool Pop(T& value) {
+        Node* tail = m_tail;
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (!next)
+            return false;
+
+        // The popped node becomes the new placeholder
+        value = std::move(next->value);
+        m_tail = next;
+        delete tail;
+        m_size.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @brief Get the number of values queued
+     * @return Approximate count; exact only when no producer is pushing
+     */
+    size_t GetSize() const { return m_size.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Get the number of values dropped because the queue was full
+     * @return Dropped count since construction
+     */
+    uint64_t GetDropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        T value{};
+    };
+
+    const size_t m_capacity;            ///< Most values held at once
+    std::atomic<size_t> m_size{0};      ///< Values pushed and not popped
+    std::atomic<uint64_t> m_dropped{0}; ///< Values refused for capacity
+    std::atomic<Node*> m_head;          ///< Newest node; producers exchange it
+    Node* m_tail;                       ///< Placeholder before the oldest value; consumer only
+};
+
+} // namespace ITD
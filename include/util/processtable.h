@@ -0,0 +1,246 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "util/seqlock.h"
+
+namespace ITD {
+
+/**
+ * @brief Busiest processes of one pass over /proc
+ *
+ * Fixed-size and trivially copyable so that it can be published through a
+ * SeqLock; only the top rows are included.
+ */
+struct ProcessSnapshot {
+    static constexpr size_t kMaxRows = 64;     ///< Rows published at most
+    static constexpr size_t kNameLength = 16;  ///< Kernel command name limit
+
+    /**
+     * @brief Resource usage of a process
+     */
+    struct Row {
+        int32_t pid;                ///< Process ID
+        char name[kNameLength];     ///< Command name from /proc/[pid]/stat
+        double cpuPercent;          ///< CPU time, 100 per fully used core
+        uint64_t rssBytes;          ///< Resident memory
+        double readBytesPerSec;     ///< Storage reads, 0 if not readable
+        double writeBytesPerSec;    ///< Storage writes, 0 if not readable
+    };
+
+    uint64_t sequence = 0;          ///< Pass number, 0 before the first one
+    double intervalSec = 0.0;       ///< Time since the previous pass
+    uint32_t processCount = 0;      ///< Processes known to the table
+    uint32_t statReads = 0;         ///< /proc/[pid]/stat files read by the pass
+    uint32_t rowCount = 0;          ///< Entries in rows
+    Row rows[kMaxRows] = {};        ///< Top processes, busiest first
+};
+
+/**
+ * @brief Incremental per-process resource table
+ *
+ * Re-reading /proc/[pid]/stat of every process on every pass does not scale
+ * to servers with thousands of processes, so the table works incrementally:
+ *
+ *  - Entries are kept by PID across passes and reused; a changed start time
+ *    detects a reused PID and resets the entry.
+ *  - Listing /proc to find new processes is rate-limited to one full rescan
+ *    per kRescanIntervalMs. Exited processes drop out as soon as their stat
+ *    file disappears.
+ *  - A process whose CPU time did not change is read less often, backing off
+ *    to every kMaxReadSkip passes; it is read every pass again once it runs.
+ *  - Only the top rows are sorted (partial sort), and /proc/[pid]/io is read
+ *    for those rows only, unless the table is sorted by I/O.
+ *
+ * The passes run on a background thread and publish a ProcessSnapshot
+ * through a SeqLock, so the UI only copies the rows it shows. Only Linux
+ * provides /proc; elsewhere Start() returns false.
+ */
+class ProcessTable {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Column the rows are sorted by, descending
+     */
+    enum class SortKey { Cpu, Memory, Io };
+
+    /**
+     * @brief Fields of /proc/[pid]/stat used by the table
+     */
+    struct StatFields {
+        char name[ProcessSnapshot::kNameLength] = {};  ///< Command name
+        uint64_t cpuTicks = 0;   ///< utime + stime in clock ticks
+        uint64_t startTime = 0;  ///< Start time in clock ticks after boot
+        uint64_t rssPages = 0;   ///< Resident set size in pages
+    };
+
+    /**
+     * @brief Constructor; does not start sampling
+     * @param procRoot Directory to read processes from
+     */
+    explicit ProcessTable(const std::string& procRoot = "/proc");
+
+    /**
+     * @brief Destructor; stops the sampler thread
+     */
+    ~ProcessTable();
+
+    /**
+     * @brief Start passes on the background thread
+     * @param intervalMs Time between passes
+     * @return False if the process directory is not available
+     */
+    bool Start(int intervalMs);
+
+    /**
+     * @brief Stop and join the background thread
+     */
+    void Stop();
+
+    /**
+     * @brief Set the sort column; takes effect with the next pass
+     * @param key Sort column
+     */
+    void SetSortKey(SortKey key) { m_sortKey.store(key, std::memory_order_relaxed); }
+
+    /**
+     * @brief Get the sort column
+     * @return Sort column
+     */
+    SortKey GetSortKey() const { return m_sortKey.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Set the number of rows to publish; takes effect with the next pass
+     * @param rows Row count, at most ProcessSnapshot::kMaxRows
+     */
+    void SetRowCount(size_t rows);
+
+    /**
+     * @brief Copy the latest snapshot; lock-free, safe from any thread
+     * @param snapshot Receives the snapshot
+     * @return False if no pass has completed yet
+     */
+    bool GetSnapshot(ProcessSnapshot& snapshot) const;
+
+    /**
+     * @brief Run one pass and publish its snapshot
+     *
+     * Called by the background thread; without Start() it can be called
+     * directly, from one thread at a time.
+     *
+     * @param now Time of the pass
+     * @return False if the process directory is not available
+     */
+    bool Update(Clock::time_point now);
+
+    /**
+     * @brief Parse /proc/[pid]/stat content
+     * @param data File content
+     * @param size Content size in bytes
+     * @param fields Receives the fields
+     * @return False if the content is malformed
+     */
+    static bool ParseStat(const char* data, size_t size, StatFields& fields);
+
+    /**
+     * @brief Parse /proc/[pid]/io content
+     * @param data File content
+     * @param size Content size in bytes
+     * @param readBytes Receives read_bytes
+     * @param writeBytes Receives write_bytes
+     */
+    static void ParseIo(const char* data, size_t size, uint64_t& readBytes, uint64_t& writeBytes);
+
+    static constexpr int kRescanIntervalMs = 5000;  ///< Minimum time between /proc listings
+    static constexpr int kMaxReadSkip = 8;          ///< Most passes an idle process is skipped
+
+private:
+    /**
+     * @brief Cached state of one process
+     */
+    struct Entry {
+        int32_t pid = 0;
+        char name[ProcessSnapshot::kNameLength] = {};
+        uint64_t startTime = 0;        ///< Identifies the process behind the PID
+        uint64_t cpuTicks = 0;         ///< CPU time at the last read
+        uint64_t rssBytes = 0;
+        double cpuPercent = 0.0;
+        Clock::time_point statTime;    ///< Time of the last stat read
+        bool statValid = false;        ///< cpuTicks holds a reading
+
+        uint64_t ioRead = 0;           ///< read_bytes at the last read
+        uint64_t ioWrite = 0;          ///< write_bytes at the last read
+        double readRate = 0.0;
+        double writeRate = 0.0;
+        Clock::time_point ioTime;      ///< Time of the last io read
+        bool ioValid = false;          ///< ioRead/ioWrite hold a reading
+        bool ioDenied = false;         ///< /proc/[pid]/io is not readable
+
+        int readSkip = 1;              ///< Passes between stat reads
+        uint64_t nextRead = 0;         ///< Pass of the next stat read
+        uint64_t seen = 0;             ///< Rescan that last listed the process
+        bool alive = true;             ///< Cleared when the stat file is gone
+    };
+
+    std::string m_root;                        ///< Process directory
+    int m_rootFd = -1;                         ///< Open process directory, -1 if closed
+    double m_ticksPerSecond = 100.0;           ///< Clock ticks of the CPU times
+    uint64_t m_pageSize = 4096;                ///< Unit of the RSS field
+
+    // Pass state (sampler thread, or the caller of Update())
+    std::vector<Entry> m_entries;              ///< Known processes
+    std::unordered_map<int32_t, size_t> m_index;  ///< Entry index by PID
+    std::vector<size_t> m_order;               ///< Sort scratch
+    std::vector<char> m_buffer;                ///< Read buffer
+    uint64_t m_pass = 0;                       ///< Passes run
+    uint64_t m_rescan = 0;                     ///< Rescans run
+    Clock::time_point m_lastRescan;            ///< Time of the last rescan
+    Clock::time_point m_lastPass;              ///< Time of the last pass
+    ProcessSnapshot m_scratch;                 ///< Snapshot being built
+
+    std::atomic<SortKey> m_sortKey{SortKey::Cpu};  ///< Sort column
+    std::atomic<size_t> m_rowCount{20};            ///< Rows to publish
+    SeqLock<ProcessSnapshot> m_snapshot;           ///< Published snapshot
+
+    // Sampler thread state
+    std::thread m_thread;                      ///< Sampler thread
+    std::mutex m_mutex;                        ///< Guards m_stopping
+    std::condition_variable m_condition;       ///< Wakes the thread to stop
+    bool m_stopping = false;                   ///< Thread should exit
+    int m_intervalMs = 2000;                   ///< Time between passes
+
+    // Open the process directory
+    bool OpenRoot();
+
+    // List the process directory, adding new processes and dropping gone ones
+    void Rescan();
+
+    // Read a file below the process directory into the buffer; -1 on failure
+    long ReadFile(int32_t pid, const char* file);
+
+    // Re-read the stat file of an entry; false if the process is gone
+    bool ReadStat(Entry& entry, Clock::time_point now);
+
+    // Re-read the io file of an entry
+    void ReadIo(Entry& entry, Clock::time_point now);
+
+    // Remove entries of exited processes
+    void RemoveDead();
+
+    // Sampler thread function
+    void SamplerLoop();
+
+    ProcessTable(const ProcessTable&) = delete;
+    ProcessTable& operator=(const ProcessTable&) = delete;
+};
+
+} // namespace ITD
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace ITD {
+
+/**
+ * @brief Token inside a scanned buffer; points into the buffer
+ */
+struct ProcToken {
+    const char* data = nullptr;  ///< First character
+    size_t length = 0;           ///< Length in bytes
+
+    bool Equals(const char* literal) const {
+        return std::strlen(literal) == length && std::memcmp(data, literal, length) == 0;
+    }
+
+    bool StartsWith(const char* literal) const {
+        const size_t literalLength = std::strlen(literal);
+        return literalLength <= length && std::memcmp(data, literal, literalLength) == 0;
+    }
+
+    /**
+     * @brief Copy into a fixed-size buffer, truncating and terminating
+     */
+    template<size_t N>
+    void CopyTo(char (&buffer)[N]) const {
+        const size_t count = std::min(length, N - 1);
+        std::memcpy(buffer, data, count);
+        buffer[count] = '\0';
+    }
+};
+
+/**
+ * @brief Forward-only, allocation-free scanner over /proc text
+ *
+ * Missing numbers read as 0, so truncated or unexpected content degrades to
+ * zeros instead of failing.
+ */
+class ProcScanner {
+public:
+    ProcScanner(const char* data, size_t size) : m_pos(data), m_end(data + size) {}
+
+    bool AtEnd() const { return m_pos >= m_end; }
+
+    /**
+     * @brief Skip blanks, stopping at the end of the line
+     */
+    void SkipBlanks() {
+        while (m_pos < m_end && (*m_pos == ' ' || *m_pos == '\t'))
+            ++m_pos;
+    }
+
+    /**
+     * @brief Read up to a blank, a newline or the delimiter, which is consumed
+     */
+    ProcToken ReadToken(char delimiter = '\0') {
+        SkipBlanks();
+        ProcToken token;
+        token.data = m_pos;
+        while (m_pos < m_end && *m_pos != ' ' && *m_pos != '\t' && *m_pos != '\n' && *m_pos != delimiter)
+            ++m_pos;
+        token.length = static_cast<size_t>(m_pos - token.data);
+        if (delimiter != '\0' && m_pos < m_end && *m_pos == delimiter)
+            ++m_pos;
+        return token;
+    }
+
+    /**
+     * @brief Read an unsigned decimal number; 0 if there is none
+     */
+    uint64_t ReadNumber() {
+        SkipBlanks();
+        uint64_t value = 0;
+        while (m_pos < m_end && *m_pos >= '0' && *m_pos <= '9')
+            value = value * 10 + static_cast<uint64_t>(*m_pos++ - '0');
+        return value;
+    }
+
+    /**
+     * @brief Skip whitespace-separated fields of any kind
+     */
+    void SkipFields(int count) {
+        for (int i = 0; i < count; ++i)
+            ReadToken();
+    }
+
+    /**
+     * @brief Move to the start of the next line
+     */
+    void NextLine() {
+        const void* newline = std::memchr(m_pos, '\n', static_cast<size_t>(m_end - m_pos));
+        m_pos = newline ? static_cast<const char*>(newline) + 1 : m_end;
+    }
+
+private:
+    const char* m_pos;  ///< Current position
+    const char* m_end;  ///< End of the buffer
+};
+
+} // namespace ITD
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+namespace ITD {
+
+/**
+ * @brief Single-writer sequence lock for publishing small values
+ *
+ * The writer never waits and readers never block it: a reader copies the
+ * value and retries if the writer was active meanwhile, which the sequence
+ * number reveals (odd while a write is in progress). Suited to values that
+ * are written periodically and read often, such as monitoring samples.
+ *
+ * The value is copied bytewise, so it must be trivially copyable.
+ */
+template<typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock values are copied bytewise");
+
+public:
+    /**
+     * @brief Publish a value; only one thread may write
+     * @param value New value
+     */
+    void Store(const T& value) {
+        const uint32_t sequence = m_sequence.load(std::memory_order_relaxed);
+        m_sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&m_value, &value, sizeof(T));
+        m_sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief Copy the latest value; safe from any thread
+     * @param value Receives the value
+     */
+    void Load(T& value) const {
+        for (;;) {
+            const uint32_t before = m_sequence.load(std::memory_order_acquire);
+            if (before & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            std::memcpy(&value, &m_value, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (m_sequence.load(std::memory_order_relaxed) == before)
+                return;
+        }
+    }
+
+    /**
+     * @brief Get the number of values stored so far
+     * @return Store() count
+     */
+    uint32_t GetVersion() const { return m_sequence.load(std::memory_order_acquire) / 2; }
+
+private:
+    std::atomic<uint32_t> m_sequence{0};  ///< Odd while a write is in progress
+    T m_value{};                          ///< Published value
+};
+
+} // namespace ITD
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <wx/wx.h>
+#include <chrono>
+
+namespace ITD {
+
+/**
+ * @brief Records the phases of application startup
+ *
+ * Times are measured from process start (static initialization). Recording
+ * is cheap and always on until Finish() is called; the recorded phases can
+ * be written as a Chrome trace file (chrome://tracing, Perfetto) for
+ * inspection.
+ */
+class StartupTrace {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Target time from process start to an interactive prompt
+     */
+    static constexpr double kBudgetMs = 150.0;
+
+    /**
+     * @brief Record a completed phase
+     * @param name Phase name (must outlive the trace, e.g. a literal)
+     * @param begin Phase start time
+     * @param end Phase end time
+     */
+    static void Record(const char* name, Clock::time_point begin, Clock::time_point end);
+
+    /**
+     * @brief Record an instant event
+     * @param name Event name (must outlive the trace, e.g. a literal)
+     * @return Milliseconds from process start until the event
+     */
+    static double Mark(const char* name);
+
+    /**
+     * @brief Stop recording; later phases are ignored
+     */
+    static void Finish();
+
+    /**
+     * @brief Get the time elapsed since process start
+     * @return Elapsed time in milliseconds
+     */
+    static double GetElapsedMs();
+
+    /**
+     * @brief Write the recorded phases as a Chrome trace file
+     * @param filename Trace file path
+     * @return True if successful
+     */
+    static bool Write(const wxString& filename);
+
+    /**
+     * @brief Get the trace file requested by the user
+     *
+     * Tracing to a file is enabled by setting ITD_STARTUP_TRACE to the path
+     * of the trace file.
+     *
+     * @return Trace file path, or an empty string if not requested
+     */
+    static wxString GetRequestedPath();
+};
+
+/**
+ * @brief Records the enclosing scope as a startup phase
+ */
+class StartupScope {
+public:
+    /**
+     * @brief Constructor
+     * @param name Phase name (must outlive the trace, e.g. a literal)
+     */
+    explicit StartupScope(const char* name)
+        : m_name(name), m_begin(StartupTrace::Clock::now()) {}
+
+    /**
+     * @brief Destructor; records the phase
+     */
+    ~StartupScope() { StartupTrace::Record(m_name, m_begin, StartupTrace::Clock::now()); }
+
+    StartupScope(const StartupScope&) = delete;
+    StartupScope& operator=(const StartupScope&) = delete;
+
+private:
+    const char* m_name;                       ///< Phase name
+    StartupTrace::Clock::time_point m_begin;  ///< Phase start time
+};
+
+} // namespace ITD
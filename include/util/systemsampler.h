@@ -0,0 +1,231 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <thread>
+#include "util/seqlock.h"
+
+namespace ITD {
+
+/**
+ * @brief System resource usage computed from two consecutive samples
+ *
+ * Fixed-size and trivially copyable so that it can be published through a
+ * SeqLock; devices beyond the limits are ignored.
+ */
+struct SystemSample {
+    static constexpr size_t kMaxCpus = 256;       ///< Cores reported individually
+    static constexpr size_t kMaxDisks = 16;       ///< Disks reported
+    static constexpr size_t kMaxInterfaces = 16;  ///< Network interfaces reported
+    static constexpr size_t kNameLength = 32;     ///< Device name buffer size
+
+    /**
+     * @brief Throughput of a disk
+     */
+    struct Disk {
+        char name[kNameLength];     ///< Device name ("sda", "nvme0n1")
+        double readBytesPerSec;     ///< Read throughput
+        double writeBytesPerSec;    ///< Write throughput
+        double busyPercent;         ///< Time with I/O in flight
+    };
+
+    /**
+     * @brief Throughput of a network interface
+     */
+    struct Interface {
+        char name[kNameLength];     ///< Interface name ("eth0")
+        double rxBytesPerSec;       ///< Receive throughput
+        double txBytesPerSec;       ///< Transmit throughput
+    };
+
+    uint64_t sequence = 0;          ///< Sample number, 0 before the first one
+    int64_t timeMs = 0;             ///< Steady-clock time of the sample
+    double intervalSec = 0.0;       ///< Time covered by the sample
+
+    double cpuPercent = 0.0;        ///< Busy time of all cores
+    uint32_t cpuCount = 0;          ///< Entries in cpuPercentPerCore
+    float cpuPercentPerCore[kMaxCpus] = {};  ///< Busy time per core
+
+    uint64_t memoryTotal = 0;       ///< Physical memory in bytes
+    uint64_t memoryAvailable = 0;   ///< Memory available without swapping
+    uint64_t swapTotal = 0;         ///< Swap space in bytes
+    uint64_t swapFree = 0;          ///< Unused swap space in bytes
+
+    uint32_t diskCount = 0;         ///< Entries in disks
+    Disk disks[kMaxDisks] = {};     ///< Whole disks, partitions excluded
+
+    uint32_t interfaceCount = 0;    ///< Entries in interfaces
+    Interface interfaces[kMaxInterfaces] = {};  ///< Interfaces, loopback excluded
+};
+
+/**
+ * @brief Background sampler of /proc resource counters
+ *
+ * A sampler thread keeps /proc/stat, /proc/meminfo, /proc/diskstats and
+ * /proc/net/dev open, re-reads them with pread() into a fixed buffer,
+ * parses them without allocating and turns consecutive counter values into
+ * rates. Each result is published through a SeqLock, so any thread can
+ * read the latest sample without locking or waiting for the sampler.
+ *
+ * Widgets subscribe with the interval they need; the sampler runs at the
+ * shortest subscribed interval and stops when the last subscriber leaves.
+ * Only Linux provides /proc; elsewhere Subscribe() returns false.
+ */
+class SystemSampler {
+public:
+    /**
+     * @brief Raw counters of one pass over /proc
+     */
+    struct Counters {
+        /**
+         * @brief Jiffies of a CPU line
+         */
+        struct Cpu {
+            uint64_t busy = 0;   ///< All time except idle and iowait
+            uint64_t total = 0;  ///< All time
+        };
+
+        /**
+         * @brief Cumulative disk counters
+         */
+        struct Disk {
+            char name[SystemSample::kNameLength] = {};
+            uint64_t sectorsRead = 0;
+            uint64_t sectorsWritten = 0;
+            uint64_t ioTicksMs = 0;
+        };
+
+        /**
+         * @brief Cumulative interface counters
+         */
+        struct Interface {
+            char name[SystemSample::kNameLength] = {};
+            uint64_t rxBytes = 0;
+            uint64_t txBytes = 0;
+        };
+
+        Cpu cpu;                                      ///< Aggregate "cpu" line
+        size_t cpuCount = 0;                          ///< Entries in cpus
+        Cpu cpus[SystemSample::kMaxCpus];             ///< "cpuN" lines
+        uint64_t memoryTotal = 0;                     ///< Bytes
+        uint64_t memoryAvailable = 0;                 ///< Bytes
+        uint64_t swapTotal = 0;                       ///< Bytes
+        uint64_t swapFree = 0;                        ///< Bytes
+        size_t diskCount = 0;                         ///< Entries in disks
+        Disk disks[SystemSample::kMaxDisks];          ///< Whole disks
+        size_t interfaceCount = 0;                    ///< Entries in interfaces
+        Interface interfaces[SystemSample::kMaxInterfaces];  ///< Non-loopback interfaces
+    };
+
+    /**
+     * @brief Constructor; does not start sampling
+     */
+    SystemSampler();
+
+    /**
+     * @brief Destructor; stops the sampler thread
+     */
+    ~SystemSampler();
+
+    /**
+     * @brief Start or speed up sampling for a subscriber
+     * @param intervalMs Interval the subscriber needs
+     * @return False if /proc is not available
+     */
+    bool Subscribe(int intervalMs);
+
+    /**
+     * @brief Remove a subscription made with Subscribe()
+     * @param intervalMs Interval given to Subscribe()
+     */
+    void Unsubscribe(int intervalMs);
+
+    /**
+     * @brief Copy the latest sample; lock-free, safe from any thread
+     * @param sample Receives the sample
+     * @return False if no sample has been computed yet
+     */
+    bool GetSample(SystemSample& sample) const;
+
+    /**
+     * @brief Parse /proc/stat content
+     * @param data File content (may be truncated after the CPU lines)
+     * @param size Content size in bytes
+     * @param counters Receives the CPU counters
+     */
+    static void ParseStat(const char* data, size_t size, Counters& counters);
+
+    /**
+     * @brief Parse /proc/meminfo content
+     * @param data File content
+     * @param size Content size in bytes
+     * @param counters Receives the memory counters
+     */
+    static void ParseMeminfo(const char* data, size_t size, Counters& counters);
+
+    /**
+     * @brief Parse /proc/diskstats content, skipping partitions and virtual devices
+     * @param data File content
+     * @param size Content size in bytes
+     * @param counters Receives the disk counters
+     */
+    static void ParseDiskstats(const char* data, size_t size, Counters& counters);
+
+    /**
+     * @brief Parse /proc/net/dev content, skipping the loopback interface
+     * @param data File content
+     * @param size Content size in bytes
+     * @param counters Receives the interface counters
+     */
+    static void ParseNetDev(const char* data, size_t size, Counters& counters);
+
+    /**
+     * @brief Turn two passes into a sample
+     * @param previous Earlier counters
+     * @param current Later counters
+     * @param seconds Time between the passes
+     * @param sample Receives the rates; its sequence number is left alone
+     */
+    static void ComputeSample(const Counters& previous, const Counters& current, double seconds,
+                              SystemSample& sample);
+
+private:
+    /**
+     * @brief /proc files kept open by the sampler thread
+     */
+    enum ProcFile { Stat, Meminfo, Diskstats, NetDev, ProcFileCount };
+
+    int m_fds[ProcFileCount];                 ///< Open descriptors, -1 if unavailable
+    SeqLock<SystemSample> m_sample;           ///< Published sample
+
+    std::multiset<int> m_subscriptions;       ///< Subscribed intervals (UI thread)
+
+    // Sampler thread state
+    std::thread m_thread;                     ///< Sampler thread
+    std::mutex m_mutex;                       ///< Guards the fields below
+    std::condition_variable m_condition;      ///< Wakes the thread on changes
+    int m_intervalMs = 1000;                  ///< Shortest subscribed interval
+    bool m_intervalChanged = false;           ///< Interval changed during the wait
+    bool m_stopping = false;                  ///< Thread should exit
+
+    // Open the /proc files; false if /proc/stat is missing
+    bool OpenFiles();
+    void CloseFiles();
+
+    // Read all files into counters using the scratch buffer
+    void ReadCounters(Counters& counters, char* buffer, size_t size) const;
+
+    // Stop and join the thread
+    void Stop();
+
+    // Sampler thread function
+    void SamplerLoop();
+
+    SystemSampler(const SystemSampler&) = delete;
+    SystemSampler& operator=(const SystemSampler&) = delete;
+};
+
+} // namespace ITD
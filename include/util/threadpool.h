@@ -0,0 +1,63 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ITD {
+
+/**
+ * @brief Fixed-size pool of worker threads running queued tasks
+ *
+ * Threads are started on the first submitted task, so an unused pool costs
+ * nothing. Tasks run in submission order but may finish in any order.
+ */
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    /**
+     * @brief Constructor
+     * @param threadCount Number of threads (0 = based on the hardware)
+     */
+    explicit ThreadPool(size_t threadCount = 0);
+
+    /**
+     * @brief Destructor
+     *
+     * Discards queued tasks and waits for running ones.
+     */
+    ~ThreadPool();
+
+    /**
+     * @brief Queue a task
+     * @param task Task to run on a worker thread
+     */
+    void Submit(Task task);
+
+    /**
+     * @brief Get the number of threads
+     * @return Thread count
+     */
+    size_t GetThreadCount() const { return m_threadCount; }
+
+private:
+    size_t m_threadCount;                  ///< Number of threads to start
+    std::vector<std::thread> m_threads;    ///< Worker threads
+
+    std::mutex m_mutex;                    ///< Guards the fields below
+    std::condition_variable m_condition;   ///< Signals queued tasks
+    std::deque<Task> m_tasks;              ///< Tasks waiting for a thread
+    bool m_stopping = false;               ///< Threads should exit
+
+    // Worker thread function
+    void WorkerLoop();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+};
+
+} // namespace ITD
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ITD {
+
+/**
+ * @brief Metric history at several resolutions in fixed-size ring buffers
+ *
+ * Every sample is added to each level, which keeps one bucket (minimum,
+ * maximum and count) per resolution step in a ring of fixed capacity. The
+ * default levels keep 10 minutes at 1 s, 2 hours at 10 s and 24 hours at
+ * 1 minute, about 32 KiB per series however long it runs.
+ *
+ * Downsample() reduces a time range to one minimum/maximum pair per pixel
+ * column. It reads the finest level with at most kMaxBucketsPerColumn
+ * buckets per column, so peaks survive and the work is proportional to the
+ * width rather than to the length of the range.
+ */
+class TimeSeries {
+public:
+    /**
+     * @brief Resolution and length of a level
+     */
+    struct Level {
+        int64_t resolutionMs;  ///< Time per bucket
+        size_t capacity;       ///< Buckets kept
+    };
+
+    /**
+     * @brief Values falling into one pixel column
+     */
+    struct Column {
+        float min = 0.0f;    ///< Smallest value
+        float max = 0.0f;    ///< Largest value
+        bool valid = false;  ///< The column has samples
+    };
+
+    /**
+     * @brief Constructor with the default levels (1 s, 10 s, 1 min)
+     */
+    TimeSeries();
+
+    /**
+     * @brief Constructor
+     * @param levels Levels from the finest to the coarsest resolution
+     */
+    explicit TimeSeries(std::initializer_list<Level> levels);
+
+    /**
+     * @brief Add a sample
+     * @param timeMs Time of the sample; must increase from sample to sample
+     * @param value Sample value
+     * @return False if the sample is not newer than the previous one
+     */
+    bool Add(int64_t timeMs, double value);
+
+    /**
+     * @brief Reduce a time range to pixel columns
+     *
+     * Column i covers [fromMs + i * span / width, fromMs + (i + 1) * span / width).
+     *
+     * @param fromMs Start of the range
+     * @param toMs End of the range
+     * @param width Number of columns
+     * @param columns Receives the columns; reused without reallocating
+     */
+    void Downsample(int64_t fromMs, int64_t toMs, size_t width, std::vector<Column>& columns) const;
+
+    /**
+     * @brief Check if any sample was added
+     * @return True after the first sample
+     */
+    bool IsEmpty() const { return m_count == 0; }
+
+    /**
+     * @brief Get the time of the latest sample
+     * @return Time in milliseconds
+     */
+    int64_t GetLastTime() const { return m_lastTime; }
+
+    /**
+     * @brief Get the latest sample
+     * @return Sample value
+     */
+    double GetLastValue() const { return m_lastValue; }
+
+    /**
+     * @brief Get the memory held by the buckets
+     * @return Size in bytes; constant after construction
+     */
+    size_t GetMemoryUsage() const;
+
+    static constexpr size_t kMaxBucketsPerColumn = 4;  ///< Finer levels are skipped above this
+
+private:
+    /**
+     * @brief Aggregate of one resolution step
+     */
+    struct Bucket {
+        float min;
+        float max;
+        uint32_t count;  ///< 0 if empty
+    };
+
+    /**
+     * @brief Ring of buckets at one resolution
+     */
+    struct Ring {
+        Level level;
+        std::unique_ptr<Bucket[]> buckets;
+        int64_t head = -1;  ///< Step number of the newest bucket, -1 if empty
+
+        int64_t GetOldest() const { return head - static_cast<int64_t>(level.capacity) + 1; }
+        Bucket& At(int64_t step) { return buckets[static_cast<size_t>(step % static_cast<int64_t>(level.capacity))]; }
+        const Bucket& At(int64_t step) const { return buckets[static_cast<size_t>(step % static_cast<int64_t>(level.capacity))]; }
+    };
+
+    std::vector<Ring> m_rings;  ///< Levels, finest first
+    uint64_t m_count = 0;       ///< Samples added
+    int64_t m_lastTime = 0;     ///< Time of the latest sample
+    double m_lastValue = 0.0;   ///< Latest sample
+};
+
+/**
+ * @brief Named time series shared by widgets
+ *
+ * Series are created on first use and live as long as the store; it is used
+ * from the UI thread only.
+ */
+class TimeSeriesStore {
+public:
+    /**
+     * @brief Get a series, creating it with the default levels
+     * @param name Metric name ("cpu", "memory")
+     * @return The series
+     */
+    TimeSeries& Get(const std::string& name);
+
+    /**
+     * @brief Find a series
+     * @param name Metric name
+     * @return The series, or nullptr if it was never used
+     */
+    const TimeSeries* Find(const std::string& name) const;
+
+private:
+    std::map<std::string, std::unique_ptr<TimeSeries>> m_series;  ///< Series by name
+};
+
+} // namespace ITD
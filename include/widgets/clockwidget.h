@@ -0,0 +1,38 @@
+#pragma once
+
+#include "widgets/widgetmanager.h"
+
+namespace ITD {
+
+/**
+ * @brief Widget showing the local time and date
+ */
+class ClockWidget : public Widget {
+public:
+    /**
+     * @brief Constructor
+     * @param parent Parent window
+     */
+    explicit ClockWidget(wxWindow* parent);
+
+    wxString GetWidgetType() const override { return "clock"; }
+    void SaveConfig(wxConfigBase* config) const override;
+    void LoadConfig(wxConfigBase* config) override;
+    void RefreshContent() override;
+
+    /**
+     * @brief Refresh every second, or every minute without seconds
+     * @return Interval in milliseconds
+     */
+    int GetRefreshInterval() const override { return m_showSeconds ? 1000 : 60000; }
+
+private:
+    bool m_showSeconds = true;  ///< Show seconds
+    wxString m_timeText;        ///< Formatted time
+    wxString m_dateText;        ///< Formatted date
+    wxRect m_timeRect;          ///< Band holding the time, set when painted
+
+    void PaintContent(wxDC& dc, const wxRect& dirty) override;
+};
+
+} // namespace ITD
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <wx/wx.h>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <utility>
+
+namespace ITD {
+
+/**
+ * @brief Offscreen bitmaps holding the rarely changing layers of widgets
+ *
+ * A widget draws a layer (its background, a graph) once into a bitmap and
+ * blits it on later repaints, redrawing only what changed on top. Layers are
+ * keyed by window and layer number. Memory is bounded: when the cache grows
+ * beyond its budget, the least recently used layers are dropped and redrawn
+ * the next time they are needed.
+ */
+class LayerCache {
+public:
+    /**
+     * @brief Cache statistics
+     */
+    struct Stats {
+        uint64_t hits = 0;       ///< Layers reused
+        uint64_t misses = 0;     ///< Layers that had to be drawn
+        uint64_t evictions = 0;  ///< Layers dropped for the budget
+    };
+
+    /**
+     * @brief Constructor
+     * @param budgetBytes Memory the bitmaps may use
+     */
+    explicit LayerCache(size_t budgetBytes = kDefaultBudget);
+
+    /**
+     * @brief Get the bitmap of a layer
+     *
+     * A layer whose size changed or that was invalidated comes back with
+     * valid set to false; the caller draws it and the next call reports it
+     * valid.
+     *
+     * @param owner Window the layer belongs to
+     * @param layer Layer number
+     * @param size Bitmap size
+     * @param valid Set to true if the bitmap holds the last drawn content
+     * @return The bitmap; stays valid until the next call on the cache
+     */
+    wxBitmap& Get(const wxWindow* owner, int layer, const wxSize& size, bool& valid);
+
+    /**
+     * @brief Mark a layer for redrawing
+     * @param owner Window the layer belongs to
+     * @param layer Layer number
+     */
+    void Invalidate(const wxWindow* owner, int layer);
+
+    /**
+     * @brief Mark all layers of a window for redrawing
+     * @param owner Window the layers belong to
+     */
+    void InvalidateAll(const wxWindow* owner);
+
+    /**
+     * @brief Drop all layers of a window
+     * @param owner Window being destroyed
+     */
+    void Remove(const wxWindow* owner);
+
+    /**
+     * @brief Get the memory used by the bitmaps
+     * @return Estimated size in bytes
+     */
+    size_t GetMemoryUsage() const { return m_usage; }
+
+    /**
+     * @brief Get the cache statistics
+     * @return Statistics since construction
+     */
+    const Stats& GetStats() const { return m_stats; }
+
+    static constexpr size_t kDefaultBudget = 64 * 1024 * 1024;  ///< 64 MiB
+
+private:
+    /**
+     * @brief Cached layer
+     */
+    struct Entry {
+        wxBitmap bitmap;
+        size_t bytes = 0;       ///< Estimated bitmap size
+        bool valid = false;     ///< Holds the last drawn content
+        uint64_t lastUse = 0;   ///< Value of m_clock at the last Get()
+    };
+
+    using Key = std::pair<const wxWindow*, int>;
+
+    std::map<Key, Entry> m_layers;  ///< Layers by owner and number
+    size_t m_budget;                ///< Memory limit
+    size_t m_usage = 0;             ///< Memory in use
+    uint64_t m_clock = 0;           ///< Use counter for LRU eviction
+    Stats m_stats;                  ///< Statistics
+
+    // Drop least recently used layers other than keep until within budget
+    void Evict(const Entry* keep);
+};
+
+} // namespace ITD
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "widgets/widgetmanager.h"
+#include "util/processtable.h"
+#include <memory>
+
+namespace ITD {
+
+/**
+ * @brief Widget listing the busiest processes, like top
+ *
+ * Rows come from a ProcessTable running in the background; only as many
+ * rows as fit are requested. Clicking a column header sorts by CPU, memory
+ * or I/O.
+ */
+class ProcessMonitorWidget : public Widget {
+public:
+    /**
+     * @brief Constructor
+     * @param parent Parent window
+     */
+    explicit ProcessMonitorWidget(wxWindow* parent);
+
+    /**
+     * @brief Destructor
+     */
+    virtual ~ProcessMonitorWidget();
+
+    wxString GetWidgetType() const override { return "processes"; }
+    void SaveConfig(wxConfigBase* config) const override;
+    void LoadConfig(wxConfigBase* config) override;
+    void RefreshContent() override;
+
+    /**
+     * @brief Refresh at the configured interval
+     * @return Interval in milliseconds
+     */
+    int GetRefreshInterval() const override { return m_intervalMs; }
+
+private:
+    int m_intervalMs = 2000;                    ///< Time between passes
+    bool m_running = false;                     ///< The table is sampling
+    std::unique_ptr<ProcessTable> m_table;      ///< Background process table
+    std::unique_ptr<ProcessSnapshot> m_snapshot;  ///< Rows shown
+
+    // Request as many rows as fit in the window
+    void UpdateRowCount();
+
+    // Header drawn into the background layer, rows drawn over it
+    void PaintBackground(wxDC& dc, const wxSize& size) override;
+    void PaintContent(wxDC& dc, const wxRect& dirty) override;
+
+    // Event handlers
+    void OnSize(wxSizeEvent& event);
+    void OnLeftDown(wxMouseEvent& event);
+};
+
+} // namespace ITD
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "widgets/widgetmanager.h"
+#include "util/timeseries.h"
+#include <vector>
+
+namespace ITD {
+
+/**
+ * @brief Widget showing system resource usage
+ *
+ * Below the current values, graphs show the CPU and memory history kept in
+ * the application's TimeSeriesStore over the configured history length.
+ * Each graph is a cached layer used as a ring of pixel columns: a new
+ * sample draws only the columns it adds, and painting copies the ring in
+ * two parts.
+ */
+class SysMonWidget : public Widget {
+public:
+    /**
+     * @brief Constructor
+     * @param parent Parent window
+     */
+    explicit SysMonWidget(wxWindow* parent);
+
+    /**
+     * @brief Destructor
+     */
+    virtual ~SysMonWidget();
+
+    wxString GetWidgetType() const override { return "sysmon"; }
+    void SaveConfig(wxConfigBase* config) const override;
+    void LoadConfig(wxConfigBase* config) override;
+    void RefreshContent() override;
+
+    /**
+     * @brief Refresh at the configured interval
+     * @return Interval in milliseconds
+     */
+    int GetRefreshInterval() const override { return m_intervalMs; }
+
+private:
+    int m_intervalMs = 2000;     ///< Sampling interval
+    int m_historySec = 300;      ///< Time shown by the graphs
+    bool m_subscribed = false;   ///< Subscribed to the SystemSampler
+    uint64_t m_lastSequence = 0; ///< Sample shown last
+    wxString m_text;             ///< Formatted usage
+    std::vector<TimeSeries::Column> m_columns;  ///< Graph scratch, one entry per pixel
+
+    /**
+     * @brief Content of a graph layer
+     */
+    struct GraphState {
+        int64_t lastColumn = -1;  ///< Newest column drawn, in units of msPerColumn
+        int64_t msPerColumn = 0;  ///< Time per pixel column when drawn
+    };
+
+    static constexpr int kGraphCount = 2;  ///< CPU and memory
+    GraphState m_graphs[kGraphCount];      ///< Graph layers
+
+    // Text area and graph plots for a client size; plots are empty if they do not fit
+    void GetLayout(const wxSize& size, wxRect& text, wxRect (&plots)[kGraphCount]) const;
+
+    // Bring a graph layer up to date and copy it into the plot
+    void PaintGraph(wxDC& dc, int index, const TimeSeries& series, const wxRect& plot);
+
+    void PaintBackground(wxDC& dc, const wxSize& size) override;
+    void PaintContent(wxDC& dc, const wxRect& dirty) override;
+};
+
+} // namespace ITD
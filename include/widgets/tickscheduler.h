@@ -0,0 +1,160 @@
+#pragma once
+
+#include <wx/wx.h>
+#include <wx/timer.h>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "util/latencyhistogram.h"
+
+namespace ITD {
+
+/**
+ * @brief Shared timer for periodic widget updates
+ *
+ * Replaces a wxTimer per widget with a single one-shot timer:
+ *
+ *  - Tasks fall due on multiples of their interval on the wall clock, so
+ *    tasks with related intervals (a 1 s clock and a 2 s monitor) share
+ *    ticks, and a minute clock updates right at the minute.
+ *  - A task may run up to a twentieth of its interval late to join a tick
+ *    that is already scheduled.
+ *  - A task bound to a window is suspended while the window is hidden,
+ *    minimized or outside its frame. It resumes at once when the window is
+ *    shown or Wake() is called; otherwise its visibility is checked at most
+ *    once a second, which also catches a parent being shown again.
+ *  - The timer is stopped whenever there are no tasks.
+ *
+ * Every run is timed; GetTaskStats() reports the cost of each task. UI
+ * thread only.
+ */
+class TickScheduler : public wxEvtHandler {
+public:
+    using TaskId = int;
+    using Callback = std::function<void()>;
+
+    /**
+     * @brief Cost accounting of a task
+     */
+    struct TaskStats {
+        wxString name;             ///< Name given to Add()
+        int intervalMs = 0;        ///< Interval between runs
+        bool suspended = false;    ///< Waiting for its window to become visible
+        uint64_t runs = 0;         ///< Completed runs
+        uint64_t suspensions = 0;  ///< Ticks skipped because the window was not visible
+        LatencyHistogram cost;     ///< Run durations
+    };
+
+    /**
+     * @brief Constructor
+     */
+    TickScheduler();
+
+    /**
+     * @brief Destructor
+     */
+    virtual ~TickScheduler();
+
+    /**
+     * @brief Add a periodic task
+     *
+     * The first run is on the next aligned tick.
+     *
+     * @param name Name for diagnostics
+     * @param intervalMs Interval between runs in milliseconds
+     * @param callback Function to run
+     * @param window Window whose visibility gates the task (optional); the
+     *        task is removed when the window is destroyed
+     * @return Task ID for Remove()
+     */
+    TaskId Add(const wxString& name, int intervalMs, Callback callback, wxWindow* window = nullptr);
+
+    /**
+     * @brief Remove a task
+     * @param id Task ID returned by Add()
+     * @return True if the task existed
+     */
+    bool Remove(TaskId id);
+
+    /**
+     * @brief Change the interval of a task
+     * @param id Task ID
+     * @param intervalMs New interval in milliseconds
+     * @return True if the task exists
+     */
+    bool SetInterval(TaskId id, int intervalMs);
+
+    /**
+     * @brief Resume suspended tasks whose window may have become visible
+     *
+     * Resumed tasks run on the next event loop iteration so that their
+     * windows are up to date. Call when the frame is restored or resized.
+     */
+    void Wake();
+
+    /**
+     * @brief Get the cost accounting of a task
+     * @param id Task ID
+     * @return Statistics, or nullptr if the task does not exist
+     */
+    const TaskStats* GetTaskStats(TaskId id) const;
+
+    /**
+     * @brief Visit the cost accounting of all tasks
+     * @param callback Called with the ID and statistics of each task
+     */
+    void ForEachTask(const std::function<void(TaskId id, const TaskStats& stats)>& callback) const;
+
+    /**
+     * @brief Get the number of timer wakeups
+     * @return Wakeup count since construction
+     */
+    uint64_t GetWakeupCount() const { return m_wakeups; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Scheduled task
+     */
+    struct Task {
+        TaskId id;                ///< Task ID
+        Callback callback;        ///< Function to run
+        wxWindow* window;         ///< Visibility gate (optional)
+        Clock::time_point due;    ///< Next run
+        TaskStats stats;          ///< Cost accounting
+    };
+
+    std::vector<Task> m_tasks;           ///< Tasks in insertion order
+    std::vector<TaskId> m_dueTasks;      ///< Scratch list for the current tick
+    TaskId m_nextId = 1;                 ///< Next task ID
+    wxTimer m_timer;                     ///< One-shot timer for the next tick
+    uint64_t m_wakeups = 0;              ///< Timer wakeups
+    bool m_ticking = false;              ///< Running the tasks of a tick
+
+    // Find a task by ID
+    Task* Find(TaskId id);
+
+    // Next multiple of the interval on the wall clock
+    static Clock::time_point NextAlignedTime(Clock::time_point now, int intervalMs);
+
+    // How late a task may run to share a tick
+    static Clock::duration GetSlack(int intervalMs);
+
+    // Check if a window can be seen
+    static bool IsVisible(wxWindow* window);
+
+    // Remove a task, unbinding its window unless it is being destroyed
+    void RemoveAt(size_t index, bool unbind);
+
+    // Start the timer for the next tick, or stop it if nothing is due
+    void Reschedule();
+
+    // Event handlers
+    void OnTimer(wxTimerEvent& event);
+    void OnWindowShow(wxShowEvent& event);
+    void OnWindowDestroy(wxWindowDestroyEvent& event);
+};
+
+} // namespace ITD
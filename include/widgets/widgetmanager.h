@@ -2,10 +2,13 @@
 
 #include <wx/wx.h>
 #include <wx/aui/aui.h>
+#include <functional>
 #include <vector>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include "widgets/layercache.h"
+#include "widgets/widgetpluginregistry.h"
 
 namespace ITD {
 
@@ -17,6 +20,12 @@ class Widget;
  * 
  * This class defines the interface for all widgets that can be managed
  * by the WidgetManager.
+ *
+ * Painting is split into layers. PaintBackground() draws the static part
+ * once into a bitmap from the manager's LayerCache; each repaint blits the
+ * dirty area from it and calls PaintContent() clipped to that area. Widgets
+ * refresh only the rectangles that changed, and may keep further layers
+ * with GetLayer().
  */
 class Widget : public wxPanel {
 public:
@@ -75,15 +84,89 @@ public:
      */
     virtual void RefreshContent() = 0;
 
+    /**
+     * @brief Get the interval of periodic refreshes
+     *
+     * The widget manager calls RefreshContent() at this interval through the
+     * shared TickScheduler while the widget is visible.
+     *
+     * @return Interval in milliseconds, or 0 if the widget only changes on events
+     */
+    virtual int GetRefreshInterval() const { return 0; }
+
     /**
      * @brief Set transparency level
      * @param alpha Alpha value (0-255, where 0 is fully transparent and 255 is opaque)
      */
-    virtual void SetTransparency(unsigned char alpha) { m_transparency = alpha; }
+    virtual void SetTransparency(unsigned char alpha);
+
+    /**
+     * @brief Set the cache holding the layers
+     * @param cache Layer cache, or nullptr to paint without caching
+     */
+    void SetLayerCache(LayerCache* cache);
+
+    static constexpr int kBackgroundLayer = 0;  ///< Layer drawn by PaintBackground()
 
 protected:
+    /**
+     * @brief Paint the static layer
+     *
+     * The default fills the background, blended with the parent's colour for
+     * the transparency, and draws a frame. Overrides add parts that only
+     * change with the size or settings, and call InvalidateLayer() with
+     * kBackgroundLayer when those change.
+     *
+     * @param dc Device context of the cached bitmap
+     * @param size Client size
+     */
+    virtual void PaintBackground(wxDC& dc, const wxSize& size);
+
+    /**
+     * @brief Paint the dynamic content over the background
+     * @param dc Device context, clipped to the dirty area
+     * @param dirty Area being repainted
+     */
+    virtual void PaintContent(wxDC& dc, const wxRect& dirty) = 0;
+
+    /**
+     * @brief Get a cached layer for the widget's own use
+     * @param layer Layer number above kBackgroundLayer
+     * @param size Bitmap size
+     * @param valid Set to false if the bitmap must be drawn
+     * @return The bitmap, or nullptr without a cache
+     */
+    wxBitmap* GetLayer(int layer, const wxSize& size, bool& valid);
+
+    /**
+     * @brief Redraw a cached layer on the next repaint
+     * @param layer Layer number
+     */
+    void InvalidateLayer(int layer);
+
+    /**
+     * @brief Redraw all cached layers on the next repaint
+     *
+     * For changes every layer depends on, like the background colour.
+     */
+    void InvalidateLayers();
+
+    /**
+     * @brief Get the background colour blended for the transparency
+     * @return Flat background colour
+     */
+    wxColour GetBlendedBackgroundColour() const;
+
     wxString m_title;                  ///< Widget title
     unsigned char m_transparency = 255; ///< Transparency level
+
+private:
+    LayerCache* m_layerCache = nullptr;  ///< Layer bitmaps, owned by the manager
+
+    // Event handlers
+    void OnPaint(wxPaintEvent& event);
+    void OnSize(wxSizeEvent& event);
+    void OnColourChanged(wxSysColourChangedEvent& event);
 };
 
 /**
@@ -129,9 +212,12 @@ public:
 
     /**
      * @brief Get available widget types
+     *
+     * Includes the plugins; the plugin directories are scanned on first use.
+     *
      * @return Vector of widget type identifiers
      */
-    std::vector<wxString> GetAvailableWidgetTypes() const;
+    std::vector<wxString> GetAvailableWidgetTypes();
 
     /**
      * @brief Load all widgets from configuration
@@ -154,6 +240,12 @@ public:
      */
     void SetTransparency(unsigned char alpha);
 
+    /**
+     * @brief Get the cache of widget layers
+     * @return Layer cache
+     */
+    const LayerCache& GetLayerCache() const { return m_layerCache; }
+
 private:
     wxWindow* m_parent;                ///< Parent window
     wxAuiManager* m_auiManager;        ///< AUI manager for docking
@@ -163,8 +255,24 @@ private:
     using WidgetCreatorFunction = std::function<Widget*(wxWindow*)>;
     std::unordered_map<wxString, WidgetCreatorFunction> m_widgetFactories;
 
+    std::unordered_map<Widget*, int> m_tickTasks;  ///< Refresh tasks by widget
+    unsigned char m_transparency = 255;             ///< Transparency level
+    LayerCache m_layerCache;                        ///< Cached widget layers
+    WidgetPluginRegistry m_plugins;                 ///< Widget types from shared libraries
+    bool m_pluginsScanned = false;                  ///< Plugin directories were scanned
+    int m_nextPaneId = 1;                           ///< Suffix of the next AUI pane name
+
     // Initialize widget factories
     void InitializeWidgetFactories();
+
+    // Read the plugin manifests and add factories that load plugins on demand
+    void ScanPlugins();
+
+    // Create and dock a widget without updating the AUI layout
+    Widget* AddWidget(const wxString& type, const wxString& title);
+
+    // Undock and destroy a widget without updating the AUI layout
+    void DetachWidget(Widget* widget);
 };
 
 } // namespace ITD 
\ No newline at end of file
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <wx/wx.h>
+
+/**
+ * @file widgetplugin.h
+ * @brief ABI between ITD and widget plugins
+ *
+ * A widget plugin is a shared library plus a manifest file next to it,
+ * installed in a widget plugin directory (the "widgets" directory beside
+ * the configuration file, or the system plugin directory). The manifest is
+ * read without loading the library:
+ *
+ * @code
+ * [widget]
+ * type = weather
+ * title = Weather
+ * description = Current conditions and forecast
+ * library = libweather.so
+ * abi = 1
+ * @endcode
+ *
+ * The library is loaded the first time a widget of its type is created. It
+ * exports the entry point declared by ITD_WIDGET_PLUGIN, which names the
+ * type and creates instances:
+ *
+ * @code
+ * class WeatherWidget : public ITD::Widget { ... };
+ * ITD_WIDGET_PLUGIN("weather", WeatherWidget)
+ * @endcode
+ *
+ * Plugins link against the same wxWidgets build as ITD, and against the ITD
+ * executable itself, which exports its symbols, and must be built for the
+ * ABI version in their manifest:
+ *
+ * @code
+ * add_library(weather MODULE weather.cpp)
+ * target_link_libraries(weather PRIVATE ITD ${wxWidgets_LIBRARIES})
+ * @endcode
+ */
+
+namespace ITD {
+class Widget;
+}
+
+#define ITD_WIDGET_PLUGIN_ABI 1  ///< Version of ITDWidgetPlugin
+#define ITD_WIDGET_PLUGIN_ENTRY "ITD_GetWidgetPlugin"  ///< Exported entry point
+
+extern "C" {
+
+/**
+ * @brief Description returned by the entry point of a plugin
+ */
+struct ITDWidgetPlugin {
+    int abi;                                     ///< ITD_WIDGET_PLUGIN_ABI at build time
+    const char* type;                            ///< Widget type, as in the manifest
+    ITD::Widget* (*create)(wxWindow* parent);    ///< Create a widget
+};
+
+/**
+ * @brief Signature of the entry point
+ */
+typedef const ITDWidgetPlugin* (*ITDWidgetPluginEntry)();
+
+}
+
+/**
+ * @brief Define the entry point of a plugin providing one widget class
+ * @param typeName Widget type
+ * @param WidgetClass Class derived from ITD::Widget with a (wxWindow*) constructor
+ */
+#define ITD_WIDGET_PLUGIN(typeName, WidgetClass)                                     \
+    extern "C" WXEXPORT const ITDWidgetPlugin* ITD_GetWidgetPlugin() {               \
+        static const ITDWidgetPlugin plugin = {                                      \
+            ITD_WIDGET_PLUGIN_ABI, typeName,                                         \
+            [](wxWindow* parent) -> ITD::Widget* { return new WidgetClass(parent); } \
+        };                                                                           \
+        return &plugin;                                                              \
+    }
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <wx/wx.h>
+#include <map>
+#include <vector>
+#include "widgets/widgetplugin.h"
+
+namespace ITD {
+
+class Widget;
+
+/**
+ * @brief Widget plugins found in the plugin directories
+ *
+ * Scan() reads the manifests (*.widget) only; a plugin's library is loaded
+ * when the first widget of its type is created, so startup cost does not
+ * depend on the number of installed plugins. Loaded libraries stay loaded
+ * until the process exits, because their widgets may outlive the registry.
+ */
+class WidgetPluginRegistry {
+public:
+    /**
+     * @brief Plugin described by a manifest
+     */
+    struct PluginInfo {
+        wxString type;          ///< Widget type
+        wxString title;         ///< Default widget title
+        wxString description;   ///< Short description
+        wxString library;       ///< Full path of the shared library
+        wxString manifest;      ///< Full path of the manifest
+    };
+
+    /**
+     * @brief Read the manifests in a directory
+     *
+     * Manifests with another ABI version, without a type or library, or for
+     * a type found earlier are skipped with a warning.
+     *
+     * @param directory Plugin directory; ignored if it does not exist
+     * @return Number of plugins added
+     */
+    size_t Scan(const wxString& directory);
+
+    /**
+     * @brief Find a plugin
+     * @param type Widget type
+     * @return Plugin, or nullptr if no manifest declares the type
+     */
+    const PluginInfo* Find(const wxString& type) const;
+
+    /**
+     * @brief Get the types of all plugins
+     * @return Widget types
+     */
+    std::vector<wxString> GetTypes() const;
+
+    /**
+     * @brief Create a widget, loading its plugin on first use
+     * @param type Widget type
+     * @param parent Parent window
+     * @return The widget, or nullptr if the plugin is unknown or failed to load
+     */
+    Widget* Create(const wxString& type, wxWindow* parent);
+
+    /**
+     * @brief Check if a plugin's library is loaded
+     * @param type Widget type
+     * @return True after the first successful Create()
+     */
+    bool IsLoaded(const wxString& type) const;
+
+    static constexpr const char* kManifestExtension = "widget";  ///< Manifest file extension
+
+private:
+    /**
+     * @brief Registered plugin and its load state
+     */
+    struct Plugin {
+        PluginInfo info;
+        const ITDWidgetPlugin* entry = nullptr;  ///< Set once loaded
+        bool failed = false;                     ///< Loading failed; not retried
+    };
+
+    std::map<wxString, Plugin> m_plugins;  ///< Plugins by lower-case type
+
+    // Load a plugin's library and resolve its entry point
+    bool Load(Plugin& plugin);
+};
+
+} // namespace ITD
@@ -1,26 +1,39 @@
 #include "app.h"
 #include "mainframe.h"
+#include "util/startuptrace.h"
 #include <wx/wx.h>
 #include <wx/splash.h>
 #include <wx/image.h>
 #include <wx/stdpaths.h>
 #include <wx/filename.h>
+#include <algorithm>
 
 namespace ITD {
 
 bool App::OnInit() {
+    StartupScope scope("App::OnInit");
+
     // Initialize the wxWidgets framework
     if (!wxApp::OnInit())
         return false;
 
     // Initialize image handlers
-    wxInitAllImageHandlers();
+    {
+        StartupScope imageScope("wxInitAllImageHandlers");
+        wxInitAllImageHandlers();
+    }
 
     // Load configuration
-    if (!m_configManager.Load()) {
-        wxLogError("Failed to load configuration");
+    {
+        StartupScope configScope("ConfigManager::Load");
+        if (!m_configManager.Load()) {
+            wxLogError("Failed to load configuration");
+        }
     }
 
+    // Persist further changes in the background, coalescing bursts
+    m_configManager.EnableAutoSave(true);
+
     // Create the main application window
     m_mainFrame = new MainFrame(
         "Integrated Terminal Desktop",
@@ -32,12 +45,62 @@ bool App::OnInit() {
     m_mainFrame->Show(true);
     SetTopWindow(m_mainFrame);
 
+    // Idle events only arrive once the first frame has been painted
+    Bind(wxEVT_IDLE, &App::OnStartupIdle, this);
+
     return true;
 }
 
+void App::OnStartupIdle(wxIdleEvent& event) {
+    event.Skip();
+    Unbind(wxEVT_IDLE, &App::OnStartupIdle, this);
+
+    const double elapsed = StartupTrace::Mark("interactive");
+    if (elapsed > StartupTrace::kBudgetMs) {
+        wxLogDebug("Startup took %.1f ms, over the %.0f ms budget", elapsed, StartupTrace::kBudgetMs);
+    }
+
+    // Now build what the first frame did not need
+    LoadUserScripts();
+    m_mainFrame->CompleteStartup();
+    StartupTrace::Finish();
+
+    const wxString tracePath = StartupTrace::GetRequestedPath();
+    if (!tracePath.empty() && !StartupTrace::Write(tracePath)) {
+        wxLogWarning("Failed to write startup trace to '%s'", tracePath);
+    }
+}
+
+void App::OnEventLoopEnter(wxEventLoopBase* loop) {
+    wxApp::OnEventLoopEnter(loop);
+
+    // File watching needs a running main loop; pick up config edits live
+    if (loop->IsMain() && !m_configManager.StartWatching()) {
+        wxLogWarning("Configuration hot-reload is unavailable");
+    }
+}
+
+void App::LoadUserScripts() {
+    StartupScope scope("App::LoadUserScripts");
+
+    // Scripts get a bounded heap; 0 disables the limit
+    const int limitMB = m_configManager.GetInt("scripting", "memoryLimitMB", 256);
+    m_luaScript.SetMemoryLimit(static_cast<size_t>(std::max(limitMB, 0)) * 1024 * 1024);
+
+    const wxString configDir = wxFileName(m_configManager.GetConfigFilePath()).GetPath();
+    m_luaScript.AddLuaPath(wxFileName(configDir, "scripts").GetFullPath());
+
+    const wxString initScript = wxFileName(configDir, "init.lua").GetFullPath();
+    if (wxFileName::FileExists(initScript) && !m_luaScript.LoadFile(initScript)) {
+        wxLogWarning("Error in %s: %s", initScript, m_luaScript.GetLastError());
+    }
+}
+
 int App::OnExit() {
-    // Save configuration
+    // Stop reacting to file changes, then save configuration
+    m_configManager.StopWatching();
     m_configManager.Save();
+    m_configManager.EnableAutoSave(false);
 
     return wxApp::OnExit();
 }
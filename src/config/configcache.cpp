@@ -0,0 +1,268 @@
+#include "config/configcache.h"
+#include "config/configmanager.h"
+#include "util/atomicfile.h"
+#include "util/hash.h"
+#include <wx/wx.h>
+#include <wx/filename.h>
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+namespace ITD {
+
+namespace {
+
+constexpr char kCacheMagic[8] = { 'I', 'T', 'D', 'C', 'F', 'G', 'C', '\0' };
+constexpr uint32_t kCacheVersion = 1;
+constexpr uint32_t kByteOrder = 0x01020304;
+
+// Compare two byte strings the way std::string does
+int CompareBytes(const char* a, size_t aLength, const char* b, size_t bLength) {
+    const int result = std::memcmp(a, b, std::min(aLength, bLength));
+    if (result != 0)
+        return result;
+    return aLength < bLength ? -1 : (aLength > bLength ? 1 : 0);
+}
+
+bool GetModificationTime(const wxString& filename, int64_t& modified) {
+    const wxDateTime time = wxFileName(filename).GetModificationTime();
+    if (!time.IsValid())
+        return false;
+    modified = time.GetValue().GetValue();
+    return true;
+}
+
+} // namespace
+
+bool ConfigCache::Open(const wxString& configPath) {
+    Close();
+
+    if (!m_file.Open(GetCachePath(configPath)))
+        return false;
+
+    // Structural checks; everything else is bounds-checked on access
+    const size_t size = m_file.GetSize();
+    const char* data = m_file.GetData();
+    if (size < sizeof(Header)) {
+        m_file.Close();
+        return false;
+    }
+
+    const Header* header = reinterpret_cast<const Header*>(data);
+    if (std::memcmp(header->magic, kCacheMagic, sizeof(kCacheMagic)) != 0 ||
+        header->version != kCacheVersion || header->byteOrder != kByteOrder ||
+        header->entryCount > (size - sizeof(Header)) / sizeof(Entry) ||
+        header->stringsSize != size - sizeof(Header) - header->entryCount * sizeof(Entry)) {
+        m_file.Close();
+        return false;
+    }
+
+    m_header = header;
+    m_entries = reinterpret_cast<const Entry*>(data + sizeof(Header));
+    m_strings = data + sizeof(Header) + header->entryCount * sizeof(Entry);
+
+    if (!IsValid(configPath)) {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+void ConfigCache::Close() {
+    m_header = nullptr;
+    m_entries = nullptr;
+    m_strings = nullptr;
+    m_file.Close();
+}
+
+bool ConfigCache::IsValid(const wxString& configPath) const {
+    const wxFileName source(configPath);
+    if (!source.FileExists())
+        return false;
+
+    const uint64_t sourceSize = source.GetSize().GetValue();
+    int64_t sourceModified = 0;
+    if (sourceSize != m_header->sourceSize || !GetModificationTime(configPath, sourceModified))
+        return false;
+
+    // Fast path: untouched since the cache was built
+    if (sourceModified == m_header->sourceModified)
+        return true;
+
+    // Touched but possibly unchanged (e.g. restored from a backup): compare content
+    MappedFile content;
+    if (!content.Open(configPath))
+        return sourceSize == 0 && m_header->sourceHash == HashBytes(nullptr, 0);
+    return HashBytes(content.GetData(), content.GetSize()) == m_header->sourceHash;
+}
+
+bool ConfigCache::Find(const wxString& section, const wxString& key, wxString& value) const {
+    if (!IsOpen())
+        return false;
+
+    const wxScopedCharBuffer sectionUtf8 = section.utf8_str();
+    const wxScopedCharBuffer keyUtf8 = key.utf8_str();
+    const Entry* entry = LowerBound(sectionUtf8.data(), sectionUtf8.length(),
+                                    keyUtf8.data(), keyUtf8.length());
+    if (entry == m_entries + m_header->entryCount)
+        return false;
+
+    if (GetString(entry->section) != section || GetString(entry->key) != key)
+        return false;
+
+    value = GetString(entry->value);
+    return true;
+}
+
+std::vector<wxString> ConfigCache::GetSections() const {
+    std::vector<wxString> sections;
+    if (!IsOpen())
+        return sections;
+
+    // Entries are sorted by section and share one string per section
+    const StringRef* previous = nullptr;
+    for (uint64_t i = 0; i < m_header->entryCount; ++i) {
+        const StringRef& section = m_entries[i].section;
+        if (previous && previous->offset == section.offset && previous->length == section.length)
+            continue;
+        sections.push_back(GetString(section));
+        previous = &section;
+    }
+
+    return sections;
+}
+
+std::vector<wxString> ConfigCache::GetKeys(const wxString& section) const {
+    std::vector<wxString> keys;
+    if (!IsOpen())
+        return keys;
+
+    const wxScopedCharBuffer sectionUtf8 = section.utf8_str();
+    const Entry* end = m_entries + m_header->entryCount;
+    for (const Entry* entry = LowerBound(sectionUtf8.data(), sectionUtf8.length(), "", 0);
+         entry != end && GetString(entry->section) == section; ++entry) {
+        keys.push_back(GetString(entry->key));
+    }
+
+    return keys;
+}
+
+ConfigEntries ConfigCache::ReadEntries() const {
+    ConfigEntries entries;
+    if (!IsOpen())
+        return entries;
+
+    for (uint64_t i = 0; i < m_header->entryCount; ++i) {
+        const Entry& entry = m_entries[i];
+        entries[GetString(entry.section)][GetString(entry.key)] = GetString(entry.value);
+    }
+
+    return entries;
+}
+
+wxString ConfigCache::GetString(const StringRef& ref) const {
+    // A damaged cache yields empty strings rather than reading out of bounds
+    if (static_cast<uint64_t>(ref.offset) + ref.length > m_header->stringsSize)
+        return wxEmptyString;
+    return wxString::FromUTF8(m_strings + ref.offset, ref.length);
+}
+
+const ConfigCache::Entry* ConfigCache::LowerBound(const char* section, size_t sectionLength,
+                                                  const char* key, size_t keyLength) const {
+    auto inBounds = [this](const StringRef& ref) {
+        return static_cast<uint64_t>(ref.offset) + ref.length <= m_header->stringsSize;
+    };
+
+    return std::lower_bound(m_entries, m_entries + m_header->entryCount, 0,
+        [&](const Entry& entry, int) {
+            if (!inBounds(entry.section) || !inBounds(entry.key))
+                return false;
+            const int order = CompareBytes(m_strings + entry.section.offset, entry.section.length,
+                                           section, sectionLength);
+            if (order != 0)
+                return order < 0;
+            return CompareBytes(m_strings + entry.key.offset, entry.key.length, key, keyLength) < 0;
+        });
+}
+
+bool ConfigCache::Update(const wxString& configPath) {
+    // Take the time stamp first: if the file changes while we read it, the
+    // stamp no longer matches and the cache is simply rebuilt next time
+    Header header = {};
+    std::memcpy(header.magic, kCacheMagic, sizeof(kCacheMagic));
+    header.version = kCacheVersion;
+    header.byteOrder = kByteOrder;
+    if (!GetModificationTime(configPath, header.sourceModified))
+        return false;
+
+    ConfigEntries entries;
+    MappedFile source;
+    if (source.Open(configPath)) {
+        header.sourceSize = source.GetSize();
+        header.sourceHash = HashBytes(source.GetData(), source.GetSize());
+        if (!ConfigManager::ParseEntries(source.GetData(), source.GetSize(), entries))
+            return false;
+    } else if (wxFileName(configPath).GetSize().GetValue() == 0) {
+        header.sourceHash = HashBytes(nullptr, 0);
+    } else {
+        return false;
+    }
+
+    // Encode to UTF-8 and sort by bytes, which is the order lookups use
+    struct EncodedEntry {
+        std::string section;
+        std::string key;
+        std::string value;
+    };
+    std::vector<EncodedEntry> encoded;
+    for (const auto& [section, values] : entries) {
+        for (const auto& [key, value] : values) {
+            const wxScopedCharBuffer sectionUtf8 = section.utf8_str();
+            const wxScopedCharBuffer keyUtf8 = key.utf8_str();
+            const wxScopedCharBuffer valueUtf8 = value.utf8_str();
+            encoded.push_back({ std::string(sectionUtf8.data(), sectionUtf8.length()),
+                                std::string(keyUtf8.data(), keyUtf8.length()),
+                                std::string(valueUtf8.data(), valueUtf8.length()) });
+        }
+    }
+    std::sort(encoded.begin(), encoded.end(), [](const EncodedEntry& a, const EncodedEntry& b) {
+        return a.section != b.section ? a.section < b.section : a.key < b.key;
+    });
+
+    // Build the string table, sharing one copy of each section name
+    std::string strings;
+    std::vector<Entry> records;
+    records.reserve(encoded.size());
+    StringRef lastSection = {};
+    const std::string* lastSectionName = nullptr;
+    auto addString = [&strings](const std::string& text) {
+        StringRef ref = { static_cast<uint32_t>(strings.size()), static_cast<uint32_t>(text.size()) };
+        strings += text;
+        return ref;
+    };
+    for (const EncodedEntry& entry : encoded) {
+        if (!lastSectionName || *lastSectionName != entry.section) {
+            lastSection = addString(entry.section);
+            lastSectionName = &entry.section;
+        }
+        records.push_back({ lastSection, addString(entry.key), addString(entry.value) });
+    }
+
+    header.entryCount = records.size();
+    header.stringsSize = strings.size();
+
+    std::string data;
+    data.reserve(sizeof(Header) + records.size() * sizeof(Entry) + strings.size());
+    data.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    data.append(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(Entry));
+    data += strings;
+
+    return WriteFileAtomic(GetCachePath(configPath), data);
+}
+
+wxString ConfigCache::GetCachePath(const wxString& configPath) {
+    return configPath + ".cache";
+}
+
+} // namespace ITD
\ No newline at end of file
@@ -1 +1,820 @@
-// Placeholder 
+#include "config/configmanager.h"
+#include "util/atomicfile.h"
+#include "util/mappedfile.h"
+#include <wx/wx.h>
+#include <wx/stdpaths.h>
+#include <wx/wfstream.h>
+#include <wx/sstream.h>
+#include <wx/mstream.h>
+#include <algorithm>
+#include <set>
+
+namespace ITD {
+
+namespace {
+
+// Sections compiled into ConfigSnapshot; changes elsewhere do not republish
+const wxString kSnapshotSections[] = {
+    "terminal", "ui", "taskbar", "widgets", "explorer"
+};
+
+bool IsSnapshotSection(const wxString& section) {
+    for (const wxString& snapshotSection : kSnapshotSections) {
+        if (section == snapshotSection)
+            return true;
+    }
+    return false;
+}
+
+wxString MakeConfigPath(const wxString& section, const wxString& key) {
+    return "/" + section + "/" + key;
+}
+
+// Escape a key or section name the way wxFileConfig expects it
+wxString EscapeName(const wxString& name) {
+    wxString result;
+    for (wxChar c : name) {
+        if (c < 127 && !wxIsalnum(c) && !wxStrchr(wxS("@_/-!.*%()"), c))
+            result += '\\';
+        result += c;
+    }
+    return result;
+}
+
+// Escape a value the way wxFileConfig expects it
+wxString EscapeValue(const wxString& value) {
+    if (value.empty())
+        return value;
+
+    // Quote to preserve leading and trailing whitespace
+    const bool quote = wxIsspace(value[0]) || wxIsspace(value.Last()) || value[0] == '"';
+
+    wxString result;
+    if (quote)
+        result += '"';
+    for (wxChar c : value) {
+        switch (c) {
+            case '\n':
+                result += "\\n";
+                break;
+            case '\r':
+                result += "\\r";
+                break;
+            case '\t':
+                result += "\\t";
+                break;
+            case '\\':
+                result += "\\\\";
+                break;
+            case '"':
+                result += quote ? "\\\"" : "\"";
+                break;
+            default:
+                result += c;
+                break;
+        }
+    }
+    if (quote)
+        result += '"';
+
+    return result;
+}
+
+void AppendUTF8(std::string& out, const wxString& text) {
+    const wxScopedCharBuffer utf8 = text.utf8_str();
+    out.append(utf8.data(), utf8.length());
+}
+
+// Create an empty, in-memory configuration
+std::unique_ptr<wxFileConfig> CreateEmptyConfig() {
+    wxStringInputStream empty(wxEmptyString);
+    return std::make_unique<wxFileConfig>(empty);
+}
+
+} // namespace
+
+ConfigSnapshot::Edge ConfigSnapshot::ParseEdge(const wxString& name, Edge defaultVal) {
+    const wxString lower = name.Lower();
+    if (lower == "top")
+        return Edge::Top;
+    if (lower == "bottom")
+        return Edge::Bottom;
+    if (lower == "left")
+        return Edge::Left;
+    if (lower == "right")
+        return Edge::Right;
+    return defaultVal;
+}
+
+wxString ConfigSnapshot::EdgeName(Edge edge) {
+    switch (edge) {
+        case Edge::Top:
+            return "top";
+        case Edge::Left:
+            return "left";
+        case Edge::Right:
+            return "right";
+        case Edge::Bottom:
+        default:
+            return "bottom";
+    }
+}
+
+uint32_t ConfigSnapshot::Diff(const ConfigSnapshot& before, const ConfigSnapshot& after) {
+    uint32_t changes = ConfigChangeNone;
+
+    // Terminal
+    if (before.terminal.fontName != after.terminal.fontName ||
+        before.terminal.fontSize != after.terminal.fontSize)
+        changes |= ConfigChangeTerminalFont;
+    if (before.terminal.foreground != after.terminal.foreground ||
+        before.terminal.background != after.terminal.background ||
+        before.terminal.selection != after.terminal.selection)
+        changes |= ConfigChangeTerminalColors;
+    if (before.terminal.vimMode != after.terminal.vimMode)
+        changes |= ConfigChangeTerminalMode;
+
+    // Appearance
+    if (before.ui.transparencyEnabled != after.ui.transparencyEnabled ||
+        before.ui.transparency != after.ui.transparency)
+        changes |= ConfigChangeTransparency;
+    if (before.ui.theme != after.ui.theme)
+        changes |= ConfigChangeTheme;
+
+    // Taskbar
+    if (before.taskbar.position != after.taskbar.position)
+        changes |= ConfigChangeTaskbarPosition;
+    if (before.taskbar.visible != after.taskbar.visible ||
+        before.taskbar.showClock != after.taskbar.showClock ||
+        before.taskbar.clockFormat != after.taskbar.clockFormat)
+        changes |= ConfigChangeTaskbar;
+
+    // Widgets
+    if (before.widgets.visible != after.widgets.visible ||
+        before.widgets.transparency != after.widgets.transparency)
+        changes |= ConfigChangeWidgets;
+
+    // Explorer
+    if (before.explorer.visible != after.explorer.visible ||
+        before.explorer.width != after.explorer.width)
+        changes |= ConfigChangeExplorer;
+
+    return changes;
+}
+
+ConfigManager::ConfigManager()
+    : m_config(CreateEmptyConfig()),
+      m_configFilePath(GetDefaultConfigPath()) {
+    // Readers must always find a snapshot, even before Load()
+    PublishSnapshot(CompileSnapshot());
+}
+
+ConfigManager::~ConfigManager() {
+    StopWatching();
+
+    // Flushes a save still waiting for its quiet period
+    m_saver.reset();
+
+    if (m_cacheThread.joinable())
+        m_cacheThread.join();
+}
+
+bool ConfigManager::Load(const wxString& filename) {
+    // Follow the file if we are watching and it moves
+    const bool restartWatcher = m_watcher && !filename.empty() && filename != m_configFilePath;
+    if (restartWatcher)
+        StopWatching();
+
+    if (!filename.empty())
+        m_configFilePath = filename;
+
+    // Whatever happens to the file, hot reload goes on
+    const bool loaded = ReadConfigFile();
+    if (restartWatcher)
+        StartWatching();
+    return loaded;
+}
+
+bool ConfigManager::ReadConfigFile() {
+    ClearCache();
+    m_sectionText.clear();
+    m_dirtySections.clear();
+    m_unsavedSections.clear();
+    m_binaryCache.Close();
+
+    // Fast path: serve reads from the binary cache and skip parsing entirely
+    if (m_binaryCache.Open(m_configFilePath)) {
+        m_config.reset();
+        m_fileEntries.clear();
+        NotifyListeners(PublishSnapshot(CompileSnapshot()));
+        return true;
+    }
+
+    // First run: start from the defaults and write them out
+    if (!wxFileName::FileExists(m_configFilePath)) {
+        m_config = CreateEmptyConfig();
+        CreateDefaultConfig();
+        NotifyListeners(PublishSnapshot(CompileSnapshot()));
+        return Save();
+    }
+
+    wxFileInputStream input(m_configFilePath);
+    if (!input.IsOk())
+        return false;
+
+    m_config = std::make_unique<wxFileConfig>(input);
+    m_fileEntries = CollectEntries(*m_config);
+    NotifyListeners(PublishSnapshot(CompileSnapshot()));
+
+    // Missing or stale cache; the next startup uses the rebuilt one
+    RefreshBinaryCache();
+    return true;
+}
+
+bool ConfigManager::Save(const wxString& filename) {
+    const wxString path = filename.empty() ? m_configFilePath : filename;
+    const bool mainFile = path == m_configFilePath;
+
+    // An older background write must not land after this one
+    const bool pending = m_saver && m_saver->IsPending();
+    if (m_saver && mainFile)
+        m_saver->Cancel();
+
+    // Nothing changed since the file was loaded or saved: keep it (and its cache)
+    if (mainFile && !pending && m_dirtySections.empty() && m_unsavedSections.empty() &&
+        wxFileName::FileExists(path))
+        return true;
+
+    EnsureConfig();
+
+    // Make sure the configuration directory exists
+    wxFileName::Mkdir(wxFileName(path).GetPath(), wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+
+    // The file holds everything or nothing of this save
+    const bool written = WriteFileAtomic(path, Serialize(mainFile));
+    if (mainFile)
+        OnWritten(UINT64_MAX, written);
+    return written;
+}
+
+void ConfigManager::EnableAutoSave(bool enable) {
+    if (!enable) {
+        m_saver.reset();
+        return;
+    }
+
+    if (!m_saver) {
+        m_saver = std::make_unique<ConfigSaver>(
+            [this](uint64_t sequence) {
+                EnsureConfig();
+                return Serialize(true, sequence);
+            },
+            [this](uint64_t sequence, bool success) { OnWritten(sequence, success); });
+    }
+}
+
+wxString ConfigManager::GetString(const wxString& section, const wxString& key, const wxString& defaultVal) const {
+    // Check the cache first
+    auto sectionIt = m_cache.find(section);
+    if (sectionIt != m_cache.end()) {
+        auto keyIt = sectionIt->second.find(key);
+        if (keyIt != sectionIt->second.end())
+            return keyIt->second;
+    }
+
+    wxString value;
+    const bool found = m_config ? m_config->Read(MakeConfigPath(section, key), &value)
+                                : m_binaryCache.Find(section, key, value);
+    if (!found)
+        return defaultVal;
+
+    m_cache[section][key] = value;
+    return value;
+}
+
+void ConfigManager::SetString(const wxString& section, const wxString& key, const wxString& value) {
+    EnsureConfig();
+    m_config->Write(MakeConfigPath(section, key), value);
+    m_cache[section][key] = value;
+    OnSectionChanged(section);
+}
+
+int ConfigManager::GetInt(const wxString& section, const wxString& key, int defaultVal) const {
+    long value;
+    if (!GetString(section, key).ToLong(&value))
+        return defaultVal;
+    return static_cast<int>(value);
+}
+
+void ConfigManager::SetInt(const wxString& section, const wxString& key, int value) {
+    SetString(section, key, wxString::Format("%d", value));
+}
+
+bool ConfigManager::GetBool(const wxString& section, const wxString& key, bool defaultVal) const {
+    const wxString value = GetString(section, key).Lower();
+    if (value == "1" || value == "true" || value == "yes" || value == "on")
+        return true;
+    if (value == "0" || value == "false" || value == "no" || value == "off")
+        return false;
+    return defaultVal;
+}
+
+void ConfigManager::SetBool(const wxString& section, const wxString& key, bool value) {
+    SetString(section, key, value ? "true" : "false");
+}
+
+wxColour ConfigManager::GetColor(const wxString& section, const wxString& key, const wxColour& defaultVal) const {
+    const wxString value = GetString(section, key);
+    if (value.empty())
+        return defaultVal;
+
+    wxColour colour(value);
+    return colour.IsOk() ? colour : defaultVal;
+}
+
+void ConfigManager::SetColor(const wxString& section, const wxString& key, const wxColour& value) {
+    SetString(section, key, value.GetAsString(wxC2S_HTML_SYNTAX));
+}
+
+std::vector<wxString> ConfigManager::GetArrayString(const wxString& section, const wxString& key) const {
+    const wxArrayString parts = wxSplit(GetString(section, key), ',');
+    return std::vector<wxString>(parts.begin(), parts.end());
+}
+
+void ConfigManager::SetArrayString(const wxString& section, const wxString& key, const std::vector<wxString>& value) {
+    wxArrayString parts;
+    for (const wxString& item : value)
+        parts.Add(item);
+    SetString(section, key, wxJoin(parts, ','));
+}
+
+bool ConfigManager::HasEntry(const wxString& section, const wxString& key) const {
+    if (!m_config) {
+        wxString value;
+        return m_binaryCache.Find(section, key, value);
+    }
+    return m_config->HasEntry(MakeConfigPath(section, key));
+}
+
+bool ConfigManager::DeleteEntry(const wxString& section, const wxString& key) {
+    EnsureConfig();
+
+    auto sectionIt = m_cache.find(section);
+    if (sectionIt != m_cache.end())
+        sectionIt->second.erase(key);
+
+    if (!m_config->DeleteEntry(MakeConfigPath(section, key), false))
+        return false;
+
+    OnSectionChanged(section);
+    return true;
+}
+
+bool ConfigManager::DeleteSection(const wxString& section) {
+    EnsureConfig();
+    m_cache.erase(section);
+
+    if (!m_config->DeleteGroup("/" + section))
+        return false;
+
+    OnSectionChanged(section);
+    return true;
+}
+
+std::vector<wxString> ConfigManager::GetSections() const {
+    if (!m_config)
+        return m_binaryCache.GetSections();
+
+    std::vector<wxString> sections;
+
+    m_config->SetPath("/");
+    wxString name;
+    long index;
+    bool more = m_config->GetFirstGroup(name, index);
+    while (more) {
+        sections.push_back(name);
+        more = m_config->GetNextGroup(name, index);
+    }
+
+    return sections;
+}
+
+std::vector<wxString> ConfigManager::GetKeys(const wxString& section) const {
+    if (!m_config)
+        return m_binaryCache.GetKeys(section);
+
+    std::vector<wxString> keys;
+
+    m_config->SetPath("/" + section);
+    wxString name;
+    long index;
+    bool more = m_config->GetFirstEntry(name, index);
+    while (more) {
+        keys.push_back(name);
+        more = m_config->GetNextEntry(name, index);
+    }
+    m_config->SetPath("/");
+
+    return keys;
+}
+
+void ConfigManager::ClearCache() {
+    m_cache.clear();
+}
+
+wxString ConfigManager::GetDefaultConfigPath() {
+    wxFileName path(wxStandardPaths::Get().GetUserConfigDir(), "config.ini");
+    path.AppendDir("ITD");
+    return path.GetFullPath();
+}
+
+void ConfigManager::EnsureConfig() {
+    if (m_config)
+        return;
+
+    // Rebuild an in-memory configuration from the cached entries; they are
+    // exactly what the file contains, so they are also the edit baseline
+    m_fileEntries = m_binaryCache.ReadEntries();
+    m_config = CreateEmptyConfig();
+    for (const auto& [section, values] : m_fileEntries) {
+        for (const auto& [key, value] : values)
+            m_config->Write(MakeConfigPath(section, key), value);
+    }
+
+    // Release the mapping so the cache file can be replaced
+    m_binaryCache.Close();
+}
+
+void ConfigManager::RefreshBinaryCache() {
+    if (m_cacheThread.joinable())
+        m_cacheThread.join();
+
+    m_cacheThread = std::thread([path = m_configFilePath]() { ConfigCache::Update(path); });
+}
+
+void ConfigManager::CreateDefaultConfig() {
+    const ConfigSnapshot defaults;
+
+    // Write straight to the config; the caller publishes one snapshot afterwards
+    auto write = [this](const wxString& section, const wxString& key, const wxString& value) {
+        m_config->Write(MakeConfigPath(section, key), value);
+    };
+    auto colour = [](const wxColour& value) { return value.GetAsString(wxC2S_HTML_SYNTAX); };
+    auto flag = [](bool value) { return wxString(value ? "true" : "false"); };
+
+    // Terminal
+    write("terminal", "fontName", defaults.terminal.fontName);
+    write("terminal", "fontSize", wxString::Format("%d", defaults.terminal.fontSize));
+    write("terminal", "foreground", colour(defaults.terminal.foreground));
+    write("terminal", "background", colour(defaults.terminal.background));
+    write("terminal", "selection", colour(defaults.terminal.selection));
+    write("terminal", "vimMode", flag(defaults.terminal.vimMode));
+
+    // Appearance
+    write("ui", "transparencyEnabled", flag(defaults.ui.transparencyEnabled));
+    write("ui", "transparency", wxString::Format("%d", defaults.ui.transparency));
+    write("ui", "theme", defaults.ui.theme);
+
+    // Taskbar
+    write("taskbar", "position", ConfigSnapshot::EdgeName(defaults.taskbar.position));
+    write("taskbar", "visible", flag(defaults.taskbar.visible));
+    write("taskbar", "showClock", flag(defaults.taskbar.showClock));
+    write("taskbar", "clockFormat", defaults.taskbar.clockFormat);
+
+    // Widgets
+    write("widgets", "visible", flag(defaults.widgets.visible));
+    write("widgets", "transparency", wxString::Format("%d", defaults.widgets.transparency));
+
+    // Explorer
+    write("explorer", "visible", flag(defaults.explorer.visible));
+    write("explorer", "width", wxString::Format("%d", defaults.explorer.width));
+}
+
+std::unique_ptr<ConfigSnapshot> ConfigManager::CompileSnapshot() const {
+    auto snapshot = std::make_unique<ConfigSnapshot>();
+    ConfigSnapshot& s = *snapshot;
+
+    // Terminal
+    s.terminal.fontName = GetString("terminal", "fontName", s.terminal.fontName);
+    s.terminal.fontSize = GetInt("terminal", "fontSize", s.terminal.fontSize);
+    s.terminal.foreground = GetColor("terminal", "foreground", s.terminal.foreground);
+    s.terminal.background = GetColor("terminal", "background", s.terminal.background);
+    s.terminal.selection = GetColor("terminal", "selection", s.terminal.selection);
+    s.terminal.vimMode = GetBool("terminal", "vimMode", s.terminal.vimMode);
+
+    // Appearance
+    s.ui.transparencyEnabled = GetBool("ui", "transparencyEnabled", s.ui.transparencyEnabled);
+    s.ui.transparency = static_cast<unsigned char>(
+        std::clamp(GetInt("ui", "transparency", s.ui.transparency), 0, 255));
+    s.ui.theme = GetString("ui", "theme", s.ui.theme);
+
+    // Taskbar
+    s.taskbar.position = ConfigSnapshot::ParseEdge(GetString("taskbar", "position"), s.taskbar.position);
+    s.taskbar.visible = GetBool("taskbar", "visible", s.taskbar.visible);
+    s.taskbar.showClock = GetBool("taskbar", "showClock", s.taskbar.showClock);
+    s.taskbar.clockFormat = GetString("taskbar", "clockFormat", s.taskbar.clockFormat);
+
+    // Widgets
+    s.widgets.visible = GetBool("widgets", "visible", s.widgets.visible);
+    s.widgets.transparency = static_cast<unsigned char>(
+        std::clamp(GetInt("widgets", "transparency", s.widgets.transparency), 0, 255));
+
+    // Explorer
+    s.explorer.visible = GetBool("explorer", "visible", s.explorer.visible);
+    s.explorer.width = GetInt("explorer", "width", s.explorer.width);
+
+    return snapshot;
+}
+
+uint32_t ConfigManager::PublishSnapshot(std::unique_ptr<ConfigSnapshot> snapshot) {
+    const std::shared_ptr<const ConfigSnapshot> previous = std::atomic_load(&m_snapshot);
+    const uint32_t changes = previous ? ConfigSnapshot::Diff(*previous, *snapshot) : ConfigChangeAll;
+
+    snapshot->generation = ++m_snapshotGeneration;
+
+    // Readers still holding the previous snapshot keep it alive
+    std::atomic_store(&m_snapshot, std::shared_ptr<const ConfigSnapshot>(std::move(snapshot)));
+    return changes;
+}
+
+void ConfigManager::OnSectionChanged(const wxString& section) {
+    m_dirtySections.insert(section);
+    if (m_saver)
+        m_saver->Schedule(m_configFilePath);
+
+    if (!IsSnapshotSection(section))
+        return;
+
+    if (m_batchDepth > 0)
+        m_batchSnapshotStale = true;
+    else
+        NotifyListeners(PublishSnapshot(CompileSnapshot()));
+}
+
+void ConfigManager::EndBatch() {
+    if (m_batchDepth == 0 || --m_batchDepth > 0)
+        return;
+
+    if (m_batchSnapshotStale) {
+        m_batchSnapshotStale = false;
+        NotifyListeners(PublishSnapshot(CompileSnapshot()));
+    }
+}
+
+std::string ConfigManager::Serialize(bool commit, uint64_t sequence) {
+    std::string data;
+    std::set<wxString> present;
+
+    for (const wxString& section : GetSections()) {
+        present.insert(section);
+
+        // Reuse the text of sections that have not changed since the last save
+        auto cached = m_sectionText.find(section);
+        if (cached != m_sectionText.end() && m_dirtySections.count(section) == 0) {
+            data += cached->second;
+            continue;
+        }
+
+        std::map<wxString, wxString> values;
+        std::string text = SerializeSection(section, values);
+        data += text;
+
+        // What we write becomes the baseline for detecting external edits
+        if (commit) {
+            m_sectionText[section] = std::move(text);
+            m_fileEntries[section] = std::move(values);
+        }
+    }
+
+    if (commit) {
+        // Forget sections deleted since the last save
+        for (auto it = m_sectionText.begin(); it != m_sectionText.end();) {
+            if (present.count(it->first) == 0) {
+                m_fileEntries.erase(it->first);
+                it = m_sectionText.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        // Dirty until the write is known to have succeeded
+        for (const wxString& section : m_dirtySections)
+            m_unsavedSections[section] = sequence;
+        m_dirtySections.clear();
+    }
+
+    return data;
+}
+
+void ConfigManager::OnWritten(uint64_t sequence, bool success) {
+    // Every write holds the whole file, so it covers all earlier sequences;
+    // sections serialized later wait for their own write
+    bool retry = false;
+    for (auto it = m_unsavedSections.begin(); it != m_unsavedSections.end();) {
+        if (it->second > sequence) {
+            ++it;
+            continue;
+        }
+        if (!success) {
+            m_dirtySections.insert(it->first);
+            retry = true;
+        }
+        it = m_unsavedSections.erase(it);
+    }
+
+    if (success)
+        RefreshBinaryCache();
+    else if (retry && m_saver)
+        m_saver->Schedule(m_configFilePath);
+}
+
+std::string ConfigManager::SerializeSection(const wxString& section, std::map<wxString, wxString>& values) const {
+    std::string text;
+    text += '[';
+    AppendUTF8(text, EscapeName(section));
+    text += "]\n";
+
+    for (const wxString& key : GetKeys(section)) {
+        const wxString value = m_config->Read(MakeConfigPath(section, key), wxEmptyString);
+        AppendUTF8(text, EscapeName(key));
+        text += '=';
+        AppendUTF8(text, EscapeValue(value));
+        text += '\n';
+        values[key] = value;
+    }
+    text += '\n';
+
+    return text;
+}
+
+int ConfigManager::AddChangeListener(uint32_t mask, ConfigChangeListener listener) {
+    const int id = m_nextListenerId++;
+    m_listeners.push_back({ id, mask, std::move(listener) });
+    return id;
+}
+
+void ConfigManager::RemoveChangeListener(int id) {
+    m_listeners.erase(std::remove_if(m_listeners.begin(), m_listeners.end(),
+        [id](const ListenerEntry& entry) { return entry.id == id; }), m_listeners.end());
+}
+
+void ConfigManager::NotifyListeners(uint32_t changes) {
+    if (changes == ConfigChangeNone)
+        return;
+
+    // Listeners may add or remove listeners while being notified
+    const std::vector<ListenerEntry> listeners = m_listeners;
+    const std::shared_ptr<const ConfigSnapshot> snapshot = GetSnapshot();
+    for (const ListenerEntry& listener : listeners) {
+        if (listener.mask & changes)
+            listener.callback(*snapshot, changes & listener.mask);
+    }
+}
+
+bool ConfigManager::StartWatching() {
+    if (m_watcher)
+        return true;
+
+    m_watcher = std::make_unique<ConfigWatcher>(m_configFilePath,
+        [this](const ConfigEntries& entries) { ApplyExternalChanges(entries); });
+    if (!m_watcher->Start()) {
+        m_watcher.reset();
+        return false;
+    }
+
+    return true;
+}
+
+void ConfigManager::StopWatching() {
+    m_watcher.reset();
+}
+
+bool ConfigManager::ReadEntries(const wxString& filename, ConfigEntries& entries) {
+    MappedFile file;
+    if (!file.Open(filename)) {
+        // Empty files cannot be mapped but are valid
+        if (!wxFileName::FileExists(filename) || wxFileName(filename).GetSize().GetValue() != 0)
+            return false;
+        entries.clear();
+        return true;
+    }
+
+    return ParseEntries(file.GetData(), file.GetSize(), entries);
+}
+
+bool ConfigManager::ParseEntries(const char* data, size_t size, ConfigEntries& entries) {
+    wxMemoryInputStream input(data, size);
+    if (!input.IsOk())
+        return false;
+
+    wxFileConfig config(input);
+    entries = CollectEntries(config);
+    return true;
+}
+
+std::string ConfigManager::SerializeEntries(const ConfigEntries& entries) {
+    std::string data;
+    for (const auto& [section, values] : entries) {
+        data += '[';
+        AppendUTF8(data, EscapeName(section));
+        data += "]\n";
+        for (const auto& [key, value] : values) {
+            AppendUTF8(data, EscapeName(key));
+            data += '=';
+            AppendUTF8(data, EscapeValue(value));
+            data += '\n';
+        }
+        data += '\n';
+    }
+    return data;
+}
+
+ConfigEntries ConfigManager::CollectEntries(wxConfigBase& config) {
+    ConfigEntries entries;
+
+    // Collect the group names first; changing the path restarts enumeration
+    std::vector<wxString> sections;
+    config.SetPath("/");
+    wxString name;
+    long index;
+    bool more = config.GetFirstGroup(name, index);
+    while (more) {
+        sections.push_back(name);
+        more = config.GetNextGroup(name, index);
+    }
+
+    for (const wxString& section : sections) {
+        std::map<wxString, wxString>& values = entries[section];
+
+        config.SetPath("/" + section);
+        more = config.GetFirstEntry(name, index);
+        while (more) {
+            values[name] = config.Read(name, wxEmptyString);
+            more = config.GetNextEntry(name, index);
+        }
+    }
+    config.SetPath("/");
+
+    return entries;
+}
+
+void ConfigManager::ApplyExternalChanges(const ConfigEntries& entries) {
+    EnsureConfig();
+
+    std::set<wxString> changedSections;
+
+    // Merge only what changed in the file since we last loaded or saved it, so
+    // in-memory changes that have not been saved yet survive the reload
+    for (const auto& [section, values] : entries) {
+        auto baseSection = m_fileEntries.find(section);
+        for (const auto& [key, value] : values) {
+            if (baseSection != m_fileEntries.end()) {
+                auto baseValue = baseSection->second.find(key);
+                if (baseValue != baseSection->second.end() && baseValue->second == value)
+                    continue;
+            }
+            m_config->Write(MakeConfigPath(section, key), value);
+            changedSections.insert(section);
+        }
+    }
+
+    // Keys removed from the file
+    for (const auto& [section, values] : m_fileEntries) {
+        auto newSection = entries.find(section);
+        for (const auto& entry : values) {
+            if (newSection == entries.end() || newSection->second.count(entry.first) == 0) {
+                m_config->DeleteEntry(MakeConfigPath(section, entry.first), true);
+                changedSections.insert(section);
+            }
+        }
+    }
+
+    m_fileEntries = entries;
+    if (changedSections.empty())
+        return;
+
+    // The cache describes the previous content of the file
+    RefreshBinaryCache();
+
+    // Map the touched sections to change flags
+    uint32_t changes = ConfigChangeNone;
+    bool snapshotChanged = false;
+    for (const wxString& section : changedSections) {
+        // Cached text is stale; the file already has these values, so no save is scheduled
+        m_cache.erase(section);
+        m_sectionText.erase(section);
+        if (IsSnapshotSection(section))
+            snapshotChanged = true;
+        else if (section.StartsWith("widget-"))
+            changes |= ConfigChangeWidgetLayout;
+        else
+            changes |= ConfigChangeOther;
+    }
+
+    if (snapshotChanged)
+        changes |= PublishSnapshot(CompileSnapshot());
+
+    NotifyListeners(changes);
+}
+
+} // namespace ITD
\ No newline at end of file
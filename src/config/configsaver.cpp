@@ -0,0 +1,108 @@
+#include "config/configsaver.h"
+#include "util/atomicfile.h"
+#include <wx/wx.h>
+
+namespace ITD {
+
+namespace {
+
+// Quiet period after the last change before the file is written
+constexpr int kDebounceMs = 500;
+
+} // namespace
+
+ConfigSaver::ConfigSaver(SerializeCallback serialize, WrittenCallback written)
+    : m_serialize(std::move(serialize)),
+      m_written(std::move(written)),
+      m_debounceTimer(this) {
+    Bind(wxEVT_TIMER, &ConfigSaver::OnDebounceTimer, this);
+}
+
+ConfigSaver::~ConfigSaver() {
+    // Flush a save that is still waiting for its quiet period
+    if (m_debounceTimer.IsRunning()) {
+        m_debounceTimer.Stop();
+        Enqueue(m_filename);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_condition.notify_all();
+
+    // The writer drains the pending write before exiting
+    if (m_writerThread.joinable())
+        m_writerThread.join();
+}
+
+void ConfigSaver::Schedule(const wxString& filename) {
+    m_filename = filename;
+    m_debounceTimer.StartOnce(kDebounceMs);
+}
+
+void ConfigSaver::Cancel() {
+    m_debounceTimer.Stop();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_hasPending = false;
+    m_pendingData.clear();
+    m_condition.wait(lock, [this]() { return !m_writing; });
+}
+
+bool ConfigSaver::IsPending() const {
+    if (m_debounceTimer.IsRunning())
+        return true;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_hasPending || m_writing;
+}
+
+void ConfigSaver::OnDebounceTimer(wxTimerEvent& event) {
+    wxUnusedVar(event);
+    Enqueue(m_filename);
+}
+
+void ConfigSaver::Enqueue(const wxString& filename) {
+    const uint64_t sequence = ++m_sequence;
+    std::string data = m_serialize(sequence);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // Newer data replaces data that has not been written yet
+        m_pendingFilename = filename;
+        m_pendingData = std::move(data);
+        m_pendingSequence = sequence;
+        m_hasPending = true;
+
+        if (!m_writerThread.joinable())
+            m_writerThread = std::thread(&ConfigSaver::WriterLoop, this);
+    }
+    m_condition.notify_all();
+}
+
+void ConfigSaver::WriterLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_condition.wait(lock, [this]() { return m_hasPending || m_stopping; });
+        if (!m_hasPending)
+            return;
+
+        const wxString filename = m_pendingFilename;
+        const std::string data = std::move(m_pendingData);
+        const uint64_t sequence = m_pendingSequence;
+        m_hasPending = false;
+        m_writing = true;
+
+        lock.unlock();
+        const bool success = WriteFileAtomic(filename, data);
+        if (m_written)
+            CallAfter([this, sequence, success]() { m_written(sequence, success); });
+        lock.lock();
+
+        m_writing = false;
+        m_condition.notify_all();
+    }
+}
+
+} // namespace ITD
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include "config/configwatcher.h"
+#include "config/configmanager.h"
+#include <wx/wx.h>
+#include <wx/filename.h>
+
+namespace ITD {
+
+namespace {
+
+// Quiet period before a burst of file system events triggers a reload
+constexpr int kDebounceMs = 150;
+
+} // namespace
+
+ConfigWatcher::ConfigWatcher(const wxString& filename, ReloadCallback callback)
+    : m_filename(filename),
+      m_callback(std::move(callback)),
+      m_debounceTimer(this) {
+    Bind(wxEVT_FSWATCHER, &ConfigWatcher::OnFileSystemEvent, this);
+    Bind(wxEVT_TIMER, &ConfigWatcher::OnDebounceTimer, this);
+}
+
+ConfigWatcher::~ConfigWatcher() {
+    Stop();
+}
+
+bool ConfigWatcher::Start() {
+    if (m_watcher)
+        return true;
+
+    // Watch the directory so that replace-by-rename saves are seen as well
+    const wxFileName dir = wxFileName::DirName(wxFileName(m_filename).GetPath());
+    if (!dir.DirExists())
+        return false;
+
+    m_watcher = std::make_unique<wxFileSystemWatcher>();
+    m_watcher->SetOwner(this);
+    if (!m_watcher->Add(dir, wxFSW_EVENT_CREATE | wxFSW_EVENT_MODIFY | wxFSW_EVENT_RENAME)) {
+        m_watcher.reset();
+        return false;
+    }
+
+    return true;
+}
+
+void ConfigWatcher::Stop() {
+    m_debounceTimer.Stop();
+    m_watcher.reset();
+    m_reloadPending = false;
+
+    if (m_parseThread.joinable())
+        m_parseThread.join();
+}
+
+void ConfigWatcher::OnFileSystemEvent(wxFileSystemWatcherEvent& event) {
+    const wxFileName target(m_filename);
+    const bool matches = event.GetPath().SameAs(target) ||
+        (event.GetChangeType() == wxFSW_EVENT_RENAME && event.GetNewPath().SameAs(target));
+    if (!matches)
+        return;
+
+    // Restart the quiet period; editors emit several events per save
+    m_debounceTimer.StartOnce(kDebounceMs);
+}
+
+void ConfigWatcher::OnDebounceTimer(wxTimerEvent& event) {
+    wxUnusedVar(event);
+
+    if (m_parsing) {
+        m_reloadPending = true;
+        return;
+    }
+
+    StartParse();
+}
+
+void ConfigWatcher::StartParse() {
+    if (m_parseThread.joinable())
+        m_parseThread.join();
+
+    m_parsing = true;
+    m_parseThread = std::thread([this, filename = m_filename]() {
+        ConfigEntries entries;
+        const bool success = ConfigManager::ReadEntries(filename, entries);
+
+        // Hand the result back to the UI thread
+        CallAfter([this, entries, success]() {
+            OnParseFinished(entries, success);
+        });
+    });
+}
+
+void ConfigWatcher::OnParseFinished(const ConfigEntries& entries, bool success) {
+    m_parsing = false;
+
+    // Stopped while the parse was running
+    if (!m_watcher)
+        return;
+
+    if (success && m_callback)
+        m_callback(entries);
+
+    // The file changed again while we were parsing
+    if (m_reloadPending) {
+        m_reloadPending = false;
+        StartParse();
+    }
+}
+
+} // namespace ITD
\ No newline at end of file
@@ -0,0 +1,177 @@
+#include "lua/luaallocator.h"
+#include <lua.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace ITD {
+
+namespace {
+
+// Same behavior as the panic function installed by luaL_newstate
+int Panic(lua_State* L) {
+    const char* message = lua_tostring(L, -1);
+    std::fprintf(stderr, "PANIC: unprotected error in call to Lua API (%s)\n",
+                 message ? message : "error object is not a string");
+    return 0;
+}
+
+} // namespace
+
+LuaAllocator::LuaAllocator(size_t limit)
+    : m_limit(limit) {
+}
+
+LuaAllocator::~LuaAllocator() {
+    for (void* chunk : m_chunks)
+        std::free(chunk);
+
+    while (m_keptHeapBlocks) {
+        void* block = m_keptHeapBlocks;
+        std::memcpy(&m_keptHeapBlocks, static_cast<char*>(block) + kMaxPooledSize, sizeof(m_keptHeapBlocks));
+        std::free(block);
+    }
+}
+
+lua_State* LuaAllocator::NewState() {
+    lua_State* L = lua_newstate(&LuaAllocator::Allocate, this);
+    if (L)
+        lua_atpanic(L, &Panic);
+    return L;
+}
+
+void* LuaAllocator::Allocate(void* userData, void* block, size_t oldSize, size_t newSize) {
+    return static_cast<LuaAllocator*>(userData)->Reallocate(block, oldSize, newSize);
+}
+
+void* LuaAllocator::Reallocate(void* block, size_t oldSize, size_t newSize) {
+    // Without a block, oldSize only tells the type of the new object
+    if (!block)
+        oldSize = 0;
+
+    if (newSize == 0) {
+        if (block)
+            ReleaseBlock(block, oldSize);
+        return nullptr;
+    }
+
+    // Only growth counts against the limit; shrinking must always succeed
+    if (newSize > oldSize && m_limit != 0 && m_stats.bytesInUse + (newSize - oldSize) > m_limit) {
+        ++m_stats.refusedAllocations;
+        return nullptr;
+    }
+
+    if (!block)
+        return AllocateBlock(newSize);
+
+    // Lua treats a failed shrink as fatal, so only growth may return nullptr
+    void* result = block;
+    if (oldSize > kMaxPooledSize && newSize > kMaxPooledSize) {
+        // Both on the system heap
+        result = std::realloc(block, std::max(newSize, kMinHeapBlockSize));
+        if (!result)
+            return newSize > oldSize ? nullptr : KeepBlock(block, oldSize, newSize);
+        m_stats.largeBytes = m_stats.largeBytes - oldSize + newSize;
+    } else if (oldSize > kMaxPooledSize || newSize > kMaxPooledSize ||
+               GetSizeClass(oldSize) != GetSizeClass(newSize)) {
+        // Moves between size classes or to/from the system heap; on failure
+        // the old block stays valid, as Lua expects
+        result = AllocateBlock(newSize);
+        if (!result)
+            return newSize > oldSize ? nullptr : KeepBlock(block, oldSize, newSize);
+        std::memcpy(result, block, std::min(oldSize, newSize));
+        ReleaseBlock(block, oldSize);
+        return result;
+    }
+
+    m_stats.bytesInUse = m_stats.bytesInUse - oldSize + newSize;
+    m_stats.peakBytesInUse = std::max(m_stats.peakBytesInUse, m_stats.bytesInUse);
+    return result;
+}
+
+void* LuaAllocator::AllocateBlock(size_t size) {
+    void* block;
+    if (size > kMaxPooledSize) {
+        block = std::malloc(std::max(size, kMinHeapBlockSize));
+        if (!block)
+            return nullptr;
+        m_stats.largeBytes += size;
+    } else {
+        const size_t sizeClass = GetSizeClass(size);
+        FreeBlock* free = m_freeLists[sizeClass];
+        if (free) {
+            m_freeLists[sizeClass] = free->next;
+            block = free;
+        } else {
+            block = AllocateFromArena((sizeClass + 1) * kSizeClassGranularity);
+            if (!block)
+                return nullptr;
+        }
+        ++m_stats.pooledAllocations;
+    }
+
+    ++m_stats.allocations;
+    m_stats.bytesInUse += size;
+    m_stats.peakBytesInUse = std::max(m_stats.peakBytesInUse, m_stats.bytesInUse);
+    return block;
+}
+
+void LuaAllocator::ReleaseBlock(void* block, size_t size) {
+    if (size > kMaxPooledSize) {
+        std::free(block);
+        m_stats.largeBytes -= size;
+    } else {
+        // Pooled blocks are kept for reuse until the allocator is destroyed
+        const size_t sizeClass = GetSizeClass(size);
+        FreeBlock* free = static_cast<FreeBlock*>(block);
+        free->next = m_freeLists[sizeClass];
+        m_freeLists[sizeClass] = free;
+    }
+
+    ++m_stats.frees;
+    m_stats.bytesInUse -= size;
+}
+
+void* LuaAllocator::KeepBlock(void* block, size_t oldSize, size_t newSize) {
+    // Lua passes newSize from now on. A pooled block then goes to the free
+    // list of a smaller class than its own, which only wastes its tail; a
+    // heap block shrunk into the pool is linked through the bytes past
+    // kMaxPooledSize, which the pool never uses, and freed with the allocator
+    if (oldSize > kMaxPooledSize && newSize <= kMaxPooledSize) {
+        std::memcpy(static_cast<char*>(block) + kMaxPooledSize, &m_keptHeapBlocks, sizeof(m_keptHeapBlocks));
+        m_keptHeapBlocks = block;
+        m_stats.largeBytes -= oldSize;
+    } else if (oldSize > kMaxPooledSize) {
+        m_stats.largeBytes = m_stats.largeBytes - oldSize + newSize;
+    }
+
+    m_stats.bytesInUse = m_stats.bytesInUse - oldSize + newSize;
+    return block;
+}
+
+void* LuaAllocator::AllocateFromArena(size_t blockSize) {
+    if (static_cast<size_t>(m_chunkEnd - m_chunkCursor) < blockSize) {
+        // The rest of the current chunk is too small to matter
+        void* chunk = std::malloc(kArenaChunkSize);
+        if (!chunk)
+            return nullptr;
+        try {
+            m_chunks.push_back(chunk);
+        } catch (const std::bad_alloc&) {
+            // Exceptions must not cross the Lua C code
+            std::free(chunk);
+            return nullptr;
+        }
+        m_chunkCursor = static_cast<char*>(chunk);
+        m_chunkEnd = m_chunkCursor + kArenaChunkSize;
+        m_stats.arenaBytes += kArenaChunkSize;
+    }
+
+    void* block = m_chunkCursor;
+    m_chunkCursor += blockSize;
+    return block;
+}
+
+} // namespace ITD
@@ -0,0 +1,418 @@
+#include "lua/luaasync.h"
+#include "lua/luabinding.h"
+#include "lua/luaprofiler.h"
+#include <wx/wx.h>
+#include <wx/dir.h>
+#include <wx/file.h>
+#include <lua.hpp>
+#include <algorithm>
+
+namespace ITD {
+
+namespace {
+
+// Metatable of chunk iterator state
+constexpr const char* kStreamMetatable = "ITD.AsyncStream";
+
+// Block size of whole-file reads; the stop flag is checked in between
+constexpr size_t kReadBlockSize = 1024 * 1024;
+
+// Upper bounds for script-provided chunk sizes
+constexpr lua_Integer kMaxChunkSize = 64 * 1024 * 1024;
+constexpr lua_Integer kMaxBatchSize = 64 * 1024;
+
+wxString ToString(lua_State* L, int index) {
+    size_t length = 0;
+    const char* text = luaL_checklstring(L, index, &length);
+    return wxString::FromUTF8(text, length);
+}
+
+// Continuation of a chunk iterator: the task was resumed with either the
+// chunk, nil at the end, or nil and an error message to raise
+int ContinueStream(lua_State* L, int status, lua_KContext context) {
+    (void)status;
+    (void)context;
+    if (lua_gettop(L) == 2 && lua_isnil(L, 1))
+        return lua_error(L);
+    return lua_gettop(L);
+}
+
+} // namespace
+
+LuaAsync::LuaAsync(lua_State* L, ErrorHandler onError)
+    : m_state(L),
+      m_onError(std::move(onError)),
+      m_pool(2) {
+}
+
+LuaAsync::~LuaAsync() {
+    // m_pool is destroyed first and joins the I/O threads
+    m_stopping = true;
+}
+
+void LuaAsync::RegisterFunctions() {
+    lua_State* L = m_state;
+
+    if (luaL_newmetatable(L, kStreamMetatable)) {
+        lua_pushcfunction(L, &LuaAsync::StreamGc);
+        lua_setfield(L, -2, "__gc");
+    }
+    lua_pop(L, 1);
+
+    auto add = [this, L](const char* name, lua_CFunction function) {
+        lua_pushlightuserdata(L, this);
+        lua_pushcclosure(L, function, 1);
+        lua_setfield(L, -2, name);
+    };
+    add("Async", &LuaAsync::Async);
+    add("ReadFileAsync", &LuaAsync::ReadFileAsync);
+    add("ListDirectoryAsync", &LuaAsync::ListDirectoryAsync);
+    add("ReadChunks", &LuaAsync::ReadChunks);
+    add("ListDirectoryChunks", &LuaAsync::ListDirectoryChunks);
+}
+
+void LuaAsync::Resume(lua_State* co, lua_State* from, int argCount) {
+    int resultCount = 0;
+    LuaProfiler::MarkEntry();
+    const int status = lua_resume(co, from, argCount, &resultCount);
+
+    if (status == LUA_YIELD) {
+        lua_pop(co, resultCount);
+
+        // Yielded by coroutine.yield() rather than by a wait: continue later
+        auto it = m_tasks.find(co);
+        if (it != m_tasks.end() && !it->second.waiting) {
+            CallAfter([this, co]() {
+                if (m_tasks.count(co))
+                    Resume(co, m_state, 0);
+            });
+        }
+        return;
+    }
+
+    if (status != LUA_OK) {
+        size_t length = 0;
+        const char* message = lua_tolstring(co, -1, &length);
+        luaL_traceback(m_state, co, message, 0);
+        const char* traceback = lua_tolstring(m_state, -1, &length);
+        if (m_onError)
+            m_onError(traceback ? wxString::FromUTF8(traceback, length) : wxString("Unknown Lua error"));
+        lua_pop(m_state, 1);
+    }
+
+    // Finished; let the collector have the coroutine
+    auto it = m_tasks.find(co);
+    if (it != m_tasks.end()) {
+        luaL_unref(m_state, LUA_REGISTRYINDEX, it->second.ref);
+        m_tasks.erase(it);
+    }
+}
+
+void LuaAsync::Await(lua_State* co, Producer work) {
+    m_tasks[co].waiting = true;
+
+    m_pool.Submit([this, co, work = std::move(work)]() {
+        Result result = work();
+        CallAfter([this, co, result = std::move(result)]() {
+            auto it = m_tasks.find(co);
+            if (it == m_tasks.end())
+                return;
+            it->second.waiting = false;
+            ResumeWithResult(co, result);
+        });
+    });
+}
+
+void LuaAsync::PushStream(lua_State* L, Producer next) {
+    auto stream = std::make_shared<Stream>();
+    stream->next = std::move(next);
+
+    // The iterator holds the stream; a pending read keeps it alive too
+    lua_pushlightuserdata(L, this);
+    void* memory = lua_newuserdatauv(L, sizeof(std::shared_ptr<Stream>), 0);
+    new (memory) std::shared_ptr<Stream>(stream);
+    luaL_setmetatable(L, kStreamMetatable);
+    lua_pushcclosure(L, &LuaAsync::StreamNext, 2);
+
+    ReadAhead(stream);
+}
+
+void LuaAsync::ReadAhead(const std::shared_ptr<Stream>& stream) {
+    if (stream->pending || stream->finished || stream->ready)
+        return;
+
+    stream->pending = true;
+    m_pool.Submit([this, stream]() {
+        Result result = m_stopping ? Result() : stream->next();
+        CallAfter([this, stream, result = std::move(result)]() mutable {
+            OnStreamRead(stream, std::move(result));
+        });
+    });
+}
+
+void LuaAsync::OnStreamRead(const std::shared_ptr<Stream>& stream, Result result) {
+    stream->pending = false;
+    if (result.kind == Result::Kind::End || result.kind == Result::Kind::Error) {
+        stream->finished = true;
+        stream->next = nullptr;  // Closes the file or directory
+    }
+
+    lua_State* co = stream->waiter;
+    stream->waiter = nullptr;
+    auto it = co ? m_tasks.find(co) : m_tasks.end();
+    if (it == m_tasks.end()) {
+        stream->ready = std::move(result);
+        return;
+    }
+    it->second.waiting = false;
+
+    // Hand the chunk over and read the next one while the script works
+    ReadAhead(stream);
+    ResumeWithResult(co, result);
+}
+
+void LuaAsync::ResumeWithResult(lua_State* co, const Result& result) {
+    // Nothing catches Lua errors in the event loop, and the result is alive
+    // here: the values are built on the idle main state under lua_pcall,
+    // then moved to the task
+    lua_State* L = m_state;
+    const int top = lua_gettop(L);
+    lua_pushcfunction(L, &LuaAsync::PushResultThunk);
+    lua_pushlightuserdata(L, const_cast<Result*>(&result));
+    if (lua_pcall(L, 1, LUA_MULTRET, 0) == LUA_OK && lua_checkstack(co, lua_gettop(L) - top)) {
+        const int count = lua_gettop(L) - top;
+        lua_xmove(L, co, count);
+        Resume(co, L, count);
+        return;
+    }
+    lua_settop(L, top);
+
+    // Out of memory; the task is dropped like one that failed
+    if (m_onError)
+        m_onError("Not enough memory to resume an asynchronous task");
+    auto it = m_tasks.find(co);
+    if (it != m_tasks.end()) {
+        luaL_unref(L, LUA_REGISTRYINDEX, it->second.ref);
+        m_tasks.erase(it);
+    }
+}
+
+int LuaAsync::PushResult(lua_State* L, const Result& result) {
+    switch (result.kind) {
+        case Result::Kind::Data:
+            lua_pushlstring(L, result.data.data(), result.data.size());
+            return 1;
+        case Result::Kind::Names:
+            lua_createtable(L, static_cast<int>(result.names.size()), 0);
+            for (size_t i = 0; i < result.names.size(); ++i) {
+                LuaBinding::Push(L, result.names[i]);
+                lua_rawseti(L, -2, static_cast<lua_Integer>(i + 1));
+            }
+            return 1;
+        case Result::Kind::End:
+            lua_pushnil(L);
+            return 1;
+        case Result::Kind::Error:
+            lua_pushnil(L);
+            LuaBinding::Push(L, result.error);
+            return 2;
+    }
+    return 0;
+}
+
+int LuaAsync::PushResultThunk(lua_State* L) {
+    return PushResult(L, *static_cast<const Result*>(lua_touserdata(L, 1)));
+}
+
+LuaAsync::Task& LuaAsync::CheckTask(lua_State* L, const char* function) {
+    auto it = m_tasks.find(L);
+    if (it == m_tasks.end() || !lua_isyieldable(L))
+        luaL_error(L, "%s must be called from a task started with itd.Async", function);
+    return it->second;
+}
+
+LuaAsync& LuaAsync::FromUpvalue(lua_State* L) {
+    return *static_cast<LuaAsync*>(lua_touserdata(L, lua_upvalueindex(1)));
+}
+
+int LuaAsync::Async(lua_State* L) {
+    // itd.Async(fn, ...) -> runs fn(...) as a task
+    LuaAsync& self = FromUpvalue(L);
+    luaL_checktype(L, 1, LUA_TFUNCTION);
+    const int argCount = lua_gettop(L) - 1;
+
+    lua_State* co = lua_newthread(L);
+    lua_insert(L, 1);
+    lua_xmove(L, co, argCount + 1);
+    self.m_tasks[co] = Task{ luaL_ref(L, LUA_REGISTRYINDEX) };
+
+    self.Resume(co, L, argCount);
+    return 0;
+}
+
+// The functions below may yield or raise Lua errors, which unwind with
+// longjmp; C++ objects are confined to full expressions that end before.
+
+int LuaAsync::ReadFileAsync(lua_State* L) {
+    LuaAsync& self = FromUpvalue(L);
+    luaL_checkstring(L, 1);
+    self.CheckTask(L, "ReadFileAsync");
+
+    self.Await(L, [&self, path = ToString(L, 1)]() {
+        Result result;
+        wxFile file;
+        if (!file.Open(path)) {
+            result.kind = Result::Kind::Error;
+            result.error = "cannot open " + path;
+            return result;
+        }
+
+        result.kind = Result::Kind::Data;
+        std::string block(kReadBlockSize, '\0');
+        while (!self.m_stopping) {
+            const ssize_t count = file.Read(&block[0], block.size());
+            if (count == wxInvalidOffset) {
+                result.kind = Result::Kind::Error;
+                result.error = "cannot read " + path;
+                result.data.clear();
+                break;
+            }
+            if (count == 0)
+                break;
+            result.data.append(block.data(), static_cast<size_t>(count));
+        }
+        return result;
+    });
+    return lua_yield(L, 0);
+}
+
+int LuaAsync::ListDirectoryAsync(lua_State* L) {
+    LuaAsync& self = FromUpvalue(L);
+    luaL_checkstring(L, 1);
+    self.CheckTask(L, "ListDirectoryAsync");
+
+    self.Await(L, [&self, path = ToString(L, 1)]() {
+        Result result;
+        wxDir dir(path);
+        if (!dir.IsOpened()) {
+            result.kind = Result::Kind::Error;
+            result.error = "cannot open " + path;
+            return result;
+        }
+
+        result.kind = Result::Kind::Names;
+        wxString name;
+        bool more = dir.GetFirst(&name);
+        while (more && !self.m_stopping) {
+            result.names.push_back(name);
+            more = dir.GetNext(&name);
+        }
+        return result;
+    });
+    return lua_yield(L, 0);
+}
+
+int LuaAsync::ReadChunks(lua_State* L) {
+    // for chunk in itd.ReadChunks(path, [size]) do ... end
+    LuaAsync& self = FromUpvalue(L);
+    luaL_checkstring(L, 1);
+    const lua_Integer chunkSize = luaL_optinteger(L, 2, static_cast<lua_Integer>(kDefaultChunkSize));
+    luaL_argcheck(L, chunkSize > 0 && chunkSize <= kMaxChunkSize, 2, "chunk size out of range");
+
+    // The file is opened by the first read, on an I/O thread
+    self.PushStream(L, [path = ToString(L, 1), file = std::make_shared<wxFile>(),
+                        size = static_cast<size_t>(chunkSize)]() {
+        Result result;
+        if (!file->IsOpened() && !file->Open(path)) {
+            result.kind = Result::Kind::Error;
+            result.error = "cannot open " + path;
+            return result;
+        }
+
+        result.data.resize(size);
+        const ssize_t count = file->Read(&result.data[0], size);
+        if (count == wxInvalidOffset) {
+            result.kind = Result::Kind::Error;
+            result.error = "cannot read " + path;
+        } else if (count > 0) {
+            result.kind = Result::Kind::Data;
+            result.data.resize(static_cast<size_t>(count));
+        }
+        return result;
+    });
+    return 1;
+}
+
+int LuaAsync::ListDirectoryChunks(lua_State* L) {
+    // for names in itd.ListDirectoryChunks(path, [count]) do ... end
+    LuaAsync& self = FromUpvalue(L);
+    luaL_checkstring(L, 1);
+    const lua_Integer batchSize = luaL_optinteger(L, 2, static_cast<lua_Integer>(kDefaultBatchSize));
+    luaL_argcheck(L, batchSize > 0 && batchSize <= kMaxBatchSize, 2, "batch size out of range");
+
+    struct Listing {
+        wxDir dir;
+        bool started = false;
+    };
+    self.PushStream(L, [path = ToString(L, 1), listing = std::make_shared<Listing>(),
+                        size = static_cast<size_t>(batchSize)]() {
+        Result result;
+        if (!listing->started && !listing->dir.Open(path)) {
+            result.kind = Result::Kind::Error;
+            result.error = "cannot open " + path;
+            return result;
+        }
+
+        wxString name;
+        while (result.names.size() < size) {
+            const bool found = listing->started ? listing->dir.GetNext(&name) : listing->dir.GetFirst(&name);
+            listing->started = true;
+            if (!found)
+                break;
+            result.names.push_back(name);
+        }
+        if (!result.names.empty())
+            result.kind = Result::Kind::Names;
+        return result;
+    });
+    return 1;
+}
+
+int LuaAsync::StreamNext(lua_State* L) {
+    LuaAsync& self = FromUpvalue(L);
+    std::shared_ptr<Stream>& stream = *static_cast<std::shared_ptr<Stream>*>(lua_touserdata(L, lua_upvalueindex(2)));
+
+    if (stream->ready) {
+        const int count = PushResult(L, *stream->ready);
+        stream->ready.reset();
+        self.ReadAhead(stream);
+
+        // nil and a message: raise it
+        if (count == 2)
+            return lua_error(L);
+        return count;
+    }
+
+    // Exhausted
+    if (!stream->pending) {
+        lua_pushnil(L);
+        return 1;
+    }
+
+    Task& task = self.CheckTask(L, "the iterator");
+    luaL_argcheck(L, stream->waiter == nullptr, 1, "iterator is already in use");
+    stream->waiter = L;
+    task.waiting = true;
+
+    // ContinueStream() expects only the resume values on the stack
+    lua_settop(L, 0);
+    return lua_yieldk(L, 0, 0, &ContinueStream);
+}
+
+int LuaAsync::StreamGc(lua_State* L) {
+    using StreamPtr = std::shared_ptr<Stream>;
+    static_cast<StreamPtr*>(luaL_checkudata(L, 1, kStreamMetatable))->~StreamPtr();
+    return 0;
+}
+
+} // namespace ITD
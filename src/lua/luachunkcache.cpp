@@ -0,0 +1,205 @@
+#include "lua/luachunkcache.h"
+#include "util/atomicfile.h"
+#include "util/hash.h"
+#include "util/mappedfile.h"
+#include <wx/wx.h>
+#include <wx/filename.h>
+#include <wx/stdpaths.h>
+#include <lua.hpp>
+#include <cstring>
+#include <string>
+
+namespace ITD {
+
+namespace {
+
+constexpr char kChunkMagic[8] = { 'I', 'T', 'D', 'L', 'U', 'A', 'C', '\0' };
+constexpr uint32_t kChunkVersion = 1;
+
+// Cache file layout: Header, script path (UTF-8), bytecode
+struct Header {
+    char magic[8];            ///< File identification
+    uint32_t version;         ///< Format version
+    uint32_t luaVersion;      ///< LUA_VERSION_NUM of the compiler
+    uint64_t pathLength;      ///< Script path length in bytes
+    uint64_t bytecodeSize;    ///< Bytecode size in bytes
+    int64_t sourceModified;   ///< Script modification time (ms since epoch)
+    uint64_t sourceSize;      ///< Script size in bytes
+    uint64_t sourceHash;      ///< Script content hash
+};
+
+bool GetModificationTime(const wxString& filename, int64_t& modified) {
+    const wxDateTime time = wxFileName(filename).GetModificationTime();
+    if (!time.IsValid())
+        return false;
+    modified = time.GetValue().GetValue();
+    return true;
+}
+
+// Feeds a memory buffer to lua_load in one piece
+struct BufferReader {
+    const char* data;
+    size_t size;
+
+    static const char* Read(lua_State* L, void* userData, size_t* size) {
+        (void)L;
+        BufferReader* reader = static_cast<BufferReader*>(userData);
+        *size = reader->size;
+        reader->size = 0;
+        return reader->data;
+    }
+};
+
+int WriteBytecode(lua_State* L, const void* data, size_t size, void* userData) {
+    (void)L;
+    static_cast<std::string*>(userData)->append(static_cast<const char*>(data), size);
+    return 0;
+}
+
+} // namespace
+
+LuaChunkCache::LuaChunkCache(const wxString& directory)
+    : m_directory(directory),
+      m_writer(1) {
+}
+
+LuaChunkCache::~LuaChunkCache() {
+    // m_writer is destroyed first and joins the write in progress
+}
+
+int LuaChunkCache::Load(lua_State* L, const wxString& filename) {
+    const wxString chunkName = "@" + filename;
+
+    if (LoadCached(L, filename, chunkName))
+        return LUA_OK;
+
+    return LoadSource(L, filename, chunkName);
+}
+
+wxString LuaChunkCache::GetDefaultDirectory() {
+    wxFileName path(wxStandardPaths::Get().GetUserConfigDir(), wxEmptyString);
+    path.AppendDir("ITD");
+    path.AppendDir("luacache");
+    return path.GetPath();
+}
+
+wxString LuaChunkCache::GetCachePath(const wxString& filename) const {
+    const wxScopedCharBuffer utf8 = filename.utf8_str();
+    const uint64_t key = HashBytes(utf8.data(), utf8.length());
+    return wxFileName(m_directory, wxString::Format("%016llx.luac", static_cast<unsigned long long>(key))).GetFullPath();
+}
+
+bool LuaChunkCache::LoadCached(lua_State* L, const wxString& filename, const wxString& chunkName) {
+    MappedFile cache;
+    if (!cache.Open(GetCachePath(filename)) || cache.GetSize() < sizeof(Header))
+        return false;
+
+    Header header;
+    std::memcpy(&header, cache.GetData(), sizeof(header));
+    if (std::memcmp(header.magic, kChunkMagic, sizeof(kChunkMagic)) != 0 ||
+        header.version != kChunkVersion || header.luaVersion != LUA_VERSION_NUM ||
+        header.pathLength > cache.GetSize() - sizeof(Header) ||
+        header.bytecodeSize != cache.GetSize() - sizeof(Header) - header.pathLength)
+        return false;
+
+    // The file name is only a hash of the path; make sure it is this script
+    const char* path = cache.GetData() + sizeof(Header);
+    const wxScopedCharBuffer utf8 = filename.utf8_str();
+    if (header.pathLength != utf8.length() || std::memcmp(path, utf8.data(), utf8.length()) != 0)
+        return false;
+
+    // Up to date: same size and time stamp, or same content
+    const wxFileName source(filename);
+    int64_t modified = 0;
+    if (!source.FileExists() || source.GetSize().GetValue() != header.sourceSize ||
+        !GetModificationTime(filename, modified))
+        return false;
+    const bool touched = modified != header.sourceModified;
+    if (touched) {
+        MappedFile content;
+        if (header.sourceSize != 0 && !content.Open(filename))
+            return false;
+        const uint64_t hash = header.sourceSize != 0 ? HashBytes(content.GetData(), content.GetSize())
+                                                     : HashBytes(nullptr, 0);
+        if (hash != header.sourceHash)
+            return false;
+    }
+
+    BufferReader reader = { path + header.pathLength, header.bytecodeSize };
+    if (lua_load(L, &BufferReader::Read, &reader, chunkName.utf8_str(), "b") != LUA_OK) {
+        // Damaged or written by an incompatible build; recompile
+        lua_pop(L, 1);
+        return false;
+    }
+
+    // Same content with a new time stamp; record the time so that the next
+    // load takes the fast path again
+    if (touched) {
+        header.sourceModified = modified;
+        std::string data(cache.GetData(), cache.GetSize());
+        std::memcpy(&data[0], &header, sizeof(header));
+        cache.Close();
+        WriteCache(filename, std::move(data));
+    }
+
+    return true;
+}
+
+int LuaChunkCache::LoadSource(lua_State* L, const wxString& filename, const wxString& chunkName) {
+    // Take the time stamp first; a concurrent edit then simply misses the cache
+    Header header = {};
+    if (!GetModificationTime(filename, header.sourceModified)) {
+        lua_pushfstring(L, "cannot open %s", static_cast<const char*>(filename.utf8_str()));
+        return LUA_ERRFILE;
+    }
+
+    // Empty scripts cannot be mapped but are valid
+    MappedFile source;
+    const bool mapped = source.Open(filename);
+    if (!mapped && wxFileName(filename).GetSize().GetValue() != 0) {
+        lua_pushfstring(L, "cannot read %s", static_cast<const char*>(filename.utf8_str()));
+        return LUA_ERRFILE;
+    }
+    const char* data = mapped ? source.GetData() : "";
+    const size_t size = mapped ? source.GetSize() : 0;
+
+    const int status = luaL_loadbufferx(L, data, size, chunkName.utf8_str(), "t");
+    if (status != LUA_OK)
+        return status;
+
+    // Keep debug information so that errors still report lines
+    std::string bytecode;
+    if (lua_dump(L, &WriteBytecode, &bytecode, 0) != 0)
+        return LUA_OK;
+
+    std::memcpy(header.magic, kChunkMagic, sizeof(kChunkMagic));
+    header.version = kChunkVersion;
+    header.luaVersion = LUA_VERSION_NUM;
+    header.sourceSize = size;
+    header.sourceHash = HashBytes(data, size);
+
+    const wxScopedCharBuffer path = filename.utf8_str();
+    header.pathLength = path.length();
+    header.bytecodeSize = bytecode.size();
+
+    std::string file;
+    file.reserve(sizeof(header) + path.length() + bytecode.size());
+    file.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.append(path.data(), path.length());
+    file += bytecode;
+
+    WriteCache(filename, std::move(file));
+    return LUA_OK;
+}
+
+void LuaChunkCache::WriteCache(const wxString& filename, std::string data) {
+    // Writing (and syncing) the cache file is off the startup path
+    const wxString cachePath = GetCachePath(filename);
+    const wxString directory = m_directory;
+    m_writer.Submit([cachePath, directory, data = std::move(data)]() {
+        wxFileName::Mkdir(directory, wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+        WriteFileAtomic(cachePath, data);
+    });
+}
+
+} // namespace ITD
@@ -0,0 +1,192 @@
+#include "lua/luaprofiler.h"
+#include "lua/luaallocator.h"
+#include "util/atomicfile.h"
+#include <wx/wx.h>
+#include <lua.hpp>
+#include <algorithm>
+#include <cstring>
+
+namespace ITD {
+
+LuaProfiler* LuaProfiler::s_active = nullptr;
+
+namespace {
+
+// Sort map entries by a cost, highest first, and keep the first few
+template<typename Map, typename Key>
+std::vector<typename Map::const_iterator> TopEntries(const Map& map, size_t limit, Key key) {
+    std::vector<typename Map::const_iterator> entries;
+    entries.reserve(map.size());
+    for (auto it = map.begin(); it != map.end(); ++it)
+        entries.push_back(it);
+
+    const size_t count = std::min(limit, entries.size());
+    std::partial_sort(entries.begin(), entries.begin() + count, entries.end(),
+                      [&key](const auto& a, const auto& b) { return key(a->second) > key(b->second); });
+    entries.resize(count);
+    return entries;
+}
+
+double ToMs(uint64_t ns) {
+    return static_cast<double>(ns) / 1e6;
+}
+
+} // namespace
+
+LuaProfiler::LuaProfiler(lua_State* L, const LuaAllocator* allocator)
+    : m_state(L),
+      m_allocator(allocator) {
+}
+
+LuaProfiler::~LuaProfiler() {
+    Stop();
+}
+
+bool LuaProfiler::Start(int instructionInterval) {
+    if (s_active && s_active != this)
+        return false;
+
+    m_total = Cost();
+    m_stacks.clear();
+    m_functions.clear();
+    m_lines.clear();
+
+    s_active = this;
+    m_lastSample = std::chrono::steady_clock::now();
+    m_lastAllocations = m_allocator ? m_allocator->GetStats().allocations : 0;
+    lua_sethook(m_state, &LuaProfiler::Hook, LUA_MASKCOUNT, std::max(instructionInterval, 1));
+    return true;
+}
+
+void LuaProfiler::Stop() {
+    if (s_active != this)
+        return;
+
+    lua_sethook(m_state, nullptr, 0, 0);
+    s_active = nullptr;
+}
+
+void LuaProfiler::Hook(lua_State* L, lua_Debug* debug) {
+    (void)debug;
+
+    // Coroutines keep an inherited hook after Stop(); drop it on first use
+    if (!s_active) {
+        lua_sethook(L, nullptr, 0, 0);
+        return;
+    }
+    s_active->Sample(L);
+}
+
+void LuaProfiler::Sample(lua_State* L) {
+    const auto now = std::chrono::steady_clock::now();
+    const uint64_t timeNs = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_lastSample).count());
+    m_lastSample = now;
+
+    uint64_t allocations = 0;
+    if (m_allocator) {
+        const uint64_t count = m_allocator->GetStats().allocations;
+        allocations = count - m_lastAllocations;
+        m_lastAllocations = count;
+    }
+
+    // Describe the frames, innermost first, reusing the string buffers
+    lua_Debug ar;
+    size_t depth = 0;
+    while (lua_getstack(L, static_cast<int>(depth), &ar)) {
+        lua_getinfo(L, depth == 0 ? "Snl" : "Sn", &ar);
+        if (depth == m_frames.size())
+            m_frames.emplace_back();
+
+        std::string& frame = m_frames[depth];
+        if (ar.name)
+            frame.assign(ar.name);
+        else if (std::strcmp(ar.what, "main") == 0)
+            frame.assign("main chunk");
+        else
+            frame.assign("?");
+        frame += " (";
+        frame += ar.short_src;
+        if (ar.linedefined > 0) {
+            frame += ':';
+            frame += std::to_string(ar.linedefined);
+        }
+        frame += ')';
+
+        // ';' separates frames in the folded format
+        std::replace(frame.begin(), frame.end(), ';', ',');
+
+        if (depth == 0) {
+            m_line.assign(ar.short_src);
+            m_line += ':';
+            m_line += std::to_string(ar.currentline);
+        }
+        ++depth;
+    }
+    if (depth == 0)
+        return;
+
+    auto add = [timeNs, allocations](Cost& cost) {
+        cost.timeNs += timeNs;
+        cost.allocations += allocations;
+        ++cost.samples;
+    };
+
+    add(m_total);
+    add(m_lines[m_line]);
+    add(m_functions[m_frames[0]].self);
+
+    // Count recursive functions once per sample
+    m_stack.clear();
+    for (size_t i = depth; i-- > 0;) {
+        const std::string& frame = m_frames[i];
+        if (std::find(m_frames.begin() + i + 1, m_frames.begin() + depth, frame) == m_frames.begin() + depth)
+            add(m_functions[frame].total);
+
+        m_stack += frame;
+        if (i != 0)
+            m_stack += ';';
+    }
+    add(m_stacks[m_stack]);
+}
+
+bool LuaProfiler::WriteFoldedStacks(const wxString& filename) const {
+    std::string data;
+    for (const auto& entry : m_stacks) {
+        data += entry.first;
+        data += ' ';
+        data += std::to_string(std::max<uint64_t>(entry.second.timeNs / 1000, 1));
+        data += '\n';
+    }
+    return WriteFileAtomic(filename, data);
+}
+
+wxString LuaProfiler::GetReport(size_t limit) const {
+    wxString report = wxString::Format("Lua profile: %llu samples, %.1f ms, %llu allocations\n",
+                                       static_cast<unsigned long long>(m_total.samples), ToMs(m_total.timeNs),
+                                       static_cast<unsigned long long>(m_total.allocations));
+
+    report += "\nFunctions by self time\n";
+    report += wxString::Format("%10s %10s %8s %10s  %s\n", "self ms", "total ms", "samples", "allocs", "function");
+    for (const auto& it : TopEntries(m_functions, limit, [](const FunctionCost& cost) { return cost.self.timeNs; })) {
+        report += wxString::Format("%10.2f %10.2f %8llu %10llu  %s\n",
+                                   ToMs(it->second.self.timeNs), ToMs(it->second.total.timeNs),
+                                   static_cast<unsigned long long>(it->second.self.samples),
+                                   static_cast<unsigned long long>(it->second.self.allocations),
+                                   wxString::FromUTF8(it->first.c_str()));
+    }
+
+    report += "\nLines by time\n";
+    report += wxString::Format("%10s %8s %10s  %s\n", "ms", "samples", "allocs", "line");
+    for (const auto& it : TopEntries(m_lines, limit, [](const Cost& cost) { return cost.timeNs; })) {
+        report += wxString::Format("%10.2f %8llu %10llu  %s\n",
+                                   ToMs(it->second.timeNs),
+                                   static_cast<unsigned long long>(it->second.samples),
+                                   static_cast<unsigned long long>(it->second.allocations),
+                                   wxString::FromUTF8(it->first.c_str()));
+    }
+
+    return report;
+}
+
+} // namespace ITD
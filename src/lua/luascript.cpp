@@ -1 +1,810 @@
-// Placeholder  
+#include "lua/luascript.h"
+#include "app.h"
+#include "util/atomicfile.h"
+#include "util/mappedfile.h"
+#include <wx/wx.h>
+#include <wx/dir.h>
+#include <wx/filename.h>
+#include <wx/textdlg.h>
+#include <algorithm>
+
+namespace ITD {
+
+namespace {
+
+// Registry key of the table holding key binding callbacks
+constexpr const char* kKeyBindingsKey = "ITD.KeyBindings";
+
+// Registry key of the owning LuaScript
+constexpr const char* kScriptKey = "ITD.LuaScript";
+
+// Event names for itd.On(), in LuaEvent order
+const char* const kEventNames[] = {
+    "KeyPress",
+    "WindowFocus",
+    "CommandExecuted",
+    "SearchResultOpened",
+    nullptr
+};
+static_assert(sizeof(kEventNames) / sizeof(kEventNames[0]) == static_cast<size_t>(LuaEvent::Count) + 1,
+              "kEventNames must match LuaEvent");
+
+MainFrame* GetMainFrame() {
+    return wxGetApp().GetMainFrame();
+}
+
+// Batches opened with itd.BeginBatch() and not committed yet
+int s_openBatches = 0;
+
+void CommitOpenBatches() {
+    while (s_openBatches > 0)
+        LuaAPI::CommitBatch();
+}
+
+// Latency of an event handler, for itd.GetHandlerLatency()
+struct HandlerLatency {
+    LuaEvent event;
+    int handlerId;
+    LatencyHistogram latency;
+};
+
+// Push a list of HandlerLatency (the light userdata argument) as tables
+int PushHandlerLatency(lua_State* L) {
+    const auto& handlers = *static_cast<const std::vector<HandlerLatency>*>(lua_touserdata(L, 1));
+    const LuaScript* script = LuaScript::FromState(L);
+    lua_createtable(L, static_cast<int>(handlers.size()), 0);
+    for (size_t index = 0; index < handlers.size(); ++index) {
+        const HandlerLatency& handler = handlers[index];
+        const LatencyHistogram& latency = handler.latency;
+        lua_createtable(L, 0, 10);
+        lua_pushstring(L, LuaScript::GetEventName(handler.event));
+        lua_setfield(L, -2, "event");
+        lua_pushinteger(L, handler.handlerId);
+        lua_setfield(L, -2, "id");
+
+        // Where the handler was defined
+        lua_Debug ar;
+        if (script->PushEventHandler(L, handler.event, handler.handlerId)) {
+            lua_getinfo(L, ">S", &ar);
+            lua_pushfstring(L, "%s:%d", ar.short_src, ar.linedefined);
+            lua_setfield(L, -2, "source");
+        }
+
+        auto set = [L](const char* name, lua_Number value) {
+            lua_pushnumber(L, value);
+            lua_setfield(L, -2, name);
+        };
+        lua_pushinteger(L, static_cast<lua_Integer>(latency.count));
+        lua_setfield(L, -2, "count");
+        set("meanUs", latency.GetMeanUs());
+        set("maxUs", static_cast<lua_Number>(latency.maxNs) / 1000.0);
+        set("p50Us", static_cast<lua_Number>(latency.GetPercentileUs(0.50)));
+        set("p95Us", static_cast<lua_Number>(latency.GetPercentileUs(0.95)));
+        set("p99Us", static_cast<lua_Number>(latency.GetPercentileUs(0.99)));
+
+        // buckets[i] counts calls shorter than 2^(i-1) µs
+        lua_createtable(L, static_cast<int>(LatencyHistogram::kBucketCount), 0);
+        for (size_t i = 0; i < LatencyHistogram::kBucketCount; ++i) {
+            lua_pushinteger(L, latency.buckets[i]);
+            lua_rawseti(L, -2, static_cast<lua_Integer>(i + 1));
+        }
+        lua_setfield(L, -2, "buckets");
+
+        lua_rawseti(L, -2, static_cast<lua_Integer>(index + 1));
+    }
+    return 1;
+}
+
+// Tick scheduler statistics, for itd.GetTickStats()
+struct TickStats {
+    uint64_t wakeups;
+    std::vector<TickScheduler::TaskStats> tasks;
+};
+
+// Push a TickStats (the light userdata argument) as a table
+int PushTickStats(lua_State* L) {
+    const TickStats& stats = *static_cast<const TickStats*>(lua_touserdata(L, 1));
+    lua_createtable(L, 0, 2);
+    lua_pushinteger(L, static_cast<lua_Integer>(stats.wakeups));
+    lua_setfield(L, -2, "wakeups");
+
+    lua_createtable(L, static_cast<int>(stats.tasks.size()), 0);
+    for (size_t index = 0; index < stats.tasks.size(); ++index) {
+        const TickScheduler::TaskStats& task = stats.tasks[index];
+        lua_createtable(L, 0, 8);
+        LuaBinding::Push(L, task.name);
+        lua_setfield(L, -2, "name");
+        lua_pushinteger(L, task.intervalMs);
+        lua_setfield(L, -2, "intervalMs");
+        lua_pushboolean(L, task.suspended);
+        lua_setfield(L, -2, "suspended");
+        lua_pushinteger(L, static_cast<lua_Integer>(task.runs));
+        lua_setfield(L, -2, "runs");
+        lua_pushinteger(L, static_cast<lua_Integer>(task.suspensions));
+        lua_setfield(L, -2, "suspensions");
+        lua_pushnumber(L, task.cost.GetMeanUs());
+        lua_setfield(L, -2, "meanUs");
+        lua_pushnumber(L, static_cast<lua_Number>(task.cost.maxNs) / 1000.0);
+        lua_setfield(L, -2, "maxUs");
+        lua_pushinteger(L, static_cast<lua_Integer>(task.cost.GetPercentileUs(0.95)));
+        lua_setfield(L, -2, "p95Us");
+        lua_rawseti(L, -2, static_cast<lua_Integer>(index + 1));
+    }
+    lua_setfield(L, -2, "tasks");
+    return 1;
+}
+
+} // namespace
+
+LuaScript::LuaScript() {
+    m_luaState = m_allocator.NewState();
+    luaL_openlibs(m_luaState);
+    m_async = std::make_unique<LuaAsync>(m_luaState, [this](const wxString& message) {
+        m_lastError = message;
+        wxLogDebug("Lua error: %s", m_lastError);
+    });
+    RegisterStandardFunctions();
+}
+
+LuaScript::~LuaScript() {
+    // Stop background scripts, I/O and sampling first; they use this state
+    m_workerPool.reset();
+    m_async.reset();
+    m_profiler.reset();
+
+    if (m_luaState)
+        lua_close(m_luaState);
+}
+
+bool LuaScript::LoadFile(const wxString& filename) {
+    if (m_chunkCache.Load(m_luaState, filename) != LUA_OK) {
+        HandleLuaError();
+        return false;
+    }
+
+    if (!RunChunk())
+        return false;
+
+    if (std::find(m_loadedScripts.begin(), m_loadedScripts.end(), filename) == m_loadedScripts.end())
+        m_loadedScripts.push_back(filename);
+    return true;
+}
+
+bool LuaScript::Execute(const wxString& script) {
+    const wxScopedCharBuffer utf8 = script.utf8_str();
+    if (luaL_loadbufferx(m_luaState, utf8.data(), utf8.length(), "=script", "t") != LUA_OK) {
+        HandleLuaError();
+        return false;
+    }
+
+    return RunChunk();
+}
+
+bool LuaScript::FunctionExists(const std::string& functionName) {
+    const bool exists = lua_getglobal(m_luaState, functionName.c_str()) == LUA_TFUNCTION;
+    lua_pop(m_luaState, 1);
+    return exists;
+}
+
+void LuaScript::AddLuaPath(const wxString& path) {
+    lua_getglobal(m_luaState, "package");
+    if (!lua_istable(m_luaState, -1)) {
+        lua_pop(m_luaState, 1);
+        return;
+    }
+
+    // Prepend so that user modules take precedence
+    const wxString directory = wxFileName::DirName(path).GetPath(wxPATH_GET_VOLUME | wxPATH_GET_SEPARATOR);
+    lua_getfield(m_luaState, -1, "path");
+    const wxString current = wxString::FromUTF8(lua_tostring(m_luaState, -1));
+    lua_pop(m_luaState, 1);
+
+    const wxString updated = directory + "?.lua;" + directory + "?" + wxFileName::GetPathSeparator() +
+                             "init.lua;" + current;
+    LuaBinding::Push(m_luaState, updated);
+    lua_setfield(m_luaState, -2, "path");
+    lua_pop(m_luaState, 1);
+}
+
+LuaWorkerPool::JobId LuaScript::RunInBackground(const wxString& source, const LuaWorkerPool::JobOptions& options,
+                                                LuaWorkerPool::CompletionHandler onComplete,
+                                                LuaWorkerPool::MessageHandler onMessage) {
+    if (!m_workerPool)
+        m_workerPool = std::make_unique<LuaWorkerPool>();
+    return m_workerPool->Submit(source, options, std::move(onComplete), std::move(onMessage));
+}
+
+bool LuaScript::CancelBackground(LuaWorkerPool::JobId id) {
+    return m_workerPool && m_workerPool->Cancel(id);
+}
+
+int LuaScript::AddEventHandler(LuaEvent event, int index) {
+    lua_pushvalue(m_luaState, index);
+    const int ref = luaL_ref(m_luaState, LUA_REGISTRYINDEX);
+    m_eventHandlers[static_cast<size_t>(event)].push_back(EventHandler{ ++m_nextHandlerId, ref, LatencyHistogram() });
+    return m_nextHandlerId;
+}
+
+bool LuaScript::RemoveEventHandler(LuaEvent event, int handlerId) {
+    std::vector<EventHandler>& handlers = m_eventHandlers[static_cast<size_t>(event)];
+    auto it = std::find_if(handlers.begin(), handlers.end(), [handlerId](const EventHandler& handler) {
+        return handler.id == handlerId && handler.ref != LUA_NOREF;
+    });
+    if (it == handlers.end())
+        return false;
+
+    luaL_unref(m_luaState, LUA_REGISTRYINDEX, it->ref);
+    if (m_eventDepth > 0) {
+        // FireEvent() is iterating over the vector
+        it->ref = LUA_NOREF;
+        m_eventHandlersRemoved = true;
+    } else {
+        handlers.erase(it);
+    }
+    return true;
+}
+
+bool LuaScript::PushEventHandler(lua_State* L, LuaEvent event, int handlerId) const {
+    for (const EventHandler& handler : m_eventHandlers[static_cast<size_t>(event)]) {
+        if (handler.id == handlerId && handler.ref != LUA_NOREF) {
+            lua_rawgeti(L, LUA_REGISTRYINDEX, handler.ref);
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* LuaScript::GetEventName(LuaEvent event) {
+    return kEventNames[static_cast<size_t>(event)];
+}
+
+void LuaScript::CompactEventHandlers() {
+    for (std::vector<EventHandler>& handlers : m_eventHandlers) {
+        handlers.erase(std::remove_if(handlers.begin(), handlers.end(),
+                                      [](const EventHandler& handler) { return handler.ref == LUA_NOREF; }),
+                       handlers.end());
+    }
+    m_eventHandlersRemoved = false;
+}
+
+void LuaScript::ForEachHandlerLatency(const std::function<void(LuaEvent event, int handlerId,
+                                                               const LatencyHistogram& latency)>& visit) const {
+    for (size_t i = 0; i < m_eventHandlers.size(); ++i) {
+        for (const EventHandler& handler : m_eventHandlers[i]) {
+            if (handler.ref != LUA_NOREF)
+                visit(static_cast<LuaEvent>(i), handler.id, handler.latency);
+        }
+    }
+}
+
+bool LuaScript::StartProfiler(int instructionInterval) {
+    if (!m_profiler)
+        m_profiler = std::make_unique<LuaProfiler>(m_luaState, &m_allocator);
+    return m_profiler->Start(instructionInterval);
+}
+
+void LuaScript::StopProfiler() {
+    if (m_profiler)
+        m_profiler->Stop();
+}
+
+LuaScript* LuaScript::FromState(lua_State* L) {
+    lua_getfield(L, LUA_REGISTRYINDEX, kScriptKey);
+    LuaScript* script = static_cast<LuaScript*>(lua_touserdata(L, -1));
+    lua_pop(L, 1);
+    return script;
+}
+
+void LuaScript::RegisterStandardFunctions() {
+    lua_State* L = m_luaState;
+
+    lua_pushlightuserdata(L, this);
+    lua_setfield(L, LUA_REGISTRYINDEX, kScriptKey);
+
+    // Key binding callbacks live in the registry
+    lua_newtable(L);
+    lua_setfield(L, LUA_REGISTRYINDEX, kKeyBindingsKey);
+
+    lua_newtable(L);
+    auto add = [L](const char* name) { lua_setfield(L, -2, name); };
+
+    // Terminal functions
+    LuaBinding::PushFunction<&LuaAPI::ExecuteCommand>(L);
+    add("ExecuteCommand");
+    LuaBinding::PushFunction<&LuaAPI::GetCurrentDirectory>(L);
+    add("GetCurrentDirectory");
+
+    // Widget functions
+    LuaBinding::PushFunction<&LuaAPI::CreateWidget>(L);
+    add("CreateWidget");
+    LuaBinding::PushFunction<&LuaAPI::RemoveWidget>(L);
+    add("RemoveWidget");
+
+    // Window management functions
+    LuaBinding::PushFunction<&LuaAPI::SetLayoutType>(L);
+    add("SetLayoutType");
+    LuaBinding::PushFunction<&LuaAPI::FocusWindow>(L);
+    add("FocusWindow");
+    LuaBinding::PushFunction<&LuaAPI::SplitWindow>(L);
+    add("SplitWindow");
+    LuaBinding::PushFunction<&LuaAPI::SaveWorkspace>(L);
+    add("SaveWorkspace");
+    LuaBinding::PushFunction<&LuaAPI::LoadWorkspace>(L);
+    add("LoadWorkspace");
+    LuaBinding::PushFunction<&LuaAPI::ListWorkspaces>(L);
+    add("ListWorkspaces");
+    LuaBinding::PushFunction<&LuaAPI::SwitchDesktop>(L);
+    add("SwitchDesktop");
+    LuaBinding::PushFunction<&LuaAPI::GetDesktop>(L);
+    add("GetDesktop");
+    LuaBinding::PushFunction<&LuaAPI::MoveWindowToDesktop>(L);
+    add("MoveWindowToDesktop");
+
+    // Batch functions
+    LuaBinding::PushFunction<&LuaAPI::BeginBatch>(L);
+    add("BeginBatch");
+    LuaBinding::PushFunction<&LuaAPI::CommitBatch>(L);
+    add("CommitBatch");
+    LuaBinding::PushFunction<&LuaAPI::Batch>(L);
+    add("Batch");
+
+    // UI functions
+    LuaBinding::PushFunction<&LuaAPI::SetTransparency>(L);
+    add("SetTransparency");
+    LuaBinding::PushFunction<&LuaAPI::ShowMessage>(L);
+    add("ShowMessage");
+    LuaBinding::PushFunction<&LuaAPI::PromptInput>(L);
+    add("PromptInput");
+    LuaBinding::PushFunction<&LuaAPI::Notify>(L);
+    add("Notify");
+
+    // File system functions
+    LuaBinding::PushFunction<&LuaAPI::ListDirectory>(L);
+    add("ListDirectory");
+    LuaBinding::PushFunction<&LuaAPI::FileExists>(L);
+    add("FileExists");
+    LuaBinding::PushFunction<&LuaAPI::ReadFile>(L);
+    add("ReadFile");
+    LuaBinding::PushFunction<&LuaAPI::WriteFile>(L);
+    add("WriteFile");
+
+    // Key binding functions
+    LuaBinding::PushFunction<&LuaAPI::RegisterKeyBinding>(L);
+    add("RegisterKeyBinding");
+    LuaBinding::PushFunction<&LuaAPI::UnregisterKeyBinding>(L);
+    add("UnregisterKeyBinding");
+
+    // Background script functions
+    LuaBinding::PushFunction<&LuaAPI::RunInBackground>(L);
+    add("RunInBackground");
+    LuaBinding::PushFunction<&LuaAPI::CancelBackground>(L);
+    add("CancelBackground");
+
+    // Event functions
+    LuaBinding::PushFunction<&LuaAPI::On>(L);
+    add("On");
+    LuaBinding::PushFunction<&LuaAPI::Off>(L);
+    add("Off");
+
+    // Asynchronous file functions
+    m_async->RegisterFunctions();
+
+    // Diagnostics
+    LuaBinding::PushFunction<&LuaAPI::GetMemoryStats>(L);
+    add("GetMemoryStats");
+    LuaBinding::PushFunction<&LuaAPI::GetHandlerLatency>(L);
+    add("GetHandlerLatency");
+    LuaBinding::PushFunction<&LuaAPI::GetTickStats>(L);
+    add("GetTickStats");
+    LuaBinding::PushFunction<&LuaAPI::StartProfiler>(L);
+    add("StartProfiler");
+    LuaBinding::PushFunction<&LuaAPI::StopProfiler>(L);
+    add("StopProfiler");
+    LuaBinding::PushFunction<&LuaAPI::GetProfileReport>(L);
+    add("GetProfileReport");
+
+    lua_setglobal(L, "itd");
+}
+
+bool LuaScript::RunChunk() {
+    LuaProfiler::MarkEntry();
+    if (lua_pcall(m_luaState, 0, 0, 0) != LUA_OK) {
+        HandleLuaError();
+        return false;
+    }
+    return true;
+}
+
+void LuaScript::HandleLuaError() {
+    size_t length = 0;
+    const char* message = lua_tolstring(m_luaState, -1, &length);
+    m_lastError = message ? wxString::FromUTF8(message, length) : wxString("Unknown Lua error");
+    lua_pop(m_luaState, 1);
+
+    wxLogDebug("Lua error: %s", m_lastError);
+}
+
+namespace LuaAPI {
+
+bool ExecuteCommand(const wxString& command) {
+    MainFrame* frame = GetMainFrame();
+    return frame && frame->GetTerminal()->ExecuteCommand(command);
+}
+
+wxString GetCurrentDirectory() {
+    MainFrame* frame = GetMainFrame();
+    return frame ? frame->GetTerminal()->GetCurrentDirectory() : wxGetCwd();
+}
+
+bool CreateWidget(const wxString& type, const std::optional<wxString>& title) {
+    MainFrame* frame = GetMainFrame();
+    return frame && frame->GetWidgetManager()->CreateWidget(type, title.value_or(wxEmptyString)) != nullptr;
+}
+
+bool RemoveWidget(const wxString& title) {
+    MainFrame* frame = GetMainFrame();
+    if (!frame)
+        return false;
+
+    WidgetManager* widgetManager = frame->GetWidgetManager();
+    for (Widget* widget : widgetManager->GetWidgets()) {
+        if (widget->GetTitle() == title)
+            return widgetManager->RemoveWidget(widget);
+    }
+    return false;
+}
+
+bool SetLayoutType(const wxString& layout) {
+    MainFrame* frame = GetMainFrame();
+    if (!frame)
+        return false;
+
+    TilingManager::LayoutType type;
+    if (!TilingManager::ParseLayoutName(layout, type))
+        return false;
+    frame->GetTilingManager()->SetLayoutType(type);
+    return true;
+}
+
+bool FocusWindow(const wxString& name) {
+    MainFrame* frame = GetMainFrame();
+    if (!frame)
+        return false;
+
+    TilingManager* tilingManager = frame->GetTilingManager();
+    for (wxWindow* window : tilingManager->GetWindows()) {
+        if (tilingManager->GetWindowName(window) == name) {
+            tilingManager->FocusWindow(window);
+            return true;
+        }
+    }
+    return false;
+}
+
+void SplitWindow(const std::optional<wxString>& direction) {
+    MainFrame* frame = GetMainFrame();
+    if (frame)
+        frame->GetTilingManager()->SplitWindow(direction.value_or("horizontal").IsSameAs("horizontal", false));
+}
+
+bool SaveWorkspace(const wxString& name) {
+    MainFrame* frame = GetMainFrame();
+    return frame && frame->GetWorkspaceManager()->Save(name);
+}
+
+bool LoadWorkspace(const wxString& name) {
+    MainFrame* frame = GetMainFrame();
+    return frame && frame->GetWorkspaceManager()->Restore(name);
+}
+
+std::vector<wxString> ListWorkspaces() {
+    MainFrame* frame = GetMainFrame();
+    return frame ? frame->GetWorkspaceManager()->GetWorkspaceNames() : std::vector<wxString>();
+}
+
+// Desktops are numbered from 1 in scripts
+bool SwitchDesktop(int desktop) {
+    MainFrame* frame = GetMainFrame();
+    return frame && desktop >= 1 && frame->GetTilingManager()->SwitchDesktop(static_cast<size_t>(desktop - 1));
+}
+
+int GetDesktop() {
+    MainFrame* frame = GetMainFrame();
+    return frame ? static_cast<int>(frame->GetTilingManager()->GetActiveDesktop()) + 1 : 0;
+}
+
+bool MoveWindowToDesktop(const wxString& name, int desktop) {
+    MainFrame* frame = GetMainFrame();
+    if (!frame || desktop < 1)
+        return false;
+
+    TilingManager* tilingManager = frame->GetTilingManager();
+    for (wxWindow* window : tilingManager->GetWindows()) {
+        if (tilingManager->GetWindowName(window) == name)
+            return tilingManager->MoveWindowToDesktop(window, static_cast<size_t>(desktop - 1));
+    }
+    return false;
+}
+
+void BeginBatch() {
+    MainFrame* frame = GetMainFrame();
+    if (!frame)
+        return;
+
+    // Scripts cannot keep the UI frozen past the current event
+    if (s_openBatches++ == 0)
+        wxGetApp().CallAfter([]() { CommitOpenBatches(); });
+    frame->BeginUpdateBatch();
+}
+
+bool CommitBatch() {
+    if (s_openBatches == 0)
+        return false;
+
+    --s_openBatches;
+    if (MainFrame* frame = GetMainFrame())
+        frame->EndUpdateBatch();
+    return true;
+}
+
+int Batch(lua_State* L) {
+    // itd.Batch(fn, ...) -> results of fn; the batch is committed even if fn fails
+    luaL_checktype(L, 1, LUA_TFUNCTION);
+
+    BeginBatch();
+    const int status = lua_pcall(L, lua_gettop(L) - 1, LUA_MULTRET, 0);
+    CommitBatch();
+
+    if (status != LUA_OK)
+        return lua_error(L);
+    return lua_gettop(L);
+}
+
+void SetTransparency(int alpha) {
+    // Goes through the configuration so that every component picks it up
+    ConfigManager& config = wxGetApp().GetConfigManager();
+    config.SetBool("ui", "transparencyEnabled", true);
+    config.SetInt("ui", "transparency", std::clamp(alpha, 0, 255));
+}
+
+void ShowMessage(const wxString& message, const std::optional<wxString>& title) {
+    wxMessageBox(message, title.value_or("ITD"), wxOK | wxICON_INFORMATION, GetMainFrame());
+}
+
+wxString PromptInput(const wxString& message, const std::optional<wxString>& defaultValue) {
+    return wxGetTextFromUser(message, "ITD", defaultValue.value_or(wxEmptyString), GetMainFrame());
+}
+
+bool Notify(const wxString& title, const std::optional<wxString>& message, const std::optional<wxString>& level) {
+    // Also bound in background workers; posting is safe from any thread
+    Notification notification;
+    notification.source = "lua";
+    notification.title = title;
+    notification.message = message.value_or(wxEmptyString);
+    if (level && level->CmpNoCase("warning") == 0)
+        notification.level = Notification::Level::Warning;
+    else if (level && level->CmpNoCase("error") == 0)
+        notification.level = Notification::Level::Error;
+    return wxGetApp().GetNotificationCenter().Post(std::move(notification));
+}
+
+std::optional<std::vector<wxString>> ListDirectory(const wxString& path) {
+    wxDir dir(path);
+    if (!dir.IsOpened())
+        return std::nullopt;
+
+    std::vector<wxString> entries;
+    wxString name;
+    bool more = dir.GetFirst(&name);
+    while (more) {
+        entries.push_back(name);
+        more = dir.GetNext(&name);
+    }
+    return entries;
+}
+
+bool FileExists(const wxString& path) {
+    return wxFileName::FileExists(path);
+}
+
+std::optional<std::string> ReadFile(const wxString& path) {
+    MappedFile file;
+    if (!file.Open(path)) {
+        // Empty files cannot be mapped; any other failure is an error
+        if (wxFileName::FileExists(path) && wxFileName(path).GetSize().GetValue() == 0)
+            return std::string();
+        return std::nullopt;
+    }
+    return std::string(file.GetData(), file.GetSize());
+}
+
+bool WriteFile(const wxString& path, std::string_view content) {
+    return WriteFileAtomic(path, content.data(), content.size());
+}
+
+int RegisterKeyBinding(lua_State* L) {
+    luaL_checkstring(L, 1);
+    luaL_checktype(L, 2, LUA_TFUNCTION);
+
+    lua_getfield(L, LUA_REGISTRYINDEX, kKeyBindingsKey);
+    lua_pushvalue(L, 1);
+    lua_pushvalue(L, 2);
+    lua_rawset(L, -3);
+    return 0;
+}
+
+int UnregisterKeyBinding(lua_State* L) {
+    luaL_checkstring(L, 1);
+
+    lua_getfield(L, LUA_REGISTRYINDEX, kKeyBindingsKey);
+    lua_pushvalue(L, 1);
+    lua_rawget(L, -2);
+    const bool existed = !lua_isnil(L, -1);
+    lua_pop(L, 1);
+
+    lua_pushvalue(L, 1);
+    lua_pushnil(L);
+    lua_rawset(L, -3);
+
+    lua_pushboolean(L, existed);
+    return 1;
+}
+
+int RunInBackground(lua_State* L) {
+    // itd.RunInBackground(source, [options], [onMessage], [onDone])
+    size_t length = 0;
+    const char* source = luaL_checklstring(L, 1, &length);
+
+    LuaWorkerPool::JobOptions options;
+    if (!lua_isnoneornil(L, 2)) {
+        luaL_checktype(L, 2, LUA_TTABLE);
+        lua_getfield(L, 2, "budget");
+        const lua_Integer budget = luaL_optinteger(L, -1, 0);
+        luaL_argcheck(L, budget >= 0, 2, "budget must not be negative");
+        options.instructionBudget = static_cast<uint64_t>(budget);
+        lua_getfield(L, 2, "file");
+        options.isFile = lua_toboolean(L, -1) != 0;
+        lua_pop(L, 2);
+    }
+
+    auto reference = [L](int index) {
+        if (lua_isnoneornil(L, index))
+            return LUA_NOREF;
+        luaL_checktype(L, index, LUA_TFUNCTION);
+        lua_pushvalue(L, index);
+        return luaL_ref(L, LUA_REGISTRYINDEX);
+    };
+    const int messageRef = reference(3);
+    const int doneRef = reference(4);
+
+    LuaScript* script = LuaScript::FromState(L);
+    LuaWorkerPool::MessageHandler onMessage;
+    if (messageRef != LUA_NOREF) {
+        onMessage = [script, messageRef](LuaWorkerPool::JobId id, const wxString& name, const wxString& value) {
+            script->CallRef(messageRef, id, name, value);
+        };
+    }
+    auto onComplete = [script, messageRef, doneRef](LuaWorkerPool::JobId id, bool success, const wxString& error) {
+        if (doneRef != LUA_NOREF)
+            script->CallRef(doneRef, id, success, error);
+        luaL_unref(script->m_luaState, LUA_REGISTRYINDEX, messageRef);
+        luaL_unref(script->m_luaState, LUA_REGISTRYINDEX, doneRef);
+    };
+
+    const LuaWorkerPool::JobId id = script->RunInBackground(wxString::FromUTF8(source, length), options,
+                                                           onComplete, onMessage);
+    lua_pushinteger(L, static_cast<lua_Integer>(id));
+    return 1;
+}
+
+int CancelBackground(lua_State* L) {
+    const lua_Integer id = luaL_checkinteger(L, 1);
+    lua_pushboolean(L, LuaScript::FromState(L)->CancelBackground(static_cast<LuaWorkerPool::JobId>(id)));
+    return 1;
+}
+
+int On(lua_State* L) {
+    // itd.On(event, handler) -> handler ID
+    const LuaEvent event = static_cast<LuaEvent>(luaL_checkoption(L, 1, nullptr, kEventNames));
+    luaL_checktype(L, 2, LUA_TFUNCTION);
+
+    lua_pushinteger(L, LuaScript::FromState(L)->AddEventHandler(event, 2));
+    return 1;
+}
+
+int Off(lua_State* L) {
+    // itd.Off(event, id) -> removed
+    const LuaEvent event = static_cast<LuaEvent>(luaL_checkoption(L, 1, nullptr, kEventNames));
+    const lua_Integer id = luaL_checkinteger(L, 2);
+
+    lua_pushboolean(L, LuaScript::FromState(L)->RemoveEventHandler(event, static_cast<int>(id)));
+    return 1;
+}
+
+int GetMemoryStats(lua_State* L) {
+    // Works in any state created by a LuaAllocator, including worker states
+    void* userData = nullptr;
+    if (lua_getallocf(L, &userData) != &LuaAllocator::Allocate)
+        return 0;
+
+    const LuaAllocator& allocator = *static_cast<LuaAllocator*>(userData);
+    const LuaAllocator::Stats& stats = allocator.GetStats();
+    auto set = [L](const char* name, uint64_t value) {
+        lua_pushinteger(L, static_cast<lua_Integer>(value));
+        lua_setfield(L, -2, name);
+    };
+
+    lua_createtable(L, 0, 9);
+    set("bytesInUse", stats.bytesInUse);
+    set("peakBytesInUse", stats.peakBytesInUse);
+    set("arenaBytes", stats.arenaBytes);
+    set("largeBytes", stats.largeBytes);
+    set("allocations", stats.allocations);
+    set("frees", stats.frees);
+    set("pooledAllocations", stats.pooledAllocations);
+    set("refusedAllocations", stats.refusedAllocations);
+    set("limit", allocator.GetLimit());
+    return 1;
+}
+
+int GetHandlerLatency(lua_State* L) {
+    // List of { event, id, source, count, meanUs, maxUs, p50Us, p95Us, p99Us, buckets }
+    int status;
+    {
+        // Copied first and pushed under lua_pcall, so that a Lua error
+        // never unwinds through C++ frames
+        std::vector<HandlerLatency> handlers;
+        LuaScript::FromState(L)->ForEachHandlerLatency([&handlers](LuaEvent event, int handlerId,
+                                                                   const LatencyHistogram& latency) {
+            handlers.push_back(HandlerLatency{ event, handlerId, latency });
+        });
+
+        lua_pushcfunction(L, &PushHandlerLatency);
+        lua_pushlightuserdata(L, &handlers);
+        status = lua_pcall(L, 1, 1, 0);
+    }
+    return status == LUA_OK ? 1 : lua_error(L);
+}
+
+int GetTickStats(lua_State* L) {
+    // { wakeups, tasks = list of { name, intervalMs, suspended, runs, suspensions, meanUs, maxUs, p95Us } }
+    int status;
+    {
+        // Copied first and pushed under lua_pcall, like GetHandlerLatency()
+        const TickScheduler& scheduler = wxGetApp().GetTickScheduler();
+        TickStats stats{ scheduler.GetWakeupCount(), {} };
+        scheduler.ForEachTask([&stats](TickScheduler::TaskId, const TickScheduler::TaskStats& task) {
+            stats.tasks.push_back(task);
+        });
+
+        lua_pushcfunction(L, &PushTickStats);
+        lua_pushlightuserdata(L, &stats);
+        status = lua_pcall(L, 1, 1, 0);
+    }
+    return status == LUA_OK ? 1 : lua_error(L);
+}
+
+bool StartProfiler(const std::optional<int>& instructionInterval) {
+    return wxGetApp().GetLuaScript().StartProfiler(instructionInterval.value_or(LuaProfiler::kDefaultInterval));
+}
+
+bool StopProfiler(const std::optional<wxString>& foldedStacksFile) {
+    LuaScript& script = wxGetApp().GetLuaScript();
+    script.StopProfiler();
+
+    const LuaProfiler* profiler = script.GetProfiler();
+    if (!profiler)
+        return false;
+    return !foldedStacksFile || profiler->WriteFoldedStacks(*foldedStacksFile);
+}
+
+wxString GetProfileReport(const std::optional<int>& limit) {
+    const LuaProfiler* profiler = wxGetApp().GetLuaScript().GetProfiler();
+    if (!profiler)
+        return "The profiler has not been started";
+    return profiler->GetReport(static_cast<size_t>(std::max(limit.value_or(20), 1)));
+}
+
+} // namespace LuaAPI
+
+} // namespace ITD
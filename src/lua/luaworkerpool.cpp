@@ -0,0 +1,361 @@
+#include "lua/luaworkerpool.h"
+#include "lua/luascript.h"
+#include "lua/luachunkcache.h"
+#include "lua/luaallocator.h"
+#include <wx/wx.h>
+#include <lua.hpp>
+#include <algorithm>
+
+namespace ITD {
+
+namespace {
+
+// Instructions between two budget/cancellation checks
+constexpr int kHookInterval = 1000;
+
+// Memory limit of each worker state
+constexpr size_t kWorkerMemoryLimit = 64 * 1024 * 1024;
+
+// Registry field holding the snapshot of the shared tables
+constexpr const char* kSnapshotKey = "ITD.SharedTables";
+
+// Record the contents and metatable of the table on top of the stack into
+// the snapshot table at index snapshots, keyed by the table; pops the table
+void SnapshotTable(lua_State* L, int snapshots) {
+    const int table = lua_gettop(L);
+    if (!lua_istable(L, table)) {
+        lua_pop(L, 1);
+        return;
+    }
+
+    // Tables reachable twice (_G, the libraries in package.loaded) are taken once
+    lua_pushvalue(L, table);
+    if (lua_rawget(L, snapshots) != LUA_TNIL) {
+        lua_pop(L, 2);
+        return;
+    }
+    lua_pop(L, 1);
+
+    lua_pushvalue(L, table);
+    lua_createtable(L, 2, 0);
+    lua_newtable(L);
+    lua_pushnil(L);
+    while (lua_next(L, table) != 0) {
+        lua_pushvalue(L, -2);
+        lua_insert(L, -2);
+        lua_rawset(L, -4);
+    }
+    lua_rawseti(L, -2, 1);
+    if (lua_getmetatable(L, table))
+        lua_rawseti(L, -2, 2);
+    lua_rawset(L, snapshots);
+    lua_pop(L, 1);
+}
+
+// Snapshot everything jobs share: the globals, each library table (also
+// reachable through package.loaded) and the string metatable
+void SnapshotSharedTables(lua_State* L) {
+    lua_newtable(L);
+    const int snapshots = lua_gettop(L);
+
+    lua_rawgeti(L, LUA_REGISTRYINDEX, LUA_RIDX_GLOBALS);
+    const int globals = lua_gettop(L);
+    lua_pushnil(L);
+    while (lua_next(L, globals) != 0) {
+        lua_pushvalue(L, -1);
+        SnapshotTable(L, snapshots);
+        lua_pop(L, 1);
+    }
+    SnapshotTable(L, snapshots);
+
+    lua_getfield(L, LUA_REGISTRYINDEX, LUA_LOADED_TABLE);
+    SnapshotTable(L, snapshots);
+    lua_pushliteral(L, "");
+    if (lua_getmetatable(L, -1))
+        SnapshotTable(L, snapshots);
+    lua_pop(L, 1);
+
+    lua_setfield(L, LUA_REGISTRYINDEX, kSnapshotKey);
+}
+
+// Put the shared tables back as they were snapshot (run protected: putting
+// back a removed field may allocate)
+int RestoreSharedTables(lua_State* L) {
+    lua_getfield(L, LUA_REGISTRYINDEX, kSnapshotKey);
+    const int snapshots = lua_gettop(L);
+    lua_pushnil(L);
+    while (lua_next(L, snapshots) != 0) {
+        const int table = lua_gettop(L) - 1;
+        lua_rawgeti(L, -1, 1);
+        const int contents = lua_gettop(L);
+
+        // Drop fields a job added, then reset the others
+        lua_pushnil(L);
+        while (lua_next(L, table) != 0) {
+            lua_pop(L, 1);
+            lua_pushvalue(L, -1);
+            if (lua_rawget(L, contents) == LUA_TNIL) {
+                lua_pushvalue(L, -2);
+                lua_insert(L, -2);
+                lua_rawset(L, table);
+            } else {
+                lua_pop(L, 1);
+            }
+        }
+        lua_pushnil(L);
+        while (lua_next(L, contents) != 0) {
+            lua_pushvalue(L, -2);
+            lua_insert(L, -2);
+            lua_rawset(L, table);
+        }
+
+        lua_rawgeti(L, table + 1, 2);
+        lua_setmetatable(L, table);
+        lua_settop(L, table);
+    }
+    return 0;
+}
+
+} // namespace
+
+struct LuaWorkerPool::Job {
+    JobId id = 0;
+    wxString source;
+    JobOptions options;
+    CompletionHandler onComplete;
+    MessageHandler onMessage;
+    LuaWorkerPool* pool = nullptr;
+    std::atomic<bool> cancelled{false};
+    uint64_t executed = 0;  ///< Instructions executed (worker thread only)
+};
+
+struct LuaWorkerPool::Worker {
+    std::thread thread;
+    LuaAllocator allocator{kWorkerMemoryLimit};
+    lua_State* state = nullptr;
+    LuaChunkCache chunkCache;
+};
+
+thread_local std::shared_ptr<LuaWorkerPool::Job>* LuaWorkerPool::s_currentJob = nullptr;
+
+LuaWorkerPool::LuaWorkerPool(size_t workerCount)
+    : m_workerCount(workerCount) {
+    if (m_workerCount == 0)
+        m_workerCount = std::clamp<size_t>(std::thread::hardware_concurrency() / 2, 1, 4);
+}
+
+LuaWorkerPool::~LuaWorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        for (auto& entry : m_jobs)
+            entry.second->cancelled = true;
+        m_queue.clear();
+    }
+    m_condition.notify_all();
+
+    // Pending handler calls are discarded with this event handler
+    for (auto& worker : m_workers)
+        worker->thread.join();
+}
+
+LuaWorkerPool::JobId LuaWorkerPool::Submit(const wxString& source, const JobOptions& options,
+                                           CompletionHandler onComplete, MessageHandler onMessage) {
+    auto job = std::make_shared<Job>();
+    job->source = source;
+    job->options = options;
+    job->onComplete = std::move(onComplete);
+    job->onMessage = std::move(onMessage);
+    job->pool = this;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        job->id = m_nextJobId++;
+        m_jobs[job->id] = job;
+        m_queue.push_back(job);
+
+        // Start the workers on first use
+        if (m_workers.empty()) {
+            for (size_t i = 0; i < m_workerCount; ++i) {
+                m_workers.push_back(std::make_unique<Worker>());
+                Worker& worker = *m_workers.back();
+                worker.thread = std::thread(&LuaWorkerPool::WorkerLoop, this, std::ref(worker));
+            }
+        }
+    }
+    m_condition.notify_one();
+
+    return job->id;
+}
+
+bool LuaWorkerPool::Cancel(JobId id) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_jobs.find(id);
+    if (it == m_jobs.end())
+        return false;
+
+    // Queued jobs complete as soon as a worker picks them up
+    it->second->cancelled = true;
+    return true;
+}
+
+size_t LuaWorkerPool::GetActiveJobCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_jobs.size();
+}
+
+void LuaWorkerPool::WorkerLoop(Worker& worker) {
+    for (;;) {
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]() { return m_stopping || !m_queue.empty(); });
+            if (m_stopping)
+                break;
+
+            job = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+
+        if (job->cancelled) {
+            Complete(job, false, "cancelled");
+            continue;
+        }
+
+        // Each worker keeps its state across jobs
+        if (!worker.state) {
+            worker.state = worker.allocator.NewState();
+            luaL_openlibs(worker.state);
+
+            // Only the thread-safe part of the API, plus message passing
+            lua_State* L = worker.state;
+            lua_newtable(L);
+            LuaBinding::PushFunction<&LuaAPI::ListDirectory>(L);
+            lua_setfield(L, -2, "ListDirectory");
+            LuaBinding::PushFunction<&LuaAPI::FileExists>(L);
+            lua_setfield(L, -2, "FileExists");
+            LuaBinding::PushFunction<&LuaAPI::ReadFile>(L);
+            lua_setfield(L, -2, "ReadFile");
+            LuaBinding::PushFunction<&LuaAPI::WriteFile>(L);
+            lua_setfield(L, -2, "WriteFile");
+            lua_pushcfunction(L, &LuaWorkerPool::Post);
+            lua_setfield(L, -2, "Post");
+            LuaBinding::PushFunction<&LuaAPI::Notify>(L);
+            lua_setfield(L, -2, "Notify");
+            LuaBinding::PushFunction<&LuaAPI::GetMemoryStats>(L);
+            lua_setfield(L, -2, "GetMemoryStats");
+            lua_setglobal(L, "itd");
+
+            // Jobs must not see what earlier jobs did to the libraries
+            SnapshotSharedTables(L);
+        }
+
+        s_currentJob = &job;
+        RunJob(worker, *job);
+        s_currentJob = nullptr;
+    }
+
+    if (worker.state)
+        lua_close(worker.state);
+}
+
+void LuaWorkerPool::RunJob(Worker& worker, Job& job) {
+    lua_State* L = worker.state;
+
+    int status;
+    if (job.options.isFile) {
+        status = worker.chunkCache.Load(L, job.source);
+    } else {
+        const wxScopedCharBuffer utf8 = job.source.utf8_str();
+        status = luaL_loadbufferx(L, utf8.data(), utf8.length(), "=job", "t");
+    }
+
+    if (status == LUA_OK) {
+        // Fresh globals per job: reads fall through to the shared libraries,
+        // writes stay in the job's environment
+        lua_newtable(L);
+        lua_pushvalue(L, -1);
+        lua_setfield(L, -2, "_G");
+        lua_newtable(L);
+        lua_rawgeti(L, LUA_REGISTRYINDEX, LUA_RIDX_GLOBALS);
+        lua_setfield(L, -2, "__index");
+        lua_setmetatable(L, -2);
+        lua_setupvalue(L, -2, 1);
+
+        lua_sethook(L, &LuaWorkerPool::InstructionHook, LUA_MASKCOUNT, kHookInterval);
+        status = lua_pcall(L, 0, 0, 0);
+        lua_sethook(L, nullptr, 0, 0);
+    }
+
+    wxString error;
+    if (status != LUA_OK) {
+        size_t length = 0;
+        const char* message = lua_tolstring(L, -1, &length);
+        error = message ? wxString::FromUTF8(message, length) : wxString("Unknown Lua error");
+        lua_pop(L, 1);
+    }
+
+    // Undo changes the job made to the shared tables through its environment
+    // fallback, package.loaded or the string metatable
+    bool restored = status != LUA_ERRMEM;
+    if (restored) {
+        lua_pushcfunction(L, &RestoreSharedTables);
+        restored = lua_pcall(L, 0, 0, 0) == LUA_OK;
+        if (!restored)
+            lua_pop(L, 1);
+    }
+
+    // A state that ran out of memory or could not be reset is not worth keeping
+    if (!restored) {
+        lua_close(L);
+        worker.state = nullptr;
+    }
+
+    Complete(*s_currentJob, status == LUA_OK, error);
+}
+
+void LuaWorkerPool::DeliverMessage(const std::shared_ptr<Job>& job, const wxString& name, const wxString& value) {
+    if (!job->onMessage)
+        return;
+
+    CallAfter([job, name, value]() { job->onMessage(job->id, name, value); });
+}
+
+void LuaWorkerPool::Complete(const std::shared_ptr<Job>& job, bool success, const wxString& error) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.erase(job->id);
+    }
+
+    if (job->onComplete)
+        CallAfter([job, success, error]() { job->onComplete(job->id, success, error); });
+}
+
+void LuaWorkerPool::InstructionHook(lua_State* L, lua_Debug* debug) {
+    (void)debug;
+    if (!s_currentJob)
+        return;
+
+    Job& job = **s_currentJob;
+    if (job.cancelled.load(std::memory_order_relaxed))
+        luaL_error(L, "cancelled");
+
+    job.executed += kHookInterval;
+    if (job.options.instructionBudget != 0 && job.executed > job.options.instructionBudget)
+        luaL_error(L, "instruction budget exceeded");
+}
+
+int LuaWorkerPool::Post(lua_State* L) {
+    size_t nameLength = 0;
+    const char* name = luaL_checklstring(L, 1, &nameLength);
+    size_t valueLength = 0;
+    const char* value = lua_isnoneornil(L, 2) ? "" : luaL_tolstring(L, 2, &valueLength);
+
+    if (s_currentJob) {
+        const std::shared_ptr<Job>& job = *s_currentJob;
+        job->pool->DeliverMessage(job, wxString::FromUTF8(name, nameLength), wxString::FromUTF8(value, valueLength));
+    }
+    return 0;
+}
+
+} // namespace ITD
@@ -1,5 +1,6 @@
 #include "mainframe.h"
 #include "app.h"
+#include "util/startuptrace.h"
 #include <wx/wx.h>
 #include <wx/aboutdlg.h>
 #include <wx/menu.h>
@@ -11,6 +12,7 @@ wxBEGIN_EVENT_TABLE(ITD::MainFrame, wxFrame)
     EVT_MENU(wxID_ABOUT, ITD::MainFrame::OnAbout)
     EVT_MENU(wxID_PREFERENCES, ITD::MainFrame::OnPreferences)
     EVT_SIZE(ITD::MainFrame::OnSize)
+    EVT_ICONIZE(ITD::MainFrame::OnIconize)
     EVT_CLOSE(ITD::MainFrame::OnClose)
 wxEND_EVENT_TABLE()
 
@@ -18,6 +20,7 @@ namespace ITD {
 
 MainFrame::MainFrame(const wxString& title, const wxPoint& pos, const wxSize& size)
     : wxFrame(nullptr, wxID_ANY, title, pos, size) {
+    StartupScope scope("MainFrame::MainFrame");
     
     // Initialize the AUI manager
     m_auiManager.SetManagedWindow(this);
@@ -28,6 +31,13 @@ MainFrame::MainFrame(const wxString& title, const wxPoint& pos, const wxSize& si
     InitComponents();
     InitLayout();
     InitKeyBindings();
+    InitScriptEvents();
+
+    // Apply the configuration now and whenever it changes
+    ConfigManager& configManager = wxGetApp().GetConfigManager();
+    ApplyConfig(*configManager.GetSnapshot(), ConfigChangeAll);
+    m_configListener = configManager.AddChangeListener(ConfigChangeAll,
+        [this](const ConfigSnapshot& config, uint32_t changes) { ApplyConfig(config, changes); });
     
     // Set icon and size
     SetIcon(wxICON(MAINICON)); // This assumes you have an icon resource
@@ -41,10 +51,13 @@ MainFrame::MainFrame(const wxString& title, const wxPoint& pos, const wxSize& si
 }
 
 MainFrame::~MainFrame() {
+    wxGetApp().GetConfigManager().RemoveChangeListener(m_configListener);
+
     // Uninitialize the AUI manager
     m_auiManager.UnInit();
     
     // Clean up components
+    delete m_workspaceManager;
     delete m_terminal;
     delete m_widgetManager;
     delete m_explorer;
@@ -105,47 +118,127 @@ void MainFrame::InitStatusBar() {
 }
 
 void MainFrame::InitComponents() {
+    // Only what is visible in the first frame is created here; the widget
+    // manager, explorer and search bar are created by CompleteStartup() or
+    // when first shown
+
     // Create terminal
-    m_terminal = new TerminalWx(this);
-    
-    // Create widget manager
-    m_widgetManager = new WidgetManager(this, &m_auiManager);
-    
-    // Create file explorer
-    m_explorer = new YaziExplorer(this);
+    {
+        StartupScope scope("TerminalWx");
+        m_terminal = new TerminalWx(this);
+    }
     
     // Create taskbar
-    m_taskbar = new Taskbar(this);
+    {
+        StartupScope scope("Taskbar");
+        m_taskbar = new Taskbar(this);
+    }
     
     // Create tiling manager
-    m_tilingManager = new TilingManager(this);
-    
-    // Create search bar
-    m_searchBar = new SearchBar(this, nullptr); // Need to initialize the indexer first
+    {
+        StartupScope scope("TilingManager");
+        m_tilingManager = new TilingManager(this);
+    }
 }
 
-void MainFrame::InitLayout() {
-    // Add terminal pane
-    m_auiManager.AddPane(m_terminal, wxAuiPaneInfo()
-        .Name("terminal")
-        .Caption("Terminal")
-        .CenterPane()
-        .PaneBorder(false)
-    );
-    
+void MainFrame::CompleteStartup() {
+    if (m_startupComplete)
+        return;
+    m_startupComplete = true;
+
+    StartupScope scope("MainFrame::CompleteStartup");
+    const std::shared_ptr<const ConfigSnapshot> snapshot = wxGetApp().GetConfigManager().GetSnapshot();
+    const ConfigSnapshot& config = *snapshot;
+
+    if (config.widgets.visible)
+        EnsureWidgetManager();
+
+    if (config.explorer.visible) {
+        EnsureExplorer();
+        m_auiManager.Update();
+    }
+}
+
+void MainFrame::EnsureExplorer() {
+    if (m_explorer)
+        return;
+
+    // Starting the explorer spawns Yazi, so it is never done before the first frame
+    StartupScope scope("YaziExplorer");
+    const std::shared_ptr<const ConfigSnapshot> snapshot = wxGetApp().GetConfigManager().GetSnapshot();
+    const ConfigSnapshot& config = *snapshot;
+    m_explorer = new YaziExplorer(this);
+
     // Add explorer pane
     m_auiManager.AddPane(m_explorer, wxAuiPaneInfo()
         .Name("explorer")
         .Caption("Explorer")
         .Left()
         .Layer(1)
-        .BestSize(wxSize(300, -1))
+        .BestSize(wxSize(config.explorer.width, -1))
         .CloseButton(true)
         .MaximizeButton(true)
+        .Show(config.explorer.visible)
+    );
+}
+
+void MainFrame::EnsureWidgetManager() {
+    if (m_widgetManager)
+        return;
+
+    StartupScope scope("WidgetManager");
+    const std::shared_ptr<const ConfigSnapshot> snapshot = wxGetApp().GetConfigManager().GetSnapshot();
+    const ConfigSnapshot& config = *snapshot;
+    m_widgetManager = new WidgetManager(this, &m_auiManager);
+    m_widgetManager->SetTransparency(config.widgets.transparency);
+    m_widgetManager->LoadFromConfig();
+}
+
+WidgetManager* MainFrame::GetWidgetManager() {
+    EnsureWidgetManager();
+    return m_widgetManager;
+}
+
+void MainFrame::EnsureWorkspaceManager() {
+    if (!m_workspaceManager)
+        m_workspaceManager = new WorkspaceManager(this, m_tilingManager);
+}
+
+WorkspaceManager* MainFrame::GetWorkspaceManager() {
+    EnsureWorkspaceManager();
+    return m_workspaceManager;
+}
+
+void MainFrame::BeginUpdateBatch() {
+    Freeze();
+    wxGetApp().GetConfigManager().BeginBatch();
+    m_tilingManager->BeginUpdate();
+}
+
+void MainFrame::EndUpdateBatch() {
+    // Configuration listeners may change the layout, so they run first
+    wxGetApp().GetConfigManager().EndBatch();
+    m_tilingManager->EndUpdate();
+    Thaw();
+}
+
+void MainFrame::EnsureSearchBar() {
+    if (m_searchBar)
+        return;
+
+    m_searchBar = new SearchBar(this, nullptr); // Need to initialize the indexer first
+}
+
+void MainFrame::InitLayout() {
+    // Add terminal pane
+    m_auiManager.AddPane(m_terminal, wxAuiPaneInfo()
+        .Name("terminal")
+        .Caption("Terminal")
+        .CenterPane()
+        .PaneBorder(false)
     );
     
-    // Add taskbar
-    m_taskbar->SetPosition(Taskbar::Position::Bottom);
+    // The explorer pane is added when the explorer is created
     
     // Add the terminal to the tiling manager
     m_tilingManager->AddWindow(m_terminal, "Terminal");
@@ -155,6 +248,69 @@ void MainFrame::InitKeyBindings() {
     // TODO: Set up key bindings
 }
 
+void MainFrame::InitScriptEvents() {
+    // Key presses are seen here before any child control handles them
+    Bind(wxEVT_CHAR_HOOK, &MainFrame::OnCharHook, this);
+    Bind(wxEVT_CHILD_FOCUS, &MainFrame::OnChildFocus, this);
+    Bind(EVT_TERMINAL_COMMAND, &MainFrame::OnTerminalCommand, this);
+    Bind(EVT_SEARCH_RESULT_OPENED, &MainFrame::OnSearchResultOpened, this);
+}
+
+void MainFrame::ApplyConfig(const ConfigSnapshot& config, uint32_t changes) {
+    // Terminal
+    if (changes & ConfigChangeTerminalFont)
+        m_terminal->SetTerminalFont(config.terminal.fontName, config.terminal.fontSize);
+    if (changes & ConfigChangeTerminalColors)
+        m_terminal->SetColorScheme(config.terminal.foreground, config.terminal.background,
+                                   config.terminal.selection);
+    if (changes & ConfigChangeTerminalMode)
+        m_terminal->EnableVimMode(config.terminal.vimMode);
+    if (changes & ConfigChangeTransparency)
+        m_terminal->SetTransparency(config.ui.transparencyEnabled ? config.ui.transparency : 255);
+
+    // Taskbar
+    if (changes & ConfigChangeTaskbarPosition) {
+        switch (config.taskbar.position) {
+            case ConfigSnapshot::Edge::Top:
+                m_taskbar->SetPosition(Taskbar::Position::Top);
+                break;
+            case ConfigSnapshot::Edge::Left:
+                m_taskbar->SetPosition(Taskbar::Position::Left);
+                break;
+            case ConfigSnapshot::Edge::Right:
+                m_taskbar->SetPosition(Taskbar::Position::Right);
+                break;
+            case ConfigSnapshot::Edge::Bottom:
+                m_taskbar->SetPosition(Taskbar::Position::Bottom);
+                break;
+        }
+    }
+    if (changes & ConfigChangeTaskbar)
+        m_taskbar->Show(config.taskbar.visible);
+
+    // Widgets (the manager applies the settings itself when it is created)
+    if (m_widgetManager) {
+        if (changes & ConfigChangeWidgets)
+            m_widgetManager->SetTransparency(config.widgets.transparency);
+        if (changes & ConfigChangeWidgetLayout)
+            m_widgetManager->LoadFromConfig();
+    } else if ((changes & ConfigChangeWidgets) && config.widgets.visible && m_startupComplete) {
+        EnsureWidgetManager();
+    }
+
+    // Explorer (only relayout when something changed after startup)
+    if ((changes & ConfigChangeExplorer) && changes != ConfigChangeAll) {
+        if (config.explorer.visible && m_startupComplete)
+            EnsureExplorer();
+        if (m_explorer) {
+            m_auiManager.GetPane("explorer")
+                .BestSize(wxSize(config.explorer.width, -1))
+                .Show(config.explorer.visible);
+            m_auiManager.Update();
+        }
+    }
+}
+
 void MainFrame::OnExit(wxCommandEvent& event) {
     Close(true);
 }
@@ -178,13 +334,67 @@ void MainFrame::OnToggleFullScreen(wxCommandEvent& event) {
 }
 
 void MainFrame::OnSearch(wxCommandEvent& event) {
+    EnsureSearchBar();
     m_searchBar->Show(!m_searchBar->IsShown());
     if (m_searchBar->IsShown()) {
         m_searchBar->SetFocus();
     }
 }
 
+void MainFrame::OnCharHook(wxKeyEvent& event) {
+    LuaScript& lua = wxGetApp().GetLuaScript();
+    if (lua.HasHandlers(LuaEvent::KeyPress)) {
+        int flags = wxACCEL_NORMAL;
+        if (event.ControlDown())
+            flags |= wxACCEL_CTRL;
+        if (event.AltDown())
+            flags |= wxACCEL_ALT;
+        if (event.ShiftDown())
+            flags |= wxACCEL_SHIFT;
+
+        const wxString key = wxAcceleratorEntry(flags, event.GetKeyCode()).ToString();
+        if (lua.FireEvent(LuaEvent::KeyPress, key, event.GetKeyCode()))
+            return;
+    }
+    event.Skip();
+}
+
+void MainFrame::OnChildFocus(wxChildFocusEvent& event) {
+    event.Skip();
+
+    // Focus moving inside the same child is not a window change
+    wxWindow* window = event.GetWindow();
+    if (!window || window == m_focusedChild)
+        return;
+    m_focusedChild = window;
+
+    LuaScript& lua = wxGetApp().GetLuaScript();
+    if (!lua.HasHandlers(LuaEvent::WindowFocus))
+        return;
+
+    wxString name = m_tilingManager->GetWindowName(window);
+    if (name.empty())
+        name = window->GetName();
+    lua.FireEvent(LuaEvent::WindowFocus, name);
+}
+
+void MainFrame::OnTerminalCommand(wxCommandEvent& event) {
+    wxGetApp().GetLuaScript().FireEvent(LuaEvent::CommandExecuted, event.GetString(), event.GetInt() != 0);
+}
+
+void MainFrame::OnSearchResultOpened(wxCommandEvent& event) {
+    wxGetApp().GetLuaScript().FireEvent(LuaEvent::SearchResultOpened, event.GetString());
+}
+
 void MainFrame::OnToggleExplorer(wxCommandEvent& event) {
+    if (!m_explorer) {
+        // First use: create it shown
+        EnsureExplorer();
+        m_auiManager.GetPane("explorer").Show();
+        m_auiManager.Update();
+        return;
+    }
+
     wxAuiPaneInfo& paneInfo = m_auiManager.GetPane("explorer");
     paneInfo.Show(!paneInfo.IsShown());
     m_auiManager.Update();
@@ -196,6 +406,17 @@ void MainFrame::OnToggleWidgets(wxCommandEvent& event) {
 
 void MainFrame::OnSize(wxSizeEvent& event) {
     event.Skip();
+
+    // Widgets suspended outside the old frame area may be visible now
+    wxGetApp().GetTickScheduler().Wake();
+}
+
+void MainFrame::OnIconize(wxIconizeEvent& event) {
+    event.Skip();
+
+    // Updates stop while minimized and catch up once restored
+    if (!event.IsIconized())
+        wxGetApp().GetTickScheduler().Wake();
 }
 
 void MainFrame::OnClose(wxCloseEvent& event) {
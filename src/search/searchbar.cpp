@@ -1 +1,9 @@
-// Placeholder  
+#include "search/searchbar.h"
+
+namespace ITD {
+
+wxDEFINE_EVENT(EVT_SEARCH_RESULT_OPENED, wxCommandEvent);
+
+// Placeholder
+
+} // namespace ITD
@@ -1,4 +1,5 @@
 #include "terminal/terminalwx.h"
+#include "app.h"
 #include <wx/wx.h>
 #include <wx/process.h>
 #include <wx/textctrl.h>
@@ -9,14 +10,18 @@ wxBEGIN_EVENT_TABLE(ITD::TerminalWx, wxPanel)
     EVT_KEY_DOWN(ITD::TerminalWx::OnKeyDown)
     EVT_SIZE(ITD::TerminalWx::OnSize)
     EVT_CHAR(ITD::TerminalWx::OnChar)
+    EVT_SHOW(ITD::TerminalWx::OnShow)
 wxEND_EVENT_TABLE()
 
 namespace ITD {
 
+wxDEFINE_EVENT(EVT_TERMINAL_COMMAND, wxCommandEvent);
+
 TerminalWx::TerminalWx(wxWindow* parent, wxWindowID id, const wxPoint& pos,
                    const wxSize& size, long style)
     : wxPanel(parent, id, pos, size, style),
-      m_currentDirectory(wxGetCwd()) {
+      m_currentDirectory(wxGetCwd()),
+      m_resizeDebouncer([this]() { m_textCtrl->SetSize(GetClientSize()); }) {
     
     // Create the text control
     m_textCtrl = new wxStyledTextCtrl(this, wxID_ANY, wxDefaultPosition, wxDefaultSize);
@@ -39,6 +44,9 @@ TerminalWx::TerminalWx(wxWindow* parent, wxWindowID id, const wxPoint& pos,
     m_textCtrl->StyleSetForeground(wxSTC_STYLE_DEFAULT, *wxWHITE);
     m_textCtrl->StyleSetBackground(wxSTC_STYLE_DEFAULT, *wxBLACK);
     m_textCtrl->StyleClearAll();
+
+    // Shown beside the text control while a resize drag is in progress
+    SetBackgroundColour(*wxBLACK);
     
     // Initialize the terminal
     wxBoxSizer* sizer = new wxBoxSizer(wxVERTICAL);
@@ -66,7 +74,21 @@ TerminalWx::~TerminalWx() {
 bool TerminalWx::ExecuteCommand(const wxString& command) {
     if (m_isBusy)
         return false;
-    
+
+    const bool success = RunCommand(command);
+
+    wxCommandEvent event(EVT_TERMINAL_COMMAND, GetId());
+    event.SetEventObject(this);
+    event.SetString(command);
+    event.SetInt(success ? 1 : 0);
+    ProcessWindowEvent(event);
+
+    return success;
+}
+
+bool TerminalWx::RunCommand(const wxString& command) {
+    FlushOutput();
+
     // Display the command
     m_textCtrl->AppendText("\r\n");
     
@@ -127,6 +149,46 @@ bool TerminalWx::ExecuteCommand(const wxString& command) {
     return true;
 }
 
+void TerminalWx::SetCurrentDirectory(const wxString& directory) {
+    if (m_isBusy || !wxDir::Exists(directory))
+        return;
+
+    FlushOutput();
+    m_currentDirectory = directory;
+    const int promptStart = m_textCtrl->PositionFromLine(m_textCtrl->LineFromPosition(m_inputStart));
+    m_textCtrl->SetTargetStart(promptStart);
+    m_textCtrl->SetTargetEnd(m_textCtrl->GetLength());
+    m_textCtrl->ReplaceTarget(m_currentDirectory + ">");
+    m_inputStart = m_textCtrl->GetLength();
+}
+
+wxString TerminalWx::GetScrollback(size_t maxLength) const {
+    const int end = m_textCtrl->PositionFromLine(m_textCtrl->LineFromPosition(m_inputStart));
+    const int start = end > static_cast<int>(maxLength) ? end - static_cast<int>(maxLength) : 0;
+
+    // Start at a line boundary so the first line is not cut
+    const int lineStart = start > 0 ? m_textCtrl->PositionFromLine(m_textCtrl->LineFromPosition(start) + 1) : 0;
+    return lineStart < end ? m_textCtrl->GetTextRange(lineStart, end) : wxString();
+}
+
+void TerminalWx::RestoreScrollback(const wxString& text) {
+    if (text.empty())
+        return;
+
+    const int before = m_textCtrl->GetLength();
+    m_textCtrl->InsertText(0, text);
+    m_inputStart += m_textCtrl->GetLength() - before;
+    m_textCtrl->GotoPos(m_textCtrl->GetLength());
+}
+
+int TerminalWx::GetScrollAnchor() const {
+    return m_textCtrl->DocLineFromVisible(m_textCtrl->GetFirstVisibleLine());
+}
+
+void TerminalWx::SetScrollAnchor(int line) {
+    m_textCtrl->SetFirstVisibleLine(m_textCtrl->VisibleFromDocLine(line));
+}
+
 void TerminalWx::SetTerminalFont(const wxString& fontName, int fontSize) {
     wxFont font(wxFontInfo(fontSize).Family(wxFONTFAMILY_TELETYPE).FaceName(fontName));
     m_textCtrl->StyleSetFont(wxSTC_STYLE_DEFAULT, font);
@@ -139,6 +201,7 @@ void TerminalWx::SetColorScheme(const wxColour& foreground, const wxColour& back
     m_textCtrl->StyleSetBackground(wxSTC_STYLE_DEFAULT, background);
     m_textCtrl->SetSelBackground(true, selection);
     m_textCtrl->StyleClearAll();
+    SetBackgroundColour(background);
 }
 
 void TerminalWx::SetTransparency(unsigned char alpha) {
@@ -253,27 +316,48 @@ void TerminalWx::OnChar(wxKeyEvent& event) {
 }
 
 void TerminalWx::OnSize(wxSizeEvent& event) {
+    // Rewrapping the text on every step of a drag is what makes it stutter;
+    // the text control is resized once the size settles. The event is not
+    // skipped, so the sizer does not resize it either.
+    if (m_resizeDebouncer.Defer())
+        return;
+
     // Resize the text control
     m_textCtrl->SetSize(GetClientSize());
     event.Skip();
 }
 
+void TerminalWx::OnShow(wxShowEvent& event) {
+    event.Skip();
+    if (event.IsShown())
+        FlushOutput();
+}
+
+void TerminalWx::AppendProcessLine(wxString line) {
+    if (line.Replace("\a", wxEmptyString) > 0) {
+        Notification notification;
+        notification.source = "terminal";
+        notification.title = "Bell";
+        notification.message = m_currentDirectory;
+        wxGetApp().GetNotificationCenter().Post(std::move(notification));
+    }
+    AppendOutput("\r\n" + line);
+}
+
 void TerminalWx::ReadProcessOutput() {
     if (!m_process)
         return;
     
     if (m_process->IsInputAvailable()) {
         wxTextInputStream tis(*m_process->GetInputStream());
-        wxString line = tis.ReadLine();
-        m_textCtrl->AppendText("\r\n" + line);
+        AppendProcessLine(tis.ReadLine());
         
         // Continue reading
         wxMilliSleep(10);
         ReadProcessOutput();
     } else if (m_process->IsErrorAvailable()) {
         wxTextInputStream tis(*m_process->GetErrorStream());
-        wxString line = tis.ReadLine();
-        m_textCtrl->AppendText("\r\n" + line);
+        AppendProcessLine(tis.ReadLine());
         
         // Continue reading
         wxMilliSleep(10);
@@ -285,8 +369,18 @@ void TerminalWx::ReadProcessOutput() {
             m_process = nullptr;
             
             // Display new prompt
-            m_textCtrl->AppendText("\r\n" + m_currentDirectory + ">");
-            m_inputStart = m_textCtrl->GetLength();
+            AppendOutput("\r\n" + m_currentDirectory + ">");
+            if (m_pendingOutput.empty())
+                m_inputStart = m_textCtrl->GetLength();
+
+            // Nobody is watching a hidden terminal finish
+            if (!IsShown() && !m_commandHistory.empty()) {
+                Notification notification;
+                notification.source = "terminal";
+                notification.title = "Command finished";
+                notification.message = m_commandHistory.back();
+                wxGetApp().GetNotificationCenter().Post(std::move(notification));
+            }
         } else {
             // Wait for more output
             wxMilliSleep(50);
@@ -296,6 +390,26 @@ void TerminalWx::ReadProcessOutput() {
     }
 }
 
+void TerminalWx::AppendOutput(const wxString& text) {
+    if (IsShown())
+        m_textCtrl->AppendText(text);
+    else
+        m_pendingOutput += text;
+}
+
+void TerminalWx::FlushOutput() {
+    if (m_pendingOutput.empty())
+        return;
+
+    // Everything received while hidden is inserted and laid out at once;
+    // without a process, it ends with the prompt
+    m_textCtrl->AppendText(m_pendingOutput);
+    wxString().swap(m_pendingOutput);
+    if (!m_process)
+        m_inputStart = m_textCtrl->GetLength();
+    m_textCtrl->GotoPos(m_textCtrl->GetLength());
+}
+
 void TerminalWx::WriteProcessInput(const wxString& input) {
     if (!m_process || !m_process->IsInputOpened())
         return;
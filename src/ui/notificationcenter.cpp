@@ -0,0 +1,154 @@
+#include "ui/notificationcenter.h"
+#include <algorithm>
+#include <cmath>
+
+namespace ITD {
+
+NotificationCenter::NotificationCenter()
+    : m_queue(kQueueCapacity),
+      m_lastRefill(Clock::now()),
+      m_timer(this) {
+    Bind(wxEVT_TIMER, &NotificationCenter::OnTimer, this);
+}
+
+NotificationCenter::~NotificationCenter() {
+    m_timer.Stop();
+}
+
+bool NotificationCenter::Post(Notification notification) {
+    if (!m_queue.Push(std::move(notification)))
+        return false;
+
+    // Woken after the push completed, so the drain finds it
+    Wake();
+    return true;
+}
+
+int NotificationCenter::AddListener(Listener listener) {
+    const int id = m_nextListenerId++;
+    m_listeners.push_back({ id, std::move(listener) });
+    return id;
+}
+
+void NotificationCenter::RemoveListener(int id) {
+    m_listeners.erase(std::remove_if(m_listeners.begin(), m_listeners.end(),
+        [id](const ListenerEntry& entry) { return entry.id == id; }), m_listeners.end());
+}
+
+void NotificationCenter::ClearHistory() {
+    m_history.clear();
+    m_keys.clear();
+    m_pendingId = 0;
+    m_suppressed = 0;
+}
+
+void NotificationCenter::Wake() {
+    // One queued drain serves every producer that posts before it runs
+    if (!m_wakePending.exchange(true, std::memory_order_acq_rel))
+        CallAfter([this]() { Drain(); });
+}
+
+void NotificationCenter::Drain() {
+    m_wakePending.exchange(false, std::memory_order_acq_rel);
+
+    // A storm is taken in slices so that input and painting go on in between
+    const Clock::time_point now = Clock::now();
+    Notification notification;
+    size_t count = 0;
+    while (count < kMaxDrainBatch && m_queue.Pop(notification)) {
+        Record(std::move(notification), now);
+        ++count;
+    }
+    if (count == kMaxDrainBatch)
+        Wake();
+
+    if (count > 0)
+        Present();
+}
+
+void NotificationCenter::Record(Notification&& notification, Clock::time_point now) {
+    wxString key = notification.key;
+    if (key.empty())
+        key = notification.source + '\n' + notification.title;
+
+    uint64_t id = 0;
+    auto it = m_keys.find(key);
+    NotificationRecord* recent = it != m_keys.end() ? Find(it->second) : nullptr;
+    if (recent && now - recent->lastSeen < std::chrono::milliseconds(kCoalesceWindowMs)) {
+        // A repeat updates the record it repeats
+        recent->notification.message = std::move(notification.message);
+        recent->notification.level = std::max(recent->notification.level, notification.level);
+        recent->count++;
+        recent->time = wxDateTime::Now();
+        recent->lastSeen = now;
+        id = recent->id;
+    } else {
+        NotificationRecord record;
+        record.id = id = m_nextId++;
+        record.key = key;
+        record.notification = std::move(notification);
+        record.time = wxDateTime::Now();
+        record.lastSeen = now;
+        m_history.push_back(std::move(record));
+        m_keys[key] = id;
+
+        while (m_history.size() > kMaxHistory) {
+            const NotificationRecord& oldest = m_history.front();
+            auto latest = m_keys.find(oldest.key);
+            if (latest != m_keys.end() && latest->second == oldest.id)
+                m_keys.erase(latest);
+            m_history.pop_front();
+        }
+    }
+
+    if (m_pendingId != 0 && m_pendingId != id)
+        ++m_suppressed;
+    m_pendingId = id;
+}
+
+NotificationRecord* NotificationCenter::Find(uint64_t id) {
+    // Ids are consecutive from the oldest record
+    if (m_history.empty() || id < m_history.front().id)
+        return nullptr;
+    const uint64_t index = id - m_history.front().id;
+    return index < m_history.size() ? &m_history[static_cast<size_t>(index)] : nullptr;
+}
+
+void NotificationCenter::Present() {
+    if (m_pendingId == 0)
+        return;
+
+    // Token bucket: a burst at once, then a steady rate
+    const Clock::time_point now = Clock::now();
+    const double elapsed = std::chrono::duration<double>(now - m_lastRefill).count();
+    m_tokens = std::min(kBurst, m_tokens + elapsed * kRatePerSecond);
+    m_lastRefill = now;
+    if (m_tokens < 1) {
+        if (!m_timer.IsRunning()) {
+            const int waitMs = static_cast<int>(std::ceil((1 - m_tokens) / kRatePerSecond * 1000));
+            m_timer.StartOnce(std::max(waitMs, 1));
+        }
+        return;
+    }
+    m_tokens -= 1;
+
+    const NotificationRecord* record = Find(m_pendingId);
+    const size_t suppressed = m_suppressed;
+    m_pendingId = 0;
+    m_suppressed = 0;
+    if (!record)
+        return;
+
+    // Listeners may add or remove listeners while being notified
+    const NotificationRecord presented = *record;
+    const std::vector<ListenerEntry> listeners = m_listeners;
+    for (const ListenerEntry& listener : listeners)
+        listener.callback(presented, suppressed);
+}
+
+void NotificationCenter::OnTimer(wxTimerEvent& event) {
+    wxUnusedVar(event);
+    Present();
+}
+
+} // namespace ITD
@@ -0,0 +1,35 @@
+#include "ui/resizedebouncer.h"
+
+namespace ITD {
+
+ResizeDebouncer::ResizeDebouncer(SettleCallback settled, int quietMs)
+    : m_settled(std::move(settled)),
+      m_timer(this),
+      m_quietMs(quietMs) {
+    Bind(wxEVT_TIMER, &ResizeDebouncer::OnTimer, this);
+}
+
+bool ResizeDebouncer::Defer() {
+    // The first event of a burst is applied; the timer is still running for
+    // the ones that follow it
+    if (m_timer.IsRunning())
+        m_deferring = true;
+    m_timer.StartOnce(m_quietMs);
+    return m_deferring;
+}
+
+void ResizeDebouncer::Settle() {
+    m_timer.Stop();
+    if (!m_deferring)
+        return;
+
+    m_deferring = false;
+    m_settled();
+}
+
+void ResizeDebouncer::OnTimer(wxTimerEvent& event) {
+    wxUnusedVar(event);
+    Settle();
+}
+
+} // namespace ITD
@@ -0,0 +1,404 @@
+#include "ui/splittree.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace ITD {
+
+namespace {
+
+// Ratios are saved as integers so the text does not depend on the locale
+constexpr int kRatioScale = 10000;
+
+// Deeper descriptions are rejected rather than risking the stack
+constexpr int kMaxLoadDepth = 256;
+
+bool IsDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+} // namespace
+
+void SplitTree::Clear() {
+    m_nodes.clear();
+    m_free.clear();
+    m_leaves.clear();
+    m_root = -1;
+}
+
+void SplitTree::BuildRow(const std::vector<wxWindow*>& windows, bool horizontal) {
+    Clear();
+    m_root = Build(0, windows.size(), horizontal, [&](size_t i) {
+        const int leaf = NewNode();
+        m_nodes[leaf].window = windows[i];
+        m_leaves[windows[i]] = leaf;
+        return leaf;
+    });
+}
+
+void SplitTree::BuildGrid(const std::vector<wxWindow*>& windows, size_t columns) {
+    Clear();
+    if (columns == 0)
+        return;
+
+    const size_t rows = (windows.size() + columns - 1) / columns;
+    m_root = Build(0, rows, false, [&](size_t row) {
+        return Build(row * columns, std::min(windows.size(), (row + 1) * columns), true, [&](size_t i) {
+            const int leaf = NewNode();
+            m_nodes[leaf].window = windows[i];
+            m_leaves[windows[i]] = leaf;
+            return leaf;
+        });
+    });
+}
+
+std::string SplitTree::Save(const std::vector<wxWindow*>& windows) const {
+    std::unordered_map<wxWindow*, size_t> indices;
+    for (size_t i = 0; i < windows.size(); ++i) {
+        if (windows[i])
+            indices.emplace(windows[i], i);
+    }
+
+    std::string shape;
+    if (m_root >= 0)
+        SaveNode(m_root, indices, shape);
+    return shape;
+}
+
+bool SplitTree::Load(const std::string& shape, const std::vector<wxWindow*>& windows) {
+    Clear();
+    const char* p = shape.c_str();
+    const char* end = p + shape.size();
+    bool ok = true;
+    const int root = LoadNode(p, end, windows, 0, ok);
+    if (!ok || p != end) {
+        Clear();
+        return false;
+    }
+
+    m_root = root;
+    if (m_root >= 0)
+        m_nodes[m_root].parent = -1;
+    return true;
+}
+
+bool SplitTree::Insert(wxWindow* window, wxWindow* target, bool horizontal) {
+    if (!window || Contains(window))
+        return false;
+
+    const int leaf = NewNode();
+    m_nodes[leaf].window = window;
+    m_leaves[window] = leaf;
+    if (m_root < 0) {
+        m_root = leaf;
+        return true;
+    }
+
+    // The split takes the target's place and rectangle
+    auto it = m_leaves.find(target);
+    const int sibling = it != m_leaves.end() ? it->second : m_root;
+    const int split = NewNode();
+    Node& node = m_nodes[split];
+    node.parent = m_nodes[sibling].parent;
+    node.first = sibling;
+    node.second = leaf;
+    node.horizontal = horizontal;
+    node.rect = m_nodes[sibling].rect;
+
+    ReplaceChild(node.parent, sibling, split);
+    m_nodes[sibling].parent = split;
+    m_nodes[leaf].parent = split;
+    MarkDirty(split);
+    return true;
+}
+
+bool SplitTree::Remove(wxWindow* window) {
+    auto it = m_leaves.find(window);
+    if (it == m_leaves.end())
+        return false;
+
+    const int leaf = it->second;
+    m_leaves.erase(it);
+    const int split = m_nodes[leaf].parent;
+    FreeNode(leaf);
+    if (split < 0) {
+        m_root = -1;
+        return true;
+    }
+
+    // The sibling takes the split's place; its new rectangle comes from above
+    const Node& node = m_nodes[split];
+    const int sibling = node.first == leaf ? node.second : node.first;
+    const int grandparent = node.parent;
+    ReplaceChild(grandparent, split, sibling);
+    m_nodes[sibling].parent = grandparent;
+    FreeNode(split);
+    MarkDirty(grandparent >= 0 ? grandparent : sibling);
+    return true;
+}
+
+bool SplitTree::SetRatio(wxWindow* window, double ratio) {
+    auto it = m_leaves.find(window);
+    if (it == m_leaves.end() || m_nodes[it->second].parent < 0)
+        return false;
+
+    const int split = m_nodes[it->second].parent;
+    ratio = std::max(kMinRatio, std::min(1.0 - kMinRatio, ratio));
+    if (m_nodes[split].second == it->second)
+        ratio = 1.0 - ratio;
+
+    const float value = static_cast<float>(ratio);
+    if (m_nodes[split].ratio != value) {
+        m_nodes[split].ratio = value;
+        MarkDirty(split);
+    }
+    return true;
+}
+
+void SplitTree::SetArea(const wxRect& area) {
+    m_area = area;
+}
+
+void SplitTree::Invalidate() {
+    for (Node& node : m_nodes)
+        node.dirty = true;
+}
+
+size_t SplitTree::Layout(std::vector<Change>& changes) {
+    changes.clear();
+    if (m_root < 0)
+        return 0;
+
+    Node& root = m_nodes[m_root];
+    if (root.rect != m_area) {
+        root.rect = m_area;
+        root.dirty = true;
+    }
+    if (!root.dirty && !root.childDirty)
+        return 0;
+
+    size_t visited = 0;
+    Visit(m_root, changes, visited);
+    return visited;
+}
+
+wxRect SplitTree::GetRect(wxWindow* window) const {
+    auto it = m_leaves.find(window);
+    return it != m_leaves.end() ? m_nodes[it->second].rect : wxRect();
+}
+
+int SplitTree::NewNode() {
+    if (m_free.empty()) {
+        m_nodes.emplace_back();
+        return static_cast<int>(m_nodes.size() - 1);
+    }
+
+    const int index = m_free.back();
+    m_free.pop_back();
+    m_nodes[index] = Node();
+    return index;
+}
+
+void SplitTree::FreeNode(int index) {
+    m_nodes[index] = Node();
+    m_nodes[index].dirty = false;
+    m_free.push_back(index);
+}
+
+void SplitTree::MarkDirty(int index) {
+    m_nodes[index].dirty = true;
+
+    // Ancestors of a marked node are already marked
+    for (int parent = m_nodes[index].parent; parent >= 0 && !m_nodes[parent].childDirty;
+         parent = m_nodes[parent].parent)
+        m_nodes[parent].childDirty = true;
+}
+
+void SplitTree::ReplaceChild(int parent, int child, int replacement) {
+    if (parent < 0) {
+        m_root = replacement;
+        return;
+    }
+
+    Node& node = m_nodes[parent];
+    if (node.first == child)
+        node.first = replacement;
+    else
+        node.second = replacement;
+}
+
+int SplitTree::Build(size_t begin, size_t end, bool horizontal, const std::function<int(size_t)>& item) {
+    if (begin >= end)
+        return -1;
+    if (end - begin == 1)
+        return item(begin);
+
+    // Halving keeps the depth logarithmic, so a ratio change stays local
+    const size_t middle = begin + (end - begin) / 2;
+    const int first = Build(begin, middle, horizontal, item);
+    const int second = Build(middle, end, horizontal, item);
+    const int split = NewNode();
+    Node& node = m_nodes[split];
+    node.first = first;
+    node.second = second;
+    node.horizontal = horizontal;
+    node.ratio = static_cast<float>(middle - begin) / static_cast<float>(end - begin);
+    m_nodes[first].parent = split;
+    m_nodes[second].parent = split;
+    return split;
+}
+
+void SplitTree::Visit(int index, std::vector<Change>& changes, size_t& visited) {
+    ++visited;
+    Node& node = m_nodes[index];
+    const bool dirty = node.dirty;
+    node.dirty = false;
+    node.childDirty = false;
+
+    if (node.first < 0) {
+        if (dirty)
+            changes.push_back({ node.window, node.rect });
+        return;
+    }
+
+    if (dirty) {
+        wxRect first = node.rect;
+        wxRect second = node.rect;
+        if (node.horizontal) {
+            first.width = std::max(0, std::min(node.rect.width,
+                static_cast<int>(std::lround(node.rect.width * node.ratio))));
+            second.x += first.width;
+            second.width -= first.width;
+        } else {
+            first.height = std::max(0, std::min(node.rect.height,
+                static_cast<int>(std::lround(node.rect.height * node.ratio))));
+            second.y += first.height;
+            second.height -= first.height;
+        }
+
+        // Children whose rectangle did not change keep their subtree
+        for (const auto& child : { std::make_pair(node.first, first), std::make_pair(node.second, second) }) {
+            Node& childNode = m_nodes[child.first];
+            if (childNode.rect != child.second) {
+                childNode.rect = child.second;
+                childNode.dirty = true;
+            }
+        }
+    }
+
+    for (const int child : { node.first, node.second }) {
+        if (m_nodes[child].dirty || m_nodes[child].childDirty)
+            Visit(child, changes, visited);
+    }
+}
+
+bool SplitTree::SaveNode(int index, const std::unordered_map<wxWindow*, size_t>& indices,
+                         std::string& shape) const {
+    const Node& node = m_nodes[index];
+    if (node.first < 0) {
+        auto it = indices.find(node.window);
+        if (it == indices.end())
+            return false;
+        shape += std::to_string(it->second);
+        return true;
+    }
+
+    const size_t start = shape.size();
+    shape += node.horizontal ? 'h' : 'v';
+    shape += std::to_string(std::lround(node.ratio * kRatioScale));
+    shape += '(';
+    const size_t childStart = shape.size();
+    const bool first = SaveNode(node.first, indices, shape);
+    shape += ',';
+    const bool second = SaveNode(node.second, indices, shape);
+    if (first && second) {
+        shape += ')';
+        return true;
+    }
+
+    // A split with one listed side is written as that side
+    std::string child;
+    if (first)
+        child = shape.substr(childStart, shape.size() - childStart - 1);
+    else if (second)
+        child = shape.substr(childStart + 1);
+    shape.resize(start);
+    shape += child;
+    return first || second;
+}
+
+int SplitTree::LoadNode(const char*& p, const char* end, const std::vector<wxWindow*>& windows,
+                        int depth, bool& ok) {
+    if (p == end || depth > kMaxLoadDepth) {
+        ok = false;
+        return -1;
+    }
+
+    if (IsDigit(*p)) {
+        size_t index = 0;
+        for (; p != end && IsDigit(*p); ++p) {
+            index = index * 10 + static_cast<size_t>(*p - '0');
+            if (index >= windows.size()) {
+                ok = false;
+                return -1;
+            }
+        }
+
+        wxWindow* window = windows[index];
+        if (!window)
+            return -1;
+        if (Contains(window)) {
+            ok = false;
+            return -1;
+        }
+
+        const int leaf = NewNode();
+        m_nodes[leaf].window = window;
+        m_leaves[window] = leaf;
+        return leaf;
+    }
+
+    if (*p != 'h' && *p != 'v') {
+        ok = false;
+        return -1;
+    }
+    const bool horizontal = *p++ == 'h';
+
+    int ratio = 0;
+    const char* digits = p;
+    for (; p != end && IsDigit(*p) && ratio <= kRatioScale; ++p)
+        ratio = ratio * 10 + (*p - '0');
+    if (p == digits || ratio > kRatioScale || p == end || *p++ != '(') {
+        ok = false;
+        return -1;
+    }
+
+    const int first = LoadNode(p, end, windows, depth + 1, ok);
+    if (!ok || p == end || *p++ != ',') {
+        ok = false;
+        return -1;
+    }
+    const int second = LoadNode(p, end, windows, depth + 1, ok);
+    if (!ok || p == end || *p++ != ')') {
+        ok = false;
+        return -1;
+    }
+
+    if (first < 0)
+        return second;
+    if (second < 0)
+        return first;
+
+    const double share = static_cast<double>(ratio) / kRatioScale;
+    const int split = NewNode();
+    Node& node = m_nodes[split];
+    node.first = first;
+    node.second = second;
+    node.horizontal = horizontal;
+    node.ratio = static_cast<float>(std::max(kMinRatio, std::min(1.0 - kMinRatio, share)));
+    m_nodes[first].parent = split;
+    m_nodes[second].parent = split;
+    return split;
+}
+
+} // namespace ITD
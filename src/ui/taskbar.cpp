@@ -1 +1,219 @@
-// Placeholder  
+#include "ui/taskbar.h"
+#include "app.h"
+#include <wx/wx.h>
+#include <wx/dcbuffer.h>
+#include <algorithm>
+
+// Event table for Taskbar
+wxBEGIN_EVENT_TABLE(ITD::Taskbar, wxPanel)
+    EVT_PAINT(ITD::Taskbar::OnPaint)
+    EVT_SIZE(ITD::Taskbar::OnSize)
+    EVT_CONTEXT_MENU(ITD::Taskbar::OnRightClick)
+wxEND_EVENT_TABLE()
+
+namespace ITD {
+
+namespace {
+
+// Context menu IDs
+constexpr int kFirstPositionId = wxID_HIGHEST + 1;
+
+// How long a notification stays in the taskbar
+constexpr int kNotificationShowMs = 5000;
+
+// Longer notification text is cut; the tooltip has all of it
+constexpr size_t kMaxNotificationLength = 80;
+
+// Clock formats that show seconds need a tick every second
+bool FormatHasSeconds(const wxString& format) {
+    return format.Contains("%S") || format.Contains("%T") || format.Contains("%X") || format.Contains("%c");
+}
+
+} // namespace
+
+Taskbar::Taskbar(wxWindow* parent, wxWindowID id, const wxPoint& pos, const wxSize& size, long style)
+    : wxPanel(parent, id, pos, size, style),
+      m_notificationTimer(this) {
+    SetBackgroundStyle(wxBG_STYLE_PAINT);
+
+    m_mainSizer = new wxBoxSizer(wxHORIZONTAL);
+    m_taskStrip = new TaskStrip(this, m_tasks, [this](wxWindow* window) { ActivateTask(window); });
+    m_notificationLabel = new wxStaticText(this, wxID_ANY, wxEmptyString);
+    m_notificationLabel->Hide();
+    m_clockLabel = new wxStaticText(this, wxID_ANY, wxEmptyString);
+    m_mainSizer->Add(m_taskStrip, 1, wxEXPAND);
+    m_mainSizer->Add(m_notificationLabel, 0, wxALIGN_CENTER_VERTICAL | wxLEFT, 8);
+    m_mainSizer->Add(m_clockLabel, 0, wxALIGN_CENTER_VERTICAL | wxLEFT | wxRIGHT, 8);
+    SetSizer(m_mainSizer);
+    UpdateBackground();
+
+    Bind(wxEVT_TIMER, &Taskbar::OnNotificationTimer, this);
+    m_notificationListener = wxGetApp().GetNotificationCenter().AddListener(
+        [this](const NotificationRecord& record, size_t suppressed) { ShowNotification(record, suppressed); });
+
+    // The clock shares the application's timer and sleeps while the taskbar is hidden
+    m_clockTask = wxGetApp().GetTickScheduler().Add("Taskbar clock", 60 * 1000, [this]() { UpdateClock(); }, this);
+    UpdateClock();
+}
+
+Taskbar::~Taskbar() {
+    wxGetApp().GetTickScheduler().Remove(m_clockTask);
+    wxGetApp().GetNotificationCenter().RemoveListener(m_notificationListener);
+    m_notificationTimer.Stop();
+}
+
+void Taskbar::SetPosition(Position position) {
+    if (position == m_position)
+        return;
+
+    m_position = position;
+    UpdateLayout();
+}
+
+bool Taskbar::AddTask(const wxString& name, const wxIcon& icon, wxWindow* window) {
+    return m_tasks.Add(name, icon, window);
+}
+
+bool Taskbar::RemoveTask(wxWindow* window) {
+    return m_tasks.Remove(window);
+}
+
+void Taskbar::SetActiveTask(wxWindow* window) {
+    m_tasks.SetActive(window);
+}
+
+void Taskbar::SetTransparency(unsigned char alpha) {
+    m_transparency = alpha;
+    UpdateBackground();
+    Refresh(false);
+}
+
+bool Taskbar::Show(bool show) {
+    m_isVisible = show;
+    const bool changed = wxPanel::Show(show);
+
+    // Called for every taskbar setting change; pick up the clock format now
+    if (show)
+        UpdateClock();
+    return changed;
+}
+
+void Taskbar::OnPaint(wxPaintEvent& event) {
+    wxUnusedVar(event);
+    wxAutoBufferedPaintDC dc(this);
+    dc.SetBackground(wxBrush(m_taskStrip->GetBackgroundColour()));
+    dc.Clear();
+}
+
+void Taskbar::OnSize(wxSizeEvent& event) {
+    event.Skip();
+    UpdateLayout();
+}
+
+void Taskbar::OnRightClick(wxContextMenuEvent& event) {
+    wxUnusedVar(event);
+    static const struct {
+        Position position;
+        ConfigSnapshot::Edge edge;
+        const char* label;
+    } kPositions[] = {
+        { Position::Top, ConfigSnapshot::Edge::Top, "Top" },
+        { Position::Bottom, ConfigSnapshot::Edge::Bottom, "Bottom" },
+        { Position::Left, ConfigSnapshot::Edge::Left, "Left" },
+        { Position::Right, ConfigSnapshot::Edge::Right, "Right" },
+    };
+    constexpr int kPositionCount = static_cast<int>(sizeof(kPositions) / sizeof(kPositions[0]));
+
+    wxMenu menu;
+    for (int i = 0; i < kPositionCount; ++i) {
+        menu.AppendCheckItem(kFirstPositionId + i, kPositions[i].label);
+        if (kPositions[i].position == m_position)
+            menu.Check(kFirstPositionId + i, true);
+    }
+
+    const int index = GetPopupMenuSelectionFromUser(menu) - kFirstPositionId;
+    if (index < 0 || index >= kPositionCount)
+        return;
+
+    // Goes through the configuration; the main frame applies and saves it
+    wxGetApp().GetConfigManager().SetString("taskbar", "position", ConfigSnapshot::EdgeName(kPositions[index].edge));
+}
+
+void Taskbar::OnNotificationTimer(wxTimerEvent& event) {
+    wxUnusedVar(event);
+    m_notificationLabel->Hide();
+    Layout();
+}
+
+void Taskbar::UpdateLayout() {
+    const bool vertical = m_position == Position::Left || m_position == Position::Right;
+    const int orientation = vertical ? wxVERTICAL : wxHORIZONTAL;
+    if (m_mainSizer->GetOrientation() != orientation) {
+        m_mainSizer->SetOrientation(orientation);
+        m_taskStrip->SetVertical(vertical);
+    }
+
+    Layout();
+    Refresh(false);
+}
+
+void Taskbar::UpdateClock() {
+    const std::shared_ptr<const ConfigSnapshot> snapshot = wxGetApp().GetConfigManager().GetSnapshot();
+    const ConfigSnapshot::TaskbarSettings& config = snapshot->taskbar;
+
+    // Follow format changes: a minute clock only needs a tick per minute
+    TickScheduler& scheduler = wxGetApp().GetTickScheduler();
+    const int interval = FormatHasSeconds(config.clockFormat) ? 1000 : 60 * 1000;
+    const TickScheduler::TaskStats* stats = scheduler.GetTaskStats(m_clockTask);
+    if (stats && stats->intervalMs != interval)
+        scheduler.SetInterval(m_clockTask, interval);
+
+    m_clockLabel->Show(config.showClock);
+    if (!config.showClock)
+        return;
+
+    const wxString text = wxDateTime::Now().Format(config.clockFormat);
+    if (text == m_clockText)
+        return;
+
+    m_clockText = text;
+    m_clockLabel->SetLabel(text);
+    Layout();
+}
+
+void Taskbar::UpdateBackground() {
+    // Blend the background towards black by the transparency level
+    const wxColour base = GetBackgroundColour();
+    const int alpha = m_transparency;
+    m_taskStrip->SetBackgroundColour(wxColour(base.Red() * alpha / 255, base.Green() * alpha / 255, base.Blue() * alpha / 255));
+}
+
+void Taskbar::ShowNotification(const NotificationRecord& record, size_t suppressed) {
+    const Notification& notification = record.notification;
+    wxString text = notification.title;
+    if (!notification.message.empty())
+        text += ": " + notification.message;
+    if (text.length() > kMaxNotificationLength)
+        text = text.Left(kMaxNotificationLength - 1) + wxString::FromUTF8("\xE2\x80\xA6");
+    if (record.count > 1)
+        text += wxString::Format(" (%u)", record.count);
+    if (suppressed > 0)
+        text += wxString::Format(" +%zu more", suppressed);
+
+    static const wxColour kLevelColours[] = { wxColour(), wxColour(230, 180, 60), wxColour(230, 90, 80) };
+    m_notificationLabel->SetForegroundColour(kLevelColours[static_cast<int>(notification.level)]);
+    m_notificationLabel->SetLabel(text);
+    m_notificationLabel->SetToolTip(notification.title + "\n" + notification.message);
+    m_notificationLabel->Show();
+    Layout();
+    m_notificationTimer.StartOnce(kNotificationShowMs);
+}
+
+void Taskbar::ActivateTask(wxWindow* window) {
+    window->Show();
+    window->Raise();
+    window->SetFocus();
+    SetActiveTask(window);
+}
+
+} // namespace ITD
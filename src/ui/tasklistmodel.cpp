@@ -0,0 +1,94 @@
+#include "ui/tasklistmodel.h"
+#include <algorithm>
+
+namespace ITD {
+
+bool TaskListModel::Add(const wxString& name, const wxIcon& icon, wxWindow* window) {
+    if (!window || m_indices.count(window))
+        return false;
+
+    TaskInfo task;
+    task.name = name;
+    task.icon = icon;
+    task.window = window;
+    task.isActive = window == m_active;
+    m_tasks.push_back(task);
+
+    const size_t index = m_tasks.size() - 1;
+    m_indices[window] = index;
+    Notify(ChangeKind::Inserted, index, window);
+    return true;
+}
+
+bool TaskListModel::Remove(wxWindow* window) {
+    auto it = m_indices.find(window);
+    if (it == m_indices.end())
+        return false;
+
+    const size_t index = it->second;
+    m_indices.erase(it);
+    m_tasks.erase(m_tasks.begin() + static_cast<std::ptrdiff_t>(index));
+    for (size_t i = index; i < m_tasks.size(); ++i)
+        m_indices[m_tasks[i].window] = i;
+    if (m_active == window)
+        m_active = nullptr;
+
+    Notify(ChangeKind::Removed, index, window);
+    return true;
+}
+
+bool TaskListModel::Update(wxWindow* window, const wxString& name, const wxIcon& icon) {
+    auto it = m_indices.find(window);
+    if (it == m_indices.end())
+        return false;
+
+    TaskInfo& task = m_tasks[it->second];
+    task.name = name;
+    task.icon = icon;
+    Notify(ChangeKind::Changed, it->second, window);
+    return true;
+}
+
+void TaskListModel::SetActive(wxWindow* window) {
+    if (!m_indices.count(window))
+        window = nullptr;
+    if (window == m_active)
+        return;
+
+    // Only the tasks that were and become active are reported
+    wxWindow* previous = m_active;
+    m_active = window;
+    for (wxWindow* changed : { previous, window }) {
+        auto it = m_indices.find(changed);
+        if (!changed || it == m_indices.end())
+            continue;
+        m_tasks[it->second].isActive = changed == m_active;
+        Notify(ChangeKind::Activated, it->second, changed);
+    }
+}
+
+int TaskListModel::Find(wxWindow* window) const {
+    auto it = m_indices.find(window);
+    return it != m_indices.end() ? static_cast<int>(it->second) : -1;
+}
+
+int TaskListModel::AddListener(Listener listener) {
+    const int id = m_nextListenerId++;
+    m_listeners.push_back({ id, std::move(listener) });
+    return id;
+}
+
+void TaskListModel::RemoveListener(int id) {
+    m_listeners.erase(std::remove_if(m_listeners.begin(), m_listeners.end(),
+        [id](const ListenerEntry& entry) { return entry.id == id; }), m_listeners.end());
+}
+
+void TaskListModel::Notify(ChangeKind kind, size_t index, wxWindow* window) {
+    // Listeners may add or remove listeners while being notified
+    const std::vector<ListenerEntry> listeners = m_listeners;
+    const Change change{ kind, index, window };
+    for (const ListenerEntry& listener : listeners)
+        listener.callback(change);
+}
+
+} // namespace ITD
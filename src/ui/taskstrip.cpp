@@ -0,0 +1,250 @@
+#include "ui/taskstrip.h"
+#include <wx/dcbuffer.h>
+#include <algorithm>
+
+namespace ITD {
+
+namespace {
+
+const wxSize kItemSize(160, 28);  // In DIPs
+constexpr int kIconSize = 16;     // In DIPs
+
+} // namespace
+
+TaskStrip::TaskStrip(wxWindow* parent, TaskListModel& model, SelectCallback onSelect)
+    : wxWindow(parent, wxID_ANY, wxDefaultPosition, wxDefaultSize, wxBORDER_NONE),
+      m_model(model),
+      m_onSelect(std::move(onSelect)),
+      m_itemSize(FromDIP(kItemSize)) {
+    SetBackgroundStyle(wxBG_STYLE_PAINT);
+    SetMinSize(wxSize(-1, m_itemSize.y));
+
+    Bind(wxEVT_PAINT, &TaskStrip::OnPaint, this);
+    Bind(wxEVT_SIZE, &TaskStrip::OnSize, this);
+    Bind(wxEVT_MOTION, &TaskStrip::OnMotion, this);
+    Bind(wxEVT_LEAVE_WINDOW, &TaskStrip::OnLeave, this);
+    Bind(wxEVT_LEFT_UP, &TaskStrip::OnLeftUp, this);
+    Bind(wxEVT_MOUSEWHEEL, &TaskStrip::OnMouseWheel, this);
+    Bind(wxEVT_DPI_CHANGED, &TaskStrip::OnDPIChanged, this);
+
+    m_listener = m_model.AddListener([this](const TaskListModel::Change& change) { OnModelChange(change); });
+}
+
+TaskStrip::~TaskStrip() {
+    m_model.RemoveListener(m_listener);
+}
+
+void TaskStrip::SetVertical(bool vertical) {
+    if (vertical == m_vertical)
+        return;
+
+    m_vertical = vertical;
+    SetMinSize(vertical ? wxSize(m_itemSize.x, -1) : wxSize(-1, m_itemSize.y));
+    m_scrollOffset = 0;
+    m_hover = -1;
+    Refresh(false);
+}
+
+int TaskStrip::HitTest(const wxPoint& point) const {
+    if (!GetClientRect().Contains(point))
+        return -1;
+
+    const int position = (m_vertical ? point.y : point.x) + m_scrollOffset;
+    const int index = position / (m_vertical ? m_itemSize.y : m_itemSize.x);
+    return index < static_cast<int>(m_model.GetCount()) ? index : -1;
+}
+
+wxRect TaskStrip::GetItemRect(size_t index) const {
+    const wxSize size = GetClientSize();
+    const int offset = static_cast<int>(index) * (m_vertical ? m_itemSize.y : m_itemSize.x) - m_scrollOffset;
+    if (m_vertical)
+        return wxRect(0, offset, size.x, m_itemSize.y);
+    return wxRect(offset, 0, m_itemSize.x, size.y);
+}
+
+const wxBitmap& TaskStrip::GetIcon(const TaskInfo& task) {
+    auto it = m_icons.find(task.window);
+    if (it != m_icons.end())
+        return it->second;
+
+    // Scaled here once rather than by every paint
+    wxBitmap bitmap;
+    if (task.icon.IsOk()) {
+        bitmap.CopyFromIcon(task.icon);
+        const int side = FromDIP(kIconSize);
+        if (bitmap.GetWidth() != side || bitmap.GetHeight() != side) {
+            wxImage image = bitmap.ConvertToImage();
+            image.Rescale(side, side, wxIMAGE_QUALITY_HIGH);
+            bitmap = wxBitmap(image);
+        }
+    }
+    return m_icons.emplace(task.window, bitmap).first->second;
+}
+
+int TaskStrip::GetLength() const {
+    const wxSize size = GetClientSize();
+    return m_vertical ? size.y : size.x;
+}
+
+int TaskStrip::GetExtent() const {
+    return static_cast<int>(m_model.GetCount()) * (m_vertical ? m_itemSize.y : m_itemSize.x);
+}
+
+void TaskStrip::ClampScroll() {
+    m_scrollOffset = std::max(0, std::min(m_scrollOffset, GetExtent() - GetLength()));
+}
+
+void TaskStrip::RefreshItem(int index) {
+    if (index < 0 || index >= static_cast<int>(m_model.GetCount()))
+        return;
+
+    const wxRect rect = GetItemRect(static_cast<size_t>(index)).Intersect(GetClientRect());
+    if (!rect.IsEmpty())
+        RefreshRect(rect, false);
+}
+
+void TaskStrip::RefreshFrom(size_t index) {
+    const wxSize size = GetClientSize();
+    const wxRect item = GetItemRect(index);
+    const int start = std::max(0, m_vertical ? item.y : item.x);
+    const wxRect rect = m_vertical ? wxRect(0, start, size.x, size.y - start)
+                                   : wxRect(start, 0, size.x - start, size.y);
+    if (!rect.IsEmpty())
+        RefreshRect(rect, false);
+}
+
+void TaskStrip::SetHover(int index) {
+    if (index == m_hover)
+        return;
+
+    RefreshItem(m_hover);
+    m_hover = index;
+    RefreshItem(m_hover);
+
+    // Names may be cut off; the tooltip shows them in full
+    if (m_hover >= 0)
+        SetToolTip(m_model.GetTask(static_cast<size_t>(m_hover)).name);
+    else
+        UnsetToolTip();
+}
+
+void TaskStrip::OnModelChange(const TaskListModel::Change& change) {
+    switch (change.kind) {
+        case TaskListModel::ChangeKind::Inserted:
+        case TaskListModel::ChangeKind::Removed: {
+            // Later items moved; the one under the mouse is found again on the next move
+            if (change.kind == TaskListModel::ChangeKind::Removed)
+                m_icons.erase(change.window);
+            if (m_hover >= static_cast<int>(change.index))
+                m_hover = -1;
+
+            const int previous = m_scrollOffset;
+            ClampScroll();
+            if (m_scrollOffset != previous)
+                Refresh(false);
+            else
+                RefreshFrom(change.index);
+            break;
+        }
+        case TaskListModel::ChangeKind::Changed:
+            m_icons.erase(change.window);
+            RefreshItem(static_cast<int>(change.index));
+            break;
+        case TaskListModel::ChangeKind::Activated:
+            RefreshItem(static_cast<int>(change.index));
+            break;
+    }
+}
+
+void TaskStrip::OnPaint(wxPaintEvent& event) {
+    wxUnusedVar(event);
+    wxAutoBufferedPaintDC dc(this);
+    const wxColour background = GetBackgroundColour();
+    const wxRect update = GetUpdateClientRect();
+    dc.SetPen(*wxTRANSPARENT_PEN);
+    dc.SetBrush(wxBrush(background));
+    dc.DrawRectangle(update);
+    if (m_model.GetCount() == 0)
+        return;
+
+    // Only the items inside the updated area are drawn
+    const int itemLength = m_vertical ? m_itemSize.y : m_itemSize.x;
+    const int start = std::max(0, (m_vertical ? update.y : update.x) + m_scrollOffset);
+    const int end = std::max(0, (m_vertical ? update.GetBottom() : update.GetRight()) + m_scrollOffset);
+    const size_t first = static_cast<size_t>(start / itemLength);
+    const size_t last = std::min(m_model.GetCount(), static_cast<size_t>(end / itemLength) + 1);
+
+    const wxFont font = GetFont();
+    const wxFont bold = font.Bold();
+    const int padding = FromDIP(2);
+    const int margin = FromDIP(6);
+    dc.SetTextForeground(GetForegroundColour());
+    for (size_t i = first; i < last; ++i) {
+        const TaskInfo& task = m_model.GetTask(i);
+        const wxRect rect = GetItemRect(i).Deflate(padding);
+        if (task.isActive || static_cast<int>(i) == m_hover) {
+            dc.SetBrush(wxBrush(background.ChangeLightness(task.isActive ? 130 : 115)));
+            dc.DrawRectangle(rect);
+        }
+
+        wxDCClipper clipper(dc, rect);
+        dc.SetFont(task.isActive ? bold : font);
+        dc.DrawLabel(task.name, GetIcon(task), rect.Deflate(margin, 0), wxALIGN_LEFT | wxALIGN_CENTER_VERTICAL);
+    }
+}
+
+void TaskStrip::OnSize(wxSizeEvent& event) {
+    event.Skip();
+
+    // Growing may leave the scrolled items short of the end
+    const int previous = m_scrollOffset;
+    ClampScroll();
+    if (m_scrollOffset != previous)
+        Refresh(false);
+}
+
+void TaskStrip::OnMotion(wxMouseEvent& event) {
+    event.Skip();
+    SetHover(HitTest(event.GetPosition()));
+}
+
+void TaskStrip::OnLeave(wxMouseEvent& event) {
+    event.Skip();
+    SetHover(-1);
+}
+
+void TaskStrip::OnLeftUp(wxMouseEvent& event) {
+    event.Skip();
+    const int index = HitTest(event.GetPosition());
+    if (index >= 0 && m_onSelect)
+        m_onSelect(m_model.GetTask(static_cast<size_t>(index)).window);
+}
+
+void TaskStrip::OnMouseWheel(wxMouseEvent& event) {
+    const int delta = event.GetWheelDelta();
+    if (delta == 0)
+        return;
+
+    const int previous = m_scrollOffset;
+    m_scrollOffset -= event.GetWheelRotation() * (m_vertical ? m_itemSize.y : m_itemSize.x) / delta;
+    ClampScroll();
+    if (m_scrollOffset == previous)
+        return;
+
+    m_hover = -1;
+    SetHover(HitTest(event.GetPosition()));
+    Refresh(false);
+}
+
+void TaskStrip::OnDPIChanged(wxDPIChangedEvent& event) {
+    event.Skip();
+
+    // Icons are scaled again for the new DPI the next time they are drawn
+    m_icons.clear();
+    m_itemSize = FromDIP(kItemSize);
+    SetMinSize(m_vertical ? wxSize(m_itemSize.x, -1) : wxSize(-1, m_itemSize.y));
+    ClampScroll();
+    Refresh(false);
+}
+
+} // namespace ITD
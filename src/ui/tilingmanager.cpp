@@ -1 +1,496 @@
-// Placeholder  
+#include "ui/tilingmanager.h"
+#include <wx/dcbuffer.h>
+#include <algorithm>
+#include <cmath>
+
+namespace ITD {
+
+namespace {
+
+const struct {
+    const char* name;
+    TilingManager::LayoutType type;
+} kLayouts[] = {
+    { "horizontal", TilingManager::LayoutType::Horizontal },
+    { "vertical", TilingManager::LayoutType::Vertical },
+    { "grid", TilingManager::LayoutType::Grid },
+    { "stacked", TilingManager::LayoutType::Stacked },
+    { "tabbed", TilingManager::LayoutType::Tabbed },
+    { "tiled", TilingManager::LayoutType::Tiled },
+};
+
+} // namespace
+
+TilingManager::TilingManager(wxWindow* parent)
+    : m_parent(parent),
+      m_resizeDebouncer([this]() { EndResizePreview(); }) {
+    m_parent->Bind(wxEVT_SIZE, &TilingManager::OnParentSize, this);
+}
+
+TilingManager::~TilingManager() {
+    m_parent->Unbind(wxEVT_SIZE, &TilingManager::OnParentSize, this);
+    if (m_preview)
+        m_preview->Destroy();
+    for (wxWindow* window : m_windows)
+        window->Unbind(wxEVT_CLOSE_WINDOW, &TilingManager::OnWindowClose, this);
+    for (const Desktop& desktop : m_desktops) {
+        for (wxWindow* window : desktop.windows)
+            window->Unbind(wxEVT_CLOSE_WINDOW, &TilingManager::OnWindowClose, this);
+    }
+}
+
+void TilingManager::SetLayoutType(LayoutType type) {
+    if (type == m_currentLayout)
+        return;
+
+    // The tiled layout starts from the current arrangement; the others are
+    // rebuilt. Windows hidden by the stacked layout must be placed again.
+    m_currentLayout = type;
+    if (type != LayoutType::Tiled)
+        m_treeValid = false;
+    m_tree.Invalidate();
+    UpdateLayout();
+}
+
+void TilingManager::AddWindow(wxWindow* window, const wxString& name) {
+    if (!window || m_windowNames.count(window) || FindParkedDesktop(window))
+        return;
+
+    m_windows.push_back(window);
+    m_windowNames[window] = name;
+    window->Bind(wxEVT_CLOSE_WINDOW, &TilingManager::OnWindowClose, this);
+
+    // A tiled window splits the focused one; the other layouts are rebuilt
+    if (m_currentLayout == LayoutType::Tiled && m_treeValid)
+        m_tree.Insert(window, m_focusedWindow, m_splitHorizontal);
+    else
+        m_treeValid = false;
+
+    if (m_transparency != 255 && window->CanSetTransparent())
+        window->SetTransparent(m_transparency);
+    if (!m_focusedWindow)
+        m_focusedWindow = window;
+
+    UpdateLayout();
+}
+
+bool TilingManager::RemoveWindow(wxWindow* window) {
+    auto it = std::find(m_windows.begin(), m_windows.end(), window);
+    if (it == m_windows.end()) {
+        // A window of an inactive desktop leaves without a layout pass
+        Desktop* desktop = FindParkedDesktop(window);
+        if (!desktop)
+            return false;
+
+        window->Unbind(wxEVT_CLOSE_WINDOW, &TilingManager::OnWindowClose, this);
+        desktop->windows.erase(std::find(desktop->windows.begin(), desktop->windows.end(), window));
+        desktop->windowNames.erase(window);
+        if (desktop->layout == LayoutType::Tiled && desktop->treeValid)
+            desktop->tree.Remove(window);
+        else
+            desktop->treeValid = false;
+        if (desktop->focusedWindow == window)
+            desktop->focusedWindow = desktop->windows.empty() ? nullptr : desktop->windows.front();
+        return true;
+    }
+
+    window->Unbind(wxEVT_CLOSE_WINDOW, &TilingManager::OnWindowClose, this);
+    const size_t index = static_cast<size_t>(it - m_windows.begin());
+    m_windows.erase(it);
+    m_windowNames.erase(window);
+    if (m_currentLayout == LayoutType::Tiled && m_treeValid)
+        m_tree.Remove(window);
+    else
+        m_treeValid = false;
+
+    // Hand the focus to the window that took its place
+    if (m_focusedWindow == window)
+        m_focusedWindow = m_windows.empty() ? nullptr : m_windows[std::min(index, m_windows.size() - 1)];
+
+    UpdateLayout();
+    return true;
+}
+
+void TilingManager::FocusWindow(wxWindow* window) {
+    if (std::find(m_windows.begin(), m_windows.end(), window) == m_windows.end())
+        return;
+
+    const bool changed = m_focusedWindow != window;
+    m_focusedWindow = window;
+
+    // Only one window is visible in the stacked and tabbed layouts
+    if (changed && (m_currentLayout == LayoutType::Stacked || m_currentLayout == LayoutType::Tabbed))
+        UpdateLayout();
+    window->SetFocus();
+}
+
+wxString TilingManager::GetWindowName(wxWindow* window) const {
+    auto it = m_windowNames.find(window);
+    return it != m_windowNames.end() ? it->second : wxString();
+}
+
+wxString TilingManager::GetLayoutName(LayoutType type) {
+    for (const auto& entry : kLayouts) {
+        if (entry.type == type)
+            return entry.name;
+    }
+    return wxString();
+}
+
+bool TilingManager::ParseLayoutName(const wxString& name, LayoutType& type) {
+    for (const auto& entry : kLayouts) {
+        if (name.IsSameAs(entry.name, false)) {
+            type = entry.type;
+            return true;
+        }
+    }
+    return false;
+}
+
+void TilingManager::UpdateLayout() {
+    if (m_updateDepth > 0) {
+        m_layoutPending = true;
+        return;
+    }
+    m_layoutPending = false;
+
+    // During a resize drag the windows are placed once the size settles
+    if (IsPreviewing()) {
+        m_preview->Refresh(false);
+        return;
+    }
+
+    if (m_windows.empty())
+        return;
+    ++m_layoutCount;
+
+    switch (m_currentLayout) {
+        case LayoutType::Stacked:
+            LayoutStacked();
+            break;
+        case LayoutType::Tabbed:
+            LayoutTabbed();
+            break;
+        default:
+            LayoutTree();
+            break;
+    }
+}
+
+std::string TilingManager::SaveLayout(const std::vector<wxWindow*>& windows) const {
+    if (m_currentLayout == LayoutType::Stacked || m_currentLayout == LayoutType::Tabbed || !m_treeValid)
+        return std::string();
+    return m_tree.Save(windows);
+}
+
+bool TilingManager::RestoreLayout(LayoutType type, const std::string& shape, const std::vector<wxWindow*>& windows) {
+    m_currentLayout = type;
+    m_treeValid = false;
+    m_tree.Invalidate();
+
+    bool restored = false;
+    if (type != LayoutType::Stacked && type != LayoutType::Tabbed && !shape.empty()) {
+        restored = m_tree.Load(shape, windows);
+        if (restored) {
+            for (wxWindow* window : m_windows) {
+                if (!m_tree.Contains(window))
+                    m_tree.Insert(window, nullptr, m_splitHorizontal);
+            }
+
+            // Windows the description names but that are not managed
+            for (wxWindow* window : windows) {
+                if (window && m_tree.Contains(window) && !m_windowNames.count(window))
+                    m_tree.Remove(window);
+            }
+            m_treeValid = true;
+        }
+    }
+
+    UpdateLayout();
+    return restored;
+}
+
+void TilingManager::EndUpdate() {
+    if (m_updateDepth == 0 || --m_updateDepth > 0)
+        return;
+
+    if (m_layoutPending)
+        UpdateLayout();
+}
+
+void TilingManager::SetTransparency(unsigned char alpha) {
+    m_transparency = alpha;
+    for (wxWindow* window : m_windows) {
+        if (window->CanSetTransparent())
+            window->SetTransparent(alpha);
+    }
+    for (const Desktop& desktop : m_desktops) {
+        for (wxWindow* window : desktop.windows) {
+            if (window->CanSetTransparent())
+                window->SetTransparent(alpha);
+        }
+    }
+}
+
+void TilingManager::CycleWindowFocus() {
+    if (m_windows.empty())
+        return;
+
+    auto it = std::find(m_windows.begin(), m_windows.end(), m_focusedWindow);
+    if (it == m_windows.end() || ++it == m_windows.end())
+        it = m_windows.begin();
+    FocusWindow(*it);
+}
+
+void TilingManager::SplitWindow(bool horizontal) {
+    m_splitHorizontal = horizontal;
+    SetLayoutType(LayoutType::Tiled);
+}
+
+bool TilingManager::SetSplitRatio(wxWindow* window, double ratio) {
+    if (m_currentLayout == LayoutType::Stacked || m_currentLayout == LayoutType::Tabbed || !m_treeValid)
+        return false;
+
+    // Outside the tiled layout, the ratio lasts until the next rebuild
+    if (!m_tree.SetRatio(window, ratio))
+        return false;
+    UpdateLayout();
+    return true;
+}
+
+bool TilingManager::SwitchDesktop(size_t index) {
+    if (index >= kMaxDesktops)
+        return false;
+    if (index == m_activeDesktop)
+        return true;
+    if (m_desktops.size() <= index)
+        m_desktops.resize(index + 1);
+
+    // Hidden windows are left exactly as they are; until shown again they
+    // are not laid out or painted, and tasks gated on them do not tick
+    m_parent->Freeze();
+    for (wxWindow* window : m_windows)
+        window->Hide();
+    SwapDesktop(m_desktops[m_activeDesktop]);
+    SwapDesktop(m_desktops[index]);
+    m_activeDesktop = index;
+
+    // Every window must be shown again; only those whose rectangle changed
+    // while away are moved
+    m_tree.Invalidate();
+    UpdateLayout();
+    m_parent->Thaw();
+
+    if (m_focusedWindow)
+        m_focusedWindow->SetFocus();
+    return true;
+}
+
+bool TilingManager::MoveWindowToDesktop(wxWindow* window, size_t index) {
+    if (index >= kMaxDesktops)
+        return false;
+    if (m_desktops.size() <= index)
+        m_desktops.resize(index + 1);
+
+    Desktop* source = FindParkedDesktop(window);
+    const bool active = !source && m_windowNames.count(window) != 0;
+    if (!source && !active)
+        return false;
+    if (active ? index == m_activeDesktop : source == &m_desktops[index])
+        return true;
+
+    const wxString name = active ? GetWindowName(window) : source->windowNames[window];
+    RemoveWindow(window);
+    if (index == m_activeDesktop) {
+        AddWindow(window, name);
+        return true;
+    }
+
+    // Parked windows stay hidden until their desktop is shown
+    window->Hide();
+    Desktop& target = m_desktops[index];
+    target.windows.push_back(window);
+    target.windowNames[window] = name;
+    window->Bind(wxEVT_CLOSE_WINDOW, &TilingManager::OnWindowClose, this);
+    if (target.layout == LayoutType::Tiled && target.treeValid)
+        target.tree.Insert(window, target.focusedWindow, target.splitHorizontal);
+    else
+        target.treeValid = false;
+    if (!target.focusedWindow)
+        target.focusedWindow = window;
+    return true;
+}
+
+void TilingManager::SwapDesktop(Desktop& desktop) {
+    std::swap(m_windows, desktop.windows);
+    std::swap(m_windowNames, desktop.windowNames);
+    std::swap(m_currentLayout, desktop.layout);
+    std::swap(m_focusedWindow, desktop.focusedWindow);
+    std::swap(m_tree, desktop.tree);
+    std::swap(m_treeValid, desktop.treeValid);
+    std::swap(m_splitHorizontal, desktop.splitHorizontal);
+}
+
+TilingManager::Desktop* TilingManager::FindParkedDesktop(wxWindow* window) {
+    for (size_t i = 0; i < m_desktops.size(); ++i) {
+        if (i != m_activeDesktop && m_desktops[i].windowNames.count(window))
+            return &m_desktops[i];
+    }
+    return nullptr;
+}
+
+void TilingManager::Place(wxWindow* window, const wxRect& rect) {
+    window->SetSize(rect);
+    window->Show();
+}
+
+void TilingManager::RebuildTree() {
+    switch (m_currentLayout) {
+        case LayoutType::Horizontal:
+            m_tree.BuildRow(m_windows, true);
+            break;
+        case LayoutType::Vertical:
+            m_tree.BuildRow(m_windows, false);
+            break;
+        case LayoutType::Grid: {
+            const double count = static_cast<double>(m_windows.size());
+            m_tree.BuildGrid(m_windows, static_cast<size_t>(std::ceil(std::sqrt(count))));
+            break;
+        }
+        default:
+            m_tree.BuildRow(m_windows, m_splitHorizontal);
+            break;
+    }
+    m_treeValid = true;
+}
+
+void TilingManager::LayoutTree() {
+    if (!m_treeValid)
+        RebuildTree();
+
+    m_tree.SetArea(m_parent->GetClientRect());
+    m_tree.Layout(m_changes);
+    if (m_changes.empty())
+        return;
+
+    // Moving several windows would otherwise repaint after each move; where
+    // the platform can, the moves are also applied as one batch
+    m_parent->Freeze();
+    {
+        wxWindow::ChildrenRepositioningGuard repositioning(m_parent);
+        for (const SplitTree::Change& change : m_changes)
+            Place(change.window, change.rect);
+    }
+    m_parent->Thaw();
+}
+
+void TilingManager::LayoutStacked() {
+    const wxRect area = m_parent->GetClientRect();
+    wxWindow* visible = m_focusedWindow ? m_focusedWindow : m_windows.front();
+
+    m_parent->Freeze();
+    for (wxWindow* window : m_windows) {
+        if (window == visible)
+            Place(window, area);
+        else
+            window->Hide();
+    }
+    m_parent->Thaw();
+}
+
+void TilingManager::LayoutTabbed() {
+    // The tabs themselves are shown by the taskbar
+    LayoutStacked();
+}
+
+void TilingManager::ShowResizePreview() {
+    if (m_windows.empty())
+        return;
+
+    const wxRect area = m_parent->GetClientRect();
+    if (!m_preview) {
+        m_preview = new wxWindow(m_parent, wxID_ANY, area.GetPosition(), area.GetSize(), wxBORDER_NONE);
+        m_preview->SetBackgroundStyle(wxBG_STYLE_PAINT);
+        m_preview->Bind(wxEVT_PAINT, &TilingManager::OnPreviewPaint, this);
+        m_preview->Hide();
+    }
+
+    if (IsPreviewing()) {
+        m_preview->SetSize(area);
+        m_preview->Refresh(false);
+        return;
+    }
+
+    // Hidden windows are neither laid out nor repainted while the size changes
+    m_parent->Freeze();
+    for (wxWindow* window : m_windows)
+        window->Hide();
+    m_preview->SetSize(area);
+    m_preview->Show();
+    m_preview->Raise();
+    m_parent->Thaw();
+}
+
+void TilingManager::EndResizePreview() {
+    m_parent->Freeze();
+    if (IsPreviewing()) {
+        m_preview->Hide();
+        m_tree.Invalidate();  // The hidden windows must be shown again
+    }
+    UpdateLayout();
+    m_parent->Thaw();
+}
+
+void TilingManager::OnParentSize(wxSizeEvent& event) {
+    event.Skip();
+
+    // A lone resize is laid out at once; a drag shows the preview instead
+    if (m_resizeDebouncer.Defer())
+        ShowResizePreview();
+    else
+        UpdateLayout();
+}
+
+void TilingManager::OnWindowClose(wxCloseEvent& event) {
+    event.Skip();
+    RemoveWindow(wxDynamicCast(event.GetEventObject(), wxWindow));
+}
+
+void TilingManager::OnPreviewPaint(wxPaintEvent& event) {
+    wxUnusedVar(event);
+    wxAutoBufferedPaintDC dc(m_preview);
+    const wxColour background = m_parent->GetBackgroundColour();
+    dc.SetBackground(wxBrush(background));
+    dc.Clear();
+    if (m_windows.empty())
+        return;
+
+    dc.SetBrush(wxBrush(background.ChangeLightness(115)));
+    dc.SetPen(wxPen(background.ChangeLightness(70)));
+    dc.SetFont(m_preview->GetFont());
+    dc.SetTextForeground(m_parent->GetForegroundColour());
+
+    // The geometry is computed once per painted frame, not once per size event
+    const wxRect area = m_parent->GetClientRect();
+    const wxPoint origin = m_preview->GetPosition();
+    auto drawPane = [&](wxWindow* window, wxRect rect) {
+        rect.Offset(-origin.x, -origin.y);
+        dc.DrawRectangle(rect.Deflate(1));
+        dc.DrawLabel(GetWindowName(window), rect, wxALIGN_CENTER);
+    };
+
+    if (m_currentLayout == LayoutType::Stacked || m_currentLayout == LayoutType::Tabbed) {
+        drawPane(m_focusedWindow ? m_focusedWindow : m_windows.front(), area);
+        return;
+    }
+
+    // Only the geometry is updated; the windows move once the size settles
+    if (!m_treeValid)
+        RebuildTree();
+    m_tree.SetArea(area);
+    m_tree.Layout(m_changes);
+    for (wxWindow* window : m_windows)
+        drawPane(window, m_tree.GetRect(window));
+}
+
+} // namespace ITD
@@ -0,0 +1,380 @@
+#include "ui/workspacemanager.h"
+#include "app.h"
+#include "config/configmanager.h"
+#include "explorer/yaziexplorer.h"
+#include "terminal/terminalwx.h"
+#include "util/atomicfile.h"
+#include "util/mappedfile.h"
+#include <wx/dir.h>
+#include <wx/filename.h>
+#include <algorithm>
+
+namespace ITD {
+
+namespace {
+
+const char kExtension[] = "workspace";
+const char kHistoryExtension[] = "history";
+const char kTerminalType[] = "terminal";
+const char kExplorerType[] = "explorer";
+
+// Names become file names, so they may not reach outside the directory
+bool IsValidName(const wxString& name) {
+    return !name.empty() && name != "." && name != ".." && name.find_first_of("/\\:") == wxString::npos;
+}
+
+wxString GetWorkspacePath(const wxString& name) {
+    return wxFileName(WorkspaceManager::GetDirectory(), name, kExtension).GetFullPath();
+}
+
+wxString GetPaneSection(size_t index) {
+    return wxString::Format("pane%zu", index);
+}
+
+wxString GetValue(const std::map<wxString, wxString>& values, const char* key) {
+    auto it = values.find(key);
+    return it != values.end() ? it->second : wxString();
+}
+
+// Type name of a window that can be part of a workspace; empty otherwise
+wxString GetPaneType(wxWindow* window) {
+    if (dynamic_cast<TerminalWx*>(window))
+        return kTerminalType;
+    if (dynamic_cast<YaziExplorer*>(window))
+        return kExplorerType;
+    return wxString();
+}
+
+} // namespace
+
+ConfigEntries Workspace::ToEntries() const {
+    ConfigEntries entries;
+    std::map<wxString, wxString>& header = entries["workspace"];
+    header["layout"] = TilingManager::GetLayoutName(layout);
+    if (!tree.empty())
+        header["tree"] = wxString::FromUTF8(tree.c_str());
+    header["focus"] = wxString::Format("%d", focus);
+
+    for (size_t i = 0; i < panes.size(); ++i) {
+        const WorkspacePane& pane = panes[i];
+        std::map<wxString, wxString>& values = entries[GetPaneSection(i)];
+        values["type"] = pane.type;
+        values["name"] = pane.name;
+        if (!pane.directory.empty())
+            values["directory"] = pane.directory;
+        if (pane.anchor > 0)
+            values["anchor"] = wxString::Format("%d", pane.anchor);
+        if (!pane.history.empty())
+            values["history"] = pane.history;
+    }
+    return entries;
+}
+
+bool Workspace::FromEntries(const ConfigEntries& entries) {
+    auto header = entries.find("workspace");
+    if (header == entries.end())
+        return false;
+
+    *this = Workspace();
+    TilingManager::ParseLayoutName(GetValue(header->second, "layout"), layout);
+    tree = GetValue(header->second, "tree").utf8_str().data();
+    long number;
+    if (GetValue(header->second, "focus").ToLong(&number))
+        focus = static_cast<int>(number);
+
+    // Panes are numbered from 0 without gaps
+    for (size_t i = 0;; ++i) {
+        auto section = entries.find(GetPaneSection(i));
+        if (section == entries.end())
+            break;
+
+        WorkspacePane pane;
+        pane.type = GetValue(section->second, "type");
+        pane.name = GetValue(section->second, "name");
+        pane.directory = GetValue(section->second, "directory");
+        if (GetValue(section->second, "anchor").ToLong(&number))
+            pane.anchor = static_cast<int>(std::max(number, 0L));
+        pane.history = GetValue(section->second, "history");
+        panes.push_back(pane);
+    }
+
+    if (focus >= static_cast<int>(panes.size()))
+        focus = -1;
+    return true;
+}
+
+WorkspaceManager::WorkspaceManager(wxWindow* parent, TilingManager* tilingManager)
+    : m_parent(parent),
+      m_tilingManager(tilingManager) {
+}
+
+WorkspaceManager::~WorkspaceManager() {
+    // The panes outlive the manager
+    for (wxWindow* window : m_ownedPanes) {
+        window->Unbind(wxEVT_SHOW, &WorkspaceManager::OnPaneShow, this);
+        window->Unbind(wxEVT_DESTROY, &WorkspaceManager::OnPaneDestroy, this);
+    }
+}
+
+wxString WorkspaceManager::GetDirectory() {
+    const wxString configDir = wxFileName(wxGetApp().GetConfigManager().GetConfigFilePath()).GetPath();
+    return wxFileName(configDir, "workspaces").GetFullPath();
+}
+
+bool WorkspaceManager::Save(const wxString& name) {
+    const wxString directory = GetDirectory();
+    if (!IsValidName(name))
+        return false;
+    if (!wxFileName::DirExists(directory) && !wxFileName::Mkdir(directory, wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL))
+        return false;
+
+    // Panes are numbered in tiling order; other windows are left out
+    Workspace workspace;
+    workspace.layout = m_tilingManager->GetLayoutType();
+    std::vector<wxWindow*> saved;
+    for (wxWindow* window : m_tilingManager->GetWindows()) {
+        WorkspacePane pane;
+        pane.type = GetPaneType(window);
+        pane.name = m_tilingManager->GetWindowName(window);
+        if (TerminalWx* terminal = dynamic_cast<TerminalWx*>(window)) {
+            pane.directory = terminal->GetCurrentDirectory();
+            pane.anchor = terminal->GetScrollAnchor();
+
+            const wxString history = terminal->GetScrollback(kMaxHistoryLength);
+            if (!history.empty()) {
+                pane.history = wxString::Format("%s.%zu.%s", name, saved.size(), kHistoryExtension);
+                const wxScopedCharBuffer utf8 = history.utf8_str();
+                if (!WriteFileAtomic(wxFileName(directory, pane.history).GetFullPath(), utf8.data(), utf8.length()))
+                    return false;
+            }
+        } else if (YaziExplorer* explorer = dynamic_cast<YaziExplorer*>(window)) {
+            pane.directory = explorer->GetCurrentDirectory();
+        } else {
+            continue;
+        }
+
+        if (window == m_tilingManager->GetFocusedWindow())
+            workspace.focus = static_cast<int>(saved.size());
+        workspace.panes.push_back(pane);
+        saved.push_back(window);
+    }
+    workspace.tree = m_tilingManager->SaveLayout(saved);
+
+    const wxString path = GetWorkspacePath(name);
+    if (!WriteFileAtomic(path, ConfigManager::SerializeEntries(workspace.ToEntries())))
+        return false;
+
+    // Scrollback of panes the workspace no longer has
+    wxArrayString files;
+    wxDir::GetAllFiles(directory, &files, name + ".*." + kHistoryExtension, wxDIR_FILES);
+    for (const wxString& file : files) {
+        // Only <name>.<number>.history; "dev.1.0.history" belongs to "dev.1"
+        const wxString fileName = wxFileName(file).GetFullName();
+        wxString index;
+        if (!fileName.BeforeLast('.').StartsWith(name + ".", &index) || !index.IsNumber())
+            continue;
+
+        const bool used = std::any_of(workspace.panes.begin(), workspace.panes.end(),
+            [&](const WorkspacePane& pane) { return pane.history == fileName; });
+        if (!used)
+            wxRemoveFile(file);
+    }
+
+    CacheEntry& entry = m_cache[name];
+    entry.workspace = std::move(workspace);
+    entry.modified = wxFileName(path).GetModificationTime();
+    return true;
+}
+
+bool WorkspaceManager::Restore(const wxString& name) {
+    const Workspace* workspace = Load(name);
+    if (!workspace)
+        return false;
+
+    const wxString directory = GetDirectory();
+    const std::vector<wxWindow*> current = m_tilingManager->GetWindows();
+    std::vector<bool> kept(current.size(), false);
+    std::vector<wxWindow*> windows(workspace->panes.size(), nullptr);
+
+    m_parent->Freeze();
+    m_tilingManager->BeginUpdate();
+
+    // Panes with the same type and name are kept as they are
+    for (size_t i = 0; i < workspace->panes.size(); ++i) {
+        const WorkspacePane& pane = workspace->panes[i];
+        for (size_t j = 0; j < current.size(); ++j) {
+            if (!kept[j] && GetPaneType(current[j]) == pane.type &&
+                m_tilingManager->GetWindowName(current[j]) == pane.name) {
+                kept[j] = true;
+                windows[i] = current[j];
+                break;
+            }
+        }
+
+        if (!windows[i]) {
+            windows[i] = CreatePane(pane, directory);
+            if (windows[i])
+                m_tilingManager->AddWindow(windows[i], pane.name);
+        }
+    }
+
+    // Panes created elsewhere (the initial terminal) are not ours to destroy;
+    // they are parked on another desktop, where they keep running
+    const size_t active = m_tilingManager->GetActiveDesktop();
+    size_t parking = m_tilingManager->GetDesktopCount();
+    if (parking >= TilingManager::kMaxDesktops)
+        parking = active == TilingManager::kMaxDesktops - 1 ? active - 1 : TilingManager::kMaxDesktops - 1;
+
+    for (size_t j = 0; j < current.size(); ++j) {
+        if (kept[j])
+            continue;
+        if (m_ownedPanes.count(current[j])) {
+            m_tilingManager->RemoveWindow(current[j]);
+            current[j]->Hide();
+            current[j]->Destroy();
+        } else {
+            m_tilingManager->MoveWindowToDesktop(current[j], parking);
+        }
+    }
+
+    m_tilingManager->RestoreLayout(workspace->layout, workspace->tree, windows);
+    m_tilingManager->EndUpdate();
+    m_parent->Thaw();
+
+    if (workspace->focus >= 0 && windows[workspace->focus])
+        m_tilingManager->FocusWindow(windows[workspace->focus]);
+    return true;
+}
+
+std::vector<wxString> WorkspaceManager::GetWorkspaceNames() const {
+    std::vector<wxString> names;
+    const wxString directory = GetDirectory();
+    if (!wxDir::Exists(directory))
+        return names;
+
+    wxArrayString files;
+    wxDir::GetAllFiles(directory, &files, wxString("*.") + kExtension, wxDIR_FILES);
+    for (const wxString& file : files)
+        names.push_back(wxFileName(file).GetName());
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+const Workspace* WorkspaceManager::Load(const wxString& name) {
+    const wxString path = GetWorkspacePath(name);
+    if (!IsValidName(name) || !wxFileName::FileExists(path))
+        return nullptr;
+
+    // Switching back to a workspace does not parse its file again
+    const wxDateTime modified = wxFileName(path).GetModificationTime();
+    auto it = m_cache.find(name);
+    if (it != m_cache.end() && modified.IsValid() && it->second.modified.IsValid() &&
+        it->second.modified == modified)
+        return &it->second.workspace;
+
+    ConfigEntries entries;
+    Workspace workspace;
+    if (!ConfigManager::ReadEntries(path, entries) || !workspace.FromEntries(entries))
+        return nullptr;
+
+    CacheEntry& entry = m_cache[name];
+    entry.workspace = std::move(workspace);
+    entry.modified = modified;
+    return &entry.workspace;
+}
+
+wxWindow* WorkspaceManager::CreatePane(const WorkspacePane& pane, const wxString& directory) {
+    wxWindow* window = nullptr;
+    if (pane.type == kTerminalType) {
+        TerminalWx* terminal = new TerminalWx(m_parent);
+        terminal->SetCurrentDirectory(pane.directory);
+        window = terminal;
+    } else if (pane.type == kExplorerType) {
+        window = new YaziExplorer(m_parent);
+    } else {
+        return nullptr;
+    }
+
+    // The layout pass shows the pane, which loads its content
+    window->Hide();
+    m_ownedPanes.insert(window);
+    window->Bind(wxEVT_DESTROY, &WorkspaceManager::OnPaneDestroy, this);
+
+    const bool deferred = pane.type == kExplorerType ? !pane.directory.empty()
+                                                     : !pane.history.empty() || pane.anchor > 0;
+    if (deferred) {
+        PendingContent& content = m_pending[window];
+        content.id = m_nextContentId++;
+        content.pane = pane;
+        if (!pane.history.empty())
+            content.historyPath = wxFileName(directory, pane.history).GetFullPath();
+        window->Bind(wxEVT_SHOW, &WorkspaceManager::OnPaneShow, this);
+    }
+    return window;
+}
+
+void WorkspaceManager::LoadContent(wxWindow* window) {
+    auto it = m_pending.find(window);
+    if (it == m_pending.end())
+        return;
+
+    const PendingContent& content = it->second;
+    if (content.pane.type == kExplorerType) {
+        // Navigating starts the explorer's listing
+        if (YaziExplorer* explorer = dynamic_cast<YaziExplorer*>(window))
+            explorer->NavigateTo(content.pane.directory);
+        m_pending.erase(it);
+        return;
+    }
+
+    if (content.historyPath.empty()) {
+        ApplyContent(window, content.id, wxString());
+        return;
+    }
+
+    // Panes shown together read their scrollback in parallel
+    const uint64_t id = content.id;
+    const wxString path = content.historyPath;
+    m_pool.Submit([this, window, id, path]() {
+        MappedFile file;
+        wxString history;
+        if (file.Open(path))
+            history = wxString::FromUTF8(file.GetData(), file.GetSize());
+        CallAfter([this, window, id, history]() { ApplyContent(window, id, history); });
+    });
+}
+
+void WorkspaceManager::ApplyContent(wxWindow* window, uint64_t id, const wxString& history) {
+    // The pane may have been closed, and another one created at its address
+    auto it = m_pending.find(window);
+    if (it == m_pending.end() || it->second.id != id)
+        return;
+
+    if (TerminalWx* terminal = dynamic_cast<TerminalWx*>(window)) {
+        terminal->RestoreScrollback(history);
+        terminal->SetScrollAnchor(it->second.pane.anchor);
+    }
+    m_pending.erase(it);
+}
+
+void WorkspaceManager::OnPaneShow(wxShowEvent& event) {
+    event.Skip();
+    if (!event.IsShown())
+        return;
+
+    wxWindow* window = wxDynamicCast(event.GetEventObject(), wxWindow);
+    if (!window)
+        return;
+    window->Unbind(wxEVT_SHOW, &WorkspaceManager::OnPaneShow, this);
+    LoadContent(window);
+}
+
+void WorkspaceManager::OnPaneDestroy(wxWindowDestroyEvent& event) {
+    event.Skip();
+
+    // Destroy events of the panes' children arrive here too
+    m_ownedPanes.erase(event.GetWindow());
+    m_pending.erase(event.GetWindow());
+}
+
+} // namespace ITD
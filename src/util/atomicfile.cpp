@@ -0,0 +1,113 @@
+#include "util/atomicfile.h"
+#include <wx/wx.h>
+#include <wx/filename.h>
+#include <algorithm>
+#include <atomic>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace ITD {
+
+namespace {
+
+// Temporary file used while writing; unique per process and per write so
+// neither two instances nor two threads writing the same file collide
+wxString GetTempPath(const wxString& filename) {
+    static std::atomic<unsigned> sequence{0};
+    const unsigned id = sequence.fetch_add(1, std::memory_order_relaxed);
+#ifdef _WIN32
+    return wxString::Format("%s.%lu.%u.tmp", filename, static_cast<unsigned long>(GetCurrentProcessId()), id);
+#else
+    return wxString::Format("%s.%ld.%u.tmp", filename, static_cast<long>(getpid()), id);
+#endif
+}
+
+} // namespace
+
+#ifdef _WIN32
+
+bool WriteFileAtomic(const wxString& filename, const void* data, size_t size) {
+    const wxString tempPath = GetTempPath(filename);
+
+    HANDLE file = CreateFileW(tempPath.wc_str(), GENERIC_WRITE, 0, nullptr,
+                              CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        wxLogError("Cannot create '%s' (error %lu)", tempPath, GetLastError());
+        return false;
+    }
+
+    // Write everything, then force it to disk before the rename
+    const char* bytes = static_cast<const char*>(data);
+    size_t written = 0;
+    bool success = true;
+    while (success && written < size) {
+        DWORD chunk = 0;
+        const DWORD request = static_cast<DWORD>(std::min<size_t>(size - written, 1 << 30));
+        success = WriteFile(file, bytes + written, request, &chunk, nullptr) != FALSE;
+        written += chunk;
+    }
+    success = success && FlushFileBuffers(file) != FALSE;
+    CloseHandle(file);
+
+    if (!success ||
+        !MoveFileExW(tempPath.wc_str(), filename.wc_str(),
+                     MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+        wxLogError("Cannot write '%s' (error %lu)", filename, GetLastError());
+        DeleteFileW(tempPath.wc_str());
+        return false;
+    }
+
+    return true;
+}
+
+#else
+
+bool WriteFileAtomic(const wxString& filename, const void* data, size_t size) {
+    const wxString tempPath = GetTempPath(filename);
+
+    int fd = open(tempPath.fn_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        wxLogError("Cannot create '%s' (errno %d)", tempPath, errno);
+        return false;
+    }
+
+    // Write everything, then force it to disk before the rename
+    const char* bytes = static_cast<const char*>(data);
+    size_t written = 0;
+    bool success = true;
+    while (success && written < size) {
+        const ssize_t chunk = write(fd, bytes + written, size - written);
+        if (chunk < 0 && errno == EINTR)
+            continue;
+        success = chunk > 0;
+        if (success)
+            written += static_cast<size_t>(chunk);
+    }
+    success = success && fsync(fd) == 0;
+    success = close(fd) == 0 && success;
+
+    if (!success || rename(tempPath.fn_str(), filename.fn_str()) != 0) {
+        wxLogError("Cannot write '%s' (errno %d)", filename, errno);
+        unlink(tempPath.fn_str());
+        return false;
+    }
+
+    // Persist the rename itself
+    int dirFd = open(wxFileName(filename).GetPath().fn_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirFd >= 0) {
+        fsync(dirFd);
+        close(dirFd);
+    }
+
+    return true;
+}
+
+#endif
+
+} // namespace ITD
\ No newline at end of file
@@ -0,0 +1,367 @@
+#include "util/processtable.h"
+#include "util/procscanner.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace ITD {
+
+namespace {
+
+// /proc/[pid]/stat is well below 1 KiB, /proc/[pid]/io below 256 bytes
+constexpr size_t kBufferSize = 4096;
+
+// Shortest supported pass interval
+constexpr int kMinIntervalMs = 250;
+
+// Counter difference that tolerates resets
+uint64_t Delta(uint64_t before, uint64_t after) {
+    return after >= before ? after - before : 0;
+}
+
+double Seconds(ProcessTable::Clock::duration duration) {
+    return std::chrono::duration<double>(duration).count();
+}
+
+// Parse a directory name that is a PID; 0 otherwise
+int32_t ParsePid(const char* name) {
+    int32_t pid = 0;
+    for (const char* p = name; *p; ++p) {
+        if (*p < '0' || *p > '9' || pid > 100000000)
+            return 0;
+        pid = pid * 10 + (*p - '0');
+    }
+    return pid;
+}
+
+} // namespace
+
+ProcessTable::ProcessTable(const std::string& procRoot)
+    : m_root(procRoot),
+      m_buffer(kBufferSize) {
+#ifdef __linux__
+    const long ticks = sysconf(_SC_CLK_TCK);
+    if (ticks > 0)
+        m_ticksPerSecond = static_cast<double>(ticks);
+    const long pageSize = sysconf(_SC_PAGESIZE);
+    if (pageSize > 0)
+        m_pageSize = static_cast<uint64_t>(pageSize);
+#endif
+}
+
+ProcessTable::~ProcessTable() {
+    Stop();
+#ifdef __linux__
+    if (m_rootFd >= 0)
+        close(m_rootFd);
+#endif
+}
+
+bool ProcessTable::Start(int intervalMs) {
+    Stop();
+    if (!OpenRoot())
+        return false;
+
+    m_stopping = false;
+    m_intervalMs = std::max(intervalMs, kMinIntervalMs);
+    m_thread = std::thread(&ProcessTable::SamplerLoop, this);
+    return true;
+}
+
+void ProcessTable::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_condition.notify_all();
+
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+void ProcessTable::SetRowCount(size_t rows) {
+    m_rowCount.store(std::min(rows, ProcessSnapshot::kMaxRows), std::memory_order_relaxed);
+}
+
+bool ProcessTable::GetSnapshot(ProcessSnapshot& snapshot) const {
+    if (m_snapshot.GetVersion() == 0)
+        return false;
+    m_snapshot.Load(snapshot);
+    return true;
+}
+
+bool ProcessTable::ParseStat(const char* data, size_t size, StatFields& fields) {
+    // The command name is in parentheses and may itself contain them
+    const char* end = data + size;
+    const char* open = static_cast<const char*>(std::memchr(data, '(', size));
+    if (!open)
+        return false;
+    const char* close = end;
+    while (close > open + 1 && close[-1] != ')')
+        --close;
+    if (close[-1] != ')')
+        return false;
+
+    ProcToken name;
+    name.data = open + 1;
+    name.length = static_cast<size_t>(close - 1 - name.data);
+    name.CopyTo(fields.name);
+
+    // Fields after the name, starting with field 3 (state)
+    ProcScanner scanner(close, static_cast<size_t>(end - close));
+    scanner.SkipFields(11);                   // state .. cmajflt
+    fields.cpuTicks = scanner.ReadNumber();   // utime
+    fields.cpuTicks += scanner.ReadNumber();  // stime
+    scanner.SkipFields(6);                    // cutime .. itrealvalue
+    fields.startTime = scanner.ReadNumber();
+    scanner.SkipFields(1);                    // vsize
+    fields.rssPages = scanner.ReadNumber();
+    return true;
+}
+
+void ProcessTable::ParseIo(const char* data, size_t size, uint64_t& readBytes, uint64_t& writeBytes) {
+    readBytes = 0;
+    writeBytes = 0;
+
+    ProcScanner scanner(data, size);
+    while (!scanner.AtEnd()) {
+        const ProcToken key = scanner.ReadToken(':');
+        if (key.Equals("read_bytes"))
+            readBytes = scanner.ReadNumber();
+        else if (key.Equals("write_bytes"))
+            writeBytes = scanner.ReadNumber();
+        scanner.NextLine();
+    }
+}
+
+bool ProcessTable::Update(Clock::time_point now) {
+    if (m_rootFd < 0 && !OpenRoot())
+        return false;
+
+    // New processes are only found by listing the directory, at a limited rate
+    if (m_rescan == 0 || now - m_lastRescan >= std::chrono::milliseconds(kRescanIntervalMs)) {
+        Rescan();
+        m_lastRescan = now;
+    }
+
+    const SortKey key = GetSortKey();
+    uint32_t statReads = 0;
+    for (Entry& entry : m_entries) {
+        if (!entry.alive || entry.nextRead > m_pass)
+            continue;
+        ++statReads;
+        if (!ReadStat(entry, now)) {
+            entry.alive = false;
+            continue;
+        }
+        if (key == SortKey::Io)
+            ReadIo(entry, now);
+    }
+    RemoveDead();
+
+    // Order only the rows that are published
+    auto value = [key](const Entry& entry) {
+        switch (key) {
+        case SortKey::Memory: return static_cast<double>(entry.rssBytes);
+        case SortKey::Io: return entry.readRate + entry.writeRate;
+        default: return entry.cpuPercent;
+        }
+    };
+    const size_t rowCount = std::min(m_rowCount.load(std::memory_order_relaxed), m_entries.size());
+    m_order.resize(m_entries.size());
+    std::iota(m_order.begin(), m_order.end(), size_t(0));
+    std::partial_sort(m_order.begin(), m_order.begin() + rowCount, m_order.end(),
+                      [this, &value](size_t a, size_t b) {
+                          const double valueA = value(m_entries[a]);
+                          const double valueB = value(m_entries[b]);
+                          return valueA != valueB ? valueA > valueB : m_entries[a].pid < m_entries[b].pid;
+                      });
+
+    ProcessSnapshot& snapshot = m_scratch;
+    snapshot.intervalSec = m_pass ? Seconds(now - m_lastPass) : 0.0;
+    snapshot.processCount = static_cast<uint32_t>(m_entries.size());
+    snapshot.statReads = statReads;
+    snapshot.rowCount = static_cast<uint32_t>(rowCount);
+    for (size_t i = 0; i < rowCount; ++i) {
+        Entry& entry = m_entries[m_order[i]];
+        if (key != SortKey::Io)
+            ReadIo(entry, now);
+
+        ProcessSnapshot::Row& row = snapshot.rows[i];
+        row.pid = entry.pid;
+        std::memcpy(row.name, entry.name, sizeof(row.name));
+        row.cpuPercent = entry.cpuPercent;
+        row.rssBytes = entry.rssBytes;
+        row.readBytesPerSec = entry.readRate;
+        row.writeBytesPerSec = entry.writeRate;
+    }
+
+    ++m_pass;
+    m_lastPass = now;
+    snapshot.sequence = m_pass;
+    m_snapshot.Store(snapshot);
+    return true;
+}
+
+bool ProcessTable::OpenRoot() {
+#ifdef __linux__
+    if (m_rootFd < 0)
+        m_rootFd = open(m_root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    return m_rootFd >= 0;
+#else
+    return false;
+#endif
+}
+
+void ProcessTable::Rescan() {
+#ifdef __linux__
+    DIR* dir = opendir(m_root.c_str());
+    if (!dir)
+        return;
+
+    ++m_rescan;
+    while (const dirent* item = readdir(dir)) {
+        const int32_t pid = ParsePid(item->d_name);
+        if (pid <= 0)
+            continue;
+
+        auto it = m_index.find(pid);
+        if (it != m_index.end()) {
+            m_entries[it->second].seen = m_rescan;
+            continue;
+        }
+
+        Entry entry;
+        entry.pid = pid;
+        entry.seen = m_rescan;
+        entry.nextRead = m_pass;
+        m_index.emplace(pid, m_entries.size());
+        m_entries.push_back(entry);
+    }
+    closedir(dir);
+
+    for (Entry& entry : m_entries) {
+        if (entry.seen != m_rescan)
+            entry.alive = false;
+    }
+#endif
+}
+
+long ProcessTable::ReadFile(int32_t pid, const char* file) {
+#ifdef __linux__
+    char path[32];
+    std::snprintf(path, sizeof(path), "%d/%s", static_cast<int>(pid), file);
+    const int fd = openat(m_rootFd, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return -1;
+
+    const ssize_t length = read(fd, m_buffer.data(), m_buffer.size());
+    const int error = errno;
+    close(fd);
+    errno = error;
+    return static_cast<long>(length);
+#else
+    (void)pid;
+    (void)file;
+    return -1;
+#endif
+}
+
+bool ProcessTable::ReadStat(Entry& entry, Clock::time_point now) {
+    const long length = ReadFile(entry.pid, "stat");
+    if (length <= 0)
+        return false;
+
+    StatFields fields;
+    if (!ParseStat(m_buffer.data(), static_cast<size_t>(length), fields))
+        return false;
+
+    // A different start time means the PID now belongs to another process
+    if (entry.statValid && fields.startTime != entry.startTime) {
+        Entry reused;
+        reused.pid = entry.pid;
+        reused.seen = entry.seen;
+        entry = reused;
+    }
+
+    if (entry.statValid) {
+        const uint64_t ticks = Delta(entry.cpuTicks, fields.cpuTicks);
+        const double seconds = Seconds(now - entry.statTime);
+        entry.cpuPercent = seconds > 0.0 ? 100.0 * static_cast<double>(ticks) / m_ticksPerSecond / seconds : 0.0;
+        entry.readSkip = ticks ? 1 : std::min(entry.readSkip * 2, kMaxReadSkip);
+    }
+
+    // Names change on exec, so they are copied on every read
+    std::memcpy(entry.name, fields.name, sizeof(entry.name));
+    entry.startTime = fields.startTime;
+    entry.cpuTicks = fields.cpuTicks;
+    entry.rssBytes = fields.rssPages * m_pageSize;
+    entry.statTime = now;
+    entry.statValid = true;
+    entry.nextRead = m_pass + static_cast<uint64_t>(entry.readSkip);
+    return true;
+}
+
+void ProcessTable::ReadIo(Entry& entry, Clock::time_point now) {
+    if (entry.ioDenied)
+        return;
+
+    // Other users' io files need privileges; do not retry them every pass
+    const long length = ReadFile(entry.pid, "io");
+    if (length < 0) {
+        if (errno == EACCES || errno == EPERM)
+            entry.ioDenied = true;
+        return;
+    }
+
+    uint64_t readBytes, writeBytes;
+    ParseIo(m_buffer.data(), static_cast<size_t>(length), readBytes, writeBytes);
+    if (entry.ioValid) {
+        const double seconds = Seconds(now - entry.ioTime);
+        entry.readRate = seconds > 0.0 ? static_cast<double>(Delta(entry.ioRead, readBytes)) / seconds : 0.0;
+        entry.writeRate = seconds > 0.0 ? static_cast<double>(Delta(entry.ioWrite, writeBytes)) / seconds : 0.0;
+    }
+    entry.ioRead = readBytes;
+    entry.ioWrite = writeBytes;
+    entry.ioTime = now;
+    entry.ioValid = true;
+}
+
+void ProcessTable::RemoveDead() {
+    // Swap-remove keeps the vector compact without shifting thousands of entries
+    for (size_t i = 0; i < m_entries.size();) {
+        if (m_entries[i].alive) {
+            ++i;
+            continue;
+        }
+        m_index.erase(m_entries[i].pid);
+        if (i + 1 != m_entries.size()) {
+            m_entries[i] = m_entries.back();
+            m_index[m_entries[i].pid] = i;
+        }
+        m_entries.pop_back();
+    }
+}
+
+void ProcessTable::SamplerLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stopping) {
+        const Clock::time_point start = Clock::now();
+        lock.unlock();
+        Update(start);
+        lock.lock();
+
+        m_condition.wait_until(lock, start + std::chrono::milliseconds(m_intervalMs),
+                               [this] { return m_stopping; });
+    }
+}
+
+} // namespace ITD
@@ -0,0 +1,116 @@
+#include "util/startuptrace.h"
+#include "util/atomicfile.h"
+#include <wx/wx.h>
+#include <wx/utils.h>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ITD {
+
+namespace {
+
+struct TraceEvent {
+    const char* name;
+    int64_t begin;     ///< Microseconds since process start
+    int64_t duration;  ///< Microseconds; negative for instant events
+    size_t thread;
+};
+
+// Taken during static initialization, as close to process start as we get
+const StartupTrace::Clock::time_point g_origin = StartupTrace::Clock::now();
+
+std::mutex g_mutex;
+std::vector<TraceEvent> g_events;
+bool g_finished = false;
+
+int64_t ToMicroseconds(StartupTrace::Clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(time - g_origin).count();
+}
+
+size_t CurrentThread() {
+    return std::hash<std::thread::id>()(std::this_thread::get_id());
+}
+
+void AddEvent(const TraceEvent& event) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (!g_finished)
+        g_events.push_back(event);
+}
+
+void AppendJsonString(std::string& out, const char* text) {
+    out += '"';
+    for (const char* c = text; *c; ++c) {
+        if (*c == '"' || *c == '\\')
+            out += '\\';
+        out += *c;
+    }
+    out += '"';
+}
+
+} // namespace
+
+void StartupTrace::Record(const char* name, Clock::time_point begin, Clock::time_point end) {
+    AddEvent({ name, ToMicroseconds(begin), ToMicroseconds(end) - ToMicroseconds(begin), CurrentThread() });
+}
+
+double StartupTrace::Mark(const char* name) {
+    const int64_t now = ToMicroseconds(Clock::now());
+    AddEvent({ name, now, -1, CurrentThread() });
+    return now / 1000.0;
+}
+
+void StartupTrace::Finish() {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_finished = true;
+}
+
+double StartupTrace::GetElapsedMs() {
+    return ToMicroseconds(Clock::now()) / 1000.0;
+}
+
+bool StartupTrace::Write(const wxString& filename) {
+    std::vector<TraceEvent> events;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        events = g_events;
+    }
+
+    // Map thread hashes to small, stable IDs for readability
+    std::vector<size_t> threads;
+    auto threadId = [&threads](size_t thread) {
+        for (size_t i = 0; i < threads.size(); ++i) {
+            if (threads[i] == thread)
+                return i + 1;
+        }
+        threads.push_back(thread);
+        return threads.size();
+    };
+
+    std::string json = "{\"traceEvents\":[\n";
+    for (size_t i = 0; i < events.size(); ++i) {
+        const TraceEvent& event = events[i];
+        json += "{\"name\":";
+        AppendJsonString(json, event.name);
+        json += event.duration < 0 ? ",\"ph\":\"i\",\"s\":\"p\"" : ",\"ph\":\"X\"";
+        json += ",\"ts\":" + std::to_string(event.begin);
+        if (event.duration >= 0)
+            json += ",\"dur\":" + std::to_string(event.duration);
+        json += ",\"pid\":1,\"tid\":" + std::to_string(threadId(event.thread)) + "}";
+        json += i + 1 < events.size() ? ",\n" : "\n";
+    }
+    json += "]}\n";
+
+    return WriteFileAtomic(filename, json);
+}
+
+wxString StartupTrace::GetRequestedPath() {
+    wxString path;
+    if (!wxGetEnv("ITD_STARTUP_TRACE", &path))
+        return wxEmptyString;
+    return path;
+}
+
+} // namespace ITD
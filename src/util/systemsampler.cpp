@@ -0,0 +1,389 @@
+#include "util/systemsampler.h"
+#include "util/procscanner.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <memory>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace ITD {
+
+namespace {
+
+// Scratch buffer for one /proc file; /proc/stat is only read up to the CPU lines
+constexpr size_t kBufferSize = 64 * 1024;
+
+// Shortest supported sampling interval
+constexpr int kMinIntervalMs = 50;
+
+// /proc/diskstats counts 512-byte sectors regardless of the device
+constexpr uint64_t kSectorSize = 512;
+
+// Counter difference that tolerates resets and wraps
+uint64_t Delta(uint64_t before, uint64_t after) {
+    return after >= before ? after - before : 0;
+}
+
+double Percent(uint64_t part, uint64_t whole) {
+    return whole ? 100.0 * static_cast<double>(part) / static_cast<double>(whole) : 0.0;
+}
+
+// Find a device by name in the previous pass
+template<typename Device, size_t N>
+const Device* FindDevice(const Device (&devices)[N], size_t count, const char* name) {
+    for (size_t i = 0; i < count; ++i) {
+        if (std::strcmp(devices[i].name, name) == 0)
+            return &devices[i];
+    }
+    return nullptr;
+}
+
+// Partitions are named after their disk plus digits, optionally after a 'p'
+bool IsPartitionOf(const ProcToken& name, const char* disk) {
+    const size_t diskLength = std::strlen(disk);
+    if (name.length <= diskLength || std::memcmp(name.data, disk, diskLength) != 0)
+        return false;
+
+    size_t i = diskLength;
+    if (name.data[i] == 'p')
+        ++i;
+    if (i == name.length)
+        return false;
+    for (; i < name.length; ++i) {
+        if (name.data[i] < '0' || name.data[i] > '9')
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+SystemSampler::SystemSampler() {
+    std::fill(std::begin(m_fds), std::end(m_fds), -1);
+}
+
+SystemSampler::~SystemSampler() {
+    Stop();
+    CloseFiles();
+}
+
+bool SystemSampler::Subscribe(int intervalMs) {
+    intervalMs = std::max(intervalMs, kMinIntervalMs);
+
+    if (m_subscriptions.empty()) {
+        if (!OpenFiles())
+            return false;
+
+        m_subscriptions.insert(intervalMs);
+        m_stopping = false;
+        m_intervalMs = intervalMs;
+        m_thread = std::thread(&SystemSampler::SamplerLoop, this);
+        return true;
+    }
+
+    m_subscriptions.insert(intervalMs);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_intervalMs = *m_subscriptions.begin();
+        m_intervalChanged = true;
+    }
+    m_condition.notify_all();
+    return true;
+}
+
+void SystemSampler::Unsubscribe(int intervalMs) {
+    auto it = m_subscriptions.find(std::max(intervalMs, kMinIntervalMs));
+    if (it == m_subscriptions.end())
+        return;
+    m_subscriptions.erase(it);
+
+    if (m_subscriptions.empty()) {
+        Stop();
+        CloseFiles();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_intervalMs = *m_subscriptions.begin();
+        m_intervalChanged = true;
+    }
+    m_condition.notify_all();
+}
+
+bool SystemSampler::GetSample(SystemSample& sample) const {
+    if (m_sample.GetVersion() == 0)
+        return false;
+    m_sample.Load(sample);
+    return true;
+}
+
+void SystemSampler::ParseStat(const char* data, size_t size, Counters& counters) {
+    counters.cpu = Counters::Cpu();
+    counters.cpuCount = 0;
+
+    // The CPU lines come first; the rest of the file is ignored
+    ProcScanner scanner(data, size);
+    while (!scanner.AtEnd()) {
+        const ProcToken name = scanner.ReadToken();
+        if (!name.StartsWith("cpu"))
+            break;
+
+        // user nice system idle iowait irq softirq steal; guest time is part of user
+        uint64_t fields[8];
+        for (uint64_t& field : fields)
+            field = scanner.ReadNumber();
+        scanner.NextLine();
+
+        Counters::Cpu cpu;
+        for (uint64_t field : fields)
+            cpu.total += field;
+        cpu.busy = cpu.total - fields[3] - fields[4];
+
+        if (name.length == 3)
+            counters.cpu = cpu;
+        else if (counters.cpuCount < SystemSample::kMaxCpus)
+            counters.cpus[counters.cpuCount++] = cpu;
+    }
+}
+
+void SystemSampler::ParseMeminfo(const char* data, size_t size, Counters& counters) {
+    uint64_t memoryFree = 0;
+    bool hasAvailable = false;
+    counters.memoryTotal = counters.memoryAvailable = counters.swapTotal = counters.swapFree = 0;
+
+    // "Key:   value kB" lines
+    ProcScanner scanner(data, size);
+    while (!scanner.AtEnd()) {
+        const ProcToken key = scanner.ReadToken(':');
+        const uint64_t value = scanner.ReadNumber() * 1024;
+        scanner.NextLine();
+
+        if (key.Equals("MemTotal")) {
+            counters.memoryTotal = value;
+        } else if (key.Equals("MemFree")) {
+            memoryFree = value;
+        } else if (key.Equals("MemAvailable")) {
+            counters.memoryAvailable = value;
+            hasAvailable = true;
+        } else if (key.Equals("SwapTotal")) {
+            counters.swapTotal = value;
+        } else if (key.Equals("SwapFree")) {
+            counters.swapFree = value;
+        }
+    }
+
+    // Kernels before 3.14 have no MemAvailable
+    if (!hasAvailable)
+        counters.memoryAvailable = memoryFree;
+}
+
+void SystemSampler::ParseDiskstats(const char* data, size_t size, Counters& counters) {
+    counters.diskCount = 0;
+
+    // "major minor name reads merged sectors ms writes merged sectors ms inflight ioTicks ..."
+    ProcScanner scanner(data, size);
+    while (!scanner.AtEnd() && counters.diskCount < SystemSample::kMaxDisks) {
+        scanner.SkipFields(2);
+        const ProcToken name = scanner.ReadToken();
+        if (name.length == 0) {
+            scanner.NextLine();
+            continue;
+        }
+
+        // Virtual devices and stacked devices would count the same I/O twice
+        bool skip = name.StartsWith("loop") || name.StartsWith("ram") || name.StartsWith("zram") ||
+                    name.StartsWith("dm-") || name.StartsWith("md");
+        for (size_t i = 0; i < counters.diskCount && !skip; ++i)
+            skip = IsPartitionOf(name, counters.disks[i].name);
+        if (skip) {
+            scanner.NextLine();
+            continue;
+        }
+
+        Counters::Disk& disk = counters.disks[counters.diskCount++];
+        name.CopyTo(disk.name);
+        scanner.SkipFields(2);
+        disk.sectorsRead = scanner.ReadNumber();
+        scanner.SkipFields(3);
+        disk.sectorsWritten = scanner.ReadNumber();
+        scanner.SkipFields(2);
+        disk.ioTicksMs = scanner.ReadNumber();
+        scanner.NextLine();
+    }
+}
+
+void SystemSampler::ParseNetDev(const char* data, size_t size, Counters& counters) {
+    counters.interfaceCount = 0;
+
+    // Two header lines, then "name: rxBytes packets errs drop fifo frame compressed multicast txBytes ..."
+    ProcScanner scanner(data, size);
+    scanner.NextLine();
+    scanner.NextLine();
+    while (!scanner.AtEnd() && counters.interfaceCount < SystemSample::kMaxInterfaces) {
+        const ProcToken name = scanner.ReadToken(':');
+        if (name.length == 0 || name.Equals("lo")) {
+            scanner.NextLine();
+            continue;
+        }
+
+        Counters::Interface& device = counters.interfaces[counters.interfaceCount++];
+        name.CopyTo(device.name);
+        device.rxBytes = scanner.ReadNumber();
+        scanner.SkipFields(7);
+        device.txBytes = scanner.ReadNumber();
+        scanner.NextLine();
+    }
+}
+
+void SystemSampler::ComputeSample(const Counters& previous, const Counters& current, double seconds,
+                                  SystemSample& sample) {
+    sample.intervalSec = seconds;
+    const double perSecond = seconds > 0.0 ? 1.0 / seconds : 0.0;
+
+    sample.cpuPercent = Percent(Delta(previous.cpu.busy, current.cpu.busy),
+                                Delta(previous.cpu.total, current.cpu.total));
+    sample.cpuCount = static_cast<uint32_t>(std::min(previous.cpuCount, current.cpuCount));
+    for (size_t i = 0; i < sample.cpuCount; ++i) {
+        sample.cpuPercentPerCore[i] = static_cast<float>(
+            Percent(Delta(previous.cpus[i].busy, current.cpus[i].busy),
+                    Delta(previous.cpus[i].total, current.cpus[i].total)));
+    }
+
+    sample.memoryTotal = current.memoryTotal;
+    sample.memoryAvailable = current.memoryAvailable;
+    sample.swapTotal = current.swapTotal;
+    sample.swapFree = current.swapFree;
+
+    // Devices that appeared since the previous pass are reported from the next one
+    sample.diskCount = 0;
+    for (size_t i = 0; i < current.diskCount; ++i) {
+        const Counters::Disk& now = current.disks[i];
+        const Counters::Disk* before = FindDevice(previous.disks, previous.diskCount, now.name);
+        if (!before)
+            continue;
+
+        SystemSample::Disk& disk = sample.disks[sample.diskCount++];
+        std::memcpy(disk.name, now.name, sizeof(disk.name));
+        disk.readBytesPerSec = static_cast<double>(Delta(before->sectorsRead, now.sectorsRead) * kSectorSize) * perSecond;
+        disk.writeBytesPerSec = static_cast<double>(Delta(before->sectorsWritten, now.sectorsWritten) * kSectorSize) * perSecond;
+        disk.busyPercent = std::min(100.0, static_cast<double>(Delta(before->ioTicksMs, now.ioTicksMs)) * perSecond / 10.0);
+    }
+
+    sample.interfaceCount = 0;
+    for (size_t i = 0; i < current.interfaceCount; ++i) {
+        const Counters::Interface& now = current.interfaces[i];
+        const Counters::Interface* before = FindDevice(previous.interfaces, previous.interfaceCount, now.name);
+        if (!before)
+            continue;
+
+        SystemSample::Interface& device = sample.interfaces[sample.interfaceCount++];
+        std::memcpy(device.name, now.name, sizeof(device.name));
+        device.rxBytesPerSec = static_cast<double>(Delta(before->rxBytes, now.rxBytes)) * perSecond;
+        device.txBytesPerSec = static_cast<double>(Delta(before->txBytes, now.txBytes)) * perSecond;
+    }
+}
+
+bool SystemSampler::OpenFiles() {
+#ifdef __linux__
+    static const char* const kPaths[ProcFileCount] = {
+        "/proc/stat", "/proc/meminfo", "/proc/diskstats", "/proc/net/dev"
+    };
+    for (int i = 0; i < ProcFileCount; ++i) {
+        if (m_fds[i] < 0)
+            m_fds[i] = open(kPaths[i], O_RDONLY | O_CLOEXEC);
+    }
+    return m_fds[Stat] >= 0;
+#else
+    return false;
+#endif
+}
+
+void SystemSampler::CloseFiles() {
+#ifdef __linux__
+    for (int& fd : m_fds) {
+        if (fd >= 0)
+            close(fd);
+        fd = -1;
+    }
+#endif
+}
+
+void SystemSampler::ReadCounters(Counters& counters, char* buffer, size_t size) const {
+#ifdef __linux__
+    typedef void (*Parser)(const char*, size_t, Counters&);
+    static const Parser kParsers[ProcFileCount] = {
+        &SystemSampler::ParseStat, &SystemSampler::ParseMeminfo,
+        &SystemSampler::ParseDiskstats, &SystemSampler::ParseNetDev
+    };
+
+    // /proc files regenerate their content when read from offset 0
+    for (int i = 0; i < ProcFileCount; ++i) {
+        if (m_fds[i] < 0)
+            continue;
+        const ssize_t length = pread(m_fds[i], buffer, size, 0);
+        if (length > 0)
+            kParsers[i](buffer, static_cast<size_t>(length), counters);
+    }
+#else
+    (void)counters;
+    (void)buffer;
+    (void)size;
+#endif
+}
+
+void SystemSampler::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_condition.notify_all();
+
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+void SystemSampler::SamplerLoop() {
+    using Clock = std::chrono::steady_clock;
+
+    // Everything the loop touches is allocated up front
+    std::unique_ptr<char[]> buffer(new char[kBufferSize]);
+    std::unique_ptr<Counters[]> counters(new Counters[2]);
+    std::unique_ptr<SystemSample> sample(new SystemSample());
+    m_sample.Load(*sample);
+
+    size_t current = 0;
+    ReadCounters(counters[current], buffer.get(), kBufferSize);
+    Clock::time_point lastPass = Clock::now();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stopping) {
+        const Clock::time_point due = lastPass + std::chrono::milliseconds(m_intervalMs);
+        m_intervalChanged = false;
+        m_condition.wait_until(lock, due, [this] { return m_stopping || m_intervalChanged; });
+        if (m_stopping)
+            break;
+        if (Clock::now() < due)
+            continue;  // The interval changed; wait for the new deadline
+
+        lock.unlock();
+        const size_t previous = current;
+        current ^= 1;
+        ReadCounters(counters[current], buffer.get(), kBufferSize);
+        const Clock::time_point now = Clock::now();
+        const double seconds = std::chrono::duration<double>(now - lastPass).count();
+        lastPass = now;
+
+        ComputeSample(counters[previous], counters[current], seconds, *sample);
+        ++sample->sequence;
+        sample->timeMs = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+        m_sample.Store(*sample);
+        lock.lock();
+    }
+}
+
+} // namespace ITD
@@ -0,0 +1,55 @@
+#include "util/threadpool.h"
+#include <algorithm>
+
+namespace ITD {
+
+ThreadPool::ThreadPool(size_t threadCount)
+    : m_threadCount(threadCount) {
+    if (m_threadCount == 0)
+        m_threadCount = std::clamp<size_t>(std::thread::hardware_concurrency(), 2, 8);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        m_tasks.clear();
+    }
+    m_condition.notify_all();
+
+    for (std::thread& thread : m_threads)
+        thread.join();
+}
+
+void ThreadPool::Submit(Task task) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push_back(std::move(task));
+
+        // Start the threads on first use
+        if (m_threads.empty()) {
+            for (size_t i = 0; i < m_threadCount; ++i)
+                m_threads.emplace_back(&ThreadPool::WorkerLoop, this);
+        }
+    }
+    m_condition.notify_one();
+}
+
+void ThreadPool::WorkerLoop() {
+    for (;;) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+            if (m_stopping)
+                break;
+
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+
+        task();
+    }
+}
+
+} // namespace ITD
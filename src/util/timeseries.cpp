@@ -0,0 +1,118 @@
+#include "util/timeseries.h"
+#include <algorithm>
+
+namespace ITD {
+
+TimeSeries::TimeSeries()
+    : TimeSeries({ { 1000, 600 }, { 10 * 1000, 720 }, { 60 * 1000, 1440 } }) {
+}
+
+TimeSeries::TimeSeries(std::initializer_list<Level> levels) {
+    m_rings.reserve(levels.size());
+    for (const Level& level : levels) {
+        Ring ring;
+        ring.level.resolutionMs = std::max<int64_t>(level.resolutionMs, 1);
+        ring.level.capacity = std::max<size_t>(level.capacity, 1);
+        ring.buckets.reset(new Bucket[ring.level.capacity]());
+        m_rings.push_back(std::move(ring));
+    }
+}
+
+bool TimeSeries::Add(int64_t timeMs, double value) {
+    if (m_count != 0 && timeMs <= m_lastTime)
+        return false;
+
+    const float sample = static_cast<float>(value);
+    for (Ring& ring : m_rings) {
+        const int64_t step = timeMs / ring.level.resolutionMs;
+        if (step > ring.head) {
+            // Empty the buckets of the steps without samples, at most the whole ring
+            const int64_t first = std::max(ring.head + 1, step - static_cast<int64_t>(ring.level.capacity) + 1);
+            for (int64_t s = first; s <= step; ++s)
+                ring.At(s) = Bucket();
+            ring.head = step;
+        }
+
+        Bucket& bucket = ring.At(step);
+        if (bucket.count == 0) {
+            bucket.min = sample;
+            bucket.max = sample;
+        } else {
+            bucket.min = std::min(bucket.min, sample);
+            bucket.max = std::max(bucket.max, sample);
+        }
+        ++bucket.count;
+    }
+
+    ++m_count;
+    m_lastTime = timeMs;
+    m_lastValue = value;
+    return true;
+}
+
+void TimeSeries::Downsample(int64_t fromMs, int64_t toMs, size_t width, std::vector<Column>& columns) const {
+    columns.assign(width, Column());
+    if (width == 0 || toMs <= fromMs || m_count == 0 || m_rings.empty())
+        return;
+    const int64_t span = toMs - fromMs;
+    const int64_t columnCount = static_cast<int64_t>(width);
+
+    // The finest level that needs few buckets per column and reaches back far
+    // enough; otherwise the coarsest, which reaches furthest
+    const Ring* ring = nullptr;
+    for (const Ring& candidate : m_rings) {
+        ring = &candidate;
+        const int64_t resolution = candidate.level.resolutionMs;
+        const bool coarseEnough = span / resolution <= columnCount * static_cast<int64_t>(kMaxBucketsPerColumn);
+        const bool reachesBack = candidate.GetOldest() * resolution <= fromMs;
+        if (coarseEnough && reachesBack)
+            break;
+    }
+
+    const int64_t resolution = ring->level.resolutionMs;
+    const int64_t firstStep = std::max(fromMs / resolution, std::max<int64_t>(ring->GetOldest(), 0));
+    const int64_t lastStep = std::min((toMs - 1) / resolution, ring->head);
+    for (int64_t step = firstStep; step <= lastStep; ++step) {
+        const Bucket& bucket = ring->At(step);
+        if (bucket.count == 0)
+            continue;
+
+        // A bucket coarser than a column fills every column it overlaps
+        const int64_t start = std::max(step * resolution, fromMs);
+        const int64_t end = std::min((step + 1) * resolution, toMs);
+        const int64_t firstColumn = (start - fromMs) * columnCount / span;
+        const int64_t lastColumn = (end - 1 - fromMs) * columnCount / span;
+        for (int64_t i = firstColumn; i <= lastColumn; ++i) {
+            Column& column = columns[static_cast<size_t>(i)];
+            if (!column.valid) {
+                column.min = bucket.min;
+                column.max = bucket.max;
+                column.valid = true;
+            } else {
+                column.min = std::min(column.min, bucket.min);
+                column.max = std::max(column.max, bucket.max);
+            }
+        }
+    }
+}
+
+size_t TimeSeries::GetMemoryUsage() const {
+    size_t bytes = 0;
+    for (const Ring& ring : m_rings)
+        bytes += ring.level.capacity * sizeof(Bucket);
+    return bytes;
+}
+
+TimeSeries& TimeSeriesStore::Get(const std::string& name) {
+    std::unique_ptr<TimeSeries>& series = m_series[name];
+    if (!series)
+        series.reset(new TimeSeries());
+    return *series;
+}
+
+const TimeSeries* TimeSeriesStore::Find(const std::string& name) const {
+    auto it = m_series.find(name);
+    return it != m_series.end() ? it->second.get() : nullptr;
+}
+
+} // namespace ITD
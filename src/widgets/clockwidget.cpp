@@ -1 +1,54 @@
-// Placeholder  
+#include "widgets/clockwidget.h"
+#include <wx/wx.h>
+#include <wx/config.h>
+
+namespace ITD {
+
+ClockWidget::ClockWidget(wxWindow* parent)
+    : Widget(parent, wxID_ANY, "Clock") {
+}
+
+void ClockWidget::SaveConfig(wxConfigBase* config) const {
+    config->Write("showSeconds", m_showSeconds);
+}
+
+void ClockWidget::LoadConfig(wxConfigBase* config) {
+    config->Read("showSeconds", &m_showSeconds, m_showSeconds);
+}
+
+void ClockWidget::RefreshContent() {
+    const wxDateTime now = wxDateTime::Now();
+    const wxString timeText = now.Format(m_showSeconds ? "%H:%M:%S" : "%H:%M");
+    const wxString dateText = now.Format("%A, %d %B %Y");
+
+    // Only repaint when the text changed, and only the time while the date stays
+    if (timeText == m_timeText && dateText == m_dateText)
+        return;
+    const bool dateChanged = dateText != m_dateText;
+    m_timeText = timeText;
+    m_dateText = dateText;
+    if (dateChanged || m_timeRect.IsEmpty())
+        Refresh(false);
+    else
+        RefreshRect(m_timeRect, false);
+}
+
+void ClockWidget::PaintContent(wxDC& dc, const wxRect& dirty) {
+    (void)dirty;  // Time-only repaints are clipped to m_timeRect
+
+    const wxSize size = GetClientSize();
+    wxFont font = GetFont();
+    font.SetPointSize(font.GetPointSize() * 2);
+    dc.SetFont(font);
+    dc.SetTextForeground(GetForegroundColour());
+
+    const wxSize timeSize = dc.GetTextExtent(m_timeText);
+    m_timeRect = wxRect(0, size.y / 2 - timeSize.y, size.x, timeSize.y);
+    dc.DrawText(m_timeText, (size.x - timeSize.x) / 2, m_timeRect.y);
+
+    dc.SetFont(GetFont());
+    const wxSize dateSize = dc.GetTextExtent(m_dateText);
+    dc.DrawText(m_dateText, (size.x - dateSize.x) / 2, size.y / 2 + 2);
+}
+
+} // namespace ITD
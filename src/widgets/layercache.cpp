@@ -0,0 +1,71 @@
+#include "widgets/layercache.h"
+#include <wx/wx.h>
+#include <climits>
+
+namespace ITD {
+
+LayerCache::LayerCache(size_t budgetBytes)
+    : m_budget(budgetBytes) {
+}
+
+wxBitmap& LayerCache::Get(const wxWindow* owner, int layer, const wxSize& size, bool& valid) {
+    Entry& entry = m_layers[Key(owner, layer)];
+    entry.lastUse = ++m_clock;
+
+    if (!entry.bitmap.IsOk() || entry.bitmap.GetSize() != size) {
+        m_usage -= entry.bytes;
+        entry.bitmap = wxBitmap(size);
+        entry.bytes = static_cast<size_t>(size.GetWidth()) * static_cast<size_t>(size.GetHeight()) * 4;
+        entry.valid = false;
+        m_usage += entry.bytes;
+        if (m_usage > m_budget)
+            Evict(&entry);
+    }
+
+    valid = entry.valid;
+    if (valid)
+        ++m_stats.hits;
+    else
+        ++m_stats.misses;
+
+    // The caller draws the layer now
+    entry.valid = true;
+    return entry.bitmap;
+}
+
+void LayerCache::Invalidate(const wxWindow* owner, int layer) {
+    auto it = m_layers.find(Key(owner, layer));
+    if (it != m_layers.end())
+        it->second.valid = false;
+}
+
+void LayerCache::InvalidateAll(const wxWindow* owner) {
+    for (auto it = m_layers.lower_bound(Key(owner, INT_MIN)); it != m_layers.end() && it->first.first == owner; ++it)
+        it->second.valid = false;
+}
+
+void LayerCache::Remove(const wxWindow* owner) {
+    auto it = m_layers.lower_bound(Key(owner, INT_MIN));
+    while (it != m_layers.end() && it->first.first == owner) {
+        m_usage -= it->second.bytes;
+        it = m_layers.erase(it);
+    }
+}
+
+void LayerCache::Evict(const Entry* keep) {
+    while (m_usage > m_budget) {
+        auto oldest = m_layers.end();
+        for (auto it = m_layers.begin(); it != m_layers.end(); ++it) {
+            if (&it->second != keep && (oldest == m_layers.end() || it->second.lastUse < oldest->second.lastUse))
+                oldest = it;
+        }
+        if (oldest == m_layers.end())
+            return;
+
+        m_usage -= oldest->second.bytes;
+        m_layers.erase(oldest);
+        ++m_stats.evictions;
+    }
+}
+
+} // namespace ITD
@@ -0,0 +1,208 @@
+#include "widgets/processmonitorwidget.h"
+#include <wx/wx.h>
+#include <wx/config.h>
+#include <wx/filename.h>
+#include <algorithm>
+
+namespace ITD {
+
+namespace {
+
+// Table columns; widths are in characters
+struct Column {
+    const char* title;
+    int width;
+    bool alignRight;
+    bool sortable;
+    ProcessTable::SortKey key;
+};
+
+const Column kColumns[] = {
+    { "PID",     7,  true,  false, ProcessTable::SortKey::Cpu },
+    { "Name",    16, false, false, ProcessTable::SortKey::Cpu },
+    { "CPU %",   7,  true,  true,  ProcessTable::SortKey::Cpu },
+    { "Memory",  10, true,  true,  ProcessTable::SortKey::Memory },
+    { "Read/s",  10, true,  true,  ProcessTable::SortKey::Io },
+    { "Write/s", 10, true,  true,  ProcessTable::SortKey::Io },
+};
+
+constexpr int kColumnCount = sizeof(kColumns) / sizeof(kColumns[0]);
+
+// Sort key names in the configuration
+const struct {
+    const char* name;
+    ProcessTable::SortKey key;
+} kSortKeys[] = {
+    { "cpu",    ProcessTable::SortKey::Cpu },
+    { "memory", ProcessTable::SortKey::Memory },
+    { "io",     ProcessTable::SortKey::Io },
+};
+
+constexpr int kMargin = 4;
+
+wxString FormatBytes(uint64_t bytes) {
+    return wxFileName::GetHumanReadableSize(wxULongLong(bytes));
+}
+
+wxString FormatCell(const ProcessSnapshot::Row& row, int column) {
+    switch (column) {
+    case 0: return wxString::Format("%d", static_cast<int>(row.pid));
+    case 1: return wxString::FromUTF8(row.name);
+    case 2: return wxString::Format("%.1f", row.cpuPercent);
+    case 3: return FormatBytes(row.rssBytes);
+    case 4: return FormatBytes(static_cast<uint64_t>(row.readBytesPerSec));
+    default: return FormatBytes(static_cast<uint64_t>(row.writeBytesPerSec));
+    }
+}
+
+} // namespace
+
+ProcessMonitorWidget::ProcessMonitorWidget(wxWindow* parent)
+    : Widget(parent, wxID_ANY, "Processes"),
+      m_table(new ProcessTable()),
+      m_snapshot(new ProcessSnapshot()) {
+    Bind(wxEVT_SIZE, &ProcessMonitorWidget::OnSize, this);
+    Bind(wxEVT_LEFT_DOWN, &ProcessMonitorWidget::OnLeftDown, this);
+
+    UpdateRowCount();
+    m_running = m_table->Start(m_intervalMs);
+}
+
+ProcessMonitorWidget::~ProcessMonitorWidget() {
+    m_table->Stop();
+}
+
+void ProcessMonitorWidget::SaveConfig(wxConfigBase* config) const {
+    config->Write("interval", m_intervalMs);
+    for (const auto& sortKey : kSortKeys) {
+        if (sortKey.key == m_table->GetSortKey())
+            config->Write("sort", wxString(sortKey.name));
+    }
+}
+
+void ProcessMonitorWidget::LoadConfig(wxConfigBase* config) {
+    const int previousInterval = m_intervalMs;
+    config->Read("interval", &m_intervalMs, m_intervalMs);
+    m_intervalMs = std::max(m_intervalMs, 500);
+
+    wxString sort;
+    if (config->Read("sort", &sort)) {
+        for (const auto& sortKey : kSortKeys) {
+            if (sort.IsSameAs(sortKey.name, false) && sortKey.key != m_table->GetSortKey()) {
+                m_table->SetSortKey(sortKey.key);
+                InvalidateLayer(kBackgroundLayer);
+                Refresh(false);
+            }
+        }
+    }
+
+    if (m_running && m_intervalMs != previousInterval)
+        m_running = m_table->Start(m_intervalMs);
+}
+
+void ProcessMonitorWidget::RefreshContent() {
+    if (!m_running)
+        return;
+
+    // Copying the published rows is all the UI thread does
+    const uint64_t shown = m_snapshot->sequence;
+    if (!m_table->GetSnapshot(*m_snapshot) || m_snapshot->sequence == shown)
+        return;
+
+    // The header stays in the background layer
+    const int top = kMargin + GetCharHeight() + 2;
+    const wxSize size = GetClientSize();
+    RefreshRect(wxRect(0, top, size.GetWidth(), std::max(size.GetHeight() - top, 0)), false);
+}
+
+void ProcessMonitorWidget::UpdateRowCount() {
+    const int lineHeight = GetCharHeight() + 2;
+    const int rows = (GetClientSize().GetHeight() - 2 * kMargin) / lineHeight - 2;  // Header and footer
+    m_table->SetRowCount(static_cast<size_t>(std::max(rows, 1)));
+}
+
+void ProcessMonitorWidget::PaintBackground(wxDC& dc, const wxSize& size) {
+    Widget::PaintBackground(dc, size);
+    if (!m_running)
+        return;
+
+    // Header, with the sort column in bold
+    const wxFont font = GetFont();
+    const int charWidth = GetCharWidth();
+    const ProcessTable::SortKey sortKey = m_table->GetSortKey();
+    dc.SetTextForeground(GetForegroundColour());
+    int x = kMargin;
+    for (const Column& column : kColumns) {
+        const bool sorted = column.sortable && column.key == sortKey;
+        dc.SetFont(sorted ? font.Bold() : font);
+        const int width = column.width * charWidth;
+        const int textWidth = dc.GetTextExtent(column.title).GetWidth();
+        dc.DrawText(column.title, column.alignRight ? x + width - textWidth : x, kMargin);
+        x += width + charWidth;
+    }
+}
+
+void ProcessMonitorWidget::PaintContent(wxDC& dc, const wxRect& dirty) {
+    dc.SetFont(GetFont());
+    dc.SetTextForeground(GetForegroundColour());
+
+    if (!m_running) {
+        dc.DrawText("Process list not available", kMargin, kMargin);
+        return;
+    }
+
+    const int charWidth = GetCharWidth();
+    const int lineHeight = GetCharHeight() + 2;
+    const int height = GetClientSize().GetHeight();
+
+    // Rows outside the dirty area are neither formatted nor drawn
+    int y = kMargin + lineHeight;
+    const ProcessSnapshot& snapshot = *m_snapshot;
+    for (uint32_t row = 0; row < snapshot.rowCount && y + 2 * lineHeight <= height; ++row, y += lineHeight) {
+        if (y + lineHeight <= dirty.GetTop() || y > dirty.GetBottom())
+            continue;
+
+        int x = kMargin;
+        for (int i = 0; i < kColumnCount; ++i) {
+            const wxString cell = FormatCell(snapshot.rows[row], i);
+            const int width = kColumns[i].width * charWidth;
+            const int textWidth = dc.GetTextExtent(cell).GetWidth();
+            dc.DrawText(cell, kColumns[i].alignRight ? x + width - textWidth : x, y);
+            x += width + charWidth;
+        }
+    }
+
+    dc.DrawText(wxString::Format("%u processes", snapshot.processCount), kMargin, y);
+}
+
+void ProcessMonitorWidget::OnSize(wxSizeEvent& event) {
+    UpdateRowCount();
+    event.Skip();
+}
+
+void ProcessMonitorWidget::OnLeftDown(wxMouseEvent& event) {
+    const int lineHeight = GetCharHeight() + 2;
+    if (event.GetY() < kMargin || event.GetY() >= kMargin + lineHeight) {
+        event.Skip();
+        return;
+    }
+
+    // Find the clicked header
+    const int charWidth = GetCharWidth();
+    int x = kMargin;
+    for (const Column& column : kColumns) {
+        const int right = x + (column.width + 1) * charWidth;
+        if (event.GetX() >= x && event.GetX() < right) {
+            if (column.sortable && column.key != m_table->GetSortKey()) {
+                m_table->SetSortKey(column.key);
+                InvalidateLayer(kBackgroundLayer);
+                Refresh(false);
+            }
+            break;
+        }
+        x = right;
+    }
+    event.Skip();
+}
+
+} // namespace ITD
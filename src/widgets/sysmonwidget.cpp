@@ -1 +1,252 @@
-// Placeholder  
+#include "widgets/sysmonwidget.h"
+#include "app.h"
+#include <wx/wx.h>
+#include <wx/config.h>
+#include <wx/filename.h>
+#include <algorithm>
+
+namespace ITD {
+
+namespace {
+
+wxString FormatBytes(uint64_t bytes) {
+    return wxFileName::GetHumanReadableSize(wxULongLong(bytes));
+}
+
+wxString FormatRate(double bytesPerSec) {
+    return FormatBytes(static_cast<uint64_t>(bytesPerSec)) + "/s";
+}
+
+// Series and labels of the graphs
+const struct {
+    const char* series;
+    const char* label;
+} kGraphs[] = {
+    { "cpu",    "CPU" },
+    { "memory", "Memory" },
+};
+
+// Draw columns [first, last] of a percentage history into a ring bitmap,
+// where column n is at x = n % width
+void DrawHistoryColumns(wxDC& dc, const wxSize& size, const TimeSeries& series, int64_t msPerColumn,
+                        int64_t first, int64_t last, const wxColour& background, const wxColour& foreground,
+                        std::vector<TimeSeries::Column>& columns) {
+    // One more column on the left connects the first line to its neighbour
+    const size_t count = static_cast<size_t>(last - first + 2);
+    series.Downsample((first - 1) * msPerColumn, (last + 1) * msPerColumn, count, columns);
+
+    // Clear the columns, in two parts if they wrap around
+    const int width = size.GetWidth();
+    const int start = static_cast<int>(first % width);
+    const int length = static_cast<int>(last - first + 1);
+    dc.SetPen(*wxTRANSPARENT_PEN);
+    dc.SetBrush(wxBrush(background));
+    dc.DrawRectangle(start, 0, std::min(length, width - start), size.GetHeight());
+    if (start + length > width)
+        dc.DrawRectangle(0, 0, start + length - width, size.GetHeight());
+
+    auto toY = [&size](float percent) {
+        const float fraction = std::min(std::max(percent / 100.0f, 0.0f), 1.0f);
+        return size.GetHeight() - 1 - static_cast<int>(fraction * static_cast<float>(size.GetHeight() - 1));
+    };
+
+    // Extending each line to its neighbour keeps steep changes connected
+    dc.SetPen(wxPen(foreground));
+    for (size_t i = 1; i < count; ++i) {
+        const TimeSeries::Column& column = columns[i];
+        const TimeSeries::Column& previous = columns[i - 1];
+        if (!column.valid)
+            continue;
+        float low = column.min, high = column.max;
+        if (previous.valid) {
+            low = std::min(low, previous.max);
+            high = std::max(high, previous.min);
+        }
+        const int x = static_cast<int>((first + static_cast<int64_t>(i) - 1) % width);
+        dc.DrawLine(x, toY(low), x, toY(high) - 1);
+    }
+}
+
+} // namespace
+
+SysMonWidget::SysMonWidget(wxWindow* parent)
+    : Widget(parent, wxID_ANY, "System Monitor") {
+    // Falls back to wxGetFreeMemory() where there is no /proc
+    m_subscribed = wxGetApp().GetSystemSampler().Subscribe(m_intervalMs);
+}
+
+SysMonWidget::~SysMonWidget() {
+    if (m_subscribed)
+        wxGetApp().GetSystemSampler().Unsubscribe(m_intervalMs);
+}
+
+void SysMonWidget::SaveConfig(wxConfigBase* config) const {
+    config->Write("interval", m_intervalMs);
+    config->Write("history", m_historySec);
+}
+
+void SysMonWidget::LoadConfig(wxConfigBase* config) {
+    const int previousInterval = m_intervalMs;
+    const int previousHistory = m_historySec;
+    config->Read("interval", &m_intervalMs, m_intervalMs);
+    m_intervalMs = std::max(m_intervalMs, 250);
+    config->Read("history", &m_historySec, m_historySec);
+    m_historySec = std::max(m_historySec, 10);
+
+    // The graph labels show the history length
+    if (m_historySec != previousHistory) {
+        InvalidateLayer(kBackgroundLayer);
+        Refresh(false);
+    }
+
+    if (m_subscribed && m_intervalMs != previousInterval) {
+        SystemSampler& sampler = wxGetApp().GetSystemSampler();
+        sampler.Subscribe(m_intervalMs);
+        sampler.Unsubscribe(previousInterval);
+    }
+}
+
+void SysMonWidget::RefreshContent() {
+    wxString text;
+    SystemSample sample;
+    if (m_subscribed && wxGetApp().GetSystemSampler().GetSample(sample)) {
+        if (sample.sequence == m_lastSequence)
+            return;
+        m_lastSequence = sample.sequence;
+
+        // Every widget offers the sample; the series keep the first copy
+        TimeSeriesStore& history = wxGetApp().GetTimeSeries();
+        history.Get("cpu").Add(sample.timeMs, sample.cpuPercent);
+        if (sample.memoryTotal) {
+            const uint64_t used = sample.memoryTotal - sample.memoryAvailable;
+            history.Get("memory").Add(sample.timeMs, 100.0 * static_cast<double>(used) / static_cast<double>(sample.memoryTotal));
+        }
+
+        double readRate = 0.0, writeRate = 0.0;
+        for (uint32_t i = 0; i < sample.diskCount; ++i) {
+            readRate += sample.disks[i].readBytesPerSec;
+            writeRate += sample.disks[i].writeBytesPerSec;
+        }
+        double rxRate = 0.0, txRate = 0.0;
+        for (uint32_t i = 0; i < sample.interfaceCount; ++i) {
+            rxRate += sample.interfaces[i].rxBytesPerSec;
+            txRate += sample.interfaces[i].txBytesPerSec;
+        }
+
+        text = wxString::Format("CPU: %.1f %% (%u cores)\n", sample.cpuPercent, sample.cpuCount);
+        text += "Memory: " + FormatBytes(sample.memoryTotal - sample.memoryAvailable) + " / " +
+                FormatBytes(sample.memoryTotal) + "\n";
+        text += "Disk: read " + FormatRate(readRate) + ", write " + FormatRate(writeRate) + "\n";
+        text += "Network: in " + FormatRate(rxRate) + ", out " + FormatRate(txRate);
+    } else if (m_subscribed) {
+        text = "Sampling...";
+    } else {
+        const wxMemorySize freeMemory = wxGetFreeMemory();
+        text = freeMemory == -1 ? wxString("Free memory: unknown")
+                                : "Free memory: " + FormatBytes(static_cast<uint64_t>(freeMemory.GetValue()));
+    }
+
+    wxRect textRect, plots[kGraphCount];
+    GetLayout(GetClientSize(), textRect, plots);
+    if (text != m_text) {
+        m_text = text;
+        RefreshRect(textRect, false);
+    }
+
+    // A new sample moves the graphs
+    if (m_subscribed) {
+        for (const wxRect& plot : plots) {
+            if (!plot.IsEmpty())
+                RefreshRect(plot, false);
+        }
+    }
+}
+
+void SysMonWidget::GetLayout(const wxSize& size, wxRect& text, wxRect (&plots)[kGraphCount]) const {
+    const int lineHeight = GetCharHeight();
+    text = wxRect(8, 8, std::max(size.GetWidth() - 16, 0), 4 * lineHeight);
+
+    // Graphs share the space below the text, each under a label line
+    const int top = text.GetBottom() + 1 + 8;
+    const int graphHeight = (size.GetHeight() - top - 8) / kGraphCount - lineHeight - 8;
+    for (int i = 0; i < kGraphCount; ++i) {
+        if (!m_subscribed || graphHeight < 16 || size.GetWidth() < 32) {
+            plots[i] = wxRect();
+            continue;
+        }
+        const int y = top + i * (lineHeight + graphHeight + 8) + lineHeight;
+        plots[i] = wxRect(9, y + 1, size.GetWidth() - 18, graphHeight - 2);  // Inside the frame
+    }
+}
+
+void SysMonWidget::PaintBackground(wxDC& dc, const wxSize& size) {
+    Widget::PaintBackground(dc, size);
+
+    wxRect textRect, plots[kGraphCount];
+    GetLayout(size, textRect, plots);
+
+    dc.SetFont(GetFont());
+    dc.SetTextForeground(GetForegroundColour());
+    dc.SetPen(wxPen(GetForegroundColour()));
+    dc.SetBrush(wxBrush(GetBlendedBackgroundColour()));
+    for (int i = 0; i < kGraphCount; ++i) {
+        if (plots[i].IsEmpty())
+            continue;
+        const wxRect frame = plots[i].Inflate(1);
+        dc.DrawText(wxString::Format("%s, last %d s", kGraphs[i].label, m_historySec), 8, frame.y - GetCharHeight());
+        dc.DrawRectangle(frame);
+    }
+}
+
+void SysMonWidget::PaintContent(wxDC& dc, const wxRect& dirty) {
+    wxRect textRect, plots[kGraphCount];
+    GetLayout(GetClientSize(), textRect, plots);
+
+    if (dirty.Intersects(textRect)) {
+        dc.SetFont(GetFont());
+        dc.SetTextForeground(GetForegroundColour());
+        dc.DrawText(m_text, textRect.GetPosition());
+    }
+
+    const TimeSeriesStore& history = wxGetApp().GetTimeSeries();
+    for (int i = 0; i < kGraphCount; ++i) {
+        const TimeSeries* series = history.Find(kGraphs[i].series);
+        if (series && !series->IsEmpty() && !plots[i].IsEmpty() && dirty.Intersects(plots[i]))
+            PaintGraph(dc, i, *series, plots[i]);
+    }
+}
+
+void SysMonWidget::PaintGraph(wxDC& dc, int index, const TimeSeries& series, const wxRect& plot) {
+    const int width = plot.GetWidth();
+    const int64_t msPerColumn = std::max<int64_t>(static_cast<int64_t>(m_historySec) * 1000 / width, 1);
+    const int64_t last = series.GetLastTime() / msPerColumn;
+
+    bool valid = false;
+    wxBitmap* layer = GetLayer(kBackgroundLayer + 1 + index, plot.GetSize(), valid);
+    wxBitmap scratch;
+    if (!layer) {
+        scratch = wxBitmap(plot.GetSize());
+        layer = &scratch;
+    }
+
+    // Redraw the previous newest column, which may have gained samples, and
+    // everything after it; the whole ring if it is stale
+    GraphState& state = m_graphs[index];
+    int64_t first = state.lastColumn;
+    if (!valid || state.msPerColumn != msPerColumn || last < state.lastColumn || last - state.lastColumn >= width)
+        first = last - width + 1;
+
+    wxMemoryDC layerDC(*layer);
+    DrawHistoryColumns(layerDC, plot.GetSize(), series, msPerColumn, first, last,
+                       GetBlendedBackgroundColour(), GetForegroundColour(), m_columns);
+    state.lastColumn = last;
+    state.msPerColumn = msPerColumn;
+
+    // The oldest column follows the newest in the ring
+    const int split = static_cast<int>((last + 1) % width);
+    dc.Blit(plot.x, plot.y, width - split, plot.height, &layerDC, split, 0);
+    if (split > 0)
+        dc.Blit(plot.x + width - split, plot.y, split, plot.height, &layerDC, 0, 0);
+}
+
+} // namespace ITD
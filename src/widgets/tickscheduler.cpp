@@ -0,0 +1,241 @@
+#include "widgets/tickscheduler.h"
+#include <wx/wx.h>
+#include <wx/time.h>
+#include <algorithm>
+
+namespace ITD {
+
+namespace {
+
+// Longest delay a task accepts to share a tick
+constexpr int kMaxSlackMs = 1000;
+
+// Shortest interval between visibility checks of a hidden task
+constexpr int kHiddenCheckMs = 1000;
+
+} // namespace
+
+TickScheduler::TickScheduler()
+    : m_timer(this) {
+    Bind(wxEVT_TIMER, &TickScheduler::OnTimer, this);
+}
+
+TickScheduler::~TickScheduler() {
+    m_timer.Stop();
+    while (!m_tasks.empty())
+        RemoveAt(m_tasks.size() - 1, true);
+}
+
+TickScheduler::TaskId TickScheduler::Add(const wxString& name, int intervalMs, Callback callback, wxWindow* window) {
+    Task task;
+    task.id = m_nextId++;
+    task.callback = std::move(callback);
+    task.window = window;
+    task.stats.name = name;
+    task.stats.intervalMs = std::max(intervalMs, 1);
+    task.due = NextAlignedTime(Clock::now(), task.stats.intervalMs);
+    m_tasks.push_back(std::move(task));
+
+    if (window) {
+        window->Bind(wxEVT_SHOW, &TickScheduler::OnWindowShow, this);
+        window->Bind(wxEVT_DESTROY, &TickScheduler::OnWindowDestroy, this);
+    }
+
+    Reschedule();
+    return m_tasks.back().id;
+}
+
+bool TickScheduler::Remove(TaskId id) {
+    for (size_t i = 0; i < m_tasks.size(); ++i) {
+        if (m_tasks[i].id == id) {
+            RemoveAt(i, true);
+            Reschedule();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TickScheduler::SetInterval(TaskId id, int intervalMs) {
+    Task* task = Find(id);
+    if (!task)
+        return false;
+
+    task->stats.intervalMs = std::max(intervalMs, 1);
+    task->due = NextAlignedTime(Clock::now(), task->stats.intervalMs);
+    Reschedule();
+    return true;
+}
+
+void TickScheduler::Wake() {
+    const Clock::time_point now = Clock::now();
+    bool resumed = false;
+    for (Task& task : m_tasks) {
+        if (task.stats.suspended) {
+            task.stats.suspended = false;
+            task.due = now;
+            resumed = true;
+        }
+    }
+
+    if (resumed)
+        Reschedule();
+}
+
+const TickScheduler::TaskStats* TickScheduler::GetTaskStats(TaskId id) const {
+    for (const Task& task : m_tasks) {
+        if (task.id == id)
+            return &task.stats;
+    }
+    return nullptr;
+}
+
+void TickScheduler::ForEachTask(const std::function<void(TaskId id, const TaskStats& stats)>& callback) const {
+    for (const Task& task : m_tasks)
+        callback(task.id, task.stats);
+}
+
+TickScheduler::Task* TickScheduler::Find(TaskId id) {
+    for (Task& task : m_tasks) {
+        if (task.id == id)
+            return &task;
+    }
+    return nullptr;
+}
+
+TickScheduler::Clock::time_point TickScheduler::NextAlignedTime(Clock::time_point after, int intervalMs) {
+    // Map the steady time onto the wall clock to find the next boundary
+    const Clock::time_point now = Clock::now();
+    const long long wallMs = wxGetUTCTimeMillis().GetValue() +
+        std::chrono::duration_cast<std::chrono::milliseconds>(after - now).count();
+    const long long phase = wallMs % intervalMs;
+    return after + std::chrono::milliseconds(intervalMs - phase);
+}
+
+TickScheduler::Clock::duration TickScheduler::GetSlack(int intervalMs) {
+    return std::chrono::milliseconds(std::min(intervalMs / 20, kMaxSlackMs));
+}
+
+bool TickScheduler::IsVisible(wxWindow* window) {
+    if (!window->IsShownOnScreen())
+        return false;
+
+    const wxSize size = window->GetSize();
+    if (size.x <= 0 || size.y <= 0)
+        return false;
+
+    wxWindow* top = wxGetTopLevelParent(window);
+    if (!top || top == window)
+        return true;
+
+    wxTopLevelWindow* frame = wxDynamicCast(top, wxTopLevelWindow);
+    if (frame && frame->IsIconized())
+        return false;
+
+    // Scrolled or docked out of the frame
+    return top->GetScreenRect().Intersects(window->GetScreenRect());
+}
+
+void TickScheduler::RemoveAt(size_t index, bool unbind) {
+    wxWindow* window = m_tasks[index].window;
+    if (window && unbind) {
+        window->Unbind(wxEVT_SHOW, &TickScheduler::OnWindowShow, this);
+        window->Unbind(wxEVT_DESTROY, &TickScheduler::OnWindowDestroy, this);
+    }
+    m_tasks.erase(m_tasks.begin() + index);
+}
+
+void TickScheduler::Reschedule() {
+    // OnTimer() reschedules once all tasks of the tick have run
+    if (m_ticking)
+        return;
+
+    // The earliest deadline bounds how long the next tick can wait...
+    Clock::time_point deadline = Clock::time_point::max();
+    for (const Task& task : m_tasks)
+        deadline = std::min(deadline, task.due + GetSlack(task.stats.intervalMs));
+    if (deadline == Clock::time_point::max()) {
+        m_timer.Stop();
+        return;
+    }
+
+    // ...and the tick waits for the last task that can still join it
+    Clock::time_point tick = Clock::time_point::min();
+    for (const Task& task : m_tasks) {
+        if (task.due <= deadline)
+            tick = std::max(tick, task.due);
+    }
+
+    const auto delay = std::chrono::ceil<std::chrono::milliseconds>(tick - Clock::now()).count();
+    m_timer.StartOnce(static_cast<int>(std::max<decltype(delay)>(delay, 1)));
+}
+
+void TickScheduler::OnTimer(wxTimerEvent& event) {
+    wxUnusedVar(event);
+    ++m_wakeups;
+    const Clock::time_point now = Clock::now();
+
+    // Tasks may add or remove tasks, so the due ones are collected first
+    m_dueTasks.clear();
+    for (const Task& task : m_tasks) {
+        if (task.due <= now)
+            m_dueTasks.push_back(task.id);
+    }
+
+    m_ticking = true;
+    for (TaskId id : m_dueTasks) {
+        Task* task = Find(id);
+        if (!task)
+            continue;
+
+        // Hidden windows are checked again at a slower rate: showing one of
+        // their parents sends no wxEVT_SHOW to them
+        if (task->window && !IsVisible(task->window)) {
+            task->stats.suspended = true;
+            ++task->stats.suspensions;
+            task->due = NextAlignedTime(now, std::max(task->stats.intervalMs, kHiddenCheckMs));
+            continue;
+        }
+        task->stats.suspended = false;
+
+        const Clock::time_point start = Clock::now();
+        task->callback();
+        const Clock::time_point end = Clock::now();
+
+        task = Find(id);
+        if (!task)
+            continue;
+        task->stats.cost.Record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+        ++task->stats.runs;
+        task->due = NextAlignedTime(std::max(end, task->due), task->stats.intervalMs);
+    }
+    m_ticking = false;
+
+    Reschedule();
+}
+
+void TickScheduler::OnWindowShow(wxShowEvent& event) {
+    event.Skip();
+    if (event.IsShown())
+        Wake();
+}
+
+void TickScheduler::OnWindowDestroy(wxWindowDestroyEvent& event) {
+    event.Skip();
+
+    // Several tasks may share the window
+    wxWindow* window = event.GetWindow();
+    bool removed = false;
+    for (size_t i = m_tasks.size(); i-- > 0;) {
+        if (m_tasks[i].window == window) {
+            RemoveAt(i, false);
+            removed = true;
+        }
+    }
+
+    if (removed)
+        Reschedule();
+}
+
+} // namespace ITD
@@ -1 +1,280 @@
-// Placeholder  
+#include "widgets/widgetmanager.h"
+#include "widgets/clockwidget.h"
+#include "widgets/sysmonwidget.h"
+#include "widgets/processmonitorwidget.h"
+#include "app.h"
+#include "util/startuptrace.h"
+#include <wx/wx.h>
+#include <wx/dcbuffer.h>
+#include <wx/filename.h>
+#include <wx/stdpaths.h>
+#include <algorithm>
+
+namespace ITD {
+
+namespace {
+
+// Mix a colour over another; alpha 255 gives the colour itself
+wxColour Blend(const wxColour& colour, const wxColour& under, unsigned char alpha) {
+    auto mix = [alpha](unsigned char top, unsigned char bottom) {
+        return static_cast<unsigned char>((top * alpha + bottom * (255 - alpha)) / 255);
+    };
+    return wxColour(mix(colour.Red(), under.Red()), mix(colour.Green(), under.Green()),
+                    mix(colour.Blue(), under.Blue()));
+}
+
+} // namespace
+
+Widget::Widget(wxWindow* parent, wxWindowID id, const wxString& title,
+               const wxPoint& pos, const wxSize& size, long style)
+    : wxPanel(parent, id, pos, size, style),
+      m_title(title) {
+    SetBackgroundStyle(wxBG_STYLE_PAINT);
+    Bind(wxEVT_PAINT, &Widget::OnPaint, this);
+    Bind(wxEVT_SIZE, &Widget::OnSize, this);
+    Bind(wxEVT_SYS_COLOUR_CHANGED, &Widget::OnColourChanged, this);
+}
+
+Widget::~Widget() {
+    if (m_layerCache)
+        m_layerCache->Remove(this);
+}
+
+void Widget::SetTransparency(unsigned char alpha) {
+    if (alpha == m_transparency)
+        return;
+    m_transparency = alpha;
+
+    // Every layer is drawn over the blended background
+    InvalidateLayers();
+    Refresh(false);
+}
+
+void Widget::SetLayerCache(LayerCache* cache) {
+    if (m_layerCache && m_layerCache != cache)
+        m_layerCache->Remove(this);
+    m_layerCache = cache;
+}
+
+wxBitmap* Widget::GetLayer(int layer, const wxSize& size, bool& valid) {
+    valid = false;
+    if (!m_layerCache || size.GetWidth() <= 0 || size.GetHeight() <= 0)
+        return nullptr;
+    return &m_layerCache->Get(this, layer, size, valid);
+}
+
+void Widget::InvalidateLayer(int layer) {
+    if (m_layerCache)
+        m_layerCache->Invalidate(this, layer);
+}
+
+void Widget::InvalidateLayers() {
+    if (m_layerCache)
+        m_layerCache->InvalidateAll(this);
+}
+
+wxColour Widget::GetBlendedBackgroundColour() const {
+    const wxColour under = GetParent() ? GetParent()->GetBackgroundColour() : GetBackgroundColour();
+    return Blend(GetBackgroundColour(), under, m_transparency);
+}
+
+void Widget::PaintBackground(wxDC& dc, const wxSize& size) {
+    const wxColour background = GetBlendedBackgroundColour();
+    dc.GradientFillLinear(wxRect(size), background, background.ChangeLightness(94), wxSOUTH);
+
+    dc.SetPen(wxPen(Blend(GetForegroundColour(), background, 48)));
+    dc.SetBrush(*wxTRANSPARENT_BRUSH);
+    dc.DrawRectangle(wxRect(size));
+}
+
+void Widget::OnPaint(wxPaintEvent& event) {
+    wxUnusedVar(event);
+    wxAutoBufferedPaintDC dc(this);
+    const wxSize size = GetClientSize();
+    const wxRect dirty = GetUpdateRegion().GetBox();
+
+    // Only the dirty part of the static layer is copied
+    bool valid = false;
+    wxBitmap* background = GetLayer(kBackgroundLayer, size, valid);
+    if (background) {
+        wxMemoryDC layer(*background);
+        if (!valid)
+            PaintBackground(layer, size);
+        dc.Blit(dirty.GetPosition(), dirty.GetSize(), &layer, dirty.GetPosition());
+    } else {
+        PaintBackground(dc, size);
+    }
+
+    wxDCClipper clipper(dc, dirty);
+    PaintContent(dc, dirty);
+}
+
+void Widget::OnSize(wxSizeEvent& event) {
+    // Layers are sized to the window and redrawn on the next paint
+    Refresh(false);
+    event.Skip();
+}
+
+void Widget::OnColourChanged(wxSysColourChangedEvent& event) {
+    InvalidateLayers();
+    Refresh(false);
+    event.Skip();
+}
+
+WidgetManager::WidgetManager(wxWindow* parent, wxAuiManager* auiManager)
+    : m_parent(parent),
+      m_auiManager(auiManager) {
+    InitializeWidgetFactories();
+}
+
+WidgetManager::~WidgetManager() {
+    // The widgets themselves belong to the parent window
+    TickScheduler& scheduler = wxGetApp().GetTickScheduler();
+    for (const auto& entry : m_tickTasks)
+        scheduler.Remove(entry.second);
+    for (Widget* widget : m_widgets)
+        widget->SetLayerCache(nullptr);
+}
+
+void WidgetManager::InitializeWidgetFactories() {
+    m_widgetFactories["clock"] = [](wxWindow* parent) { return new ClockWidget(parent); };
+    m_widgetFactories["sysmon"] = [](wxWindow* parent) { return new SysMonWidget(parent); };
+    m_widgetFactories["processes"] = [](wxWindow* parent) { return new ProcessMonitorWidget(parent); };
+}
+
+void WidgetManager::ScanPlugins() {
+    m_pluginsScanned = true;
+    StartupScope scope("WidgetManager::ScanPlugins");
+
+    // The user's plugins come first and win over system-wide ones
+    const wxString configDir = wxFileName(wxGetApp().GetConfigManager().GetConfigFilePath()).GetPath();
+    m_plugins.Scan(wxFileName(configDir, "widgets").GetFullPath());
+    m_plugins.Scan(wxFileName(wxStandardPaths::Get().GetPluginsDir(), "widgets").GetFullPath());
+
+    // Built-in types win over plugins
+    for (const wxString& type : m_plugins.GetTypes()) {
+        const wxString key = type.Lower();
+        if (m_widgetFactories.count(key))
+            continue;
+        m_widgetFactories[key] = [this, key](wxWindow* parent) { return m_plugins.Create(key, parent); };
+    }
+}
+
+Widget* WidgetManager::CreateWidget(const wxString& type, const wxString& title) {
+    Widget* widget = AddWidget(type, title);
+    if (widget)
+        m_auiManager->Update();
+    return widget;
+}
+
+bool WidgetManager::RemoveWidget(Widget* widget) {
+    if (std::find(m_widgets.begin(), m_widgets.end(), widget) == m_widgets.end())
+        return false;
+
+    DetachWidget(widget);
+    m_auiManager->Update();
+    return true;
+}
+
+Widget* WidgetManager::AddWidget(const wxString& type, const wxString& title) {
+    auto factory = m_widgetFactories.find(type.Lower());
+    if (factory == m_widgetFactories.end() && !m_pluginsScanned) {
+        ScanPlugins();
+        factory = m_widgetFactories.find(type.Lower());
+    }
+    if (factory == m_widgetFactories.end())
+        return nullptr;
+
+    Widget* widget = factory->second(m_parent);
+    if (!widget)
+        return nullptr;
+    if (!title.empty())
+        widget->SetTitle(title);
+    widget->SetTransparency(m_transparency);
+    widget->SetLayerCache(&m_layerCache);
+    widget->RefreshContent();
+
+    m_auiManager->AddPane(widget, wxAuiPaneInfo()
+        .Name(wxString::Format("widget%d", m_nextPaneId++))
+        .Caption(widget->GetTitle())
+        .Right()
+        .Layer(1)
+        .BestSize(wxSize(200, 120))
+        .CloseButton(true)
+    );
+    m_widgets.push_back(widget);
+
+    // Periodic refreshes share the application's timer and stop while hidden
+    const int interval = widget->GetRefreshInterval();
+    if (interval > 0) {
+        m_tickTasks[widget] = wxGetApp().GetTickScheduler().Add(
+            widget->GetWidgetType() + ": " + widget->GetTitle(), interval,
+            [widget]() { widget->RefreshContent(); }, widget);
+    }
+
+    return widget;
+}
+
+void WidgetManager::DetachWidget(Widget* widget) {
+    auto task = m_tickTasks.find(widget);
+    if (task != m_tickTasks.end()) {
+        wxGetApp().GetTickScheduler().Remove(task->second);
+        m_tickTasks.erase(task);
+    }
+
+    m_widgets.erase(std::remove(m_widgets.begin(), m_widgets.end(), widget), m_widgets.end());
+    m_auiManager->DetachPane(widget);
+    widget->Destroy();
+}
+
+std::vector<wxString> WidgetManager::GetAvailableWidgetTypes() {
+    if (!m_pluginsScanned)
+        ScanPlugins();
+
+    std::vector<wxString> types;
+    types.reserve(m_widgetFactories.size());
+    for (const auto& entry : m_widgetFactories)
+        types.push_back(entry.first);
+    std::sort(types.begin(), types.end());
+    return types;
+}
+
+void WidgetManager::LoadFromConfig() {
+    // Layout changes are rare; rebuild the widgets from the [widget-*] sections
+    ConfigManager& config = wxGetApp().GetConfigManager();
+    while (!m_widgets.empty())
+        DetachWidget(m_widgets.back());
+
+    for (const wxString& section : config.GetSections()) {
+        if (section.StartsWith("widget-"))
+            AddWidget(config.GetString(section, "type"), config.GetString(section, "title"));
+    }
+    m_auiManager->Update();
+}
+
+void WidgetManager::SaveToConfig() {
+    ConfigManager& config = wxGetApp().GetConfigManager();
+    for (const wxString& section : config.GetSections()) {
+        if (section.StartsWith("widget-"))
+            config.DeleteSection(section);
+    }
+
+    for (size_t i = 0; i < m_widgets.size(); ++i) {
+        const wxString section = wxString::Format("widget-%zu", i + 1);
+        config.SetString(section, "type", m_widgets[i]->GetWidgetType());
+        config.SetString(section, "title", m_widgets[i]->GetTitle());
+    }
+}
+
+void WidgetManager::RefreshAllWidgets() {
+    for (Widget* widget : m_widgets)
+        widget->RefreshContent();
+}
+
+void WidgetManager::SetTransparency(unsigned char alpha) {
+    m_transparency = alpha;
+    for (Widget* widget : m_widgets)
+        widget->SetTransparency(alpha);
+}
+
+} // namespace ITD
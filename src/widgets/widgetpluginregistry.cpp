@@ -0,0 +1,122 @@
+#include "widgets/widgetpluginregistry.h"
+#include "config/configmanager.h"
+#include <wx/wx.h>
+#include <wx/dir.h>
+#include <wx/dynlib.h>
+#include <wx/filename.h>
+#include <algorithm>
+
+namespace ITD {
+
+size_t WidgetPluginRegistry::Scan(const wxString& directory) {
+    if (!wxDir::Exists(directory))
+        return 0;
+
+    wxArrayString manifests;
+    wxDir::GetAllFiles(directory, &manifests, wxString("*.") + kManifestExtension, wxDIR_FILES);
+    manifests.Sort();
+
+    size_t added = 0;
+    for (const wxString& manifest : manifests) {
+        ConfigEntries entries;
+        if (!ConfigManager::ReadEntries(manifest, entries)) {
+            wxLogWarning("Cannot read widget plugin manifest '%s'", manifest);
+            continue;
+        }
+
+        const auto section = entries.find("widget");
+        if (section == entries.end()) {
+            wxLogWarning("Widget plugin manifest '%s' has no [widget] section", manifest);
+            continue;
+        }
+        auto value = [&section](const char* key) {
+            const auto it = section->second.find(key);
+            return it != section->second.end() ? it->second.Strip(wxString::both) : wxString();
+        };
+
+        long abi = 0;
+        if (!value("abi").ToLong(&abi) || abi != ITD_WIDGET_PLUGIN_ABI) {
+            wxLogWarning("Widget plugin '%s' is built for ABI %s, expected %d", manifest, value("abi"),
+                         ITD_WIDGET_PLUGIN_ABI);
+            continue;
+        }
+
+        Plugin plugin;
+        plugin.info.type = value("type");
+        plugin.info.title = value("title");
+        plugin.info.description = value("description");
+        plugin.info.manifest = manifest;
+        if (plugin.info.type.empty() || value("library").empty()) {
+            wxLogWarning("Widget plugin manifest '%s' needs a type and a library", manifest);
+            continue;
+        }
+
+        // Libraries are named relative to their manifest
+        wxFileName library(value("library"));
+        library.MakeAbsolute(directory);
+        plugin.info.library = library.GetFullPath();
+
+        if (!m_plugins.emplace(plugin.info.type.Lower(), plugin).second) {
+            wxLogWarning("Widget plugin '%s' redefines type '%s'; ignored", manifest, plugin.info.type);
+            continue;
+        }
+        ++added;
+    }
+    return added;
+}
+
+const WidgetPluginRegistry::PluginInfo* WidgetPluginRegistry::Find(const wxString& type) const {
+    const auto it = m_plugins.find(type.Lower());
+    return it != m_plugins.end() ? &it->second.info : nullptr;
+}
+
+std::vector<wxString> WidgetPluginRegistry::GetTypes() const {
+    std::vector<wxString> types;
+    types.reserve(m_plugins.size());
+    for (const auto& entry : m_plugins)
+        types.push_back(entry.second.info.type);
+    return types;
+}
+
+Widget* WidgetPluginRegistry::Create(const wxString& type, wxWindow* parent) {
+    const auto it = m_plugins.find(type.Lower());
+    if (it == m_plugins.end())
+        return nullptr;
+
+    Plugin& plugin = it->second;
+    if (!plugin.entry && (plugin.failed || !Load(plugin)))
+        return nullptr;
+    return plugin.entry->create(parent);
+}
+
+bool WidgetPluginRegistry::IsLoaded(const wxString& type) const {
+    const auto it = m_plugins.find(type.Lower());
+    return it != m_plugins.end() && it->second.entry != nullptr;
+}
+
+bool WidgetPluginRegistry::Load(Plugin& plugin) {
+    plugin.failed = true;
+
+    wxDynamicLibrary library;
+    if (!library.Load(plugin.info.library)) {
+        wxLogWarning("Cannot load widget plugin '%s'", plugin.info.library);
+        return false;
+    }
+
+    const auto entry = reinterpret_cast<ITDWidgetPluginEntry>(library.GetSymbol(ITD_WIDGET_PLUGIN_ENTRY));
+    const ITDWidgetPlugin* description = entry ? entry() : nullptr;
+    if (!description || description->abi != ITD_WIDGET_PLUGIN_ABI || !description->create ||
+        !description->type || !plugin.info.type.IsSameAs(wxString::FromUTF8(description->type), false)) {
+        wxLogWarning("'%s' is not a widget plugin for type '%s' with ABI %d", plugin.info.library,
+                     plugin.info.type, ITD_WIDGET_PLUGIN_ABI);
+        return false;
+    }
+
+    // Never unloaded: widgets created by the plugin may outlive the registry
+    library.Detach();
+    plugin.entry = description;
+    plugin.failed = false;
+    return true;
+}
+
+} // namespace ITD
@@ -0,0 +1,19 @@
+#include "widgets/widgetplugin.h"
+
+// Widget plugin loaded by widgetplugin_test. It creates no widget, so it
+// needs nothing from ITD and loads into the test process.
+
+namespace {
+
+ITD::Widget* CreateProbe(wxWindow* parent) {
+    wxUnusedVar(parent);
+    return nullptr;
+}
+
+const ITDWidgetPlugin kProbe = { ITD_WIDGET_PLUGIN_ABI, "probe", &CreateProbe };
+
+} // namespace
+
+extern "C" WXEXPORT const ITDWidgetPlugin* ITD_GetWidgetPlugin() {
+    return &kProbe;
+}
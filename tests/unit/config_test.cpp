@@ -63,4 +63,94 @@ TEST_F(ConfigManagerTest, BooleanValues) {
     EXPECT_FALSE(config.GetBool("test", "nonexistent", false));
 }
 
-} // namespace 
\ No newline at end of file
+// Test the typed configuration snapshot
+TEST_F(ConfigManagerTest, Snapshot) {
+    ITD::ConfigManager config;
+    
+    // Changing a covered section republishes a typed snapshot
+    config.SetInt("terminal", "fontSize", 14);
+    config.SetString("taskbar", "position", "top");
+    EXPECT_EQ(config.GetSnapshot()->terminal.fontSize, 14);
+    EXPECT_EQ(config.GetSnapshot()->taskbar.position, ITD::ConfigSnapshot::Edge::Top);
+    
+    // Changing an unrelated section keeps the current snapshot
+    const std::shared_ptr<const ITD::ConfigSnapshot> snapshot = config.GetSnapshot();
+    config.SetString("test", "key", "value");
+    EXPECT_EQ(config.GetSnapshot(), snapshot);
+    
+    // A held snapshot outlives any number of newer ones
+    for (int size = 1; size <= 64; ++size)
+        config.SetInt("terminal", "fontSize", size);
+    EXPECT_EQ(config.GetSnapshot()->terminal.fontSize, 64);
+    EXPECT_EQ(snapshot->terminal.fontSize, 14);
+}
+
+// Test that a batch notifies listeners once
+TEST_F(ConfigManagerTest, Batch) {
+    ITD::ConfigManager config;
+    int notifications = 0;
+    config.AddChangeListener(ITD::ConfigChangeAll,
+        [&notifications](const ITD::ConfigSnapshot&, uint32_t) { ++notifications; });
+    
+    // Values are readable during the batch, the snapshot follows at the end
+    config.BeginBatch();
+    config.SetInt("terminal", "fontSize", 15);
+    config.SetBool("ui", "transparencyEnabled", true);
+    config.SetInt("ui", "transparency", 200);
+    EXPECT_EQ(config.GetInt("terminal", "fontSize"), 15);
+    EXPECT_EQ(notifications, 0);
+    config.EndBatch();
+    
+    EXPECT_EQ(notifications, 1);
+    EXPECT_EQ(config.GetSnapshot()->terminal.fontSize, 15);
+    EXPECT_EQ(config.GetSnapshot()->ui.transparency, 200);
+}
+
+// Test loading through the binary cache
+TEST_F(ConfigManagerTest, BinaryCache) {
+    const wxString path = wxFileName::CreateTempFileName("itd-config");
+    wxRemoveFile(path);
+    
+    // Write a configuration and build its cache
+    {
+        ITD::ConfigManager config;
+        config.Load(path);
+        config.SetString("test", "key", "value");
+        EXPECT_TRUE(config.Save());
+        EXPECT_TRUE(ITD::ConfigCache::Update(path));
+    }
+    
+    // A second load is served from the cache and reads the same values
+    {
+        ITD::ConfigCache cache;
+        EXPECT_TRUE(cache.Open(path));
+        
+        ITD::ConfigManager config;
+        EXPECT_TRUE(config.Load(path));
+        EXPECT_EQ(config.GetString("test", "key"), "value");
+        EXPECT_TRUE(config.HasEntry("terminal", "fontSize"));
+        
+        // Modifying falls back to the parsed configuration transparently
+        config.SetString("test", "other", "value2");
+        EXPECT_EQ(config.GetString("test", "key"), "value");
+        EXPECT_EQ(config.GetString("test", "other"), "value2");
+    }
+    
+    wxRemoveFile(ITD::ConfigCache::GetCachePath(path));
+    wxRemoveFile(path);
+}
+
+// Test that serialized entries parse back unchanged
+TEST_F(ConfigManagerTest, SerializeEntries) {
+    ITD::ConfigEntries entries;
+    entries["workspace"]["layout"] = "tiled";
+    entries["pane0"]["directory"] = " C:\\Users\\me ";
+    entries["pane0"]["note"] = "line\nbreak \"quoted\"";
+
+    const std::string data = ITD::ConfigManager::SerializeEntries(entries);
+    ITD::ConfigEntries parsed;
+    ASSERT_TRUE(ITD::ConfigManager::ParseEntries(data.data(), data.size(), parsed));
+    EXPECT_EQ(parsed, entries);
+}
+
+} // namespace 
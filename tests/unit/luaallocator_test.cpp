@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include "lua/luaallocator.h"
+#include <lua.hpp>
+
+namespace {
+
+// Test fixture for the Lua allocator
+class LuaAllocatorTest : public ::testing::Test {
+protected:
+    void* Resize(void* block, size_t oldSize, size_t newSize) {
+        return ITD::LuaAllocator::Allocate(&allocator, block, oldSize, newSize);
+    }
+
+    ITD::LuaAllocator allocator;
+};
+
+// Test that freed blocks are reused from the pool
+TEST_F(LuaAllocatorTest, ReusesPooledBlocks) {
+    void* first = Resize(nullptr, LUA_TTABLE, 40);
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(allocator.GetStats().bytesInUse, 40u);
+    EXPECT_EQ(allocator.GetStats().arenaBytes, ITD::LuaAllocator::kArenaChunkSize);
+
+    Resize(first, 40, 0);
+    EXPECT_EQ(allocator.GetStats().bytesInUse, 0u);
+
+    // Same size class
+    void* second = Resize(nullptr, LUA_TSTRING, 48);
+    EXPECT_EQ(second, first);
+    Resize(second, 48, 0);
+
+    EXPECT_EQ(allocator.GetStats().allocations, 2u);
+    EXPECT_EQ(allocator.GetStats().frees, 2u);
+    EXPECT_EQ(allocator.GetStats().pooledAllocations, 2u);
+}
+
+// Test that resizing across size classes keeps the contents
+TEST_F(LuaAllocatorTest, MovesBetweenSizeClasses) {
+    char* block = static_cast<char*>(Resize(nullptr, 0, 16));
+    ASSERT_NE(block, nullptr);
+    for (int i = 0; i < 16; ++i)
+        block[i] = static_cast<char>(i);
+
+    block = static_cast<char*>(Resize(block, 16, 1000));
+    ASSERT_NE(block, nullptr);
+    EXPECT_EQ(allocator.GetStats().largeBytes, 1000u);
+    for (int i = 0; i < 16; ++i)
+        EXPECT_EQ(block[i], static_cast<char>(i));
+
+    block = static_cast<char*>(Resize(block, 1000, 8));
+    ASSERT_NE(block, nullptr);
+    EXPECT_EQ(allocator.GetStats().largeBytes, 0u);
+    EXPECT_EQ(allocator.GetStats().bytesInUse, 8u);
+    EXPECT_EQ(block[7], 7);
+
+    Resize(block, 8, 0);
+    // Both blocks are live while moving
+    EXPECT_EQ(allocator.GetStats().peakBytesInUse, 1016u);
+}
+
+// Test that allocations beyond the limit are refused
+TEST_F(LuaAllocatorTest, EnforcesLimit) {
+    allocator.SetLimit(100);
+
+    void* block = Resize(nullptr, 0, 64);
+    ASSERT_NE(block, nullptr);
+    EXPECT_EQ(Resize(nullptr, 0, 64), nullptr);
+    EXPECT_EQ(allocator.GetStats().refusedAllocations, 1u);
+
+    // Shrinking is always allowed
+    block = Resize(block, 64, 32);
+    ASSERT_NE(block, nullptr);
+    Resize(block, 32, 0);
+}
+
+// Test that a Lua state fails with a memory error at the limit
+TEST_F(LuaAllocatorTest, LimitsLuaState) {
+    allocator.SetLimit(1024 * 1024);
+    lua_State* L = allocator.NewState();
+    ASSERT_NE(L, nullptr);
+    luaL_openlibs(L);
+
+    // A runaway script fails with a memory error instead of growing forever
+    const char* script = "local t = {} for i = 1, 1e7 do t[i] = tostring(i) end";
+    ASSERT_EQ(luaL_loadstring(L, script), LUA_OK);
+    EXPECT_EQ(lua_pcall(L, 0, 0, 0), LUA_ERRMEM);
+    // Blocks moving to a smaller size class are briefly held twice
+    EXPECT_LE(allocator.GetStats().peakBytesInUse, allocator.GetLimit() + ITD::LuaAllocator::kMaxPooledSize);
+    EXPECT_GT(allocator.GetStats().refusedAllocations, 0u);
+
+    lua_close(L);
+    EXPECT_EQ(allocator.GetStats().bytesInUse, 0u);
+}
+
+} // namespace
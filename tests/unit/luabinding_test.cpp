@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include "lua/luabinding.h"
+#include <stdexcept>
+
+namespace {
+
+int Add(int a, int b) {
+    return a + b;
+}
+
+wxString Greet(const wxString& name, const std::optional<wxString>& greeting) {
+    return greeting.value_or("Hello") + ", " + name;
+}
+
+int Fail(int code) {
+    throw std::runtime_error("failed with " + std::to_string(code));
+}
+
+std::vector<std::string> Join(const std::vector<std::string>& values) {
+    return values;
+}
+
+class Counter {
+public:
+    int Increment(int step) { return m_value += step; }
+
+private:
+    int m_value = 0;
+};
+
+// Test fixture for the Lua bindings
+class LuaBindingTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        L = luaL_newstate();
+        luaL_openlibs(L);
+    }
+
+    void TearDown() override {
+        lua_close(L);
+    }
+
+    // Run a chunk that returns one value, leaving it on the stack
+    bool Run(const char* code) {
+        return luaL_loadstring(L, code) == LUA_OK && lua_pcall(L, 0, 1, 0) == LUA_OK;
+    }
+
+    lua_State* L = nullptr;
+};
+
+// Test calling a free function
+TEST_F(LuaBindingTest, FreeFunction) {
+    ITD::LuaBinding::PushFunction<&Add>(L);
+    lua_setglobal(L, "add");
+
+    ASSERT_TRUE(Run("return add(2, 3)"));
+    EXPECT_EQ(lua_tointeger(L, -1), 5);
+}
+
+// Test wxString and optional arguments
+TEST_F(LuaBindingTest, StringArguments) {
+    ITD::LuaBinding::PushFunction<&Greet>(L);
+    lua_setglobal(L, "greet");
+
+    ASSERT_TRUE(Run("return greet('Lua')"));
+    EXPECT_STREQ(lua_tostring(L, -1), "Hello, Lua");
+    lua_pop(L, 1);
+
+    ASSERT_TRUE(Run("return greet('Lua', 'Hi')"));
+    EXPECT_STREQ(lua_tostring(L, -1), "Hi, Lua");
+}
+
+// Test calling a member function
+TEST_F(LuaBindingTest, MemberFunction) {
+    Counter counter;
+    ITD::LuaBinding::PushMethod<&Counter::Increment>(L, &counter);
+    lua_setglobal(L, "increment");
+
+    ASSERT_TRUE(Run("increment(2); return increment(3)"));
+    EXPECT_EQ(lua_tointeger(L, -1), 5);
+}
+
+// Test argument type errors
+TEST_F(LuaBindingTest, TypeError) {
+    ITD::LuaBinding::PushFunction<&Add>(L);
+    lua_setglobal(L, "add");
+
+    EXPECT_FALSE(Run("return add(1, 'x')"));
+    EXPECT_NE(std::string(lua_tostring(L, -1)).find("integer expected"), std::string::npos);
+}
+
+// Test that exceptions become Lua errors carrying their message
+TEST_F(LuaBindingTest, Exception) {
+    ITD::LuaBinding::PushFunction<&Fail>(L);
+    lua_setglobal(L, "fail");
+
+    EXPECT_FALSE(Run("return fail(7)"));
+    EXPECT_STREQ(lua_tostring(L, -1), "failed with 7");
+}
+
+// Test that numbers in string tables are converted without touching the table
+TEST_F(LuaBindingTest, NumbersAsStrings) {
+    ITD::LuaBinding::PushFunction<&Join>(L);
+    lua_setglobal(L, "join");
+
+    ASSERT_TRUE(Run("local t = {'a', 2, 'c'}; local r = join(t); "
+                    "return math.type(t[2]) == 'integer' and r[2] == '2' and r[3] == 'c'"));
+    EXPECT_TRUE(lua_toboolean(L, -1));
+}
+
+} // namespace
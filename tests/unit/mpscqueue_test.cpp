@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include "util/mpscqueue.h"
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Test that concurrent producers deliver every value once, in order per producer
+TEST(MpscQueueTest, DeliversEveryValueOnceInProducerOrder) {
+    constexpr int kProducers = 4;
+    constexpr int kPerProducer = 10000;
+    ITD::MpscQueue<int> queue(kProducers * kPerProducer);
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&queue, p]() {
+            for (int i = 0; i < kPerProducer; ++i)
+                queue.Push(p * kPerProducer + i);
+        });
+    }
+
+    // Consumed while the producers are still pushing
+    std::vector<int> next(kProducers, 0);
+    int received = 0;
+    int value = 0;
+    while (received < kProducers * kPerProducer) {
+        if (!queue.Pop(value)) {
+            std::this_thread::yield();
+            continue;
+        }
+        const int producer = value / kPerProducer;
+        ASSERT_EQ(value % kPerProducer, next[producer]);
+        ++next[producer];
+        ++received;
+    }
+
+    for (std::thread& producer : producers)
+        producer.join();
+    EXPECT_FALSE(queue.Pop(value));
+    EXPECT_EQ(queue.GetSize(), 0u);
+    EXPECT_EQ(queue.GetDropped(), 0u);
+}
+
+// Test that a full queue drops and counts values
+TEST(MpscQueueTest, DropsWhenFull) {
+    ITD::MpscQueue<int> queue(2);
+    EXPECT_TRUE(queue.Push(1));
+    EXPECT_TRUE(queue.Push(2));
+    EXPECT_FALSE(queue.Push(3));
+    EXPECT_EQ(queue.GetDropped(), 1u);
+
+    // Popping makes room again
+    int value = 0;
+    ASSERT_TRUE(queue.Pop(value));
+    EXPECT_EQ(value, 1);
+    EXPECT_TRUE(queue.Push(4));
+    ASSERT_TRUE(queue.Pop(value));
+    EXPECT_EQ(value, 2);
+    ASSERT_TRUE(queue.Pop(value));
+    EXPECT_EQ(value, 4);
+    EXPECT_FALSE(queue.Pop(value));
+}
+
+} // namespace
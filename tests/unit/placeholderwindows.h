@@ -0,0 +1,41 @@
+#pragma once
+
+#include <wx/wx.h>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Distinct window pointers for tests of code that only stores and
+ * compares them
+ *
+ * The pointers refer to plain storage, not to windows, so the code under
+ * test must never dereference them.
+ */
+class PlaceholderWindows {
+public:
+    static constexpr size_t kCount = 64;  ///< Pointers available
+
+    /**
+     * @brief Get a placeholder window
+     * @param index Index below kCount; the same index gives the same pointer
+     * @return Placeholder pointer
+     */
+    wxWindow* Get(size_t index) {
+        return reinterpret_cast<wxWindow*>(&m_storage[index]);
+    }
+
+    /**
+     * @brief Get the first placeholder windows
+     * @param count Number of windows, at most kCount
+     * @return Placeholder pointers
+     */
+    std::vector<wxWindow*> Make(size_t count) {
+        std::vector<wxWindow*> windows;
+        for (size_t i = 0; i < count; ++i)
+            windows.push_back(Get(i));
+        return windows;
+    }
+
+private:
+    char m_storage[kCount];
+};
@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+#include "util/processtable.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+
+namespace {
+
+using Clock = ITD::ProcessTable::Clock;
+
+// Test fixture with a fake /proc directory
+class ProcessTableTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        char pattern[] = "/tmp/itd-proc-XXXXXX";
+        ASSERT_NE(mkdtemp(pattern), nullptr);
+        root = pattern;
+    }
+
+    void TearDown() override {
+        const std::string command = "rm -rf '" + root + "'";
+        std::system(command.c_str());
+    }
+
+    // Write /proc/[pid]/stat with the fields the table reads
+    void WriteStat(int pid, const char* name, uint64_t cpuTicks, uint64_t startTime, uint64_t rssPages) {
+        const std::string directory = root + "/" + std::to_string(pid);
+        mkdir(directory.c_str(), 0755);
+        FILE* file = std::fopen((directory + "/stat").c_str(), "w");
+        ASSERT_NE(file, nullptr);
+        std::fprintf(file, "%d (%s) S 1 1 1 0 -1 4194304 100 0 0 0 %llu 0 0 0 20 0 1 0 %llu 1000000 %llu 0 0\n",
+                     pid, name, static_cast<unsigned long long>(cpuTicks),
+                     static_cast<unsigned long long>(startTime), static_cast<unsigned long long>(rssPages));
+        std::fclose(file);
+    }
+
+    void RemoveProcess(int pid) {
+        const std::string directory = root + "/" + std::to_string(pid);
+        std::remove((directory + "/stat").c_str());
+        rmdir(directory.c_str());
+    }
+
+    std::string root;
+    Clock::time_point start = Clock::now();
+};
+
+// Test parsing /proc/<pid>/stat and io
+TEST_F(ProcessTableTest, ParsesStatAndIo) {
+    const char stat[] = "42 (a (b) c) R 1 42 42 0 -1 4194560 10 0 0 0 150 50 0 0 20 0 3 0 9876 123456 789 18446744073709551615\n";
+    ITD::ProcessTable::StatFields fields;
+    ASSERT_TRUE(ITD::ProcessTable::ParseStat(stat, std::strlen(stat), fields));
+    EXPECT_STREQ(fields.name, "a (b) c");
+    EXPECT_EQ(fields.cpuTicks, 200u);
+    EXPECT_EQ(fields.startTime, 9876u);
+    EXPECT_EQ(fields.rssPages, 789u);
+
+    const char malformed[] = "42 no name";
+    EXPECT_FALSE(ITD::ProcessTable::ParseStat(malformed, std::strlen(malformed), fields));
+
+    const char io[] = "rchar: 1000\nwchar: 2000\nsyscr: 3\nsyscw: 4\nread_bytes: 4096\n"
+                      "write_bytes: 8192\ncancelled_write_bytes: 0\n";
+    uint64_t readBytes = 0, writeBytes = 0;
+    ITD::ProcessTable::ParseIo(io, std::strlen(io), readBytes, writeBytes);
+    EXPECT_EQ(readBytes, 4096u);
+    EXPECT_EQ(writeBytes, 8192u);
+}
+
+// Test that only the top rows are sorted and kept
+TEST_F(ProcessTableTest, SortsTopRows) {
+    WriteStat(1, "init", 0, 1, 100);
+    WriteStat(2, "busy", 0, 2, 200);
+    WriteStat(3, "big", 0, 3, 5000);
+
+    ITD::ProcessTable table(root);
+    table.SetRowCount(2);
+    ASSERT_TRUE(table.Update(start));
+
+    WriteStat(2, "busy", 1000, 2, 200);
+    ASSERT_TRUE(table.Update(start + std::chrono::seconds(1)));
+
+    ITD::ProcessSnapshot snapshot;
+    ASSERT_TRUE(table.GetSnapshot(snapshot));
+    EXPECT_EQ(snapshot.sequence, 2u);
+    EXPECT_EQ(snapshot.processCount, 3u);
+    ASSERT_EQ(snapshot.rowCount, 2u);
+    EXPECT_EQ(snapshot.rows[0].pid, 2);
+    EXPECT_STREQ(snapshot.rows[0].name, "busy");
+    EXPECT_GT(snapshot.rows[0].cpuPercent, 0.0);
+    EXPECT_EQ(snapshot.rows[1].cpuPercent, 0.0);
+
+    table.SetSortKey(ITD::ProcessTable::SortKey::Memory);
+    ASSERT_TRUE(table.Update(start + std::chrono::seconds(2)));
+    ASSERT_TRUE(table.GetSnapshot(snapshot));
+    EXPECT_EQ(snapshot.rows[0].pid, 3);
+    EXPECT_EQ(snapshot.rows[1].pid, 2);
+    EXPECT_GT(snapshot.rows[0].rssBytes, snapshot.rows[1].rssBytes);
+}
+
+// Test that idle processes are read less often
+TEST_F(ProcessTableTest, BacksOffIdleProcesses) {
+    for (int pid = 1; pid <= 10; ++pid)
+        WriteStat(pid, "idle", 5, static_cast<uint64_t>(pid), 10);
+
+    ITD::ProcessTable table(root);
+    ITD::ProcessSnapshot snapshot;
+    uint32_t reads = 0;
+    for (int pass = 0; pass < 16; ++pass) {
+        WriteStat(1, "busy", 5 + static_cast<uint64_t>(pass) * 10, 1, 10);
+        ASSERT_TRUE(table.Update(start + std::chrono::milliseconds(pass * 250)));
+        ASSERT_TRUE(table.GetSnapshot(snapshot));
+        reads += snapshot.statReads;
+    }
+
+    // The busy process is read every pass; idle ones back off
+    EXPECT_EQ(snapshot.processCount, 10u);
+    EXPECT_LT(reads, 16u * 10u / 2u);
+    EXPECT_GE(reads, 16u);
+    EXPECT_EQ(snapshot.rows[0].pid, 1);
+}
+
+// Test that exited processes are dropped and reused pids start over
+TEST_F(ProcessTableTest, TracksExitAndPidReuse) {
+    WriteStat(1, "init", 0, 1, 10);
+    WriteStat(7, "old", 0, 70, 10);
+
+    ITD::ProcessTable table(root);
+    ASSERT_TRUE(table.Update(start));
+    WriteStat(7, "old", 500, 70, 10);
+    ASSERT_TRUE(table.Update(start + std::chrono::seconds(1)));
+
+    // Another process gets PID 7: its CPU time is not diffed against the old one
+    WriteStat(7, "new", 10, 900, 10);
+    ASSERT_TRUE(table.Update(start + std::chrono::seconds(2)));
+    ITD::ProcessSnapshot snapshot;
+    ASSERT_TRUE(table.GetSnapshot(snapshot));
+    EXPECT_EQ(snapshot.processCount, 2u);
+    for (uint32_t i = 0; i < snapshot.rowCount; ++i) {
+        if (snapshot.rows[i].pid == 7) {
+            EXPECT_STREQ(snapshot.rows[i].name, "new");
+            EXPECT_EQ(snapshot.rows[i].cpuPercent, 0.0);
+        }
+    }
+
+    RemoveProcess(7);
+    ASSERT_TRUE(table.Update(start + std::chrono::seconds(3)));
+    ASSERT_TRUE(table.GetSnapshot(snapshot));
+    EXPECT_EQ(snapshot.processCount, 1u);
+}
+
+} // namespace
@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+#include "ui/splittree.h"
+#include "placeholderwindows.h"
+#include <vector>
+
+namespace {
+
+// Test fixture for SplitTree
+class SplitTreeTest : public ::testing::Test {
+protected:
+    std::vector<wxWindow*> MakeWindows(size_t count) {
+        return placeholders.Make(count);
+    }
+
+    PlaceholderWindows placeholders;
+    std::vector<ITD::SplitTree::Change> changes;
+};
+
+// Test that a row fills the area and an unchanged tree lays out nothing
+TEST_F(SplitTreeTest, RowFillsAreaAndLaysOutOnce) {
+    const std::vector<wxWindow*> windows = MakeWindows(3);
+    ITD::SplitTree tree;
+    tree.BuildRow(windows, true);
+    tree.SetArea(wxRect(10, 20, 1000, 600));
+    tree.Layout(changes);
+    ASSERT_EQ(changes.size(), 3u);
+
+    int x = 10;
+    for (wxWindow* window : windows) {
+        const wxRect rect = tree.GetRect(window);
+        EXPECT_EQ(rect.x, x);
+        EXPECT_EQ(rect.y, 20);
+        EXPECT_EQ(rect.height, 600);
+        EXPECT_NEAR(rect.width, 333, 1);
+        x += rect.width;
+    }
+    EXPECT_EQ(x, 1010);
+
+    // Nothing changed: nothing is visited or reported
+    EXPECT_EQ(tree.Layout(changes), 0u);
+    EXPECT_TRUE(changes.empty());
+
+    // A taller area changes every window
+    tree.SetArea(wxRect(10, 20, 1000, 700));
+    tree.Layout(changes);
+    EXPECT_EQ(changes.size(), 3u);
+
+    tree.Invalidate();
+    tree.Layout(changes);
+    EXPECT_EQ(changes.size(), 3u);
+}
+
+// Test that a ratio change only lays out the affected subtree
+TEST_F(SplitTreeTest, RatioChangeStaysLocal) {
+    const std::vector<wxWindow*> windows = MakeWindows(40);
+    ITD::SplitTree tree;
+    tree.BuildGrid(windows, 7);
+    tree.SetArea(wxRect(0, 0, 1400, 600));
+    const size_t full = tree.Layout(changes);
+    EXPECT_EQ(full, 79u);  // 40 leaves and 39 splits
+    EXPECT_EQ(changes.size(), 40u);
+    EXPECT_EQ(tree.GetRect(windows[39]).width, 1400 / 5);
+
+    // The first window shares its split with the next two windows of its row
+    ASSERT_TRUE(tree.SetRatio(windows[0], 0.25));
+    const size_t visited = tree.Layout(changes);
+    EXPECT_LT(visited, 10u);
+    ASSERT_EQ(changes.size(), 3u);
+    EXPECT_EQ(tree.GetRect(windows[3]), wxRect(600, 0, 200, 100));
+
+    EXPECT_TRUE(tree.SetRatio(windows[0], 0.25));
+    EXPECT_EQ(tree.Layout(changes), 0u);
+}
+
+// Test inserting beside a pane and removing panes
+TEST_F(SplitTreeTest, InsertAndRemove) {
+    const std::vector<wxWindow*> windows = MakeWindows(4);
+    ITD::SplitTree tree;
+    tree.SetArea(wxRect(0, 0, 800, 600));
+    ASSERT_TRUE(tree.Insert(windows[0], nullptr, true));
+    ASSERT_TRUE(tree.Insert(windows[1], windows[0], true));
+    ASSERT_TRUE(tree.Insert(windows[2], windows[1], false));
+    EXPECT_FALSE(tree.Insert(windows[2], windows[0], false));
+    tree.Layout(changes);
+    EXPECT_EQ(changes.size(), 3u);
+    EXPECT_EQ(tree.GetRect(windows[0]), wxRect(0, 0, 400, 600));
+    EXPECT_EQ(tree.GetRect(windows[1]), wxRect(400, 0, 400, 300));
+    EXPECT_EQ(tree.GetRect(windows[2]), wxRect(400, 300, 400, 300));
+
+    // Splitting the bottom right window moves only it and the new one
+    ASSERT_TRUE(tree.Insert(windows[3], windows[2], true));
+    tree.Layout(changes);
+    EXPECT_EQ(changes.size(), 2u);
+    EXPECT_EQ(tree.GetRect(windows[3]), wxRect(600, 300, 200, 300));
+
+    // The sibling of a removed window takes its space
+    ASSERT_TRUE(tree.Remove(windows[1]));
+    EXPECT_FALSE(tree.Remove(windows[1]));
+    tree.Layout(changes);
+    EXPECT_EQ(changes.size(), 2u);
+    EXPECT_EQ(tree.GetRect(windows[2]), wxRect(400, 0, 200, 600));
+    EXPECT_EQ(tree.GetRect(windows[3]), wxRect(600, 0, 200, 600));
+
+    ASSERT_TRUE(tree.Remove(windows[0]));
+    ASSERT_TRUE(tree.Remove(windows[3]));
+    tree.Layout(changes);
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0].rect, wxRect(0, 0, 800, 600));
+    EXPECT_FALSE(tree.SetRatio(windows[2], 0.5));
+    EXPECT_EQ(tree.GetWindowCount(), 1u);
+}
+
+// Test saving and loading the tree shape
+TEST_F(SplitTreeTest, SavesAndLoadsShape) {
+    const std::vector<wxWindow*> windows = MakeWindows(3);
+    ITD::SplitTree tree;
+    tree.Insert(windows[0], nullptr, true);
+    tree.Insert(windows[1], windows[0], true);
+    tree.Insert(windows[2], windows[1], false);
+    ASSERT_TRUE(tree.SetRatio(windows[0], 0.25));
+    const std::string shape = tree.Save(windows);
+    EXPECT_EQ(shape, "h2500(0,v5000(1,2))");
+
+    // Windows that are not listed are left out
+    EXPECT_EQ(tree.Save({ windows[0], nullptr, windows[2] }), "h2500(0,2)");
+    EXPECT_EQ(tree.Save({ nullptr, windows[1] }), "1");
+
+    ITD::SplitTree loaded;
+    ASSERT_TRUE(loaded.Load(shape, windows));
+    loaded.SetArea(wxRect(0, 0, 800, 600));
+    loaded.Layout(changes);
+    EXPECT_EQ(changes.size(), 3u);
+    EXPECT_EQ(loaded.GetRect(windows[0]), wxRect(0, 0, 200, 600));
+    EXPECT_EQ(loaded.GetRect(windows[2]), wxRect(200, 300, 600, 300));
+
+    // A missing window collapses its split
+    ASSERT_TRUE(loaded.Load(shape, { windows[0], nullptr, windows[2] }));
+    EXPECT_EQ(loaded.GetWindowCount(), 2u);
+    EXPECT_EQ(loaded.Save(windows), "h2500(0,2)");
+
+    for (const char* malformed : { "", "h5000(0,1", "h5000(0,0)", "x(0,1)", "h(0,1)", "h5000(0,3)", "0)" }) {
+        EXPECT_FALSE(loaded.Load(malformed, windows)) << malformed;
+        EXPECT_EQ(loaded.GetWindowCount(), 0u);
+    }
+}
+
+} // namespace
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+#include "util/systemsampler.h"
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+namespace {
+
+// Test fixture for the /proc sampler
+class SystemSamplerTest : public ::testing::Test {
+protected:
+    void Parse(void (*parser)(const char*, size_t, ITD::SystemSampler::Counters&), const char* text,
+               ITD::SystemSampler::Counters& counters) {
+        parser(text, std::strlen(text), counters);
+    }
+
+    std::unique_ptr<ITD::SystemSampler::Counters[]> counters{new ITD::SystemSampler::Counters[2]};
+};
+
+// Test CPU usage from two /proc/stat samples
+TEST_F(SystemSamplerTest, ComputesCpuUsage) {
+    Parse(&ITD::SystemSampler::ParseStat,
+          "cpu  100 0 100 800 0 0 0 0 0 0\n"
+          "cpu0 50 0 50 400 0 0 0 0 0 0\n"
+          "cpu1 50 0 50 400 0 0 0 0 0 0\n"
+          "intr 12345 0 1 2\n", counters[0]);
+    Parse(&ITD::SystemSampler::ParseStat,
+          "cpu  200 0 200 1400 200 0 0 0 0 0\n"
+          "cpu0 100 0 100 500 0 0 0 0 0 0\n"
+          "cpu1 50 0 50 500 100 0 0 0 0 0\n", counters[1]);
+    EXPECT_EQ(counters[1].cpuCount, 2u);
+
+    ITD::SystemSample sample;
+    ITD::SystemSampler::ComputeSample(counters[0], counters[1], 1.0, sample);
+    EXPECT_DOUBLE_EQ(sample.cpuPercent, 20.0);
+    EXPECT_EQ(sample.cpuCount, 2u);
+    EXPECT_FLOAT_EQ(sample.cpuPercentPerCore[0], 50.0f);
+    EXPECT_FLOAT_EQ(sample.cpuPercentPerCore[1], 0.0f);
+}
+
+// Test parsing /proc/meminfo
+TEST_F(SystemSamplerTest, ParsesMeminfo) {
+    Parse(&ITD::SystemSampler::ParseMeminfo,
+          "MemTotal:       16000 kB\n"
+          "MemFree:         2000 kB\n"
+          "MemAvailable:    8000 kB\n"
+          "SwapTotal:       4000 kB\n"
+          "SwapFree:        3000 kB\n", counters[0]);
+    EXPECT_EQ(counters[0].memoryTotal, 16000u * 1024);
+    EXPECT_EQ(counters[0].memoryAvailable, 8000u * 1024);
+    EXPECT_EQ(counters[0].swapTotal, 4000u * 1024);
+    EXPECT_EQ(counters[0].swapFree, 3000u * 1024);
+}
+
+// Test disk and network rates, counting whole devices only
+TEST_F(SystemSamplerTest, ComputesDiskAndNetworkRates) {
+    Parse(&ITD::SystemSampler::ParseDiskstats,
+          "   7       0 loop0 10 0 80 0 0 0 0 0 0 0 0\n"
+          "   8       0 sda 100 0 1000 0 50 0 2000 0 0 100 0\n"
+          "   8       1 sda1 100 0 1000 0 50 0 2000 0 0 100 0\n"
+          " 259       0 nvme0n1 10 0 100 0 10 0 100 0 0 10 0\n"
+          " 259       1 nvme0n1p1 10 0 100 0 10 0 100 0 0 10 0\n", counters[0]);
+    Parse(&ITD::SystemSampler::ParseDiskstats,
+          "   8       0 sda 200 0 3000 0 60 0 2000 0 0 600 0\n"
+          " 259       0 nvme0n1 10 0 100 0 10 0 100 0 0 10 0\n", counters[1]);
+    ASSERT_EQ(counters[0].diskCount, 2u);
+    EXPECT_STREQ(counters[0].disks[0].name, "sda");
+    EXPECT_STREQ(counters[0].disks[1].name, "nvme0n1");
+
+    Parse(&ITD::SystemSampler::ParseNetDev,
+          "Inter-|   Receive |  Transmit\n"
+          " face |bytes packets|bytes packets\n"
+          "    lo: 999 1 0 0 0 0 0 0 999 1 0 0 0 0 0 0\n"
+          "  eth0: 1000 1 0 0 0 0 0 0 500 1 0 0 0 0 0 0\n", counters[0]);
+    Parse(&ITD::SystemSampler::ParseNetDev,
+          "Inter-|   Receive |  Transmit\n"
+          " face |bytes packets|bytes packets\n"
+          "  eth0: 5000 1 0 0 0 0 0 0 2500 1 0 0 0 0 0 0\n", counters[1]);
+    ASSERT_EQ(counters[0].interfaceCount, 1u);
+
+    ITD::SystemSample sample;
+    ITD::SystemSampler::ComputeSample(counters[0], counters[1], 2.0, sample);
+    ASSERT_EQ(sample.diskCount, 2u);
+    EXPECT_DOUBLE_EQ(sample.disks[0].readBytesPerSec, 2000.0 * 512 / 2);
+    EXPECT_DOUBLE_EQ(sample.disks[0].writeBytesPerSec, 0.0);
+    EXPECT_DOUBLE_EQ(sample.disks[0].busyPercent, 25.0);
+    ASSERT_EQ(sample.interfaceCount, 1u);
+    EXPECT_STREQ(sample.interfaces[0].name, "eth0");
+    EXPECT_DOUBLE_EQ(sample.interfaces[0].rxBytesPerSec, 2000.0);
+    EXPECT_DOUBLE_EQ(sample.interfaces[0].txBytesPerSec, 1000.0);
+}
+
+// Test that the sequence lock never returns a torn value
+TEST_F(SystemSamplerTest, SeqLockReadsConsistentValues) {
+    struct Value {
+        uint64_t fields[64];
+    };
+    ITD::SeqLock<Value> lock;
+
+    // Every stored value has equal fields; a torn read would not
+    std::thread writer([&lock]() {
+        Value value;
+        for (uint64_t i = 1; i <= 100000; ++i) {
+            std::fill(std::begin(value.fields), std::end(value.fields), i);
+            lock.Store(value);
+        }
+    });
+
+    uint32_t reads = 0;
+    uint32_t tornReads = 0;
+    while (lock.GetVersion() < 100000) {
+        Value value;
+        lock.Load(value);
+        if (std::count(std::begin(value.fields), std::end(value.fields), value.fields[0]) != 64)
+            ++tornReads;
+        ++reads;
+    }
+    writer.join();
+
+    EXPECT_GT(reads, 0u);
+    EXPECT_EQ(tornReads, 0u);
+    EXPECT_EQ(lock.GetVersion(), 100000u);
+}
+
+} // namespace
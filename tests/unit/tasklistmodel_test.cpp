@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include "ui/tasklistmodel.h"
+#include "placeholderwindows.h"
+#include <vector>
+
+namespace {
+
+// Test fixture for TaskListModel
+class TaskListModelTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        model.AddListener([this](const ITD::TaskListModel::Change& change) { changes.push_back(change); });
+    }
+
+    wxWindow* Window(size_t index) {
+        return windows.Get(index);
+    }
+
+    PlaceholderWindows windows;
+    ITD::TaskListModel model;
+    std::vector<ITD::TaskListModel::Change> changes;
+};
+
+// Test that insertions and removals are reported with their index
+TEST_F(TaskListModelTest, ReportsInsertionsAndRemovals) {
+    ASSERT_TRUE(model.Add("one", wxIcon(), Window(0)));
+    ASSERT_TRUE(model.Add("two", wxIcon(), Window(1)));
+    ASSERT_TRUE(model.Add("three", wxIcon(), Window(2)));
+    EXPECT_FALSE(model.Add("again", wxIcon(), Window(1)));
+    EXPECT_FALSE(model.Add("none", wxIcon(), nullptr));
+    ASSERT_EQ(changes.size(), 3u);
+    EXPECT_EQ(changes[2].kind, ITD::TaskListModel::ChangeKind::Inserted);
+    EXPECT_EQ(changes[2].index, 2u);
+
+    // Later tasks move up and are still found
+    changes.clear();
+    ASSERT_TRUE(model.Remove(Window(1)));
+    EXPECT_FALSE(model.Remove(Window(1)));
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0].kind, ITD::TaskListModel::ChangeKind::Removed);
+    EXPECT_EQ(changes[0].index, 1u);
+    EXPECT_EQ(changes[0].window, Window(1));
+    EXPECT_EQ(model.GetCount(), 2u);
+    EXPECT_EQ(model.Find(Window(2)), 1);
+    EXPECT_EQ(model.Find(Window(1)), -1);
+    EXPECT_EQ(model.GetTask(1).name, wxString("three"));
+}
+
+// Test that activation reports only the tasks whose state changed
+TEST_F(TaskListModelTest, ActivationReportsOnlyAffectedTasks) {
+    for (size_t i = 0; i < 5; ++i)
+        model.Add("task", wxIcon(), Window(i));
+
+    changes.clear();
+    model.SetActive(Window(3));
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0].kind, ITD::TaskListModel::ChangeKind::Activated);
+    EXPECT_EQ(changes[0].index, 3u);
+    EXPECT_TRUE(model.GetTask(3).isActive);
+
+    // The previous and the new active task, nothing else
+    changes.clear();
+    model.SetActive(Window(1));
+    ASSERT_EQ(changes.size(), 2u);
+    EXPECT_EQ(changes[0].index, 3u);
+    EXPECT_EQ(changes[1].index, 1u);
+    EXPECT_FALSE(model.GetTask(3).isActive);
+
+    changes.clear();
+    model.SetActive(Window(1));
+    EXPECT_TRUE(changes.empty());
+
+    // Removing the active task leaves none active
+    model.Remove(Window(1));
+    changes.clear();
+    model.SetActive(nullptr);
+    EXPECT_TRUE(changes.empty());
+}
+
+} // namespace
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include "util/timeseries.h"
+#include <vector>
+
+namespace {
+
+// Test fixture for the multi-resolution time series
+class TimeSeriesTest : public ::testing::Test {
+protected:
+    // Two levels: 10 buckets of 1 s, 10 buckets of 10 s
+    ITD::TimeSeries series{ { 1000, 10 }, { 10000, 10 } };
+    std::vector<ITD::TimeSeries::Column> columns;
+};
+
+// Test that samples must move forward in time
+TEST_F(TimeSeriesTest, RejectsOldSamples) {
+    EXPECT_TRUE(series.IsEmpty());
+    EXPECT_TRUE(series.Add(1000, 1.0));
+    EXPECT_FALSE(series.Add(1000, 2.0));
+    EXPECT_FALSE(series.Add(500, 2.0));
+    EXPECT_TRUE(series.Add(1500, 3.0));
+    EXPECT_EQ(series.GetLastTime(), 1500);
+    EXPECT_DOUBLE_EQ(series.GetLastValue(), 3.0);
+}
+
+// Test downsampling from the finest ring
+TEST_F(TimeSeriesTest, DownsamplesFineLevel) {
+    for (int64_t t = 0; t < 10000; t += 250)
+        series.Add(t, t == 4500 ? 100.0 : 1.0);
+
+    // 10 s over 5 columns: 2 buckets of 1 s per column
+    series.Downsample(0, 10000, 5, columns);
+    ASSERT_EQ(columns.size(), 5u);
+    for (size_t i = 0; i < columns.size(); ++i) {
+        EXPECT_TRUE(columns[i].valid);
+        EXPECT_FLOAT_EQ(columns[i].min, 1.0f);
+        EXPECT_FLOAT_EQ(columns[i].max, i == 2 ? 100.0f : 1.0f);  // The peak survives
+    }
+}
+
+// Test that older ranges come from the coarser rings
+TEST_F(TimeSeriesTest, FallsBackToRollups) {
+    for (int64_t t = 0; t < 60000; t += 1000)
+        series.Add(t, static_cast<double>(t / 1000));
+
+    // The 1 s ring only reaches back 10 s; the full minute comes from the 10 s ring
+    series.Downsample(0, 60000, 6, columns);
+    for (size_t i = 0; i < columns.size(); ++i) {
+        ASSERT_TRUE(columns[i].valid);
+        EXPECT_FLOAT_EQ(columns[i].min, static_cast<float>(i * 10));
+        EXPECT_FLOAT_EQ(columns[i].max, static_cast<float>(i * 10 + 9));
+    }
+
+    // Wider than the data: buckets coarser than a column fill every column they cover
+    series.Downsample(0, 60000, 60, columns);
+    EXPECT_TRUE(columns[0].valid);
+    EXPECT_FLOAT_EQ(columns[5].max, 9.0f);
+}
+
+// Test that memory use does not grow with samples
+TEST_F(TimeSeriesTest, KeepsConstantMemory) {
+    const size_t memory = series.GetMemoryUsage();
+    for (int64_t t = 0; t < 1000000; t += 100)
+        series.Add(t, 1.0);
+    EXPECT_EQ(series.GetMemoryUsage(), memory);
+
+    // A gap longer than the rings leaves only the new sample
+    series.Add(5000000, 7.0);
+    series.Downsample(4950000, 5010000, 6, columns);
+    for (size_t i = 0; i < columns.size(); ++i)
+        EXPECT_EQ(columns[i].valid, i == 5);
+    EXPECT_FLOAT_EQ(columns[5].max, 7.0f);
+}
+
+// Test that the store creates each series once
+TEST_F(TimeSeriesTest, StoreCreatesSeriesOnce) {
+    ITD::TimeSeriesStore store;
+    EXPECT_EQ(store.Find("cpu"), nullptr);
+    ITD::TimeSeries& cpu = store.Get("cpu");
+    cpu.Add(1, 1.0);
+    EXPECT_EQ(&store.Get("cpu"), &cpu);
+    EXPECT_EQ(store.Find("cpu"), &cpu);
+}
+
+} // namespace
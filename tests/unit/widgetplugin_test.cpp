@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include "widgets/widgetpluginregistry.h"
+#include <wx/wx.h>
+#include <wx/ffile.h>
+#include <wx/filename.h>
+#include <wx/log.h>
+
+namespace {
+
+// Test fixture with a temporary plugin directory
+class WidgetPluginTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        directory = wxFileName::CreateTempFileName("itd-plugins");
+        wxRemoveFile(directory);
+        ASSERT_TRUE(wxFileName::Mkdir(directory));
+    }
+
+    void TearDown() override {
+        wxFileName::Rmdir(directory, wxPATH_RMDIR_RECURSIVE);
+    }
+
+    void WriteManifest(const wxString& name, const wxString& content) {
+        wxFFile file(wxFileName(directory, name).GetFullPath(), "w");
+        ASSERT_TRUE(file.IsOpened());
+        file.Write(content);
+    }
+
+    wxString directory;
+    wxLogNull noLog;  // Skipped manifests log warnings
+};
+
+// Test that scanning reads manifests without loading libraries
+TEST_F(WidgetPluginTest, ScansManifestsWithoutLoading) {
+    WriteManifest("weather.widget",
+                  "[widget]\ntype = Weather\ntitle = Weather\nlibrary = libweather.so\nabi = 1\n");
+    WriteManifest("old.widget", "[widget]\ntype = old\nlibrary = libold.so\nabi = 0\n");
+    WriteManifest("broken.widget", "[widget]\ntype = broken\nabi = 1\n");
+    WriteManifest("notes.txt", "[widget]\ntype = notes\nlibrary = libnotes.so\nabi = 1\n");
+
+    ITD::WidgetPluginRegistry registry;
+    EXPECT_EQ(registry.Scan(directory), 1u);
+    EXPECT_EQ(registry.Scan(directory + "-missing"), 0u);
+
+    const ITD::WidgetPluginRegistry::PluginInfo* info = registry.Find("weather");
+    ASSERT_NE(info, nullptr);
+    EXPECT_EQ(info->type, "Weather");
+    EXPECT_EQ(info->title, "Weather");
+    EXPECT_EQ(info->library, wxFileName(directory, "libweather.so").GetFullPath());
+    EXPECT_FALSE(registry.IsLoaded("weather"));
+    EXPECT_EQ(registry.Find("old"), nullptr);
+    EXPECT_EQ(registry.Find("broken"), nullptr);
+    EXPECT_EQ(registry.Find("notes"), nullptr);
+}
+
+// Test that the first manifest of a type wins and missing libraries fail
+TEST_F(WidgetPluginTest, FirstScanWinsAndMissingLibrariesFail) {
+    WriteManifest("a.widget", "[widget]\ntype = clock2\nlibrary = liba.so\nabi = 1\n");
+    WriteManifest("b.widget", "[widget]\ntype = CLOCK2\nlibrary = libb.so\nabi = 1\n");
+
+    ITD::WidgetPluginRegistry registry;
+    EXPECT_EQ(registry.Scan(directory), 1u);
+    EXPECT_EQ(registry.GetTypes().size(), 1u);
+    EXPECT_TRUE(registry.Find("clock2")->library.EndsWith("liba.so"));
+
+    // The library does not exist; creating fails without retrying the load
+    EXPECT_EQ(registry.Create("clock2", nullptr), nullptr);
+    EXPECT_EQ(registry.Create("clock2", nullptr), nullptr);
+    EXPECT_FALSE(registry.IsLoaded("clock2"));
+    EXPECT_EQ(registry.Create("unknown", nullptr), nullptr);
+}
+
+// Test that a library is loaded on first use and stays loaded
+TEST_F(WidgetPluginTest, LoadsLibraryOnFirstCreate) {
+    WriteManifest("probe.widget", wxString::Format("[widget]\ntype = probe\nlibrary = %s\nabi = 1\n",
+                                                   ITD_PROBE_WIDGET_PLUGIN));
+
+    ITD::WidgetPluginRegistry registry;
+    ASSERT_EQ(registry.Scan(directory), 1u);
+    EXPECT_FALSE(registry.IsLoaded("probe"));
+
+    // The probe creates no widget
+    EXPECT_EQ(registry.Create("probe", nullptr), nullptr);
+    EXPECT_TRUE(registry.IsLoaded("probe"));
+    EXPECT_EQ(registry.Create("probe", nullptr), nullptr);
+}
+
+} // namespace